@@ -5,6 +5,8 @@
 BinaryThreadOp::BinaryThreadOp(OP_MODE opt)
 {
 	optType=opt;
+	RIDR=NULL;
+	RIDS=NULL;
 }
 
 
@@ -16,6 +18,16 @@ void BinaryThreadOp::init(cl_mem p_R, int p_rLen, cl_mem p_S, int p_sLen)
 	sLen=p_sLen;
 }
 
+//R and S are typed key columns of the same type, joined on the typed hash join.
+void BinaryThreadOp::initTyped(cl_mem p_R, int p_rLen, cl_mem p_RIDR, cl_mem p_S, int p_sLen, cl_mem p_RIDS, int p_colType)
+{
+	init(p_R,p_rLen,p_S,p_sLen);
+	RIDR=p_RIDR;
+	RIDS=p_RIDS;
+	isTyped=true;
+	colType=p_colType;
+}
+
 BinaryThreadOp::~BinaryThreadOp(void)
 {
 }
@@ -24,6 +36,11 @@ BinaryThreadOp::~BinaryThreadOp(void)
 void BinaryThreadOp::execute(EXEC_MODE eM)
 {
 		//ON_GPU("BinaryThreadOp::execute");
+		if(isTyped)
+		{
+			numResult=CL_TypedHjOnly(R,RIDR,Query_rLen,S,RIDS,sLen,colType,&Rout,256,512,eM);
+			return;
+		}
 		switch(optType)
 		{
 			case JOIN_NINLJ:
@@ -47,6 +64,12 @@ void BinaryThreadOp::execute(EXEC_MODE eM)
 					numResult=CL_hjOnly(R,Query_rLen,S,sLen,&Rout,eM);
 					//printf("CL_hjOnly::finished\n");
 				}break;
+			case TOP_K:
+			default:
+				{
+					cout<<"not a join, "<<OpToString(optType,eM)<<endl;
+					exit(1);
+				}
 		}
 		//ON_GPU_DONE("BinaryThreadOp::execute");
 }
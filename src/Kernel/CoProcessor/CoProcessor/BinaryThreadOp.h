@@ -8,8 +8,12 @@ class BinaryThreadOp :
 public:
 	cl_mem S;
 	int sLen;
+	//the rids of the typed keys in R and S, NULL for a base table.
+	cl_mem RIDR;
+	cl_mem RIDS;
 	BinaryThreadOp(OP_MODE opt);
 	void init(cl_mem p_R, int p_rLen, cl_mem p_S, int p_sLen);
+	void initTyped(cl_mem p_R, int p_rLen, cl_mem p_RIDR, cl_mem p_S, int p_sLen, cl_mem p_RIDS, int p_colType);
 	~BinaryThreadOp(void);
 	void execute(EXEC_MODE eM);
 	ThreadOp* getNextOp(EXEC_MODE eM);
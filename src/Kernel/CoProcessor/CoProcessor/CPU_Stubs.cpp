@@ -15,6 +15,7 @@
 #include "../MyLib/common.h"
 #include "../MyLib/hashTable.h"
 #include "../MyLib/CC_CSSTree.h"
+#include "../TonyLib/Sketch.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
@@ -162,6 +163,89 @@ void CPU_Sort(Record* Rin, int rLen, Record* Rout, int numThread) {
     qsort(Rout, rLen, sizeof(Record), cmp_record_value);
 }
 
+// ---------- CPU Top K ----------
+static bool topk_less(const Record& a, const Record& b) {
+    return a.value < b.value || (a.value == b.value && a.rid < b.rid);
+}
+
+static bool topk_greater(const Record& a, const Record& b) {
+    return a.value > b.value || (a.value == b.value && a.rid < b.rid);
+}
+
+// each thread keeps the k best of its chunk, the numThread*k candidates are
+// then ordered once: n log k instead of sorting all of Rin.
+int CPU_TopK(Record* Rin, int rLen, int k, bool largest, Record* Rout, int numThread) {
+    if (k > rLen) k = rLen;
+    if (k <= 0) return 0;
+    if (numThread < 1) numThread = 1;
+    bool (*better)(const Record&, const Record&) = largest ? topk_greater : topk_less;
+    Record* cand = new Record[(size_t)numThread * k];
+    int* candLen = new int[numThread];
+    #pragma omp parallel for num_threads(numThread)
+    for (int t = 0; t < numThread; t++) {
+        int from = (int)((long long)rLen * t / numThread);
+        int to = (int)((long long)rLen * (t + 1) / numThread);
+        Record* out = cand + (size_t)t * k;
+        candLen[t] = (int)(std::partial_sort_copy(Rin + from, Rin + to, out, out + k, better) - out);
+    }
+    int numCand = 0;
+    for (int t = 0; t < numThread; t++) {
+        memmove(cand + numCand, cand + (size_t)t * k, sizeof(Record) * candLen[t]);
+        numCand += candLen[t];
+    }
+    std::partial_sort(cand, cand + k, cand + numCand, better);
+    memcpy(Rout, cand, sizeof(Record) * k);
+    delete[] candLen;
+    delete[] cand;
+    return k;
+}
+
+// ---------- CPU Approximate Aggregates ----------
+// a sketch per thread, merged as the work groups of the device merge theirs.
+double CPU_ApproxCountDistinct(Record* Rin, int rLen, int p, int numThread) {
+    if (rLen <= 0) return 0;
+    if (numThread < 1) numThread = 1;
+    p = (p < SKETCH_HLL_MIN_P) ? SKETCH_HLL_MIN_P : ((p > SKETCH_HLL_MAX_P) ? SKETCH_HLL_MAX_P : p);
+    int m = 1 << p;
+    int* registers = new int[(size_t)numThread * m]();
+    #pragma omp parallel for num_threads(numThread)
+    for (int t = 0; t < numThread; t++) {
+        int from = (int)((long long)rLen * t / numThread);
+        int to = (int)((long long)rLen * (t + 1) / numThread);
+        for (int i = from; i < to; i++)
+            sketch_hllAdd(registers + (size_t)t * m, p, Rin[i].value);
+    }
+    for (int t = 1; t < numThread; t++)
+        for (int j = 0; j < m; j++)
+            if (registers[(size_t)t * m + j] > registers[j])
+                registers[j] = registers[(size_t)t * m + j];
+    double result = sketch_hllEstimate(registers, p);
+    delete[] registers;
+    return result;
+}
+
+void CPU_ApproxQuantile(Record* Rin, int rLen, double alpha, const double* q, int numQ, int* out, int numThread) {
+    if (numThread < 1) numThread = 1;
+    alpha = sketch_clampAlpha(alpha);
+    float invLogGamma = sketch_invLogGamma(alpha);
+    int maxBucket = sketch_maxBucket(alpha);
+    int numBin = sketch_numBin(alpha);
+    int* bins = new int[(size_t)numThread * numBin]();
+    #pragma omp parallel for num_threads(numThread)
+    for (int t = 0; t < numThread; t++) {
+        int from = (int)((long long)rLen * t / numThread);
+        int to = (int)((long long)rLen * (t + 1) / numThread);
+        for (int i = from; i < to; i++)
+            bins[(size_t)t * numBin + sketch_bin(Rin[i].value, invLogGamma, maxBucket)]++;
+    }
+    for (int t = 1; t < numThread; t++)
+        for (int j = 0; j < numBin; j++)
+            bins[j] += bins[(size_t)t * numBin + j];
+    for (int i = 0; i < numQ; i++)
+        out[i] = sketch_quantile(bins, alpha, q[i]);
+    delete[] bins;
+}
+
 // ---------- CPU Point Selection ----------
 int CPU_PointSelection(Record* Rin, int rLen, int matchingKeyValue, Record **Rout, int numThread) {
     // Count matches first
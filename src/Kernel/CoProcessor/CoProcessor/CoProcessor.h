@@ -99,35 +99,56 @@ typedef enum{
 #endif
 
 /*
-* here is the data structure for the sorting algorithm.
+* morsel driven co-processing of a partitionable operator: the input is a range
+* of units (records, or the partitions of hj), one worker per device takes
+* morsels of it from a shared cursor. a morsel is sized by the speed of its
+* device, calibrated by RunOpInCPU/RunOpInGPU until the device has timed one.
 */
-#define CPU_SORT_BLOCKSIZE (8*1024*1024)
-#define GPU_SORT_BLOCKSIZE (16*1024*1024)
+#define CO_MORSEL_SIZE (1024*1024)//records in a morsel of the slower device.
+#define CO_MORSEL_MIN (64*1024)
 
-struct ws_cosort
+//processes the units [from,to) on eM, the output, if any, is a new[] array in *Rout.
+typedef int (*CoMorselFunc)(void* op, int from, int to, EXEC_MODE eM, Record** Rout);
+
+struct co_morsel
 {
-	Record* R;
-	int Query_rLen;
-	Record *Rout;
-	int blockSize;
+	int from;
+	int to;
+	Record* Rout;
+	int numResult;
+};
+
+struct ws_comorsel
+{
+	void* op;
+	CoMorselFunc func;
+	int numUnit;
+	int unitLen;//records per unit.
 //shared parameters
 	HANDLE dispatchMutex;
 	HANDLE mergeMutex;
-	int* curPosToSort;
+	int* curUnit;
+	double* speed;//units per second of each device, 0 until timed.
+	double* busyUntil;//when the morsel in flight of each device is done.
+	double* calibrated;
 	EXEC_MODE execMode;
-	vector<int>* tempSizeVec;
-	void init(Record *pR, int pRLen, int pBlockSize, HANDLE pDMutex, HANDLE pMMutex, int *curP, 
-		EXEC_MODE eM,vector<int>* pSizeVec, Record *pRout)
+	vector<co_morsel>* morselVec;
+	void init(void* pOp, CoMorselFunc pFunc, int pNumUnit, int pUnitLen, 
+		HANDLE pDMutex, HANDLE pMMutex, int *curU, double* pSpeed, double* pBusyUntil, 
+		double* pCalibrated, EXEC_MODE eM, vector<co_morsel>* pMorselVec)
 	{
-		R=pR;
-		Query_rLen=pRLen;
-		blockSize=pBlockSize;
+		op=pOp;
+		func=pFunc;
+		numUnit=pNumUnit;
+		unitLen=pUnitLen;
 		dispatchMutex=pDMutex;
 		mergeMutex=pMMutex;
-		curPosToSort=curP;
+		curUnit=curU;
+		speed=pSpeed;
+		busyUntil=pBusyUntil;
+		calibrated=pCalibrated;
 		execMode=eM;
-		tempSizeVec=pSizeVec;
-		Rout=pRout;
+		morselVec=pMorselVec;
 	}
 	
 };
@@ -221,51 +242,36 @@ struct ws_coinlj
 };
 
 /*
-* the data structures for hj.
+* CO_Sort keeps its sorted runs in memory up to the budget and spills the rest
+* to a temporary file, the runs are then merged k-way by several threads.
 */
+#define CO_SORT_MEMORY_BUDGET (1024LL*1024*1024)//bytes.
+#define CO_SORT_READ_BUFFER (64*1024)//records read at once from a spilled run.
+#define CO_SORT_FENCE_STRIDE (1024)//records of a spilled run per value kept in memory.
 
-struct ws_hj
-{
-	Record* R;
-	int rLen;
-	Record* S;
-	int sLen;
-	int* curPartition;
-//shared parameters
-	int *RStartHist;
-	int *SStartHist;
-	int numPartition;
-	HANDLE dispatchMutex;
-	HANDLE mergeMutex;
-	int* curPosToJoin;
-	EXEC_MODE execMode;
-	vector<Record**>* tempResultVec;
-	vector<int>* tempSizeVec;//one int corresponds to one Record** in tempResultVec.
-	void init(Record *pR, int pRLen,  Record* pS, int pSLen, 
-		int *pRStartHist, int *pSStartHist, int pnumPartition,
-		HANDLE pDMutex, HANDLE pMMutex, int *curP, EXEC_MODE eM,
-		vector<Record**>* pRVec, vector<int>* pSizeVec)
-	{
-		R=pR;
-		rLen=pRLen;
-		S=pS;
-		sLen=pSLen;
-		dispatchMutex=pDMutex;
-		mergeMutex=pMMutex;
-		curPosToJoin=curP;
-		execMode=eM;
-		tempResultVec=pRVec;
-		tempSizeVec=pSizeVec;
-		RStartHist=pRStartHist;
-		SStartHist=pSStartHist;
-		numPartition=pnumPartition;
-		curPartition=curP;
-	}
-	
-};
+/*
+* hj partitions both relations, a morsel is a range of partitions.
+*/
+#define CO_HJ_PARTITION_SIZE (128*1024)//records of R.
+#define CO_HJ_MAX_PARTITION (1024)
 
+/*
+* selection, projection and aggregation on device columns: a unit is a window of
+* CO_SCAN_UNIT records, a sub-buffer at an offset any device accepts. operator level
+* scheduling splits an operator that gives each device a morsel of its own.
+*/
+#define CO_SCAN_UNIT (64*1024)
 
 //functions
+int CO_Morsel(void* op, CoMorselFunc func, int numUnit, int unitLen, OP_MODE optType, vector<co_morsel>* morselVec);
+int CO_Concat(vector<co_morsel>* morselVec, Record** Rout);
+void CO_AdoptResult(Record* h_Rout, int numResult, Record** Rout);
+bool CO_IsSplit(int numRecord);
+int CO_RangeSelection(cl_mem R, int Query_rLen, int rangeSmallKey, int rangeLargeKey, cl_mem* Rout);
+//Rout is allocated by the caller, a record for each rid of RIDList.
+void CO_Projection(cl_mem R, int Query_rLen, cl_mem RIDList, int RIDLen, cl_mem Rout);
+//optType is AGG_SUM, AGG_MAX, AGG_MIN or AGG_AVG, Rout is the record (0, aggregate).
+int CO_Agg(cl_mem R, int Query_rLen, OP_MODE optType, cl_mem* Rout);
 void CO_Sort(Record *R, int Query_rLen, Record* Rout);
 int CO_ninlj(Record *R, int Query_rLen, Record *S, int sLen, Record** Rout);
 int MergeJoinResult(vector<Record**>* tempResultVec, vector<int>* tempSizeVec, Record** Rout);
@@ -11,9 +11,12 @@ double Query_UpGPUBurden=0;
 double Query_LoGPUBurden=0;
 double Query_LothresholdForGPUApp=0;
 double Query_LothresholdForCPUApp=0;
-double Query_SpeedupGPUOverCPU[12];
-double RunInCPU[12];
-double RunInGPU[12];
+double Query_SpeedupGPUOverCPU[NUM_QUERY_TYPE];
+double RunInCPU[NUM_QUERY_TYPE];
+double RunInGPU[NUM_QUERY_TYPE];
+//per operator cost, indexed by OP_MODE, used by the plan level scheduler.
+double RunOpInCPU[NUM_OP_MODE];
+double RunOpInGPU[NUM_OP_MODE];
 
 double Query_CPUBurden=0;
 double Query_GPUBurden=0;
@@ -28,6 +31,8 @@ pthread_mutex_t Query_GPUBurdenCS = PTHREAD_MUTEX_INITIALIZER;
 
 int numQueries=30;//->corresponding to numOfThread for K_schedule
 int numThread=4;//this is fixed to 1 for Q and O schedule
+int minThread=1;//bounds of the adaptive worker count, numThread is the start.
+int maxThread=0;//0 for twice numThread.
 int Query_rLen=2*1024*1024;
 FILE *K_ofp;
 void usage(int argc, char **argv) {
@@ -35,18 +40,47 @@ void usage(int argc, char **argv) {
 	fprintf(stderr, "\t<total amount of querys>		  	- side size of matrix n (positive integer)\n");
 	fprintf(stderr, "\t<total number of threads>			- number of thread per block(1 - 32)\n");
 //	exit(1);
+	fprintf(stderr, "\t[schedule level]			- 0 kernel, 1 operator, 2 query, 3 hybrid, 4 plan (default 0),\n\t\t\t\t\t  a list such as 0,2,3 places the queries with the levels in turn\n");
+	fprintf(stderr, "\t[max threads]			- upper bound of the adaptive worker count (default twice the threads)\n");
+	fprintf(stderr, "\t[residency aware]			- 1 to charge and prefetch buffer migration, 0 to ignore it (default 1)\n");
+	fprintf(stderr, "\t[hybrid threshold]			- load ratio between the devices that lets the hybrid level move a kernel (default 2.0)\n");
 	fprintf(stdout,"Use default value: %s <30> <4>\n",argv[0]);
 }
 int main(int argc, char **argv)
 {
-	if(argc!=3){
+	int levels[SCHEDULE_PLAN+1]={SCHEDULE_KERNEL};
+	int numLevel=1;
+	int residencyAware=1;
+	double hybridThreshold=0;
+	if(argc<3 || argc>7){
 		usage( argc, argv);
 	}else{
 		numQueries=atoi(argv[1]);
 		numThread=atoi(argv[2]);
+		if(argc>=4)
+		{
+			char* s=argv[3];
+			for(numLevel=0;numLevel<=SCHEDULE_PLAN && *s!='\0';numLevel++)
+			{
+				levels[numLevel]=(int)strtol(s,&s,10);
+				if(*s==',')
+					s++;
+			}
+			if(numLevel==0)
+				numLevel=1;
+		}
+		if(argc>=5)
+			maxThread=atoi(argv[4]);
+		if(argc>=6)
+			residencyAware=atoi(argv[5]);
+		if(argc==7)
+			hybridThreshold=atof(argv[6]);
 	}
 
 	EngineStart(0,1);
+	CL_SetResidencyAware(residencyAware);
+	if(hybridThreshold>0)
+		CL_SetHybridThreshold(hybridThreshold);
 #ifdef _WIN32
 	InitializeCriticalSection(&(Query_GPUBurdenCS));
 	InitializeCriticalSection(&(Query_CPUBurdenCS));
@@ -55,10 +89,14 @@ int main(int argc, char **argv)
 #endif
 	int choice;
 	QUERY_TYPE qt;
+	Query_readFromFile();
+	OP_readFromFile();
 	initDB2("RS.conf",TEST_MAX);
 	QUERY_TYPE qT1=Q_RANGE_SELECTION;
 	QUERY_TYPE qT2=Q_HJ;
-	testQueryProcessor(qT1,qT2,numQueries,numThread);	
+	if(maxThread==0)
+		maxThread=2*numThread;
+	testQueryProcessor(qT1,qT2,numQueries,numThread,levels,numLevel);	
 	EngineStop();
 	return 0;
 }
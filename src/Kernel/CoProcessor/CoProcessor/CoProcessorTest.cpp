@@ -32,9 +32,9 @@ extern double Query_CPUBurden;
 extern double Query_GPUBurden;
 extern double Query_LothresholdForGPUApp;
 extern double Query_LothresholdForCPUApp;
-extern double Query_SpeedupGPUOverCPU[12];
-extern double RunInCPU[12];
-extern double RunInGPU[12];
+extern double Query_SpeedupGPUOverCPU[NUM_QUERY_TYPE];
+extern double RunInCPU[NUM_QUERY_TYPE];
+extern double RunInGPU[NUM_QUERY_TYPE];
 int qselect=0;
 void initDB2(char *confFile,int Uplimit)
 {
@@ -102,6 +102,39 @@ void makeTestQuery(QUERY_TYPE qt, char *query)
 		{
 			sprintf(query, "AGG;R;MAX;R.a00,;$;:GRP;R;$;R.b00,;$;:$:$:$:");
 		}break;
+	case Q_TOPK:
+		{
+			//the 100 largest of R.a00, ORDER BY R.a00 DESC LIMIT 100.
+			sprintf(query, "PRO;R;$;R.b00,;$;:TOP;R;100;R.a00,;$;:$:$:$:");
+		}break;
+	case Q_DISTINCT:
+		{
+			//SELECT DISTINCT R.a00, R.b00; the tuples are hashed, not sorted.
+			sprintf(query, "PRO;R;$;R.b00,;$;:DIS;R;$;R.a00,R.b00,;$;:$:$:$:");
+		}break;
+	case Q_APPROX_NDV:
+		{
+			//COUNT(DISTINCT R.a00) within a 2% standard error.
+			sprintf(query, "APX;R;NDV@0.02;R.a00,;$;:$:$:");
+		}break;
+	case Q_APPROX_QUANTILE:
+		{
+			//the median and the 99th percentile of R.a00, each within 1% of its value.
+			sprintf(query, "APX;R;P50|P99@0.01;R.a00,;$;:$:$:");
+		}break;
+	case Q_MULTI_AGG:
+		{
+			//one pass over R.a00 for the four of them.
+			sprintf(query, "AGG;R;SUM|MIN|MAX|COUNT;R.a00,;$;:$:$:");
+		}break;
+	case Q_AGG_GROUPBY_SEL:
+		{
+			//the average per group of the rows in a range.
+			int a=RAND(TEST_MAX);
+			int minmin=a;
+			int maxmax=minmin+20000000;
+			sprintf(query, "AGG;R;AVG;R.a00,;$;:GRP;R;$;R.b00,;$;:SEL;R;$;R.a00,;AND,>,R.a00,$,$,%d,$,$,<,R.a00,$,$,%d,$,$,;:$:$:$:$:", minmin, maxmax);
+		}break;
 	case Q_NINLJ:
 		{
 			//sprintf(query, "JOIN;R;S;R.a00,S.a00,;<,R.a00,$,$,S.a00,$,$,;:$:$:");
@@ -272,6 +305,10 @@ char* OpToString(OP_MODE op,EXEC_MODE eM)
 				return "JOIN_HJ, on the CPU";
 			case DISTINCT:
 				return "DISTINCT, on the CPU";
+			case TOP_K:
+				return "TOP_K, on the CPU";
+			case APPROX_AGG:
+				return "APPROX_AGG, on the CPU";
 			default:
 				return "TYPE_UNKNOWN, on the CPU";
 			}
@@ -322,6 +359,10 @@ char* OpToString(OP_MODE op,EXEC_MODE eM)
 				return "JOIN_HJ, on the GPU";
 			case DISTINCT:
 				return "DISTINCT, on the GPU";
+			case TOP_K:
+				return "TOP_K, on the GPU";
+			case APPROX_AGG:
+				return "APPROX_AGG, on the GPU";
 			default:
 				return "TYPE_UNKNOWN, on the GPU";
 			}
@@ -16,7 +16,14 @@ typedef enum{
 	Q_DBMBENCH3,
 	Q_AGG_GROUPBY,
 	Q_NINLJ,
+	Q_AGG_GROUPBY_SEL,
+	Q_MULTI_AGG,
+	Q_TOPK,
+	Q_DISTINCT,
+	Q_APPROX_NDV,
+	Q_APPROX_QUANTILE,
 }QUERY_TYPE;
+#define NUM_QUERY_TYPE ((int)Q_APPROX_QUANTILE+1)
 
 struct Query_stat{
 	bool isAssigned;
@@ -24,6 +31,7 @@ struct Query_stat{
 	QUERY_TYPE qT;
 	float speedupGPUoverCPU;
 	float timeInSec;
+	int level;//SCHEDULE_KERNEL, SCHEDULE_OPERATOR, SCHEDULE_QUERY or SCHEDULE_HYBRID
 	//bool needCop;
 };
 
@@ -49,6 +57,19 @@ struct tp_batchQuery{
 	}
 };
 
+//AIMD control of the number of query workers, see tp_concurrencyControl.
+struct tp_concurrency{
+	int minThread;
+	int maxThread;
+	int interval;//ms between two samples.
+	void init(int pminThread, int pmaxThread, int pinterval)
+	{
+		minThread=pminThread;
+		maxThread=pmaxThread;
+		interval=pinterval;
+	}
+};
+
 struct tp_singleQuery{
 	char* query;
 	EXEC_MODE eM;
@@ -70,6 +91,8 @@ void makeTestQuery(QUERY_TYPE qt, char *query);
 QUERY_TYPE makeRandomQuery(QUERY_TYPE fromType, QUERY_TYPE toType, char *query);
 void execQuery(char *query, bool isGPUONLY_QP, bool isAdaptive, EXEC_MODE eM);
 void testQueryProcessor(QUERY_TYPE fromType, QUERY_TYPE toType, int numQuery, int numThread);
+void testQueryProcessor(QUERY_TYPE fromType, QUERY_TYPE toType, int numQuery, int numThread, int level);
+void testQueryProcessor(QUERY_TYPE fromType, QUERY_TYPE toType, int numQuery, int numThread, int* levels, int numLevel);
 int pickQuerySmart(Query_stat *gQstat, int numQuery);
 void testMbench(int numQuery, EXEC_MODE eM, int numThread, int scale);
 
@@ -6,110 +6,55 @@
 
 using namespace std;
 
-#ifdef _WIN32
-DWORD WINAPI tp_hj(LPVOID lpParam)
-#else
-void *tp_hj(void *lpParam)
-#endif
-{
-  ws_hj *pData;
-  pData = (ws_hj *)lpParam;
-  Record *R = pData->R;
-  int rLen = pData->rLen;
-  Record *S = pData->S;
-  int sLen = pData->sLen;
-  int *RStartHist = pData->RStartHist;
-  int *SStartHist = pData->SStartHist;
-  int numPartition = pData->numPartition;
-  HANDLE dispatchMutex = pData->dispatchMutex;
-  HANDLE mergeMutex = pData->mergeMutex;
-  vector<Record **> *tempResultVec = pData->tempResultVec;
-  vector<int> *tempSizeVec = pData->tempSizeVec;
-  EXEC_MODE execMode = pData->execMode;
-  int RfromPos, RtoPos;
-  int SfromPos, StoPos;
-  int partToBeProcessed;
-  int R_realBlockSize;
-  int S_realBlockSize;
-  int numResult = 0;
-  while (1) {
-    Record *tempRout;
-    // get the tuples to sort
-    WaitForSingleObject(dispatchMutex, INFINITE);
-    partToBeProcessed = *(pData->curPartition);
-    if (partToBeProcessed >= numPartition) {
-      ReleaseMutex(dispatchMutex);
-      break;
-    }
-    (*(pData->curPartition))++;
-    ReleaseMutex(dispatchMutex);
-    // partition for R.
-    RfromPos = RStartHist[partToBeProcessed];
-    if ((partToBeProcessed + 1) == numPartition)
-      RtoPos = rLen;
-    else
-      RtoPos = RStartHist[partToBeProcessed + 1];
-    R_realBlockSize = RtoPos - RfromPos;
-    if (R_realBlockSize == 0)
-      continue;
-
-    // partition for S.
-    SfromPos = SStartHist[partToBeProcessed];
-    if ((partToBeProcessed + 1) == numPartition)
-      StoPos = sLen;
-    else
-      StoPos = SStartHist[partToBeProcessed + 1];
-    S_realBlockSize = StoPos - SfromPos;
-    if (S_realBlockSize == 0)
-      continue;
-
-    if (execMode == EXEC_CPU) {
-      clock_t tt = 0;
-      startTimer(tt);
-      ON_CPU("tp_hj");
-      cout << "CPU: " << R_realBlockSize << endl;
-      numResult = CPU_hj(R + RfromPos, R_realBlockSize, S + SfromPos,
-                         S_realBlockSize, &tempRout, OMP_JOIN_NUM_THREAD);
-      ON_CPU_DONE("tp_hj");
-      endTimer("CPU_hj", tt);
-    } else // on the GPU
-    {
-      clock_t tt = 0;
-      startTimer(tt);
-      ON_GPU("tp_hj");
-      cout << "GPU: " << R_realBlockSize << endl;
-      numResult = GPUCopy_hj(R + RfromPos, R_realBlockSize, S + SfromPos,
-                             S_realBlockSize, &tempRout);
-      ON_GPU_DONE("tp_hj");
-      endTimer("GPUCopy_hj", tt);
-    }
+// the units are the partitions; a range of partitions is a contiguous range of
+// both RTempOut and STempOut, and a key only matches in its own partition.
+struct co_hj {
+  Record *R;
+  int rLen;
+  Record *S;
+  int sLen;
+  int *RStartHist;
+  int *SStartHist;
+  int numPartition;
+};
 
-    WaitForSingleObject(mergeMutex, INFINITE);
-    if (numResult != 0) {
-      tempResultVec->push_back(&tempRout);
-      tempSizeVec->push_back(numResult);
-    }
-    ReleaseMutex(mergeMutex);
+static int co_hjMorsel(void *op, int from, int to, EXEC_MODE eM,
+                       Record **Rout) {
+  co_hj *p = (co_hj *)op;
+  int numResult = 0;
+  int RfromPos = p->RStartHist[from];
+  int RtoPos = (to == p->numPartition) ? p->rLen : p->RStartHist[to];
+  int SfromPos = p->SStartHist[from];
+  int StoPos = (to == p->numPartition) ? p->sLen : p->SStartHist[to];
+  int R_realBlockSize = RtoPos - RfromPos;
+  int S_realBlockSize = StoPos - SfromPos;
+  if (R_realBlockSize == 0 || S_realBlockSize == 0)
+    return 0;
+  if (eM == EXEC_CPU) {
+    ON_CPU("co_hj");
+    cout << "CPU: " << R_realBlockSize << endl;
+    numResult = CPU_hj(p->R + RfromPos, R_realBlockSize, p->S + SfromPos,
+                       S_realBlockSize, Rout, OMP_JOIN_NUM_THREAD);
+    ON_CPU_DONE("co_hj");
+  } else // on the GPU
+  {
+    ON_GPU("co_hj");
+    cout << "GPU: " << R_realBlockSize << endl;
+    Record *h_Rout = NULL;
+    numResult = GPUCopy_hj(p->R + RfromPos, R_realBlockSize, p->S + SfromPos,
+                           S_realBlockSize, &h_Rout);
+    CO_AdoptResult(h_Rout, numResult, Rout);
+    ON_GPU_DONE("co_hj");
   }
-
-  return 0;
+  return numResult;
 }
 
 int CO_hj(Record *R, int rLen, Record *S, int sLen, Record **Rout) {
-  int resultSize = 0;
-  HANDLE dispatchMutex = CreateMutex(NULL, FALSE, NULL);
-  HANDLE mergeMutex = CreateMutex(NULL, FALSE, NULL);
-  MyThreadPoolCop *pool = (MyThreadPoolCop *)malloc(sizeof(MyThreadPoolCop));
-  int numThread = 2; // one for CPU and one for GPU.
-  pool->create(numThread);
-  int i = 0;
-  ws_hj **pData = (ws_hj **)malloc(sizeof(ws_hj *) * numThread);
-  int curP = 0;
-  vector<Record **> *tempResultVec = new vector<Record **>();
-  vector<int> *tempSizeVec = new vector<int>();
-  // partition R on the CPU, and partition S on the GPU. Partition it into four
-  // partitions.
+  // enough partitions for the morsels of both devices to be sized freely.
   int numPartition = 2;
+  while (numPartition < CO_HJ_MAX_PARTITION &&
+         rLen / numPartition > CO_HJ_PARTITION_SIZE)
+    numPartition <<= 1;
   int *RStartHist = new int[numPartition];
   int *SStartHist = new int[numPartition];
   Record *RTempOut = new Record[rLen];
@@ -129,41 +74,21 @@ int CO_hj(Record *R, int rLen, Record *S, int sLen, Record **Rout) {
   }
   endTimer("partition", tt);
 
-  for (i = 0; i < numThread; i++) {
-    // Allocate memory for thread data.
-    pData[i] = (ws_hj *)calloc(1, sizeof(ws_hj));
-
-    if (pData[i] == NULL)
-      exit(2);
-
-    // as far as we know if sorting 16M tuples on the GPU is as fast
-    // as sorting 8M tuples on the GPU.
-    if (i == 0) // GPU first.
-    {
-      pData[i]->init(RTempOut, rLen, STempOut, sLen, RStartHist, SStartHist,
-                     numPartition, dispatchMutex, mergeMutex, &curP, EXEC_GPU,
-                     tempResultVec, tempSizeVec);
-    } else {
-      pData[i]->init(RTempOut, rLen, STempOut, sLen, RStartHist, SStartHist,
-                     numPartition, dispatchMutex, mergeMutex, &curP, EXEC_CPU,
-                     tempResultVec, tempSizeVec);
-    }
-
-    pool->assignParameter(i, pData[i]);
-    pool->assignTask(i, tp_hj);
-  }
-  pool->run();
-  for (i = 0; i < numThread; i++) {
-    free(pData[i]);
-  }
-  free(pData);
-  pool->destory();
-  CloseHandle(dispatchMutex);
-  CloseHandle(mergeMutex);
-  resultSize = MergeJoinResult(tempResultVec, tempSizeVec, Rout);
+  co_hj op;
+  op.R = RTempOut;
+  op.rLen = rLen;
+  op.S = STempOut;
+  op.sLen = sLen;
+  op.RStartHist = RStartHist;
+  op.SStartHist = SStartHist;
+  op.numPartition = numPartition;
+  vector<co_morsel> morselVec;
+  CO_Morsel(&op, co_hjMorsel, numPartition, (rLen + sLen) / numPartition,
+            JOIN_HJ, &morselVec);
+  int resultSize = CO_Concat(&morselVec, Rout);
 
-  delete tempResultVec;
-  delete tempSizeVec;
+  delete[] RStartHist;
+  delete[] SStartHist;
   delete[] RTempOut;
   delete[] STempOut;
   return resultSize;
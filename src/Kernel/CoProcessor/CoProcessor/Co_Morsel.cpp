@@ -0,0 +1,352 @@
+#include "CoProcessor.h"
+#include "Helper.h"
+#include "MyThreadPoolCop.h"
+#include <math.h>
+#include <algorithm>
+#include <vector>
+using namespace std;
+
+// co-processing driver for the partitionable operators: one worker per device
+// takes morsels from the shared range of units until it is exhausted. a morsel
+// is sized by the speed of its device, so the faster one takes more per trip,
+// and the last morsels split the rest so both devices finish together.
+extern double RunOpInCPU[NUM_OP_MODE];
+extern double RunOpInGPU[NUM_OP_MODE];
+
+// units per second of device d; the calibrated speed until a morsel is timed.
+static double co_deviceSpeed(ws_comorsel *pData, int d)
+{
+	int o = 1 - d;
+	if (pData->speed[d] > 0)
+		return pData->speed[d];
+	if (pData->speed[o] > 0)
+		return pData->speed[o] * pData->calibrated[d] / pData->calibrated[o];
+	return pData->calibrated[d];
+}
+
+// the units of the next morsel of this worker, the caller holds dispatchMutex.
+static int co_morselUnits(ws_comorsel *pData, int remaining, double now)
+{
+	int d = pData->execMode;
+	int o = 1 - d;
+	double mine = co_deviceSpeed(pData, d);
+	double other = co_deviceSpeed(pData, o);
+	double slower = (mine < other) ? mine : other;
+	int minUnits = CO_MORSEL_MIN / pData->unitLen;
+	if (minUnits < 1)
+		minUnits = 1;
+	double size = (double)CO_MORSEL_SIZE / pData->unitLen * (mine / slower);
+	// the other device is busy until busyUntil[o]; split the rest so that both
+	// are done at the same time, none for this one if the other finishes first.
+	double lag = 0;
+	if (pData->speed[d] > 0 && pData->speed[o] > 0 && pData->busyUntil[o] > now)
+		lag = pData->busyUntil[o] - now;
+	double finish = (remaining + other * lag) / (mine + other);
+	double share = (finish > lag) ? mine * finish : remaining;
+	if (share < size)
+		size = ceil(share);
+	int units = (int)size;
+	if (units < minUnits)
+		units = minUnits;
+	if (units > remaining)
+		units = remaining;
+	pData->busyUntil[d] = (pData->speed[d] > 0) ? now + units / mine : 0;
+	return units;
+}
+
+#ifdef _WIN32
+DWORD WINAPI tp_morsel(LPVOID lpParam)
+{
+#else
+void *tp_morsel(void *lpParam)
+{
+#endif
+	ws_comorsel *pData;
+	pData = (ws_comorsel *)lpParam;
+	HANDLE dispatchMutex = pData->dispatchMutex;
+	HANDLE mergeMutex = pData->mergeMutex;
+	EXEC_MODE execMode = pData->execMode;
+	co_morsel m;
+	// the worker is the device of its morsels, their kernels are not moved.
+	CL_SetScheduleLevel(SCHEDULE_OPERATOR);
+	if (execMode != EXEC_CPU)
+	{
+		setHighPriority();
+#ifdef FIXED_CORE_TO_GPU
+		set_selfCPUID(3);
+#endif
+	}
+	while (1)
+	{
+		// get the next morsel
+		WaitForSingleObject(dispatchMutex, INFINITE);
+		double start = wallTime();
+		m.from = *(pData->curUnit);
+		if (m.from >= pData->numUnit)
+		{
+			ReleaseMutex(dispatchMutex);
+			break;
+		}
+		m.to = m.from + co_morselUnits(pData, pData->numUnit - m.from, start);
+		*(pData->curUnit) = m.to;
+		ReleaseMutex(dispatchMutex);
+
+		m.Rout = NULL;
+		m.numResult = pData->func(pData->op, m.from, m.to, execMode, &(m.Rout));
+		double elapsed = wallTime() - start;
+
+		WaitForSingleObject(dispatchMutex, INFINITE);
+		if (elapsed > 0)
+		{
+			double observed = (m.to - m.from) / elapsed;
+			double *speed = pData->speed + execMode;
+			*speed = (*speed > 0) ? (*speed + observed) / 2 : observed;
+		}
+		ReleaseMutex(dispatchMutex);
+
+		WaitForSingleObject(mergeMutex, INFINITE);
+		pData->morselVec->push_back(m);
+		ReleaseMutex(mergeMutex);
+	}
+
+	return 0;
+}
+
+static bool co_morselBefore(const co_morsel &a, const co_morsel &b)
+{
+	return a.from < b.from;
+}
+
+int CO_Morsel(void *op, CoMorselFunc func, int numUnit, int unitLen, OP_MODE optType, vector<co_morsel> *morselVec)
+{
+	HANDLE dispatchMutex = CreateMutex(NULL, FALSE, NULL);
+	HANDLE mergeMutex = CreateMutex(NULL, FALSE, NULL);
+	MyThreadPoolCop *pool = (MyThreadPoolCop *)malloc(sizeof(MyThreadPoolCop));
+	int numThread = 2; // one for CPU and one for GPU.
+	pool->create(numThread);
+	int i = 0;
+	int curUnit = 0;
+	double speed[2] = {0, 0};
+	double busyUntil[2] = {0, 0};
+	double calibrated[2];
+	// the calibrated cost is the time of the operator, its inverse the speed.
+	calibrated[EXEC_CPU] = (RunOpInCPU[optType] > 0) ? 1 / RunOpInCPU[optType] : 1;
+	calibrated[EXEC_GPU] = (RunOpInGPU[optType] > 0) ? 1 / RunOpInGPU[optType] : 1;
+	if (unitLen < 1)
+		unitLen = 1;
+	ws_comorsel *pData = (ws_comorsel *)calloc(numThread, sizeof(ws_comorsel));
+	for (i = 0; i < numThread; i++)
+	{
+		pData[i].init(op, func, numUnit, unitLen, dispatchMutex, mergeMutex, &curUnit, speed, busyUntil, calibrated, (i == 0) ? EXEC_GPU : EXEC_CPU, morselVec);
+		pool->assignParameter(i, pData + i);
+		pool->assignTask(i, tp_morsel);
+	}
+	pool->run();
+	free(pData);
+	pool->destory();
+	free(pool);
+	CloseHandle(dispatchMutex);
+	CloseHandle(mergeMutex);
+	// in the order of the input, whichever device took them.
+	sort(morselVec->begin(), morselVec->end(), co_morselBefore);
+	int numResult = 0;
+	for (i = 0; i < (int)morselVec->size(); i++)
+		numResult += (*morselVec)[i].numResult;
+	return numResult;
+}
+
+// the engine mallocs its results, the morsels are released with delete[].
+void CO_AdoptResult(Record *h_Rout, int numResult, Record **Rout)
+{
+	if (numResult > 0)
+	{
+		*Rout = new Record[numResult];
+		memcpy(*Rout, h_Rout, numResult * sizeof(Record));
+	}
+	free(h_Rout);
+}
+
+int CO_Concat(vector<co_morsel> *morselVec, Record **Rout)
+{
+	int i = 0;
+	int numResult = 0;
+	for (i = 0; i < (int)morselVec->size(); i++)
+		numResult += (*morselVec)[i].numResult;
+	*Rout = (numResult > 0) ? new Record[numResult] : NULL;
+	int cur = 0;
+	for (i = 0; i < (int)morselVec->size(); i++)
+	{
+		co_morsel *m = &((*morselVec)[i]);
+		if (m->Rout == NULL)
+			continue;
+		memcpy((*Rout) + cur, m->Rout, m->numResult * sizeof(Record));
+		cur += m->numResult;
+		delete[] m->Rout;
+		m->Rout = NULL;
+	}
+	return numResult;
+}
+
+struct co_scan
+{
+	cl_mem R;
+	int rLen;
+	cl_mem RIDList;
+	int RIDLen;
+	cl_mem Rout;
+	int lowerKey;
+	int higherKey;
+	OP_MODE optType;
+	cl_mem *out; // the output of a morsel, in the slot of its first unit.
+};
+
+bool CO_IsSplit(int numRecord)
+{
+	return CL_GetScheduleLevel() == SCHEDULE_OPERATOR && numRecord >= 2 * CO_MORSEL_SIZE;
+}
+
+static int co_scanUnits(int len)
+{
+	return (len + CO_SCAN_UNIT - 1) / CO_SCAN_UNIT;
+}
+
+// the records of the units [from,to) of a column of len records, from *start.
+static int co_scanWindow(int from, int to, int len, int *start)
+{
+	int end = to * CO_SCAN_UNIT;
+	*start = from * CO_SCAN_UNIT;
+	return ((end < len) ? end : len) - *start;
+}
+
+static int co_selectionMorsel(void *op, int from, int to, EXEC_MODE eM, Record **Rout)
+{
+	co_scan *p = (co_scan *)op;
+	int start = 0;
+	int len = co_scanWindow(from, to, p->rLen, &start);
+	cl_mem win = NULL;
+	CL_SubBuffer(p->R, start * sizeof(Record), len * sizeof(Record), &win);
+	// the rids are base positions, the window does not shift them.
+	int numResult = CL_RangeSelectionOnly(win, len, p->lowerKey, p->higherKey, p->out + from, 256, 512, eM);
+	CL_DESTORY(&win);
+	return numResult;
+}
+
+// the outputs of the morsels in the order of the input, in one new buffer.
+static int co_concatDevice(co_scan *p, vector<co_morsel> *morselVec, cl_mem *Rout)
+{
+	int i = 0;
+	int numResult = 0;
+	for (i = 0; i < (int)morselVec->size(); i++)
+		numResult += (*morselVec)[i].numResult;
+	CL_CREATE(Rout, sizeof(Record) * (numResult > 0 ? numResult : 1));
+	int cur = 0;
+	for (i = 0; i < (int)morselVec->size(); i++)
+	{
+		co_morsel *m = &((*morselVec)[i]);
+		if (m->numResult > 0)
+			CopyGPUToGPU(p->out[m->from], 0, *Rout, cur * sizeof(Record), sizeof(Record) * m->numResult);
+		cur += m->numResult;
+		CL_DESTORY(p->out + m->from);
+	}
+	free(p->out);
+	return numResult;
+}
+
+int CO_RangeSelection(cl_mem R, int rLen, int rangeSmallKey, int rangeLargeKey, cl_mem *Rout)
+{
+	co_scan op;
+	int numUnit = co_scanUnits(rLen);
+	op.R = R;
+	op.rLen = rLen;
+	op.lowerKey = rangeSmallKey;
+	op.higherKey = rangeLargeKey;
+	op.out = (cl_mem *)calloc(numUnit > 0 ? numUnit : 1, sizeof(cl_mem));
+	vector<co_morsel> morselVec;
+	CO_Morsel(&op, co_selectionMorsel, numUnit, CO_SCAN_UNIT, SELECTION, &morselVec);
+	return co_concatDevice(&op, &morselVec, Rout);
+}
+
+// the units are the rids of RIDList, the records of Rout are filled in place.
+static int co_projectionMorsel(void *op, int from, int to, EXEC_MODE eM, Record **Rout)
+{
+	co_scan *p = (co_scan *)op;
+	int start = 0;
+	int len = co_scanWindow(from, to, p->RIDLen, &start);
+	cl_mem ridWin = NULL;
+	cl_mem outWin = NULL;
+	CL_SubBuffer(p->RIDList, start * sizeof(int), len * sizeof(int), &ridWin);
+	CL_SubBuffer(p->Rout, start * sizeof(Record), len * sizeof(Record), &outWin);
+	CL_setRIDList(ridWin, len, outWin, 256, 64, eM);
+	CL_ProjectionOnly(p->R, p->rLen, outWin, len, 256, 64, eM);
+	CL_DESTORY(&ridWin);
+	CL_DESTORY(&outWin);
+	return 0;
+}
+
+void CO_Projection(cl_mem R, int rLen, cl_mem RIDList, int RIDLen, cl_mem Rout)
+{
+	co_scan op;
+	op.R = R;
+	op.rLen = rLen;
+	op.RIDList = RIDList;
+	op.RIDLen = RIDLen;
+	op.Rout = Rout;
+	vector<co_morsel> morselVec;
+	CO_Morsel(&op, co_projectionMorsel, co_scanUnits(RIDLen), CO_SCAN_UNIT, PROJECTION, &morselVec);
+}
+
+// the partial aggregate of the morsel is returned in one host record, (records, value).
+static int co_aggMorsel(void *op, int from, int to, EXEC_MODE eM, Record **Rout)
+{
+	co_scan *p = (co_scan *)op;
+	int start = 0;
+	int len = co_scanWindow(from, to, p->rLen, &start);
+	cl_mem win = NULL;
+	cl_mem Rtmp = NULL;
+	CL_SubBuffer(p->R, start * sizeof(Record), len * sizeof(Record), &win);
+	if (p->optType == AGG_MAX)
+		CL_AggMaxOnly(win, len, &Rtmp, 256, 512, eM);
+	else if (p->optType == AGG_MIN)
+		CL_AggMinOnly(win, len, &Rtmp, 256, 512, eM);
+	else
+		CL_AggSumOnly(win, len, &Rtmp, 256, 512, eM);
+	*Rout = new Record[1];
+	CopyGPUToCPU(Rtmp, *Rout, sizeof(Record));
+	(*Rout)->rid = len;
+	CL_DESTORY(&Rtmp);
+	CL_DESTORY(&win);
+	return 1;
+}
+
+int CO_Agg(cl_mem R, int rLen, OP_MODE optType, cl_mem *Rout)
+{
+	co_scan op;
+	op.R = R;
+	op.rLen = rLen;
+	op.optType = optType;
+	vector<co_morsel> morselVec;
+	CO_Morsel(&op, co_aggMorsel, co_scanUnits(rLen), CO_SCAN_UNIT, optType, &morselVec);
+	long long sum = 0;
+	int result = 0;
+	for (int i = 0; i < (int)morselVec.size(); i++)
+	{
+		int partial = morselVec[i].Rout->value;
+		if (optType == AGG_MAX)
+			result = (i == 0 || partial > result) ? partial : result;
+		else if (optType == AGG_MIN)
+			result = (i == 0 || partial < result) ? partial : result;
+		else
+			sum += partial;
+		delete[] morselVec[i].Rout;
+	}
+	if (optType == AGG_SUM)
+		result = (int)sum;
+	else if (optType == AGG_AVG)
+		result = (rLen > 0) ? (int)(sum / rLen) : 0;
+	Record rec;
+	rec.rid = 0;
+	rec.value = result;
+	CL_CREATE(Rout, sizeof(Record));
+	CopyCPUToGPU(*Rout, &rec, sizeof(Record));
+	return result;
+}
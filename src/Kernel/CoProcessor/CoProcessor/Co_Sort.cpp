@@ -1,183 +1,340 @@
 #include "CoProcessor.h"
-#include "MyThreadPoolCop.h"
 #include "../MyLib/CPU_Dll.h"
 #include "Helper.h"
+#include <stdio.h>
+#include <limits.h>
+#include <assert.h>
+#include <algorithm>
 #include <vector>
 using namespace std;
 
-#define CPU_SORT_RATIO (0.0) //(0.24)
-
 #ifdef _WIN32
-DWORD WINAPI tp_sort(LPVOID lpParam) {
+#define co_fseek _fseeki64
 #else
-void* tp_sort(void* lpParam) {
+#define co_fseek fseeko
 #endif
-  ws_cosort *pData;
-  pData = (ws_cosort *)lpParam;
-  Record *R = pData->R;
-  int rLen = pData->Query_rLen;
-  Record *Rout = pData->Rout;
-  int blockSize = pData->blockSize;
-  HANDLE dispatchMutex = pData->dispatchMutex;
-  HANDLE mergeMutex = pData->mergeMutex;
-  vector<int> *tempSizeVec = pData->tempSizeVec;
-  EXEC_MODE execMode = pData->execMode;
-  int fromPos;
-  int toPos;
-  int realBlockSize;
-  Record *tempRout;
-  if (execMode != EXEC_CPU) {
-    setHighPriority();
-    set_selfCPUID(3);
-    cout << "set the GPU thread ID to core 4" << endl;
-  }
-  while (1) {
-    // get the tuples to sort
-    WaitForSingleObject(dispatchMutex, INFINITE);
-    fromPos = *(pData->curPosToSort);
-    if (fromPos >= rLen) {
-      ReleaseMutex(dispatchMutex);
-      break;
-    }
-    toPos = fromPos + blockSize;
-    if (toPos >= rLen)
-      toPos = rLen;
-    *(pData->curPosToSort) = toPos;
-    ReleaseMutex(dispatchMutex);
-    realBlockSize = toPos - fromPos;
-    // sort it
-    tempRout = new Record[realBlockSize];
-    if (execMode == EXEC_CPU) {
-      clock_t tt = 0;
-      startTimer(tt);
-      ON_CPU("tp_sort");
-      cout << fromPos << ", " << realBlockSize << endl;
-      CPU_Sort(R + fromPos, realBlockSize, tempRout, OMP_SORT_NUM_THREAD);
-      ON_CPU_DONE("tp_sort");
-      endTimer("CPU_Sort", tt);
-
-    } else // on the GPU
-    {
-      clock_t tt = 0;
-      startTimer(tt);
-      ON_GPU("tp_sort");
-      cout << fromPos << ", " << realBlockSize << endl;
-      // GPUCopy_bitonicSort(R+fromPos,realBlockSize,tempRout);
-      GPUCopy_QuickSort(R + fromPos, realBlockSize, tempRout);
-      ON_GPU_DONE("tp_sort");
-      endTimer("GPUCopy_QuickSort", tt);
-    }
 
-    WaitForSingleObject(mergeMutex, INFINITE);
-    // tempResultVec->push_back(&tempRout);
-    int curSize = 0;
-    for (int i = 0; i < (int)tempSizeVec->size(); i++)
-      curSize += (*tempSizeVec)[i];
-    memcpy(Rout + curSize, tempRout, realBlockSize * sizeof(Record));
-    tempSizeVec->push_back(realBlockSize);
-    ReleaseMutex(mergeMutex);
+// a sorted run, in memory or spilled to the temporary file of the sort.
+struct co_run {
+  int from; // position of the morsel in R, the runs are merged in this order.
+  int len;
+  Record *R;            // NULL once spilled.
+  long long fileOffset; // in records.
+  int *fence; // of a spilled run, the value at every CO_SORT_FENCE_STRIDE-th record.
+};
+
+struct co_sort {
+  Record *R;
+  vector<co_run> runs;
+  long long memoryUsed; // bytes of the runs kept in memory.
+  FILE *spillFile;      // all the spilled runs, one after the other.
+  long long spillLen;   // records.
+  HANDLE runMutex;
+  HANDLE fileMutex;
+};
+
+// appends the run to the spill file; the caller holds fileMutex.
+static long long co_spill(co_sort *p, Record *R, int len) {
+  if (p->spillFile == NULL) {
+    p->spillFile = tmpfile();
+    if (p->spillFile == NULL) {
+      cout << "co_sort: no temporary file to spill to" << endl;
+      exit(2);
+    }
+  }
+  long long offset = p->spillLen;
+  co_fseek(p->spillFile, offset * sizeof(Record), SEEK_SET);
+  if (fwrite(R, sizeof(Record), len, p->spillFile) != (size_t)len) {
+    cout << "co_sort: spilling " << len << " records failed" << endl;
+    exit(2);
   }
+  p->spillLen += len;
+  return offset;
+}
 
-  return 0;
+// reads records [pos,pos+len) of a spilled run.
+static void co_readSpilled(co_sort *p, co_run *run, long long pos, int len,
+                           Record *buf) {
+  WaitForSingleObject(p->fileMutex, INFINITE);
+  co_fseek(p->spillFile, (run->fileOffset + pos) * sizeof(Record), SEEK_SET);
+  size_t numRead = fread(buf, sizeof(Record), len, p->spillFile);
+  ReleaseMutex(p->fileMutex);
+  assert(numRead == (size_t)len);
 }
 
-void BinaryMergeSort(Record *R, int rLen, Record *S, int sLen, Record *Rout) {
-  int pR = 0;
-  int pS = 0;
-  int cur = 0;
-  while (pR < rLen && pS < sLen) {
-    if (R[pR].value == S[pS].value) {
-      EVAL((Rout + cur), (R + pR));
-      cur++;
-      EVAL((Rout + cur), (S + pS));
-      cur++;
-      pS++;
-      pR++;
-    } else if (R[pR].value < S[pS].value) {
-      EVAL((Rout + cur), (R + pR));
-      cur++;
-      pR++;
-    } else {
-      EVAL((Rout + cur), (S + pS));
-      cur++;
-      pS++;
-    }
+// the morsels of R are sorted into runs, on whichever device takes them. a run
+// beyond the memory budget is spilled at once.
+static int co_sortMorsel(void *op, int from, int to, EXEC_MODE eM,
+                         Record **Rout) {
+  co_sort *p = (co_sort *)op;
+  co_run run;
+  run.from = from;
+  run.len = to - from;
+  run.R = new Record[run.len];
+  run.fileOffset = 0;
+  run.fence = NULL;
+  if (eM == EXEC_CPU) {
+    ON_CPU("co_sort");
+    CPU_Sort(p->R + from, run.len, run.R, OMP_SORT_NUM_THREAD);
+    ON_CPU_DONE("co_sort");
+  } else // on the GPU
+  {
+    ON_GPU("co_sort");
+    // GPUCopy_bitonicSort(R+from,len,run.R);
+    GPUCopy_QuickSort(p->R + from, run.len, run.R);
+    ON_GPU_DONE("co_sort");
   }
-  while (pR < rLen) {
-    EVAL((Rout + cur), (R + pR));
-    cur++;
-    pR++;
+  long long bytes = (long long)run.len * sizeof(Record);
+  WaitForSingleObject(p->runMutex, INFINITE);
+  bool spill = (p->memoryUsed + bytes > CO_SORT_MEMORY_BUDGET);
+  if (!spill)
+    p->memoryUsed += bytes;
+  ReleaseMutex(p->runMutex);
+  if (spill) {
+    int numFence = (run.len + CO_SORT_FENCE_STRIDE - 1) / CO_SORT_FENCE_STRIDE;
+    run.fence = new int[numFence];
+    for (int f = 0; f < numFence; f++)
+      run.fence[f] = run.R[f * CO_SORT_FENCE_STRIDE].value;
+    WaitForSingleObject(p->fileMutex, INFINITE);
+    run.fileOffset = co_spill(p, run.R, run.len);
+    ReleaseMutex(p->fileMutex);
+    delete[] run.R;
+    run.R = NULL;
   }
-  while (pS < sLen) {
-    EVAL((Rout + cur), (S + pS));
-    cur++;
-    pS++;
+  WaitForSingleObject(p->runMutex, INFINITE);
+  p->runs.push_back(run);
+  ReleaseMutex(p->runMutex);
+  return 0;
+}
+
+// the records of R[0,len) whose value is below v (orEqual: at most v).
+static int co_rank(Record *R, int len, int v, bool orEqual) {
+  int lo = 0;
+  int hi = len;
+  while (lo < hi) {
+    int mid = lo + (hi - lo) / 2;
+    if (R[mid].value < v || (orEqual && R[mid].value == v))
+      lo = mid + 1;
+    else
+      hi = mid;
   }
-  assert(cur == (rLen + sLen));
+  return lo;
 }
 
-void CO_Sort(Record *R, int rLen, Record *Rout) {
-  if (rLen > 24 * 1024 * 1024) {
-    cout << "we currently support at most 24 million tuples at most due the "
-            "binary merge"
-         << endl;
-    exit(0);
-  }
-  HANDLE dispatchMutex = CreateMutex(NULL, FALSE, NULL);
-  HANDLE mergeMutex = CreateMutex(NULL, FALSE, NULL);
-  MyThreadPoolCop *pool = (MyThreadPoolCop *)malloc(sizeof(MyThreadPoolCop));
-  int numThread = 2; // one for CPU and one for GPU.
-  pool->create(numThread);
+// co_rank over a run; of a spilled run the fences pick the one block that
+// holds the rank, which is the only read.
+static int co_runRank(co_sort *p, co_run *run, int v, bool orEqual) {
+  if (run->R != NULL)
+    return co_rank(run->R, run->len, v, orEqual);
+  int lo = 0;
+  int hi = (run->len + CO_SORT_FENCE_STRIDE - 1) / CO_SORT_FENCE_STRIDE;
+  while (lo < hi) {
+    int mid = lo + (hi - lo) / 2;
+    if (run->fence[mid] < v || (orEqual && run->fence[mid] == v))
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  if (lo == 0)
+    return 0;
+  int from = (lo - 1) * CO_SORT_FENCE_STRIDE;
+  int len = run->len - from;
+  if (len > CO_SORT_FENCE_STRIDE)
+    len = CO_SORT_FENCE_STRIDE;
+  Record block[CO_SORT_FENCE_STRIDE];
+  co_readSpilled(p, run, from, len, block);
+  return from + co_rank(block, len, v, orEqual);
+}
+
+// merge path over k runs: the positions split[i] in the runs such that the
+// records before them are the rank smallest of all. the value at the rank is
+// searched first, the ties with it are then taken in the order of the runs.
+static void co_mergePath(co_sort *p, long long rank, int *split) {
+  int k = (int)p->runs.size();
   int i = 0;
-  ws_cosort **pData = (ws_cosort **)malloc(sizeof(ws_cosort *) * numThread);
-  int curP = 0;
-  vector<int> *tempSizeVec = new vector<int>();
-  int cpuBlockSize = CPU_SORT_BLOCKSIZE;
-  int gpuBlockSize = GPU_SORT_BLOCKSIZE;
-  if (rLen < 24 * 1024 * 1024) {
-    cpuBlockSize = (int)((double)rLen * CPU_SORT_RATIO);
-    gpuBlockSize = rLen - cpuBlockSize;
-  }
-  __DEBUGInt__((int)(CPU_SORT_RATIO * (double)100.0));
-  cout << "size: " << cpuBlockSize << "," << gpuBlockSize << endl;
-  Record *tempRout = new Record[rLen];
-  for (i = 0; i < numThread; i++) {
-    // Allocate memory for thread data.
-    pData[i] = (ws_cosort *)calloc(1, sizeof(ws_cosort));
-
-    if (pData[i] == NULL)
-      exit(2);
+  long long lo = INT_MIN;
+  long long hi = INT_MAX;
+  // the smallest v with at least rank records at most v.
+  while (lo < hi) {
+    long long mid = lo + (hi - lo) / 2;
+    long long count = 0;
+    for (i = 0; i < k && count < rank; i++)
+      count += co_runRank(p, &p->runs[i], (int)mid, true);
+    if (count >= rank)
+      hi = mid;
+    else
+      lo = mid + 1;
+  }
+  long long need = rank;
+  for (i = 0; i < k; i++) {
+    split[i] = co_runRank(p, &p->runs[i], (int)lo, false);
+    need -= split[i];
+  }
+  for (i = 0; i < k && need > 0; i++) {
+    int tie = co_runRank(p, &p->runs[i], (int)lo, true) - split[i];
+    int take = (tie < need) ? tie : (int)need;
+    split[i] += take;
+    need -= take;
+  }
+}
+
+// streams [pos,end) of a run, through a buffer if it is spilled.
+struct co_runReader {
+  co_sort *sort;
+  co_run *run;
+  int pos;
+  int end;
+  Record *buf;
+  int bufFrom; // position of buf[0] in the run.
+  int bufLen;
 
-    // as far as we know if sorting 16M tuples on the GPU is as fast
-    // as sorting 8M tuples on the GPU.
-    if (i == 0) // GPU first.
-    {
-      pData[i]->init(R, rLen, gpuBlockSize, dispatchMutex, mergeMutex, &curP,
-                     EXEC_GPU, tempSizeVec, tempRout);
-    } else {
-      pData[i]->init(R, rLen, cpuBlockSize, dispatchMutex, mergeMutex, &curP,
-                     EXEC_CPU, tempSizeVec, tempRout);
+  void open(co_sort *p, co_run *r, int from, int to) {
+    sort = p;
+    run = r;
+    pos = from;
+    end = to;
+    buf = (run->R == NULL) ? new Record[CO_SORT_READ_BUFFER] : NULL;
+    bufFrom = from;
+    bufLen = 0;
+  }
+  void close() {
+    if (buf != NULL)
+      delete[] buf;
+  }
+  bool done() { return pos >= end; }
+  Record *cur() {
+    if (run->R != NULL)
+      return run->R + pos;
+    if (pos >= bufFrom + bufLen) {
+      bufFrom = pos;
+      bufLen = end - pos;
+      if (bufLen > CO_SORT_READ_BUFFER)
+        bufLen = CO_SORT_READ_BUFFER;
+      co_readSpilled(sort, run, bufFrom, bufLen, buf);
     }
+    return buf + (pos - bufFrom);
+  }
+  void next() { pos++; }
+};
+
+// loser tree over k readers: tree[0] is the winner, the inner nodes hold the
+// loser of their match, so a pop replays one path of log(k) matches.
+struct co_loserTree {
+  int k; // leaves, a power of two; the padding readers are empty.
+  int *tree;
+  co_runReader *src;
 
-    pool->assignParameter(i, pData[i]);
-    pool->assignTask(i, tp_sort);
+  // a is merged before b; an empty reader loses, ties go to the earlier run.
+  bool before(int a, int b) {
+    if (a >= k || src[a].done())
+      return false;
+    if (b >= k || src[b].done())
+      return true;
+    int va = src[a].cur()->value;
+    int vb = src[b].cur()->value;
+    return va < vb || (va == vb && a < b);
+  }
+  void build(co_runReader *pSrc, int numSrc) {
+    src = pSrc;
+    k = 1;
+    while (k < numSrc)
+      k <<= 1;
+    tree = new int[k];
+    int *winner = new int[2 * k];
+    int n = 0;
+    for (n = 0; n < k; n++)
+      winner[k + n] = (n < numSrc) ? n : k;
+    for (n = k - 1; n >= 1; n--) {
+      int l = winner[2 * n];
+      int r = winner[2 * n + 1];
+      winner[n] = before(r, l) ? r : l;
+      tree[n] = (winner[n] == l) ? r : l;
+    }
+    tree[0] = winner[1];
+    delete[] winner;
+  }
+  Record pop() {
+    int w = tree[0];
+    Record out = *(src[w].cur());
+    src[w].next();
+    for (int node = (w + k) >> 1; node >= 1; node >>= 1) {
+      if (before(tree[node], w)) {
+        int t = tree[node];
+        tree[node] = w;
+        w = t;
+      }
+    }
+    tree[0] = w;
+    return out;
   }
-  pool->run();
-  for (i = 0; i < numThread; i++) {
-    free(pData[i]);
+  void destory() { delete[] tree; }
+};
+
+// each thread merges the slice of Rout between its two merge paths.
+static void co_parallelMerge(co_sort *p, int rLen, Record *Rout) {
+  int k = (int)p->runs.size();
+  int numThread = OMP_NUM_MERGE_THREAD;
+  if (numThread > rLen)
+    numThread = 1;
+  int *split = new int[(numThread + 1) * k];
+  int t = 0;
+#pragma omp parallel for num_threads(numThread)
+  for (t = 0; t <= numThread; t++)
+    co_mergePath(p, (long long)rLen * t / numThread, split + t * k);
+#pragma omp parallel for num_threads(numThread)
+  for (t = 0; t < numThread; t++) {
+    int *from = split + t * k;
+    int *to = split + (t + 1) * k;
+    co_runReader *src = new co_runReader[k];
+    int i = 0;
+    for (i = 0; i < k; i++)
+      src[i].open(p, &p->runs[i], from[i], to[i]);
+    co_loserTree lt;
+    lt.build(src, k);
+    int outFrom = (int)((long long)rLen * t / numThread);
+    int outTo = (int)((long long)rLen * (t + 1) / numThread);
+    for (i = outFrom; i < outTo; i++)
+      Rout[i] = lt.pop();
+    lt.destory();
+    for (i = 0; i < k; i++)
+      src[i].close();
+    delete[] src;
   }
-  free(pData);
-  pool->destory();
-  CloseHandle(dispatchMutex);
-  CloseHandle(mergeMutex);
-  assert(tempSizeVec->size() == 2);
+  delete[] split;
+}
+
+static bool co_runBefore(const co_run &a, const co_run &b) {
+  return a.from < b.from;
+}
+
+void CO_Sort(Record *R, int rLen, Record *Rout) {
+  int i = 0;
+  co_sort op;
+  op.R = R;
+  op.memoryUsed = 0;
+  op.spillFile = NULL;
+  op.spillLen = 0;
+  op.runMutex = CreateMutex(NULL, FALSE, NULL);
+  op.fileMutex = CreateMutex(NULL, FALSE, NULL);
+  vector<co_morsel> morselVec;
+  CO_Morsel(&op, co_sortMorsel, rLen, 1, SORT, &morselVec);
+  sort(op.runs.begin(), op.runs.end(), co_runBefore);
   clock_t tt = 0;
   startTimer(tt);
-  BinaryMergeSort(tempRout, (*tempSizeVec)[0], tempRout + (*tempSizeVec)[0],
-                  (*tempSizeVec)[1], Rout);
+  if (op.runs.size() == 1 && op.runs[0].R != NULL)
+    memcpy(Rout, op.runs[0].R, rLen * sizeof(Record));
+  else if (op.runs.size() > 0)
+    co_parallelMerge(&op, rLen, Rout);
   endTimer("Merge", tt);
-
-  delete tempSizeVec;
-  delete[] tempRout;
+  for (i = 0; i < (int)op.runs.size(); i++) {
+    if (op.runs[i].R != NULL)
+      delete[] op.runs[i].R;
+    if (op.runs[i].fence != NULL)
+      delete[] op.runs[i].fence;
+  }
+  if (op.spillFile != NULL)
+    fclose(op.spillFile); // a tmpfile is removed on close.
+  CloseHandle(op.runMutex);
+  CloseHandle(op.fileMutex);
   printf("co-processing okay");
 }
@@ -0,0 +1,229 @@
+#include "Compress.h"
+#include "CoProcessor.h"
+#include "stdio.h"
+#include "string.h"
+#include <algorithm>
+#include <vector>
+using namespace std;
+
+// the bits of the codes 0..maxCode.
+static int compress_bits(unsigned long long maxCode)
+{
+	int width = 0;
+	while (width < 64 && (1ULL << width) <= maxCode)
+		width++;
+	return width;
+}
+
+static int compress_numWord(int len, int width)
+{
+	return (int)(((long long)len * width + 31) / 32) + 1;
+}
+
+static unsigned int *compress_pack(int *codes, int len, int width, int *numWord)
+{
+	*numWord = compress_numWord(len, width);
+	unsigned int *words = (unsigned int *)calloc(*numWord, sizeof(unsigned int));
+	if (width == 0)
+		return words;
+	for (int i = 0; i < len; i++)
+	{
+		long long bit = (long long)i * width;
+		int w = (int)(bit >> 5);
+		unsigned long long v = (unsigned long long)(unsigned int)codes[i] << (bit & 31);
+		words[w] |= (unsigned int)v;
+		words[w + 1] |= (unsigned int)(v >> 32);
+	}
+	return words;
+}
+
+static unsigned int compress_unpack(unsigned int *words, int width, int i)
+{
+	if (width == 0)
+		return 0;
+	long long bit = (long long)i * width;
+	int w = (int)(bit >> 5);
+	unsigned long long word = words[w] | ((unsigned long long)words[w + 1] << 32);
+	return (unsigned int)((word >> (bit & 31)) & ((1ULL << width) - 1));
+}
+
+int CompressedColumn::getValue(int i)
+{
+	if (scheme == PACK_RLE)
+	{
+		int run = (int)(upper_bound(aux, aux + numAux, i) - aux) - 1;
+		return ((int *)data)[run];
+	}
+	unsigned int code = compress_unpack(data, width, i);
+	if (scheme == PACK_DICT)
+		return aux[code];
+	return base + (int)code;
+}
+
+long long CompressedColumn::bytes()
+{
+	return sizeof(int) * ((long long)numWord + (aux != NULL ? numAux : 0));
+}
+
+void CompressedColumn::codeRange(int low, int high, int *codeLow, int *codeHigh)
+{
+	if (scheme == PACK_RLE)
+	{
+		*codeLow = low;
+		*codeHigh = high;
+	}
+	else if (scheme == PACK_DICT)
+	{
+		*codeLow = (int)(lower_bound(aux, aux + numAux, low) - aux);
+		*codeHigh = (int)(upper_bound(aux, aux + numAux, high) - aux) - 1;
+	}
+	else
+	{
+		long long maxCode = (1LL << width) - 1;
+		long long lo = (long long)low - base;
+		long long hi = (long long)high - base;
+		*codeLow = (int)max(lo, 0LL);
+		*codeHigh = (int)min(hi, maxCode);
+		if (lo > maxCode || hi < 0)
+		{
+			*codeLow = 1;
+			*codeHigh = 0;
+		}
+	}
+}
+
+CompressedColumn *compress_column(Record *R, int len)
+{
+	int i = 0;
+	if (len <= 0)
+		return NULL;
+	for (i = 0; i < len; i++)
+		if (R[i].rid != i)
+			return NULL;
+	int minValue = R[0].value, maxValue = R[0].value;
+	int numRun = 1;
+	for (i = 1; i < len; i++)
+	{
+		minValue = min(minValue, R[i].value);
+		maxValue = max(maxValue, R[i].value);
+		if (R[i].value != R[i - 1].value)
+			numRun++;
+	}
+	vector<int> distinct(len);
+	for (i = 0; i < len; i++)
+		distinct[i] = R[i].value;
+	sort(distinct.begin(), distinct.end());
+	distinct.erase(unique(distinct.begin(), distinct.end()), distinct.end());
+	int numDistinct = (int)distinct.size();
+	// the bytes of every scheme, FOR only while base+code stays an int.
+	int forWidth = compress_bits((unsigned long long)((long long)maxValue - minValue));
+	int dictWidth = compress_bits(numDistinct - 1);
+	long long forBytes = (forWidth < 32) ? 4LL * compress_numWord(len, forWidth) : -1;
+	long long dictBytes = 4LL * (compress_numWord(len, dictWidth) + numDistinct);
+	long long rleBytes = 8LL * numRun;
+	int scheme = PACK_DICT;
+	long long best = dictBytes;
+	if (forBytes >= 0 && forBytes <= best)
+	{
+		scheme = PACK_FOR;
+		best = forBytes;
+	}
+	if (rleBytes < best)
+	{
+		scheme = PACK_RLE;
+		best = rleBytes;
+	}
+	if ((double)sizeof(int) * len < COMPRESS_MIN_RATIO * best)
+		return NULL;
+
+	CompressedColumn *col = (CompressedColumn *)malloc(sizeof(CompressedColumn));
+	col->scheme = scheme;
+	col->len = len;
+	col->base = 0;
+	col->width = 32;
+	col->aux = NULL;
+	col->numAux = 0;
+	if (scheme == PACK_RLE)
+	{
+		col->numAux = numRun;
+		col->numWord = numRun;
+		col->data = (unsigned int *)malloc(sizeof(int) * numRun);
+		col->aux = (int *)malloc(sizeof(int) * numRun);
+		int run = 0;
+		for (i = 0; i < len; i++)
+			if (i == 0 || R[i].value != R[i - 1].value)
+			{
+				((int *)col->data)[run] = R[i].value;
+				col->aux[run] = i;
+				run++;
+			}
+		return col;
+	}
+	int *codes = new int[len];
+	if (scheme == PACK_DICT)
+	{
+		col->width = dictWidth;
+		col->numAux = numDistinct;
+		col->aux = (int *)malloc(sizeof(int) * numDistinct);
+		memcpy(col->aux, &distinct[0], sizeof(int) * numDistinct);
+		for (i = 0; i < len; i++)
+			codes[i] = (int)(lower_bound(distinct.begin(), distinct.end(), R[i].value) - distinct.begin());
+	}
+	else
+	{
+		col->width = forWidth;
+		col->base = minValue;
+		for (i = 0; i < len; i++)
+			codes[i] = (int)((long long)R[i].value - minValue);
+	}
+	col->data = compress_pack(codes, len, col->width, &col->numWord);
+	delete[] codes;
+	return col;
+}
+
+void compress_upload(CompressedColumn *col, PackedColumn *p)
+{
+	p->scheme = col->scheme;
+	p->width = col->width;
+	p->base = col->base;
+	p->rLen = col->len;
+	p->numAux = col->numAux;
+	CL_CREATE(&p->d_data, sizeof(int) * col->numWord);
+	CopyCPUToGPU(p->d_data, col->data, sizeof(int) * col->numWord);
+	p->d_aux = NULL;
+	if (col->aux != NULL)
+	{
+		CL_CREATE(&p->d_aux, sizeof(int) * col->numAux);
+		CopyCPUToGPU(p->d_aux, col->aux, sizeof(int) * col->numAux);
+	}
+}
+
+void compress_release(PackedColumn *p)
+{
+	CL_DESTORY(&p->d_data);
+	if (p->d_aux != NULL)
+		CL_DESTORY(&p->d_aux);
+	p->d_data = NULL;
+	p->d_aux = NULL;
+}
+
+void compress_destroy(CompressedColumn *col)
+{
+	free(col->data);
+	if (col->aux != NULL)
+		free(col->aux);
+	free(col);
+}
+
+const char *compress_schemeName(int scheme)
+{
+	switch (scheme)
+	{
+	case PACK_FOR:
+		return "FOR";
+	case PACK_RLE:
+		return "RLE";
+	default:
+		return "DICT";
+	}
+}
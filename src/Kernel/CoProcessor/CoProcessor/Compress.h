@@ -0,0 +1,40 @@
+#ifndef COMPRESS_H
+#define COMPRESS_H
+#include "db.h"
+#include "../TonyLib/OpenCL_DLL.h"
+/*
+A column whose records are in rid order keeps its values only, compressed with
+the scheme that makes it smallest: frame of reference with bit packing, run
+length for sorted columns, or a dictionary of its distinct values. The kernels
+read the compressed words; a range selection on FOR or DICT compares the codes,
+so the values are never decoded, and the plan sees records when it asks for
+them. The layout of every scheme is the one of PackedColumn in OpenCL_DLL.h.
+*/
+// a column is compressed if its 32 bit values take this many times the bytes, so
+// a FOR column of 17 bits or more is not.
+#define COMPRESS_MIN_RATIO (2.0)
+
+struct CompressedColumn {
+	int scheme; // PACK_*
+	int width;  // bits of a code, FOR and DICT.
+	int base;   // FOR.
+	int len;
+	int numAux;
+	unsigned int *data; // the packed codes and a word of padding, or the runs.
+	int numWord;
+	int *aux; // the distinct values or the run starts, NULL for FOR.
+	int getValue(int i);
+	long long bytes(); // what goes to the device.
+	// the codes of the values in [low,high], none if *codeLow>*codeHigh. RLE
+	// compares the values themselves, they are kept.
+	void codeRange(int low, int high, int *codeLow, int *codeHigh);
+};
+
+// NULL if R is not in rid order or no scheme saves COMPRESS_MIN_RATIO.
+CompressedColumn *compress_column(Record *R, int len);
+// the device copy; compress_release frees both of its buffers.
+void compress_upload(CompressedColumn *col, PackedColumn *p);
+void compress_release(PackedColumn *p);
+void compress_destroy(CompressedColumn *col);
+const char *compress_schemeName(int scheme);
+#endif
@@ -26,6 +26,10 @@ Database::Database(void) {
   cc_indexObjs = (HashTable *)malloc(sizeof(HashTable));
   cc_indexObjs->init();
   tables = (Record **)malloc(sizeof(Record *) * MAX_TABLE_NUM);
+  typedValues = (void **)malloc(sizeof(void *) * MAX_TABLE_NUM);
+  dictColumns = (DictColumn **)malloc(sizeof(DictColumn *) * MAX_TABLE_NUM);
+  packedColumns =
+      (CompressedColumn **)malloc(sizeof(CompressedColumn *) * MAX_TABLE_NUM);
   cpu_treeIndexes =
       (CUDA_CSSTree **)malloc(sizeof(CUDA_CSSTree *) * MAX_TABLE_NUM);
   gpu_treeIndexes =
@@ -34,16 +38,31 @@ Database::Database(void) {
   int i = 0;
   for (i = 0; i < MAX_TABLE_NUM; i++) {
     tables[i] = NULL;
+    typedValues[i] = NULL;
+    dictColumns[i] = NULL;
+    packedColumns[i] = NULL;
     cpu_treeIndexes[i] = NULL;
     gpu_treeIndexes[i] = NULL;
     tPro[i].Query_rLen = -1;
     tPro[i].sortField = 0;
     tPro[i].cpu_treeindex = 0; // there is no index
     tPro[i].gpu_treeindex = 0; // there is no index
+    tPro[i].colType = COL_INT32;
     numColumnInOTable[i] = 0;
   }
 }
 
+// the column and its dictionary; the dictionary goes with its last column.
+static void dropDictColumn(DictColumn **dictColumns, int id) {
+  Dictionary *dict = dictColumns[id]->dict;
+  dict_destroyColumn(dictColumns[id]);
+  dictColumns[id] = NULL;
+  for (int i = 0; i < MAX_TABLE_NUM; i++)
+    if (dictColumns[i] != NULL && dictColumns[i]->dict == dict)
+      return;
+  dict_destroy(dict);
+}
+
 Database::~Database(void) {
   delete nameIndex;
   delete cc_indexObjs;
@@ -51,12 +70,21 @@ Database::~Database(void) {
   for (i = 0; i < MAX_TABLE_NUM; i++) {
     if (tables[i] != NULL)
       delete tables[i];
+    if (typedValues[i] != NULL)
+      free(typedValues[i]);
+    if (dictColumns[i] != NULL)
+      dropDictColumn(dictColumns, i);
+    if (packedColumns[i] != NULL)
+      compress_destroy(packedColumns[i]);
     //		if(co_treeIndexes[i]!=NULL)
     //			delete co_treeIndexes[i];
     //		if(cpu_treeIndexes[i]!=NULL)
     //			delete cpu_treeIndexes[i];
   }
   free(tables);
+  free(typedValues);
+  free(dictColumns);
+  free(packedColumns);
   free(tPro);
 }
 
@@ -74,7 +102,8 @@ int Database::check(char *rName) {
   int i = 0;
   int resultID = 0;
   for (i = 0; i < MAX_TABLE_NUM; i++)
-    if (tables[i] == NULL) {
+    if (tables[i] == NULL && typedValues[i] == NULL &&
+        dictColumns[i] == NULL && packedColumns[i] == NULL) {
       resultID = i;
       break;
     }
@@ -127,6 +156,15 @@ int Database::dropTable(char *rName) {
   if (nameIndex->Lookup(rName, &id) == true) {
     delete tables[id];
     tables[id] = NULL;
+    if (typedValues[id] != NULL)
+      free(typedValues[id]);
+    typedValues[id] = NULL;
+    if (dictColumns[id] != NULL)
+      dropDictColumn(dictColumns, id);
+    if (packedColumns[id] != NULL)
+      compress_destroy(packedColumns[id]);
+    packedColumns[id] = NULL;
+    tPro[id].colType = COL_INT32;
     nameIndex->RemoveEntry(rName);
   } else {
     cout << "table not found, " << rName << endl;
@@ -138,10 +176,25 @@ int Database::dropTable(char *rName) {
 int Database::getTable(char *rName, cl_mem *Rout, int *Query_rLen) {
   int id = -1;
   if (nameIndex->Lookup(rName, &id) == true) {
+    if (typedValues[id] != NULL) {
+      cout << "typed column, it has no records: " << rName << endl;
+      exit(1);
+    }
     *Query_rLen = tPro[id].Query_rLen;
     int memSize = (*Query_rLen) * sizeof(Record);
     CL_CREATE(Rout, memSize);
-    CopyCPUToGPU(*Rout, tables[id], memSize); // this step is correct
+    if (dictColumns[id] != NULL) {
+      // the codes are widened to records on the way to the device.
+      DictColumn *col = dictColumns[id];
+      Record *R = (Record *)malloc(memSize > 0 ? memSize : sizeof(Record));
+      for (int i = 0; i < *Query_rLen; i++) {
+        R[i].rid = i;
+        R[i].value = col->getCode(i);
+      }
+      CopyCPUToGPU(*Rout, R, memSize);
+      free(R);
+    } else
+      CopyCPUToGPU(*Rout, tables[id], memSize); // this step is correct
     // Kernel_bufferchecking(*Rout,memSize);
     // DATA_TO_GPU(memSize);
   } else {
@@ -151,6 +204,107 @@ int Database::getTable(char *rName, cl_mem *Rout, int *Query_rLen) {
   return id;
 }
 
+// the values of a typed column, a plain array of its type.
+int Database::getTypedTable(char *rName, cl_mem *Rout, int *Query_rLen) {
+  int id = -1;
+  if (nameIndex->Lookup(rName, &id) == true && typedValues[id] != NULL) {
+    *Query_rLen = tPro[id].Query_rLen;
+    int memSize = (*Query_rLen) * colTypeSize(tPro[id].colType);
+    CL_CREATE(Rout, memSize > 0 ? memSize : sizeof(long long));
+    if (memSize > 0)
+      CopyCPUToGPU(*Rout, typedValues[id], memSize);
+  } else {
+    cout << "typed column not found, " << rName << endl;
+    exit(1);
+  }
+  return id;
+}
+
+// COL_INT32 for the Record tables and for names that are not tables.
+int Database::getColumnType(char *rName) {
+  int id = -1;
+  if (nameIndex->Lookup(rName, &id) == true)
+    return tPro[id].colType;
+  return COL_INT32;
+}
+
+Dictionary *Database::getDictionary(char *rName) {
+  int id = -1;
+  if (nameIndex->Lookup(rName, &id) == true && dictColumns[id] != NULL)
+    return dictColumns[id]->dict;
+  return NULL;
+}
+
+// the string of a code of a result, NULL if rName is not a dictionary column.
+const char *Database::decode(char *rName, int code) {
+  Dictionary *dict = getDictionary(rName);
+  return (dict == NULL) ? NULL : dict->decode(code);
+}
+
+int Database::compressTable(char *rName) {
+  int id = -1;
+  if (nameIndex->Lookup(rName, &id) == false || tables[id] == NULL)
+    return -1;
+  int len = tPro[id].Query_rLen;
+  CompressedColumn *col = compress_column(tables[id], len);
+  if (col == NULL)
+    return -1;
+  // the records stay for the joins, sorts and groupings, which read them as
+  // they are instead of decoding the column on the host.
+  packedColumns[id] = col;
+  long long recordBytes = (long long)sizeof(Record) * len;
+  cout << "compressed " << rName << ", " << compress_schemeName(col->scheme)
+       << ", " << col->width << " bits, ratio "
+       << (double)sizeof(int) * len / col->bytes() << ", record bytes per packed byte "
+       << (double)recordBytes / col->bytes() << endl;
+  return col->scheme;
+}
+
+CompressedColumn *Database::getCompressedColumn(char *rName) {
+  int id = -1;
+  if (nameIndex->Lookup(rName, &id) == true)
+    return packedColumns[id];
+  return NULL;
+}
+
+int Database::getPackedTable(char *rName, PackedColumn *col) {
+  int id = -1;
+  if (nameIndex->Lookup(rName, &id) == true && packedColumns[id] != NULL)
+    compress_upload(packedColumns[id], col);
+  else {
+    cout << "compressed column not found, " << rName << endl;
+    exit(1);
+  }
+  return id;
+}
+
+// the ratio is over the 32 bit values; the bytes a scan of the records reads
+// per byte of the packed words bound what a bandwidth bound scan can gain.
+void Database::reportCompression() {
+  long long valueBytes = 0, recordBytes = 0, packedBytes = 0;
+  int numPacked = 0;
+  for (int i = 0; i < MAX_TABLE_NUM; i++) {
+    if (packedColumns[i] == NULL)
+      continue;
+    numPacked++;
+    valueBytes += (long long)sizeof(int) * packedColumns[i]->len;
+    recordBytes += (long long)sizeof(Record) * packedColumns[i]->len;
+    packedBytes += packedColumns[i]->bytes();
+  }
+  if (numPacked == 0)
+    return;
+  cout << numPacked << " columns compressed, " << recordBytes / 1024 << " KB in "
+       << packedBytes / 1024 << " KB, ratio "
+       << (double)valueBytes / packedBytes << ", record bytes per packed byte "
+       << (double)recordBytes / packedBytes << endl;
+}
+
+int Database::colTypeSize(int colType) {
+  if (colType == COL_INT64 || colType == COL_FLOAT64)
+    return 8;
+  return 4;
+}
+
 int Database::test(void) {
   /*	int Query_rLen=10;
           Record *R=(Record*)malloc(sizeof(Record)*Query_rLen);
@@ -165,7 +319,8 @@ int Database::test(void) {
 }
 
 RET_VALUE Database::getTableProperty(int tableID, TableProperty *py) {
-  if (tables[tableID] != NULL) {
+  if (tables[tableID] != NULL || typedValues[tableID] != NULL ||
+      dictColumns[tableID] != NULL || packedColumns[tableID] != NULL) {
     PY_EVAL(py, (this->tPro + tableID));
     return SUCCEED;
   } else
@@ -236,6 +391,60 @@ void Database::removeTreeIndex(char *tableName, char *columnName) {
   numIndex--;
 }
 
+// "name type" on a table line, int32 if the type is not given. "name dict" is
+// a string column, "name dict other" shares the dictionary of the column other.
+static int parseColumnType(char *line, bool *isDict, char **shareWith) {
+  *isDict = false;
+  *shareWith = NULL;
+  char *sep = strchr(line, ' ');
+  if (sep == NULL)
+    return COL_INT32;
+  *sep = '\0';
+  char *type = sep + 1;
+  if (strncmp(type, "dict", 4) == 0) {
+    *isDict = true;
+    if (type[4] == ' ')
+      *shareWith = type + 5;
+    return COL_INT32;
+  }
+  if (strcmp(type, "int64") == 0)
+    return COL_INT64;
+  if (strcmp(type, "float") == 0)
+    return COL_FLOAT32;
+  if (strcmp(type, "double") == 0)
+    return COL_FLOAT64;
+  return COL_INT32;
+}
+
+// the int64 values go past 32 bits, the float ones have a fraction.
+static void *generateTypedRand(int colType, int max, int len, int seed) {
+  void *data = malloc(Database::colTypeSize(colType) * (len > 0 ? len : 1));
+  srand(seed);
+  for (int i = 0; i < len; i++) {
+    int v = RAND(max);
+    double frac = rand() / (RAND_MAX + 1.0);
+    if (colType == COL_INT64)
+      ((long long *)data)[i] = ((long long)v << 16) | (rand() & 0xffff);
+    else if (colType == COL_FLOAT32)
+      ((float *)data)[i] = (float)(v + frac);
+    else
+      ((double *)data)[i] = v + frac;
+  }
+  return data;
+}
+
+// strings of a low cardinality dimension.
+static char **generateDictRand(int max, int len, int seed) {
+  int card = (max < DICT_GEN_CARDINALITY) ? max : DICT_GEN_CARDINALITY;
+  char **strings = (char **)malloc(sizeof(char *) * (len > 0 ? len : 1));
+  srand(seed);
+  for (int i = 0; i < len; i++) {
+    strings[i] = (char *)malloc(16);
+    sprintf(strings[i], "v%06d", RAND(card));
+  }
+  return strings;
+}
+
 int Database::loadDB(char *conFile, int Uplimit) {
   FILE *src = fopen(conFile, "r");
   __DEBUG__(conFile);
@@ -261,11 +470,15 @@ int Database::loadDB(char *conFile, int Uplimit) {
           __DEBUG__(charBuf);
           if (strcmp(charBuf, "[/Tables]") == 0)
             break;
+          bool isDict = false;
+          char *shareWith = NULL;
+          int colType = parseColumnType(charBuf, &isDict, &shareWith);
           fgets(dFileName, NAME_MAX_LENGTH, src);
           len = (int)strlen(dFileName);
           if (len <= NAME_MAX_LENGTH)
             dFileName[len - 1] = '\0';
 #ifdef DB_FROM_FILE
+          // the data files hold records, the type of the line is not used.
           FILE *dbFile = fopen(dFileName, "r");
           if (dbFile != NULL) {
             int Query_rLen = 0;
@@ -285,6 +498,26 @@ int Database::loadDB(char *conFile, int Uplimit) {
             fclose(dbFile);
           }
 #else
+          if (isDict) {
+            char **strings =
+                generateDictRand(Uplimit, Query_rLen, this->numTable);
+            this->addDictTable(charBuf, strings, Query_rLen, shareWith);
+            for (int i = 0; i < Query_rLen; i++)
+              free(strings[i]);
+            free(strings);
+            cout << "importing " << charBuf << ", size of, " << Query_rLen
+                 << endl;
+            continue;
+          }
+          if (colType != COL_INT32) {
+            this->addTypedTable(
+                charBuf,
+                generateTypedRand(colType, Uplimit, Query_rLen, this->numTable),
+                Query_rLen, colType);
+            cout << "importing " << charBuf << ", size of, " << Query_rLen
+                 << endl;
+            continue;
+          }
           Record *R = (Record *)malloc(sizeof(Record) * Query_rLen);
           generateRand(R, Uplimit, Query_rLen,
                        this->numTable); // make it adaptive...
@@ -292,12 +525,14 @@ int Database::loadDB(char *conFile, int Uplimit) {
           this->addTable(charBuf, R, Query_rLen);
           cout << "importing " << charBuf << ", size of, " << Query_rLen
                << endl;
+          this->compressTable(charBuf);
         }
 
       } else if (strcmp(charBuf, "[Indexes]") == 0) {
       }
     }
     fclose(src);
+    reportCompression();
   } else {
     __DEBUG__("ERROR: file not found");
   }
@@ -414,6 +649,40 @@ int Database::addTable(char *rName, Record *data, int Query_rLen) {
   return (numTable - 1);
 }
 
+int Database::addDictTable(char *rName, char **strings, int Query_rLen,
+                           char *shareWith) {
+  Dictionary *dict = NULL;
+  if (shareWith != NULL) {
+    dict = getDictionary(shareWith);
+    if (dict == NULL) {
+      cout << "no dictionary to share, " << shareWith << endl;
+      exit(1);
+    }
+    DictColumn *sharing[MAX_TABLE_NUM];
+    int numSharing = 0;
+    for (int i = 0; i < MAX_TABLE_NUM; i++)
+      if (dictColumns[i] != NULL && dictColumns[i]->dict == dict)
+        sharing[numSharing++] = dictColumns[i];
+    dict_merge(dict, strings, Query_rLen, sharing, numSharing);
+  } else
+    dict = dict_create(strings, Query_rLen);
+  int result = addTable(rName, NULL, Query_rLen);
+  int id = 0;
+  nameIndex->Lookup(rName, &id);
+  dictColumns[id] = dict_encode(dict, strings, Query_rLen);
+  return result;
+}
+
+int Database::addTypedTable(char *rName, void *data, int Query_rLen,
+                            int colType) {
+  int result = addTable(rName, NULL, Query_rLen);
+  int id = 0;
+  nameIndex->Lookup(rName, &id);
+  typedValues[id] = data;
+  tPro[id].colType = colType;
+  return result;
+}
+
 // default size is 150K.
 int Database::dbmbenchForMonet(int scale) {
   int i = 0;
@@ -619,6 +888,10 @@ int Database::dbmbench(int scale) {
   cout << "total database size, "
        << sizeof(Record) * DEFAULT_DB_SIZE * 3 * (scale + 1) / 1024 / 1024
        << " MB," << endl;
+  char *columns[] = {"T2.a1", "T2.a2", "T2.a3", "T1.a1", "T1.a2", "T1.a3"};
+  for (i = 0; i < 6; i++)
+    this->compressTable(columns[i]);
+  reportCompression();
   return 0;
   /*int size=DEFAULT_DB_SIZE*scale;
   int i=0;
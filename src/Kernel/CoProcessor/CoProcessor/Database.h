@@ -3,6 +3,8 @@
 //#pragma once
 #include "hash.h"
 #include "db.h"
+#include "Dictionary.h"
+#include "Compress.h"
 #include "../MyLib/CPU_Dll.h"
 #include "../TonyLib/OpenCL_DLL.h"
 extern int Query_rLen;
@@ -16,8 +18,9 @@ struct TableProperty
 	int sortField;//0, rid; 1, value.
 	int gpu_treeindex;//0, no index; 1, CSS-tree index
 	int cpu_treeindex;//0, no index; 1, CSS-tree index
+	int colType;//COL_INT32 for the Record tables, otherwise a typed column.
 };
-#define PY_EVAL(Rhs, Tmp) { Rhs->Query_rLen = Tmp->Query_rLen;Rhs->sortField = Tmp->sortField;Rhs->gpu_treeindex = Tmp->gpu_treeindex;Rhs->cpu_treeindex = Tmp->cpu_treeindex;}
+#define PY_EVAL(Rhs, Tmp) { Rhs->Query_rLen = Tmp->Query_rLen;Rhs->sortField = Tmp->sortField;Rhs->gpu_treeindex = Tmp->gpu_treeindex;Rhs->cpu_treeindex = Tmp->cpu_treeindex;Rhs->colType = Tmp->colType;}
 class Database
 {
 public:
@@ -32,6 +35,15 @@ public:
 	HashTable* nameIndex; //map the table name to the index.
 	int numTable;
 	Record** tables;
+	//a typed column (int64, float, double) keeps its values only, the rid of a value is its
+	//position. its slot in tables is NULL.
+	void** typedValues;
+	//a dictionary encoded string column keeps its codes, the plan reads it as records
+	//(rid, code) like any other. its slot in tables is NULL.
+	DictColumn** dictColumns;
+	//a compressed column keeps its values in the scheme chosen when it is loaded for the
+	//operators that read it packed, and its records in tables for the rest of the plan.
+	CompressedColumn** packedColumns;
 	TableProperty* tPro;
 	static int test(void);
 	RET_VALUE getTableProperty(int tableID, TableProperty* py);
@@ -52,6 +64,20 @@ public:
 	int loadDB(char* conFile,int Uplimit);
 	int dumpDB(char* conFile, bool toWrite);
 	int addTable(char* tableName, Record* data, int Query_rLen);
+	int addTypedTable(char* tableName, void* data, int Query_rLen, int colType);
+	int getTypedTable(char* rName, cl_mem* Rout, int * Query_rLen);
+	int getColumnType(char* rName);
+	//shareWith names a dictionary column whose dictionary is extended and used, NULL for a new one.
+	int addDictTable(char* tableName, char** strings, int Query_rLen, char* shareWith);
+	Dictionary* getDictionary(char* rName);//NULL if it is not a dictionary column.
+	const char* decode(char* rName, int code);
+	static int colTypeSize(int colType);
+	//a record table in rid order is compressed if it pays off, -1 if it stays as it is.
+	int compressTable(char* rName);
+	CompressedColumn* getCompressedColumn(char* rName);//NULL if it is not compressed.
+	//the compressed column on the device, release it with compress_release.
+	int getPackedTable(char* rName, PackedColumn* col);
+	void reportCompression();
 	char allTableName[MAX_TABLE_NUM][NAME_MAX_LENGTH];
 	char allColumnName[MAX_TABLE_NUM][NAME_MAX_LENGTH*4];
 	int numColumnInOTable[MAX_TABLE_NUM];
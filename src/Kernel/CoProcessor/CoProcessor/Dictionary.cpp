@@ -0,0 +1,167 @@
+#include "Dictionary.h"
+#include "stdio.h"
+#include "string.h"
+#include <algorithm>
+#include <vector>
+using namespace std;
+
+static bool dict_less(const char *a, const char *b) { return strcmp(a, b) < 0; }
+
+static bool dict_equal(const char *a, const char *b)
+{
+	return strcmp(a, b) == 0;
+}
+
+int Dictionary::lowerBound(const char *s)
+{
+	return (int)(lower_bound(values, values + numValue, s, dict_less) - values);
+}
+
+int Dictionary::upperBound(const char *s)
+{
+	return (int)(upper_bound(values, values + numValue, s, dict_less) - values);
+}
+
+int Dictionary::find(const char *s)
+{
+	int code = lowerBound(s);
+	if (code < numValue && strcmp(values[code], s) == 0)
+		return code;
+	return -1;
+}
+
+int Dictionary::prefixEnd(const char *prefix)
+{
+	int len = (int)strlen(prefix);
+	int lo = lowerBound(prefix);
+	int hi = numValue;
+	// the strings with the prefix are contiguous from lo.
+	while (lo < hi)
+	{
+		int mid = lo + (hi - lo) / 2;
+		if (strncmp(values[mid], prefix, len) == 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+
+int DictColumn::getCode(int i)
+{
+	if (codeBits == 8)
+		return ((unsigned char *)codes)[i];
+	if (codeBits == 16)
+		return ((unsigned short *)codes)[i];
+	return ((int *)codes)[i];
+}
+
+void DictColumn::setCodes(int *p_codes, int p_len)
+{
+	int numValue = dict->numValue;
+	codeBits = (numValue <= 256) ? 8 : ((numValue <= 65536) ? 16 : 32);
+	len = p_len;
+	codes = malloc((codeBits / 8) * (len > 0 ? len : 1));
+	for (int i = 0; i < len; i++)
+	{
+		if (codeBits == 8)
+			((unsigned char *)codes)[i] = (unsigned char)p_codes[i];
+		else if (codeBits == 16)
+			((unsigned short *)codes)[i] = (unsigned short)p_codes[i];
+		else
+			((int *)codes)[i] = p_codes[i];
+	}
+}
+
+// the distinct strings, sorted.
+static void dict_distinct(vector<const char *> &v)
+{
+	sort(v.begin(), v.end(), dict_less);
+	v.erase(unique(v.begin(), v.end(), dict_equal), v.end());
+}
+
+static void dict_setValues(Dictionary *dict, vector<const char *> &v)
+{
+	dict->numValue = (int)v.size();
+	dict->values = (char **)malloc(sizeof(char *) * (v.size() > 0 ? v.size() : 1));
+	for (int i = 0; i < dict->numValue; i++)
+	{
+		int len = (int)strlen(v[i]);
+		dict->values[i] = (char *)malloc(len + 1);
+		strcpy(dict->values[i], v[i]);
+	}
+}
+
+Dictionary *dict_create(char **strings, int len)
+{
+	vector<const char *> v(strings, strings + len);
+	dict_distinct(v);
+	Dictionary *dict = (Dictionary *)malloc(sizeof(Dictionary));
+	dict_setValues(dict, v);
+	return dict;
+}
+
+void dict_merge(Dictionary *dict, char **strings, int len, DictColumn **columns, int numColumn)
+{
+	int i = 0, k = 0;
+	vector<const char *> v(dict->values, dict->values + dict->numValue);
+	v.insert(v.end(), strings, strings + len);
+	dict_distinct(v);
+	if ((int)v.size() == dict->numValue)
+		return;
+	// old code -> new code, the old strings keep their order.
+	char **oldValues = dict->values;
+	int oldNum = dict->numValue;
+	dict_setValues(dict, v);
+	int *recode = new int[oldNum > 0 ? oldNum : 1];
+	for (i = 0; i < oldNum; i++)
+		recode[i] = dict->find(oldValues[i]);
+	for (k = 0; k < numColumn; k++)
+	{
+		DictColumn *col = columns[k];
+		int *codes = new int[col->len > 0 ? col->len : 1];
+		for (i = 0; i < col->len; i++)
+			codes[i] = recode[col->getCode(i)];
+		free(col->codes);
+		col->setCodes(codes, col->len);
+		delete[] codes;
+	}
+	delete[] recode;
+	for (i = 0; i < oldNum; i++)
+		free(oldValues[i]);
+	free(oldValues);
+}
+
+DictColumn *dict_encode(Dictionary *dict, char **strings, int len)
+{
+	int *codes = new int[len > 0 ? len : 1];
+	for (int i = 0; i < len; i++)
+	{
+		codes[i] = dict->find(strings[i]);
+		if (codes[i] < 0)
+		{
+			printf("dict_encode: %s is not in the dictionary\n", strings[i]);
+			exit(1);
+		}
+	}
+	DictColumn *col = (DictColumn *)malloc(sizeof(DictColumn));
+	col->dict = dict;
+	col->setCodes(codes, len);
+	delete[] codes;
+	return col;
+}
+
+void dict_destroy(Dictionary *dict)
+{
+	for (int i = 0; i < dict->numValue; i++)
+		free(dict->values[i]);
+	free(dict->values);
+	free(dict);
+}
+
+// the dictionary may be shared, it is released by the database.
+void dict_destroyColumn(DictColumn *col)
+{
+	free(col->codes);
+	free(col);
+}
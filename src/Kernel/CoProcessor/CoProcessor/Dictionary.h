@@ -0,0 +1,45 @@
+#ifndef DICTIONARY_H
+#define DICTIONARY_H
+#include "db.h"
+/*
+A dictionary encoded string column stores the code of every value, the code is
+the position of the string in a sorted dictionary of the distinct strings. The
+order of the codes is the order of the strings, so =, <, > and prefix
+predicates become code ranges and run in the integer kernels; the plan sees a
+column of records whose values are the codes. Columns that are joined share
+one dictionary, so equal strings have equal codes.
+*/
+#define DICT_GEN_CARDINALITY (1000) // distinct strings of a generated column.
+
+struct Dictionary {
+	char **values; // sorted, distinct.
+	int numValue;
+	int lowerBound(const char *s); // the first code whose string is >= s.
+	int upperBound(const char *s); // the first code whose string is > s.
+	int find(const char *s);       // -1 if s is not in the dictionary.
+	// the codes of the strings starting with prefix are [lowerBound, prefixEnd).
+	int prefixEnd(const char *prefix);
+	const char *decode(int code)
+	{
+		return (code >= 0 && code < numValue) ? values[code] : NULL;
+	}
+};
+
+// codes of 8, 16 or 32 bits, the narrowest that holds the dictionary.
+struct DictColumn {
+	Dictionary *dict;
+	int codeBits;
+	void *codes;
+	int len;
+	int getCode(int i);
+	void setCodes(int *p_codes, int p_len);
+};
+
+Dictionary *dict_create(char **strings, int len);
+// adds the strings to the dictionary; the columns encoded with it are recoded,
+// the new strings take codes in between the old ones.
+void dict_merge(Dictionary *dict, char **strings, int len, DictColumn **columns, int numColumn);
+DictColumn *dict_encode(Dictionary *dict, char **strings, int len);
+void dict_destroy(Dictionary *dict);
+void dict_destroyColumn(DictColumn *col);
+#endif
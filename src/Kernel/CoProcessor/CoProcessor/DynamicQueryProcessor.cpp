@@ -8,6 +8,12 @@
 #define SMART_PROCESSOR 1
 #define WORK_STEALING 1
 #define STEALING_CHANCE 3
+#define AIMD_PARK_MS 5
+#define AIMD_INTERVAL_MS 500
+#define AIMD_TOLERANCE 0.05
+#ifndef _WIN32
+#include <unistd.h>
+#endif
 extern FILE *K_ofp;
 
 #ifdef _WIN32
@@ -17,9 +23,70 @@ pthread_mutex_t PoolLock = PTHREAD_MUTEX_INITIALIZER;
 #endif
 
 int CurentID;
+//workers with threadid>=activeThread are parked by the concurrency controller.
+volatile int activeThread;
+volatile int finishedQuery;
 extern int numQueries;//->corresponding to numOfThread for K_schedule
 extern int numThread;//this is fixed to 1 for Q and O schedule
+extern int minThread;
+extern int maxThread;
 extern int Query_rLen;
+extern double Query_CPUBurden;
+extern double Query_GPUBurden;
+extern double RunInCPU[NUM_QUERY_TYPE];
+extern double RunInGPU[NUM_QUERY_TYPE];
+#ifdef _WIN32
+extern CRITICAL_SECTION Query_CPUBurdenCS;
+#define QueryBurdenLock() EnterCriticalSection(&(Query_CPUBurdenCS))
+#define QueryBurdenUnlock() LeaveCriticalSection(&(Query_CPUBurdenCS))
+#else
+extern pthread_mutex_t Query_CPUBurdenCS;
+#define QueryBurdenLock() pthread_mutex_lock(&(Query_CPUBurdenCS))
+#define QueryBurdenUnlock() pthread_mutex_unlock(&(Query_CPUBurdenCS))
+#endif
+//query level placement: greedy on the calibrated whole-query cost.
+//both burdens are read together, so Query_CPUBurdenCS guards both here.
+//a query type without calibrated cost goes round robin.
+static int roundRobinDevice=0;
+EXEC_MODE pickQueryDevice(QUERY_TYPE qT)
+{
+	EXEC_MODE eM;
+	QueryBurdenLock();
+	if(RunInCPU[qT]<=0 && RunInGPU[qT]<=0)
+	{
+		eM=(roundRobinDevice==0)?EXEC_CPU:EXEC_GPU;
+		roundRobinDevice=1-roundRobinDevice;
+	}
+	else if((Query_CPUBurden+RunInCPU[qT])<=(Query_GPUBurden+RunInGPU[qT]))
+	{
+		eM=EXEC_CPU;
+		Query_CPUBurden+=RunInCPU[qT];
+	}
+	else
+	{
+		eM=EXEC_GPU;
+		Query_GPUBurden+=RunInGPU[qT];
+	}
+	QueryBurdenUnlock();
+	return eM;
+}
+void doneQueryDevice(QUERY_TYPE qT, EXEC_MODE eM)
+{
+	QueryBurdenLock();
+	if(eM==EXEC_GPU)
+		Query_GPUBurden-=RunInGPU[qT];
+	else
+		Query_CPUBurden-=RunInCPU[qT];
+	QueryBurdenUnlock();
+}
+static void sleepMS(int ms)
+{
+#ifdef _WIN32
+	Sleep(ms);
+#else
+	usleep(ms*1000);
+#endif
+}
 void tp_QueryThread(tp_singleQuery* _pData)
 {
 	char* query=_pData->query;
@@ -29,9 +96,19 @@ void tp_QueryThread(tp_singleQuery* _pData)
 	setHighPriority();
 	QueryPlanTree tree;//set GPUONLY_QP always false. Assume CoProcessor can only see host data. so directly cancell it.
 	tree.buildTree(query);
-	tree.execute(eM);
+	if(CL_GetScheduleLevel()==SCHEDULE_PLAN)
+		tree.executeDAG();
+	else
+		tree.execute(eM);
 	int len=tree.planStatus->numResultColumn*tree.planStatus->numResultRow;
 	free(tree.planStatus->finalResult);
+	//a result over a dictionary column goes out as its strings.
+	const char** strings=tree.decodeResult();
+#ifdef DEBUG
+	for(int i=0;strings!=NULL && i<tree.q_numResult;i++)
+		cout<<strings[i]<<"\t";
+#endif
+	free((void*)strings);
 }
 
 //the naive query processor, just pick the query random one by one.
@@ -52,6 +129,14 @@ void* tp_naiveQP( void* lpParam )
 	setHighPriority();
 	while(1)
 	{
+		//parked by the concurrency controller, wait to be activated.
+		if(threadid>=activeThread)
+		{
+			if(CurentID>=numQueries)
+				break;
+			sleepMS(AIMD_PARK_MS);
+			continue;
+		}
 		//get the tuples to sort
 #ifdef _WIN32
 		EnterCriticalSection(&(PoolLock));
@@ -71,9 +156,27 @@ void* tp_naiveQP( void* lpParam )
 		query=sqlQuery[curQuery];//the query pick going to be execute
 
 		tp_singleQuery* pData = (tp_singleQuery*) calloc(1, sizeof(tp_singleQuery));
+		int level=gQstat[curQuery].level;
+		if(level==SCHEDULE_QUERY || level==SCHEDULE_HYBRID)
+			gQstat[curQuery].eM=pickQueryDevice(gQstat[curQuery].qT);
 		pData->init(gQstat[curQuery].eM,query,curQuery,threadid);
+		CL_SetScheduleLevel(level);
 		tp_QueryThread(pData);
+		CL_SetScheduleLevel(SCHEDULE_DEFAULT);
+		if(level==SCHEDULE_QUERY || level==SCHEDULE_HYBRID)
+			doneQueryDevice(gQstat[curQuery].qT,gQstat[curQuery].eM);
 		free(pData);
+#ifdef _WIN32
+		EnterCriticalSection(&(PoolLock));
+#else
+		pthread_mutex_lock(&PoolLock);
+#endif
+		finishedQuery++;
+#ifdef _WIN32
+		LeaveCriticalSection(&(PoolLock));
+#else
+		pthread_mutex_unlock(&PoolLock);
+#endif
 		//resetGPU();
 	}
 #ifdef _WIN32
@@ -82,17 +185,96 @@ void* tp_naiveQP( void* lpParam )
 	return NULL;
 #endif
 } 
+//AIMD on the number of active workers: one more while a device is idle or the
+//throughput keeps improving, half of them as soon as the throughput drops.
+//every decision is logged to K_level_Concurrency.tony.
+#ifdef _WIN32
+DWORD WINAPI tp_concurrencyControl( LPVOID lpParam )
+#else
+void* tp_concurrencyControl( void* lpParam )
+#endif
+{
+	tp_concurrency* pData=(tp_concurrency*)lpParam;
+	int timer=genTimer(1);
+	double window=0;
+	double lastThroughput=0;
+	int lastFinished=0;
+	FILE* ofp=fopen("./Output/K_level_Concurrency.tony","a");
+	if(ofp!=NULL)
+		fprintf(ofp,"<%d> start with %d threads in [%d, %d]\n",numQueries,activeThread,pData->minThread,pData->maxThread);
+	getTimer(timer);
+	while(finishedQuery<numQueries)
+	{
+		//short naps, so the last query is not followed by a whole interval.
+		int slept=0;
+		for(slept=0;slept<pData->interval && finishedQuery<numQueries;slept+=AIMD_PARK_MS)
+			sleepMS(AIMD_PARK_MS);
+		window+=getTimer(timer);
+		int finished=finishedQuery;
+		double CPUBurden=CL_getBurden(EXEC_CPU);
+		double GPUBurden=CL_getBurden(EXEC_GPU);
+		bool idle=(CPUBurden<=0 || GPUBurden<=0);
+		//no query finished yet, widen the window instead of reading a zero throughput.
+		if(finished==lastFinished && !idle)
+			continue;
+		double throughput=(finished-lastFinished)/window;
+		int active=activeThread;
+		const char* decision="hold";
+		if(throughput<lastThroughput*(1-AIMD_TOLERANCE) && active>pData->minThread)
+		{
+			active=active/2;
+			if(active<pData->minThread)
+				active=pData->minThread;
+			decision="decrease";
+		}
+		else if((idle || throughput>lastThroughput*(1+AIMD_TOLERANCE)) && active<pData->maxThread)
+		{
+			active++;
+			decision="increase";
+		}
+		activeThread=active;
+		if(ofp!=NULL)
+			fprintf(ofp,"%lf queries/s, burden CPU %lf GPU %lf, %s to %d threads\n",throughput,CPUBurden,GPUBurden,decision,active);
+		lastThroughput=throughput;
+		lastFinished=finished;
+		window=0;
+	}
+	if(ofp!=NULL)
+		fclose(ofp);
+#ifdef _WIN32
+	return 0;
+#else
+	return NULL;
+#endif
+}
 void testQueryProcessor(QUERY_TYPE fromType, QUERY_TYPE toType, int numQuery,int numThread)
+{
+	testQueryProcessor(fromType,toType,numQuery,numThread,SCHEDULE_KERNEL);
+}
+void testQueryProcessor(QUERY_TYPE fromType, QUERY_TYPE toType, int numQuery,int numThread, int level)
+{
+	testQueryProcessor(fromType,toType,numQuery,numThread,&level,1);
+}
+//query i is placed with the scheduling granularity levels[i%numLevel], so the levels
+//run side by side on the same workload and data.
+void testQueryProcessor(QUERY_TYPE fromType, QUERY_TYPE toType, int numQuery,int numThread, int* levels, int numLevel)
 {
 #ifdef _WIN32
 	InitializeCriticalSection(&(PoolLock));
 #else
 	// Already initialized with PTHREAD_MUTEX_INITIALIZER
 #endif
+	//numThread is where the controller starts, the pool holds maxThread workers.
+	int lowThread=(minThread<1)?1:minThread;
+	int highThread=(maxThread<numThread)?numThread:maxThread;
+	if(lowThread>numThread)
+		lowThread=numThread;
+	activeThread=numThread;
+	finishedQuery=0;
 	MyThreadPoolCop *pool=(MyThreadPoolCop*)malloc(sizeof(MyThreadPoolCop));	
-	pool->create(numThread);//always one thread to handle query request regardsless how many query are there.
+	pool->create(highThread+1);//the last thread runs the concurrency controller.
 	int i=0;
-	tp_batchQuery** pData=(tp_batchQuery**)malloc(sizeof(tp_batchQuery*)*numThread);
+	tp_batchQuery** pData=(tp_batchQuery**)malloc(sizeof(tp_batchQuery*)*highThread);
 	char** sqlQuery=(char**)malloc(sizeof(char*)*numQuery);
 	//QUERY_TYPE* queryType=(QUERY_TYPE*)malloc(sizeof(QUERY_TYPE)*numQuery);
 	Query_stat* gQStat=new Query_stat[numQuery];
@@ -102,10 +284,12 @@ void testQueryProcessor(QUERY_TYPE fromType, QUERY_TYPE toType, int numQuery,int
 		gQStat[i].qT=makeRandomQuery(fromType,toType,sqlQuery[i]);
 		//cout<<gQStat[i].speedupGPUoverCPU<<endl;
 		gQStat[i].isAssigned=false;
+		gQStat[i].level=levels[i%numLevel];
+		gQStat[i].eM=EXEC_CPU;
 	}
 	int curID=0;
 	int numActiveThread=numThread;
-	for( i=0; i<numThread; i++ )
+	for( i=0; i<highThread; i++ )
 	{
 		// Allocate memory for thread data.
 		pData[i] = (tp_batchQuery*) calloc(1, sizeof(tp_batchQuery));
@@ -116,23 +300,35 @@ void testQueryProcessor(QUERY_TYPE fromType, QUERY_TYPE toType, int numQuery,int
 			pool->assignParameter(i, pData[i]);
 			pool->assignTask(i, tp_naiveQP);
 	}
+	tp_concurrency control;
+	control.init(lowThread,highThread,AIMD_INTERVAL_MS);
+	pool->assignParameter(highThread, &control);
+	pool->assignTask(highThread, tp_concurrencyControl);
 	int timer=genTimer(2);
+	//the count is shared by all query threads, so only the batch total is exact.
+	CL_resetMigratedBytes();
 	getTimer(timer);
 	pool->run();
 	double t=getTimer(timer);
+	double migratedBytes=(double)CL_getMigratedBytes();
 
 	char outputFilename[50];
 	sprintf(outputFilename, "./Output/K_level_Time.tony");
 	K_ofp = fopen(outputFilename, "a");
 	if(K_ofp !=NULL){
-		fprintf(K_ofp,"<%d> <%d>\n",numQueries,numThread);
+		fprintf(K_ofp,"<%d> <%d> level",numQueries,numThread);
+		for(i=0;i<numLevel;i++)
+			fprintf(K_ofp," %d",levels[i]);
+		fprintf(K_ofp,"\n");
 		fprintf(K_ofp,"%lf\n",t);	
+		fprintf(K_ofp,"migrated bytes per query: %lf\n",migratedBytes/numQuery);
+		fprintf(K_ofp,"active threads at the end: %d\n",activeThread);
 		fclose(K_ofp);
 	}else{
 		fprintf(stderr,"\t output file is not created, please check file premission!\n");
 	}
 	printf("------------Kernel level Query finished in %lf---------------\n\n",t);
-	for(i=0;i<numThread;i++)
+	for(i=0;i<highThread;i++)
 	{
 		free(pData[i]);
 	}
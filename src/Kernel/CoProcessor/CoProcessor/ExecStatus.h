@@ -26,13 +26,18 @@ struct ExecStatus
 	//int* RID_baseTable [MAX_TABLE_PER_QUERY];
 	cl_mem RID_baseTable [MAX_TABLE_PER_QUERY];
 	int RIDLen[MAX_TABLE_PER_QUERY];
+	//a selection on a table without RID list keeps its result as a bitmap over the base table,
+	//the next selection on the table ANDs into it. it becomes the sorted RID list only when
+	//an operator asks for the values or the RID list.
+	cl_mem RID_bitmap [MAX_TABLE_PER_QUERY];
+	int bitmapLen[MAX_TABLE_PER_QUERY];
 	int numTables;
 	//one columnNames corresponds to one table, one base table, 	
 	int* finalResult;
 	int numResultColumn;
 	int numResultRow;
 	bool hasGroupBy;
-	int* groupByStartPos;
+	cl_mem groupByStartPos;
 	int groupByNumGroup;
 	cl_mem groupByRelation;
 	DATA_RESIDENCE grpRes;
@@ -58,16 +63,67 @@ struct ExecStatus
 			strcpy(RIDTableNames[numTables],tableName);
 			id=numTables;
 			RID_baseTable[id]=NULL;			
+			RID_bitmap[id]=NULL;
 			numTables++;
 		}
 		return id;	
 	}
  
+	bool canAddBitmap(int id)
+	{
+		assert(id>=0 && id<numTables);
+		return RID_baseTable[id]==NULL;
+	}
+	void addBitmap(int id, cl_mem bitmap, int numBit, EXEC_MODE eM)
+	{
+		assert(canAddBitmap(id));
+		if(RID_bitmap[id]==NULL)
+		{
+			RID_bitmap[id]=bitmap;
+			bitmapLen[id]=numBit;
+		}
+		else
+		{
+			CL_BitmapCombineOnly(RID_bitmap[id],bitmap,numBit,BITMAP_AND,256,64,eM);
+			CL_DESTORY(&bitmap);
+		}
+	}
+	void materializeBitmap(int id, EXEC_MODE eM)
+	{
+		if(RID_bitmap[id]==NULL)
+			return;
+		RIDLen[id]=CL_BitmapToRIDListOnly(RID_bitmap[id],bitmapLen[id],&(RID_baseTable[id]),256,64,eM);
+		CL_TagOutput(RID_baseTable[id],RIDLen[id]*sizeof(int));
+		CL_DESTORY(&RID_bitmap[id]);
+		RID_bitmap[id]=NULL;
+	}
+	//the RID list replaces whatever the bitmap said.
+	void dropBitmap(int id)
+	{
+		if(RID_bitmap[id]!=NULL)
+		{
+			CL_DESTORY(&RID_bitmap[id]);
+			RID_bitmap[id]=NULL;
+		}
+	}
+ 
 	int getDataTable(int id, char* columnName, cl_mem* Rout,EXEC_MODE eM)
 	{
 		assert(id>=0 && id<numTables);
 		int resultLen;
-		if(RID_baseTable[id]==NULL)
+		materializeBitmap(id,eM);
+		if(easedb->getCompressedColumn(columnName)!=NULL)
+		{
+			//only the packed words go to the device, the records are decoded there.
+			PackedColumn col;
+			easedb->getPackedTable(columnName,&col);
+			CL_SetInputs(&RID_baseTable[id],1);
+			resultLen=CL_PackedDecodeOnly(&col,RID_baseTable[id],RIDLen[id],Rout,256,64,eM);
+			CL_TagOutput(*Rout,sizeof(Record)*resultLen);
+			compress_release(&col);
+			RIDLen[id]=resultLen;
+		}
+		else if(RID_baseTable[id]==NULL)
 		{
 			easedb->getTable(columnName,Rout,&resultLen);
 			//Kernel_bufferchecking(*Rout,1);
@@ -81,12 +137,15 @@ struct ExecStatus
 			//int i=0;
 			//for(i=0;i<resultLen;i++)
 			//	(*Rout)[i].rid=RID_baseTable[id][i];
+			//the RID list decides where the first kernel runs.
+			CL_SetInputs(&RID_baseTable[id],1);
 			CL_setRIDList(RID_baseTable[id],resultLen,*Rout,256,64,eM);
 			//Kernel_bufferchecking(*Rout,1);
 			cl_mem baseTable=NULL;
 			int Query_rLen;
 			easedb->getTable(columnName,&baseTable,&Query_rLen);
 			CL_ProjectionOnly(baseTable,RIDLen[id],*Rout,resultLen,256,256,eM);	
+			CL_TagOutput(*Rout,sizeof(Record)*resultLen);
 			CL_DESTORY(&baseTable);
 		}
 		return resultLen;
@@ -99,16 +158,61 @@ struct ExecStatus
 		easedb->getTable(columnName,Rout,&Query_rLen);
 		return Query_rLen;
 	}
+	//the values of a column as a plain array of its type (COL_*), the base table.
+	//an int32 column gives its values too, so the typed operators take any column.
+	int getTypedBaseTable(int id, char* columnName, cl_mem* Rout, EXEC_MODE eM)
+	{
+		assert(id>=0 && id<numTables);
+		int Query_rLen=0;
+		if(easedb->getColumnType(columnName)==COL_INT32)
+		{
+			cl_mem R=NULL;
+			easedb->getTable(columnName,&R,&Query_rLen);
+			CL_getValueList(R,Query_rLen,Rout,256,64,eM);
+			CL_DESTORY(&R);
+		}
+		else
+			easedb->getTypedTable(columnName,Rout,&Query_rLen);
+		return Query_rLen;
+	}
+	//the typed values at the rids of the RID list, in its order.
+	int getTypedData(int id, char* columnName, cl_mem* Rout, EXEC_MODE eM)
+	{
+		assert(id>=0 && id<numTables);
+		materializeBitmap(id,eM);
+		cl_mem baseTable=NULL;
+		int Query_rLen=getTypedBaseTable(id,columnName,&baseTable,eM);
+		if(RID_baseTable[id]==NULL)
+		{
+			*Rout=baseTable;
+			RIDLen[id]=Query_rLen;
+			return Query_rLen;
+		}
+		CL_SetInputs(&RID_baseTable[id],1);
+		CL_TypedGatherOnly(baseTable,easedb->getColumnType(columnName),RID_baseTable[id],RIDLen[id],Rout,256,64,eM);
+		CL_TagOutput(*Rout,0);
+		CL_DESTORY(&baseTable);
+		return RIDLen[id];
+	}
+	//the RID list as it is, NULL while the table is the base table.
+	cl_mem peekRIDList(int id, EXEC_MODE eM)
+	{
+		assert(id>=0 && id<numTables);
+		materializeBitmap(id,eM);
+		return RID_baseTable[id];
+	}
 	//this one needs also assert the GPUONLY_QP and dataRes.
 	int getRIDList(int id, char* columnName,cl_mem* RIDList,EXEC_MODE eM)
 	{
 		assert(id>=0 && id<numTables);
 //		assert((dataRes[id]==DATA_ON_GPU && GPUONLY_QP) || (dataRes[id]==DATA_ON_CPU && (!GPUONLY_QP)));
+		materializeBitmap(id,eM);
 		if(RID_baseTable[id]==NULL)
 		{	
 			cl_mem Rout;
 			int resultLen=0;
 			CL_getRIDList(Rout,resultLen,&(RID_baseTable[id]),256,64,eM);	
+			CL_TagOutput(RID_baseTable[id],0);
 			/*Record *Rout;
 			int resultLen=0, i=0;
 			easedb->getTable(columnName,&Rout,&resultLen);
@@ -127,6 +231,8 @@ struct ExecStatus
 		assert(ID2>=0 && ID2<numTables);
 //		assert((dataRes[ID1]==DATA_ON_GPU && GPUONLY_QP) || (dataRes[ID1]==DATA_ON_CPU && (!GPUONLY_QP)));
 //		assert((dataRes[ID2]==DATA_ON_GPU && GPUONLY_QP) || (dataRes[ID2]==DATA_ON_CPU && (!GPUONLY_QP)));
+		dropBitmap(ID1);
+		dropBitmap(ID2);
 		if(RID_baseTable[ID1]!=NULL)
 			CL_DESTORY(&RID_baseTable[ID1]);
 		if(RID_baseTable[ID2]!=NULL)
@@ -138,8 +244,12 @@ struct ExecStatus
 		}
 		else 
 		{
+			CL_SetInputs(&dt,1);
 			CL_getRIDList(dt,Query_rLen,&(RID_baseTable[ID1]),256,64,eM);
+			CL_TagOutput(RID_baseTable[ID1],Query_rLen*sizeof(int));
+			CL_SetInputs(&dt,1);
 			CL_getValueList(dt,Query_rLen,&(RID_baseTable[ID2]),256,64,eM);
+			CL_TagOutput(RID_baseTable[ID2],Query_rLen*sizeof(int));
 		}
 /*		if(RID_baseTable[ID1]!=NULL)
 			delete RID_baseTable[ID1];
@@ -169,6 +279,7 @@ struct ExecStatus
 	void addDataTable(int id, cl_mem dt,int Query_rLen, DATA_RESIDENCE dataStorePlace,EXEC_MODE eM)
 	{
 		assert(id>=0 && id<numTables);
+		dropBitmap(id);
 		if(RID_baseTable[id]!=NULL)
 		{
 				CL_DESTORY(&RID_baseTable[id]);
@@ -184,7 +295,9 @@ struct ExecStatus
 				CopyCPUToGPU(tempDT,dt,rLen*sizeof(Record));	
 				DATA_TO_GPU(rLen*sizeof(Record));
 			}*/
+			CL_SetInputs(&tempDT,1);
 			CL_getRIDList(tempDT,Query_rLen,&(RID_baseTable[id]),256,64,eM);
+			CL_TagOutput(RID_baseTable[id],Query_rLen*sizeof(int));
 		}
 /*		if(RID_baseTable[id]!=NULL)
 		{
@@ -204,6 +317,7 @@ struct ExecStatus
 	void addRIDList(int id, cl_mem dt,int Query_rLen, DATA_RESIDENCE dataStorePlace)
 	{
 		assert(id>=0 && id<numTables);
+		dropBitmap(id);
 		//free(RID_baseTable[id]);
 		CL_DESTORY(&RID_baseTable[id]);
 		//even in adaptive mode, we change the execution mode and then addRIDList.
@@ -219,6 +333,7 @@ struct ExecStatus
 		for(int i=0;i<MAX_TABLE_PER_QUERY;i++)
 		{
 			RID_baseTable[i]=NULL;
+			RID_bitmap[i]=NULL;
 		}
 		finalResult=NULL;
 		numResultColumn=-1;
@@ -229,8 +344,11 @@ struct ExecStatus
 	{
 		cl_int status;
 		cl_uint refCount;
+		if(groupByStartPos!=NULL)
+			CL_DESTORY(&groupByStartPos);
 		for(int i=0;i<MAX_TABLE_PER_QUERY;i++)
 		{
+			dropBitmap(i);
 
 		status = clGetMemObjectInfo(RID_baseTable[i],
                 		        CL_MEM_REFERENCE_COUNT,
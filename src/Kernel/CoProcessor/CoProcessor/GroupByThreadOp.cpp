@@ -25,12 +25,9 @@ GroupByThreadOp::~GroupByThreadOp(void)
 
 void GroupByThreadOp::execute(EXEC_MODE eM)
 {
-/*	//ON_GPU("GroupByThreadOp::execute");
-	Rout=new Record[Query_rLen];
-	
-	numGroup=CL_GroupBy(R,Query_rLen,Rout,&startPos,256,64,eM);
+	//Rout is R sorted on the value, startPos[g] is where group g begins.
+	numGroup=CL_GroupByOnly(R,Query_rLen,&Rout,&startPos,256,64,eM);
 	numResult=Query_rLen;
-	//ON_GPU_DONE("GroupByThreadOp::execute");*/
 }
 
 ThreadOp* GroupByThreadOp::getNextOp(EXEC_MODE eM)
@@ -70,49 +67,95 @@ AggAfterGroupByThreadOp::~AggAfterGroupByThreadOp(void)
 
 void AggAfterGroupByThreadOp::execute(EXEC_MODE eM)
 {
+	//R is the base column, the grouped relation holds its rids. Rout[g] is (group key, aggregate).
+	int numAgg=1;
+	switch(optType)
+	{
+		case AGG_SUM_AFTER_GROUP_BY:
+			{
+				CL_agg_sum_afterGroupByOnly(RHavingGroupBy,rLenHavingGroupBy,startPos,numGroup,R,&Rout,256,eM);
+			}break;
+		case AGG_MAX_AFTER_GROUP_BY:
+			{
+				CL_agg_max_afterGroupByOnly(RHavingGroupBy,rLenHavingGroupBy,startPos,numGroup,R,&Rout,256,eM);
+			}break;
+		case AGG_AVG_AFTER_GROUP_BY:
+			{
+				CL_agg_avg_afterGroupByOnly(RHavingGroupBy,rLenHavingGroupBy,startPos,numGroup,R,&Rout,256,eM);
+			}break;
+		case AGG_MIN_AFTER_GROUP_BY:
+			{
+				CL_agg_min_afterGroupByOnly(RHavingGroupBy,rLenHavingGroupBy,startPos,numGroup,R,&Rout,256,eM);
+			}break;
+		case AGG_COUNT_AFTER_GROUP_BY:
+			{
+				//numAgg records per group instead of one.
+				numAgg=CL_MultiAggAfterGroupByOnly(RHavingGroupBy,rLenHavingGroupBy,startPos,numGroup,R,aggMask,&Rout,256,eM);
+			}break;
+		default:
+			{
+				cout<<"not supported after a group by, "<<OpToString(optType,eM)<<endl;
+				exit(1);
+			}
+	}
+	numResult=numGroup*numAgg;
+}
 
-		//printf("AggAfterGroupByThreadOp::execute\n");
-//!!!!not ready yet!!
-	/*	
-	//	int* tempResult=new int[numGroup];
-		switch(optType)
-		{
-			
-			case AGG_SUM_AFTER_GROUP_BY:
-				{
-		
-			//		CL_agg_sum_afterGroupBy(RHavingGroupBy,rLenHavingGroupBy,startPos,numGroup,R,tempResult,256,eM);					
-				}break;
-			case AGG_MAX_AFTER_GROUP_BY:
-				{
-	//				CL_agg_max_afterGroupBy(RHavingGroupBy,rLenHavingGroupBy,startPos,numGroup,R,tempResult,256,eM);
-				}break;
-			case AGG_AVG_AFTER_GROUP_BY:
-				{
-//					CL_agg_avg_afterGroupBy(RHavingGroupBy,rLenHavingGroupBy,startPos,numGroup,R,tempResult,256,eM);
-				}break;
-			case AGG_MIN_AFTER_GROUP_BY:
-				{
-	//				CL_agg_min_afterGroupBy(RHavingGroupBy,rLenHavingGroupBy,startPos,numGroup,R,tempResult,256,eM);
-				}break;
-		}
-Rout=new Record[numGroup];
-		int i=0;
-		for(i=0;i<numGroup;i++)
+ThreadOp* AggAfterGroupByThreadOp::getNextOp(EXEC_MODE eM)
+{
+	this->execMode=eM;
+	isFinished=true;
+	return this;
+}
+
+
+/*
+* distinct.
+*/
+
+DistinctThreadOp::DistinctThreadOp(OP_MODE opt):
+SingularThreadOp(opt)
+{
+	numCol=0;
+}
+
+void DistinctThreadOp::init(cl_mem* p_cols, int p_numCol, int p_rLen)
+{
+	numCol=p_numCol;
+	for(int i=0;i<numCol;i++)
+		cols[i]=p_cols[i];
+	R=cols[0];
+	Query_rLen=p_rLen;
+}
+
+DistinctThreadOp::~DistinctThreadOp(void)
+{
+}
+
+void DistinctThreadOp::execute(EXEC_MODE eM)
+{
+	//the other columns go after each other in one buffer, the kernel reads a tuple by row.
+	cl_mem others=NULL;
+	int numOther=numCol-1;
+	if(numOther>0)
+	{
+		CL_CREATE(&others,sizeof(Record)*Query_rLen*numOther);
+		for(int i=1;i<numCol;i++)
 		{
-			Rout[i].rid=i;
-			Rout[i].value=tempResult[i];
+			CopyGPUToGPU(cols[i],0,others,sizeof(Record)*Query_rLen*(i-1),sizeof(Record)*Query_rLen);
+			CL_DESTORY(&cols[i]);
 		}
-		numResult=numGroup;
-		delete tempResult;
-		ON_GPU_DONE("AggAfterGroupByThreadOp::execute");
-		*/
-		//printf("AggAfterGroupByThreadOp::execute\n");
+	}
+	//Rout holds one record of R per distinct tuple, its rid leads to the other columns.
+	numResult=CL_DistinctOnly(R,Query_rLen,others,numOther,&Rout,256,64,eM);
+	if(others!=NULL)
+		CL_DESTORY(&others);
+	numCol=1;
 }
 
-ThreadOp* AggAfterGroupByThreadOp::getNextOp(EXEC_MODE eM)
+ThreadOp* DistinctThreadOp::getNextOp(EXEC_MODE eM)
 {
 	this->execMode=eM;
 	isFinished=true;
 	return this;
-}
\ No newline at end of file
+}
@@ -5,7 +5,7 @@ class GroupByThreadOp: public SingularThreadOp
 {
 public:
 	int numGroup;
-	int* startPos;
+	cl_mem startPos;//the first position of every group in Rout, it stays on the device for the aggregation.
 	GroupByThreadOp(OP_MODE opt);
 	void init(cl_mem p_R, int p_rLen);
 	~GroupByThreadOp(void);
@@ -27,3 +27,18 @@ public:
 	void execute(EXEC_MODE eM);
 	ThreadOp* getNextOp(EXEC_MODE eM);
 };
+
+
+//DISTINCT over columns of one table lined up by position, cols[0] is R.
+#define MAX_DISTINCT_COL (8)
+class DistinctThreadOp: public SingularThreadOp
+{
+public:
+	int numCol;
+	cl_mem cols[MAX_DISTINCT_COL];
+	DistinctThreadOp(OP_MODE opt);
+	void init(cl_mem* p_cols, int p_numCol, int p_rLen);
+	~DistinctThreadOp(void);
+	void execute(EXEC_MODE eM);
+	ThreadOp* getNextOp(EXEC_MODE eM);
+};
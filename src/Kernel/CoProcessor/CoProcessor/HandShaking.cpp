@@ -11,9 +11,11 @@ extern double Query_CPUBurden;
 extern double Query_GPUBurden;
 extern double Query_LothresholdForGPUApp;
 extern double Query_LothresholdForCPUApp;
-extern double Query_SpeedupGPUOverCPU[12];
-extern double RunInCPU[12];
-extern double RunInGPU[12];
+extern double Query_SpeedupGPUOverCPU[NUM_QUERY_TYPE];
+extern double RunInCPU[NUM_QUERY_TYPE];
+extern double RunInGPU[NUM_QUERY_TYPE];
+extern double RunOpInCPU[NUM_OP_MODE];
+extern double RunOpInGPU[NUM_OP_MODE];
 Record* Rin;
 Record* Rin2;
 Record* Rout;
@@ -70,4 +72,52 @@ void queryTest(QUERY_TYPE qt, EXEC_MODE CPU_GPU,int qid){
 	else{
 		RunInCPU[qt]=sum/counter*scale;
 	}
-}
\ No newline at end of file
+}
+//load RunInCPU/RunInGPU written by the query level handshaking, used to place
+//queries when the scheduling level is SCHEDULE_QUERY or SCHEDULE_HYBRID.
+void Query_readFromFile()
+{
+	FILE *ifp=fopen("QuerySpecification.list","r");
+	if(ifp==NULL)
+	{
+		fprintf(stderr,"\t QuerySpecification.list is not found, queries are placed round robin!\n");
+		return;
+	}
+	char line[256];
+	int qid;
+	double value;
+	while(fgets(line,sizeof(line),ifp)!=NULL)
+	{
+		if(sscanf(line,"RunInCPU %d is %lf",&qid,&value)==2 && qid>=0 && qid<NUM_QUERY_TYPE)
+			RunInCPU[qid]=value;
+		else if(sscanf(line,"RunInGPU %d is %lf",&qid,&value)==2 && qid>=0 && qid<NUM_QUERY_TYPE)
+			RunInGPU[qid]=value;
+		else if(strncmp(line,"Final decision",14)==0)
+			break;
+	}
+	fclose(ifp);
+}
+//load the per operator cost written by the operator level handshaking,
+//"oc <OP_MODE> <cost>" for the CPU and "og <OP_MODE> <cost>" for the GPU.
+void OP_readFromFile()
+{
+	FILE *ifp=fopen("OpeartorSpecification.list","r");
+	if(ifp==NULL)
+	{
+		fprintf(stderr,"\t OpeartorSpecification.list is not found, operators are weighted equally!\n");
+		return;
+	}
+	char line[256];
+	int oid;
+	double value;
+	while(fgets(line,sizeof(line),ifp)!=NULL)
+	{
+		if(sscanf(line,"oc %d %lf",&oid,&value)==2 && oid>=0 && oid<NUM_OP_MODE)
+			RunOpInCPU[oid]=value;
+		else if(sscanf(line,"og %d %lf",&oid,&value)==2 && oid>=0 && oid<NUM_OP_MODE)
+			RunOpInGPU[oid]=value;
+		else if(strncmp(line,"EN",2)==0)
+			break;
+	}
+	fclose(ifp);
+}
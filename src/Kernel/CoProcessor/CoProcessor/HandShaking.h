@@ -1 +1,3 @@
-void Query_handShaking();
\ No newline at end of file
+void Query_handShaking();
+void Query_readFromFile();
+void OP_readFromFile();
\ No newline at end of file
@@ -21,4 +21,22 @@ inline double endTimer(const char* info, clock_t t) {
     return elapsed;
 }
 
+// wall clock in seconds, the morsel workers time their device with it.
+#ifdef _WIN32
+#include <windows.h>
+inline double wallTime() {
+    LARGE_INTEGER freq, count;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&count);
+    return (double)count.QuadPart / (double)freq.QuadPart;
+}
+#else
+#include <sys/time.h>
+inline double wallTime() {
+    struct timeval t;
+    gettimeofday(&t, 0);
+    return t.tv_sec + t.tv_usec * 1e-6;
+}
+#endif
+
 #endif
@@ -0,0 +1,227 @@
+#include <string.h>
+#include "QueryPlanTree.h"
+#include "SingularThreadOp.h"
+#include "CoProcessor.h"
+#include "stdlib.h"
+#include "stdio.h"
+
+//morsel driven execution of a plan without pipeline breakers, SEL -> PRO* -> AGG.
+//fixed size morsels of the base columns flow through the whole chain: the records a
+//morsel selects are projected in place and folded into the aggregate, so no operator
+//output is materialized at full size. sorts, group bys and joins are pipeline breakers,
+//such plans still run operator by operator in execute().
+#define MORSEL_SIZE (1<<16)//records, 512KB, a multiple of any base address alignment.
+
+static bool isPipelineBreaker(QueryPlanNode* node)
+{
+	//group by aggregates, GROUP_BY, ORDER_BY and the joins follow AGG_COUNT in OP_MODE,
+	//AGG_COUNT itself has no kernel to fold with.
+	return node->optType>=AGG_COUNT;
+}
+
+static bool isFoldingAggregate(QueryPlanNode* node)
+{
+	return node->optType==TYPE_AGGREGATION && (strcmp(node->table2,"SUM")==0 || strcmp(node->table2,"AVG")==0
+		|| strcmp(node->table2,"MIN")==0 || strcmp(node->table2,"MAX")==0);
+}
+
+bool QueryPlanTree::isPipelined()
+{
+	int i;
+	if(totalNumNode<2)
+		return false;
+	QueryPlanNode* sel=nodeVec[0];
+	if(sel->optType!=SELECTION || sel->left!=NULL || sel->num_col<1 || sel->num_col>MAX_PREDICATE_COL)
+		return false;
+	//the morsels are windows on record columns.
+	if(sel->hasTypedColumn())
+		return false;
+	if(!sel->isRangeSelection())
+	{
+		int constants[MAX_PREDICATE_CONST];
+		int numConst=0;
+		char* shape=sel->predicateRoot->get_CL_predicate_string(constants,&numConst);
+		if(shape==NULL)
+			return false;
+		free(shape);
+	}
+	int ID0=planStatus->getTableID(sel->table1,sel->columns[0]);
+	for(i=1;i<totalNumNode;i++)
+	{
+		QueryPlanNode* node=nodeVec[i];
+		//a chain, every operator on the table of the selection.
+		if(node->left!=nodeVec[i-1] || node->right!=NULL || node->num_col<1 || isPipelineBreaker(node))
+			return false;
+		if(node->hasTypedColumn())
+			return false;
+		if(planStatus->getTableID(node->table1,node->columns[0])!=ID0)
+			return false;
+		if(node->optType==PROJECTION)
+			continue;
+		//the aggregate folds the morsels, it can only close the pipeline.
+		if(!isFoldingAggregate(node) || i!=totalNumNode-1)
+			return false;
+	}
+	return true;
+}
+
+//false if the predicate did not compile, nothing has run then.
+bool QueryPlanTree::executePipeline(EXEC_MODE eM)
+{
+	int i,k;
+	QueryPlanNode* sel=nodeVec[0];
+	QueryPlanNode* top=nodeVec[totalNumNode-1];
+	for(i=0;i<totalNumNode;i++)
+	{
+		if(nodeVec[i]->tOp==NULL)
+			nodeVec[i]->createOp();
+	}
+	int ID0=planStatus->getTableID(sel->table1,sel->columns[0]);
+
+	//the selection, as initOp sets it up.
+	int lowerKey=0, higherKey=0;
+	char* shape=NULL;
+	int constants[MAX_PREDICATE_CONST];
+	int numConst=0;
+	if(sel->isRangeSelection())
+	{
+		sel->getSelOprand(&lowerKey,&higherKey);
+		if(lowerKey==higherKey && !sel->hasDictColumn())
+		{
+			lowerKey = rand()%TEST_SMALL;
+			higherKey = lowerKey;
+		}
+	}
+	else
+	{
+		if(sel->predicateRoot->array==NULL)
+		{
+			sel->predicateRoot->orderConjuncts(TEST_MAX);
+			sel->predicateRoot->init();
+		}
+		shape=sel->predicateRoot->get_CL_predicate_string(constants,&numConst);
+	}
+
+	//the base columns are loaded once, the morsels are windows on them. a projection
+	//only replaces the values of the selected records, so only the column of the last
+	//operator has to be gathered.
+	cl_mem cols[MAX_PREDICATE_COL];
+	int rLen=0;
+	for(k=0;k<sel->num_col;k++)
+		rLen=planStatus->getBaseTable(ID0,sel->columns[k],&cols[k]);
+	cl_mem valCol=NULL;
+	if(strcmp(top->columns[0],sel->columns[0])!=0)
+		planStatus->getBaseTable(ID0,top->columns[0],&valCol);
+
+	bool isAgg=(top->tOp->optType>=AGG_SUM && top->tOp->optType<=AGG_AVG);
+	OP_MODE aggType=top->tOp->optType;
+	long long aggSum=0;
+	int aggValue=0;
+	int numResult=0;
+	vector<cl_mem> outMorsel;
+	vector<int> outLen;
+	bool compiled=true;
+	for(int start=0;start<rLen && compiled;start+=MORSEL_SIZE)
+	{
+		int len=(rLen-start<MORSEL_SIZE)?(rLen-start):MORSEL_SIZE;
+		cl_mem win[MAX_PREDICATE_COL];
+		for(k=0;k<sel->num_col;k++)
+			CL_SubBuffer(cols[k],start*sizeof(Record),len*sizeof(Record),&win[k]);
+		cl_mem Rcur=NULL;
+		int n=0;
+		if(shape==NULL)
+			n=CL_RangeSelectionOnly(win[0],len,lowerKey,higherKey,&Rcur,256,512,eM);
+		else
+			n=CL_PredicateSelectionOnly(win,sel->num_col,len,shape,constants,numConst,&Rcur,256,512,eM);
+		for(k=0;k<sel->num_col;k++)
+			CL_DESTORY(&win[k]);
+		if(n<0)
+		{
+			compiled=false;
+			break;
+		}
+		//the rids are base positions, the window does not shift them.
+		if(n>0 && valCol!=NULL)
+			CL_ProjectionOnly(valCol,rLen,Rcur,n,256,64,eM);
+		if(isAgg)
+		{
+			if(n>0)
+			{
+				cl_mem Rtmp=NULL;
+				Record h_partial;
+				if(aggType==AGG_MAX)
+					CL_AggMaxOnly(Rcur,n,&Rtmp,256,512,eM);
+				else if(aggType==AGG_MIN)
+					CL_AggMinOnly(Rcur,n,&Rtmp,256,512,eM);
+				else
+					CL_AggSumOnly(Rcur,n,&Rtmp,256,512,eM);
+				//the aggregate is left on the device in Rtmp[0].value.
+				CopyGPUToCPU(Rtmp,&h_partial,sizeof(Record));
+				int partial=h_partial.value;
+				if(aggType==AGG_MAX)
+					aggValue=(numResult==0 || partial>aggValue)?partial:aggValue;
+				else if(aggType==AGG_MIN)
+					aggValue=(numResult==0 || partial<aggValue)?partial:aggValue;
+				else
+					aggSum+=partial;
+				CL_DESTORY(&Rtmp);
+			}
+			CL_DESTORY(&Rcur);
+		}
+		else if(n>0)
+		{
+			//keep the matches only, the morsel output is sized for the whole window.
+			cl_mem compact=NULL;
+			CL_CREATE(&compact,sizeof(Record)*n);
+			CopyGPUToGPU(Rcur,0,compact,0,sizeof(Record)*n);
+			CL_DESTORY(&Rcur);
+			outMorsel.push_back(compact);
+			outLen.push_back(n);
+		}
+		else
+			CL_DESTORY(&Rcur);
+		numResult+=n;
+	}
+	for(k=0;k<sel->num_col;k++)
+		CL_DESTORY(&cols[k]);
+	if(valCol!=NULL)
+		CL_DESTORY(&valCol);
+	if(shape!=NULL)
+		free(shape);
+	if(!compiled)
+		return false;
+
+	ThreadOp* topOp=top->tOp;
+	if(isAgg)
+	{
+		Record result;
+		result.rid=0;
+		if(aggType==AGG_SUM)
+			result.value=(int)aggSum;
+		else if(aggType==AGG_AVG)
+			result.value=(numResult>0)?(int)(aggSum/numResult):0;
+		else
+			result.value=aggValue;
+		CL_CREATE(&topOp->Rout,sizeof(Record));
+		CopyCPUToGPU(topOp->Rout,&result,sizeof(Record));
+		topOp->numResult=1;
+	}
+	else
+	{
+		int offset=0;
+		CL_CREATE(&topOp->Rout,sizeof(Record)*(numResult>0?numResult:1));
+		for(i=0;i<(int)outMorsel.size();i++)
+		{
+			CopyGPUToGPU(outMorsel[i],0,topOp->Rout,offset*sizeof(Record),sizeof(Record)*outLen[i]);
+			offset+=outLen[i];
+			CL_DESTORY(&outMorsel[i]);
+		}
+		topOp->numResult=numResult;
+	}
+	for(i=0;i<totalNumNode;i++)
+		nodeVec[i]->nodeStatus=STATUS_DONE;
+	curActiveNode=totalNumNode-1;
+	q_Rout=topOp->Rout;
+	q_numResult=topOp->numResult;
+	return true;
+}
@@ -0,0 +1,325 @@
+#include <string.h>
+#include "QueryPlanTree.h"
+#include "CoProcessor.h"
+#include "stdlib.h"
+#include "stdio.h"
+
+//plan level scheduling (SCHEDULE_PLAN): the operators of a query are placed by HEFT.
+//an operator costs RunOpInCPU/RunOpInGPU, an edge costs the transfer of the child's
+//RID list when the two ends are on different devices. nodes are placed in the order
+//of their upward rank, each on the device it finishes earliest. independent branches
+//run on their own thread, and the output of a finished child is prefetched to the
+//device of its parent while the sibling branch is still running.
+//the branch threads are helpers started once and kept for the whole run: a join node
+//hands one branch to an idle helper and runs the other itself, with no idle helper
+//it runs both.
+extern double RunOpInCPU[NUM_OP_MODE];
+extern double RunOpInGPU[NUM_OP_MODE];
+extern int Query_rLen;
+
+#define PLAN_HELPER_THREADS 4
+
+struct tp_planBranch
+{
+	QueryPlanTree* tree;
+	int idx;
+	int level;
+	volatile bool done;
+};
+
+static tp_planBranch* helperQueue[PLAN_HELPER_THREADS];
+static int numQueued=0;
+static int numHelper=0;
+static int numIdleHelper=0;
+#ifdef _WIN32
+static SRWLOCK helperLock=SRWLOCK_INIT;
+static CONDITION_VARIABLE helperWake=CONDITION_VARIABLE_INIT;
+static CONDITION_VARIABLE helperDone=CONDITION_VARIABLE_INIT;
+#define HelperLock() AcquireSRWLockExclusive(&helperLock)
+#define HelperUnlock() ReleaseSRWLockExclusive(&helperLock)
+#define HelperWait(COND) SleepConditionVariableSRW(&(COND),&helperLock,INFINITE,0)
+#define HelperWakeAll(COND) WakeAllConditionVariable(&(COND))
+#else
+static pthread_mutex_t helperLock=PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t helperWake=PTHREAD_COND_INITIALIZER;
+static pthread_cond_t helperDone=PTHREAD_COND_INITIALIZER;
+#define HelperLock() pthread_mutex_lock(&helperLock)
+#define HelperUnlock() pthread_mutex_unlock(&helperLock)
+#define HelperWait(COND) pthread_cond_wait(&(COND),&helperLock)
+#define HelperWakeAll(COND) pthread_cond_broadcast(&(COND))
+#endif
+
+//the final operator type, before createOp resolves it.
+OP_MODE planOpType(QueryPlanNode* node, bool afterGroupBy)
+{
+	if(node->optType==TYPE_JOIN)
+		return node->getJoinType();
+	if(node->optType==TYPE_AGGREGATION)
+	{
+		if(strcmp(node->table2,"SUM")==0)
+			return afterGroupBy?AGG_SUM_AFTER_GROUP_BY:AGG_SUM;
+		else if(strcmp(node->table2,"AVG")==0)
+			return afterGroupBy?AGG_AVG_AFTER_GROUP_BY:AGG_AVG;
+		else if(strcmp(node->table2,"MIN")==0)
+			return afterGroupBy?AGG_MIN_AFTER_GROUP_BY:AGG_MIN;
+		else if(strcmp(node->table2,"MAX")==0)
+			return afterGroupBy?AGG_MAX_AFTER_GROUP_BY:AGG_MAX;
+		return afterGroupBy?AGG_COUNT_AFTER_GROUP_BY:AGG_COUNT;
+	}
+	return node->optType;
+}
+
+double planOpCost(OP_MODE optType, int CPU_GPU)
+{
+	double cost=CPU_GPU?RunOpInGPU[optType]:RunOpInCPU[optType];
+	if(cost<=0)//not calibrated, every operator weights the same.
+		cost=1;
+	return cost;
+}
+
+//move the RID list (or the bitmap) of a finished node towards the device of its parent.
+static void handOver(ExecStatus* status, int id, EXEC_MODE from, EXEC_MODE to)
+{
+	cl_mem RIDList=status->RID_baseTable[id];
+	if(RIDList!=NULL)
+	{
+		CL_TagResidence(RIDList,status->RIDLen[id]*sizeof(int),from);
+		CL_Prefetch(RIDList,to);
+	}
+	else if(status->RID_bitmap[id]!=NULL)
+	{
+		CL_TagResidence(status->RID_bitmap[id],((status->bitmapLen[id]+31)>>5)*sizeof(int),from);
+		CL_Prefetch(status->RID_bitmap[id],to);
+	}
+}
+
+#ifdef _WIN32
+DWORD WINAPI tp_planHelper( LPVOID lpParam )
+#else
+void* tp_planHelper( void* lpParam )
+#endif
+{
+	setHighPriority();
+	while(1)
+	{
+		HelperLock();
+		while(numQueued==0)
+			HelperWait(helperWake);
+		tp_planBranch* pData=helperQueue[--numQueued];
+		HelperUnlock();
+		//the scheduling level is kept per thread by the engine.
+		CL_SetScheduleLevel(pData->level);
+		pData->tree->runSubtree(pData->idx);
+		CL_SetScheduleLevel(SCHEDULE_DEFAULT);
+		HelperLock();
+		pData->done=true;
+		numIdleHelper++;
+		HelperWakeAll(helperDone);
+		HelperUnlock();
+	}
+#ifdef _WIN32
+	return 0;
+#else
+	return NULL;
+#endif
+}
+//false if every helper is busy, the caller runs the branch then.
+static bool postBranch(tp_planBranch* branch)
+{
+	HelperLock();
+	if(numIdleHelper==0 && numHelper<PLAN_HELPER_THREADS)
+	{
+#ifdef _WIN32
+		HANDLE h=CreateThread(NULL,0,tp_planHelper,NULL,0,NULL);
+		bool started=(h!=NULL);
+		if(started)
+			CloseHandle(h);
+#else
+		pthread_t h;
+		bool started=(pthread_create(&h,NULL,tp_planHelper,NULL)==0);
+		if(started)
+			pthread_detach(h);
+#endif
+		if(started)
+		{
+			numHelper++;
+			numIdleHelper++;
+		}
+	}
+	bool posted=(numIdleHelper>0);
+	if(posted)
+	{
+		numIdleHelper--;
+		branch->done=false;
+		helperQueue[numQueued++]=branch;
+		HelperWakeAll(helperWake);
+	}
+	HelperUnlock();
+	return posted;
+}
+static void waitBranch(tp_planBranch* branch)
+{
+	HelperLock();
+	while(!branch->done)
+		HelperWait(helperDone);
+	HelperUnlock();
+}
+
+int QueryPlanTree::nodeIndex(QueryPlanNode * node)
+{
+	int i=0;
+	if(node==NULL)
+		return -1;
+	for(i=0;i<totalNumNode;i++)
+	{
+		if(nodeVec[i]==node)
+			return i;
+	}
+	return -1;
+}
+
+void QueryPlanTree::placeDAG()
+{
+	int i,j,k,d;
+	int n=totalNumNode;
+	vector<double> cost[2];
+	vector<double> rank(n,0);
+	vector<double> finish(n,0);
+	vector<int> order(n,0);
+	cost[EXEC_CPU].assign(n,0);
+	cost[EXEC_GPU].assign(n,0);
+	nodeEM.assign(n,EXEC_CPU);
+	nodeParent.assign(n,-1);
+	nodeTables.assign(n,bitset<MAX_TABLE_PER_QUERY>());
+	nodeGroupBy.assign(n,false);
+	int edgeSize=Query_rLen*sizeof(int);
+	double comm=(CL_TransferBurden(EXEC_CPU,EXEC_GPU,edgeSize)+CL_TransferBurden(EXEC_GPU,EXEC_CPU,edgeSize))/2;
+	//nodeVec is in post order, children are visited before their parent.
+	for(i=0;i<n;i++)
+	{
+		QueryPlanNode* node=nodeVec[i];
+		int child[2]={nodeIndex(node->left),nodeIndex(node->right)};
+		//the table IDs are resolved here, so the branches only look them up later.
+		if(node->table1!=NULL && node->columns!=NULL)
+			nodeTables[i].set(planStatus->getTableID(node->table1,node->columns[0]));
+		if(node->optType==TYPE_JOIN && node->table2!=NULL)
+			nodeTables[i].set(planStatus->getTableID(node->table2,node->columns[1]));
+		for(j=0;j<2;j++)
+		{
+			if(child[j]<0)
+				continue;
+			nodeParent[child[j]]=i;
+			nodeTables[i]|=nodeTables[child[j]];
+			nodeGroupBy[i]=nodeGroupBy[i]||nodeGroupBy[child[j]];
+		}
+		OP_MODE optType=planOpType(node,nodeGroupBy[i]);
+		nodeGroupBy[i]=nodeGroupBy[i]||(node->optType==GROUP_BY);
+		for(d=EXEC_CPU;d<=EXEC_GPU;d++)
+			cost[d][i]=planOpCost(optType,d);
+	}
+	//upward rank, the root is the exit of the plan.
+	for(i=n-1;i>=0;i--)
+	{
+		rank[i]=(cost[EXEC_CPU][i]+cost[EXEC_GPU][i])/2;
+		if(nodeParent[i]>=0)
+			rank[i]+=comm+rank[nodeParent[i]];
+		//insertion by decreasing rank; a child always ranks above its parent.
+		for(k=n-1-i;k>0 && rank[order[k-1]]<rank[i];k--)
+			order[k]=order[k-1];
+		order[k]=i;
+	}
+	double avail[2]={0,0};
+	for(k=0;k<n;k++)
+	{
+		i=order[k];
+		QueryPlanNode* node=nodeVec[i];
+		int child[2]={nodeIndex(node->left),nodeIndex(node->right)};
+		double best=-1;
+		for(d=EXEC_CPU;d<=EXEC_GPU;d++)
+		{
+			double ready=avail[d];
+			for(j=0;j<2;j++)
+			{
+				if(child[j]<0)
+					continue;
+				double arrive=finish[child[j]]+CL_TransferBurden(nodeEM[child[j]],d,edgeSize);
+				if(arrive>ready)
+					ready=arrive;
+			}
+			if(best<0 || ready+cost[d][i]<best)
+			{
+				best=ready+cost[d][i];
+				nodeEM[i]=(EXEC_MODE)d;
+			}
+		}
+		finish[i]=best;
+		avail[nodeEM[i]]=best;
+	}
+}
+
+void QueryPlanTree::runSubtree(int idx)
+{
+	int j;
+	QueryPlanNode* node=nodeVec[idx];
+	int child[2]={nodeIndex(node->left),nodeIndex(node->right)};
+	EXEC_MODE eM=nodeEM[idx];
+	//branches sharing a table or a group by go through the same plan status entries.
+	if(child[0]>=0 && child[1]>=0 && (nodeTables[child[0]]&nodeTables[child[1]]).none()
+		&& !nodeGroupBy[child[0]] && !nodeGroupBy[child[1]])
+	{
+		tp_planBranch branch;
+		branch.tree=this;
+		branch.idx=child[0];
+		branch.level=CL_GetScheduleLevel();
+		bool posted=postBranch(&branch);
+		if(!posted)
+			runSubtree(child[0]);
+		runSubtree(child[1]);
+		if(posted)
+			waitBranch(&branch);
+	}
+	else
+	{
+		for(j=0;j<2;j++)
+		{
+			if(child[j]>=0)
+				runSubtree(child[j]);
+		}
+	}
+
+	ThreadOp* resultOp=node->getNextOp(eM);
+	while(resultOp!=NULL)
+	{
+		node->initOp(eM);
+		resultOp->execute(eM);
+		node->PostExecution(eM);
+		resultOp=node->getNextOp(eM);
+	}
+
+	int parent=nodeParent[idx];
+	if(parent<0 || nodeEM[parent]==eM)
+		return;
+	if(node->optType==SELECTION || node->optType==PROJECTION || node->optType==ORDER_BY || node->optType==TOP_K || node->optType==DISTINCT
+		|| node->optType==GROUP_BY)
+	{
+		handOver(planStatus,node->ID0,eM,nodeEM[parent]);
+	}
+	else if(node->optType>=JOIN_NINLJ && node->optType<=JOIN_HJ)
+	{
+		handOver(planStatus,node->ID0,eM,nodeEM[parent]);
+		handOver(planStatus,node->ID1,eM,nodeEM[parent]);
+	}
+}
+
+void QueryPlanTree::executeDAG()
+{
+	if(totalNumNode==0)
+		return;
+	placeDAG();
+	curActiveNode=totalNumNode-1;
+	runSubtree(curActiveNode);
+	//store the result;
+	QueryPlanNode* rootNode=nodeVec[curActiveNode];
+	q_Rout=rootNode->tOp->Rout;
+	q_numResult=rootNode->tOp->numResult;
+}
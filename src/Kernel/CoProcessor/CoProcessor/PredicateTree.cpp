@@ -2,10 +2,16 @@
 #include "string.h"
 #include "db.h"
 #include "stdlib.h"
+#include "stdio.h"
+#include <vector>
+#include <algorithm>
+using namespace std;
 
 PredicateTree::PredicateTree(void)
 {
-	
+	root = NULL;
+	CC_str = NULL;
+	array = NULL;
 }
 
 void PredicateTree::init()
@@ -128,6 +134,8 @@ int PredicateTree::construct_predicate_array(_PREDICATE_NODE* curNode,int index)
 		array[index].flag = PREDICATE_NOTBIG;
 	else if (strcmp(curNode->opt, "<>") == 0)
 		array[index].flag = PREDICATE_NOTEQUAL;
+	else if (strcmp(curNode->opt, "NOT") == 0)
+		array[index].flag = PREDICATE_NOT;
 	else if (curNode->opt[0] == '#')
 	{
 		array[index].flag = PREDICATE_COL;
@@ -145,6 +153,384 @@ int PredicateTree::construct_predicate_array(_PREDICATE_NODE* curNode,int index)
 
 
 
+char * PredicateTree::get_CL_predicate_string(int * constants, int * numConst)
+{
+	char * str = (char*)malloc(sizeof(char)*MAX_PREDICATE_STRING);
+	*numConst = 0;
+	int len = construct_CL_predicate_string(root, str, MAX_PREDICATE_STRING, constants, numConst);
+	if (len < 0)
+	{
+		free(str);
+		return NULL;
+	}
+	str[len] = '\0';
+	return str;
+}
+
+//returns -1 if the predicate has an operand the kernel cannot take, or if it
+//does not fit in size bytes with the terminating '\0'.
+int PredicateTree::construct_CL_predicate_string(_PREDICATE_NODE* curNode, char * str, int size, int * constants, int * numConst)
+{
+	int index = 0;
+	int len;
+	const char * opt = NULL;
+
+	if (curNode == NULL)
+		return -1;
+
+	if (curNode->left == NULL && curNode->right == NULL)
+	{
+		int t = getOperandType(curNode->opt);
+		if (t == OPT_COL && atoi(curNode->opt + 1) < MAX_PREDICATE_COL)
+			len = snprintf(str, size, "col%d[pos].y", atoi(curNode->opt + 1));
+		else if (t == OPT_NUM && *numConst < MAX_PREDICATE_CONST)
+		{
+			constants[*numConst] = atoi(curNode->opt);
+			len = snprintf(str, size, "c%d", *numConst);
+			(*numConst)++;
+		}
+		else
+			return -1;
+		return (len < 0 || len >= size) ? -1 : len;
+	}
+	if (strcmp(curNode->opt, "NOT") == 0)
+	{
+		if (size < 4)
+			return -1;
+		str[index++] = '!';
+		str[index++] = '(';
+		len = construct_CL_predicate_string(curNode->left, str + index, size - index - 1, constants, numConst);
+		if (len < 0)
+			return -1;
+		index += len;
+		str[index++] = ')';
+		return index;
+	}
+
+	if (strcmp(curNode->opt, "AND") == 0)
+		opt = "&&";
+	else if (strcmp(curNode->opt, "OR") == 0)
+		opt = "||";
+	else if (strcmp(curNode->opt, ">=") == 0)
+		opt = ">=";
+	else if (strcmp(curNode->opt, "<=") == 0)
+		opt = "<=";
+	else if (strcmp(curNode->opt, "<>") == 0)
+		opt = "!=";
+	else if (strcmp(curNode->opt, "=") == 0)
+		opt = "==";
+	else if (strcmp(curNode->opt, ">") == 0)
+		opt = ">";
+	else if (strcmp(curNode->opt, "<") == 0)
+		opt = "<";
+	else
+		return -1;
+
+	//the brackets and opt around the operands, and the '\0'.
+	int extra = 4 + (int)strlen(opt) + 1;
+	if (size < extra)
+		return -1;
+	str[index++] = '(';
+	len = construct_CL_predicate_string(curNode->left, str + index, size - extra + 1, constants, numConst);
+	if (len < 0)
+		return -1;
+	index += len;
+	str[index++] = ')';
+	strcpy(str + index, opt);
+	index += (int)strlen(opt);
+	str[index++] = '(';
+	len = construct_CL_predicate_string(curNode->right, str + index, size - index - 1, constants, numConst);
+	if (len < 0)
+		return -1;
+	index += len;
+	str[index++] = ')';
+	return index;
+}
+
+//walk the postfix array built by init().
+bool PredicateTree::evaluate(int * keys)
+{
+	int stack[MAX_PREDICATE_NODE];
+	int top = 0;
+	int i, a, b;
+
+	for (i = 0; array[i].flag != PREDICATE_END; i++)
+	{
+		if (array[i].flag == PREDICATE_COL)
+		{
+			stack[top++] = keys[array[i].val];
+			continue;
+		}
+		if (array[i].flag == PREDICATE_NUM)
+		{
+			stack[top++] = array[i].val;
+			continue;
+		}
+		if (array[i].flag == PREDICATE_NOT)
+		{
+			stack[top - 1] = !stack[top - 1];
+			continue;
+		}
+		b = stack[--top];
+		a = stack[--top];
+		switch (array[i].flag)
+		{
+		case PREDICATE_AND: stack[top++] = a && b; break;
+		case PREDICATE_OR: stack[top++] = a || b; break;
+		case PREDICATE_EQUAL: stack[top++] = a == b; break;
+		case PREDICATE_BIG: stack[top++] = a > b; break;
+		case PREDICATE_SMALL: stack[top++] = a < b; break;
+		case PREDICATE_NOTBIG: stack[top++] = a <= b; break;
+		case PREDICATE_NOTSMALL: stack[top++] = a >= b; break;
+		case PREDICATE_NOTEQUAL: stack[top++] = a != b; break;
+		default: stack[top++] = 0; break;
+		}
+	}
+	return top > 0 && stack[top - 1] != 0;
+}
+
+double PredicateTree::estimateSelectivity(_PREDICATE_NODE* curNode, double domain)
+{
+	double s, a, b;
+
+	if (curNode == NULL)
+		return 1;
+	if (strcmp(curNode->opt, "AND") == 0)
+		return estimateSelectivity(curNode->left, domain) * estimateSelectivity(curNode->right, domain);
+	if (strcmp(curNode->opt, "OR") == 0)
+	{
+		a = estimateSelectivity(curNode->left, domain);
+		b = estimateSelectivity(curNode->right, domain);
+		return a + b - a * b;
+	}
+	if (strcmp(curNode->opt, "NOT") == 0)
+		return 1 - estimateSelectivity(curNode->left, domain);
+	if (curNode->left == NULL || curNode->right == NULL)
+		return 1;
+	if (strcmp(curNode->opt, "=") == 0)
+		return 1 / domain;
+	if (strcmp(curNode->opt, "<>") == 0)
+		return 1 - 1 / domain;
+
+	char * col = NULL;
+	char * num = NULL;
+	COMP_TYPE cmp = getCompare(curNode, &col, &num);
+	if (cmp == CMP_OTHER)
+		return 0.5;//two columns, nothing is known.
+	s = atof(num) / domain;
+	if (cmp == CMP_BIGER)
+		s = 1 - s;
+	if (s < 0)
+		s = 0;
+	if (s > 1)
+		s = 1;
+	return s;
+}
+
+struct conjunct_rank
+{
+	_PREDICATE_NODE * node;
+	double sel;
+};
+
+static bool conjunct_less(const conjunct_rank& a, const conjunct_rank& b)
+{
+	return a.sel < b.sel;
+}
+
+//flatten an AND chain, its AND nodes are kept for the rebuild.
+static void collect_conjuncts(_PREDICATE_NODE* curNode, vector<_PREDICATE_NODE*>& conj, vector<_PREDICATE_NODE*>& ands)
+{
+	if (strcmp(curNode->opt, "AND") == 0)
+	{
+		ands.push_back(curNode);
+		collect_conjuncts(curNode->left, conj, ands);
+		collect_conjuncts(curNode->right, conj, ands);
+	}
+	else
+		conj.push_back(curNode);
+}
+
+void PredicateTree::orderConjuncts(double domain)
+{
+	root = order_conjuncts(root, domain);
+}
+
+_PREDICATE_NODE * PredicateTree::order_conjuncts(_PREDICATE_NODE* curNode, double domain)
+{
+	int i;
+
+	if (curNode == NULL)
+		return NULL;
+	if (strcmp(curNode->opt, "AND") != 0)
+	{
+		if (strcmp(curNode->opt, "OR") == 0 || strcmp(curNode->opt, "NOT") == 0)
+		{
+			curNode->left = order_conjuncts(curNode->left, domain);
+			curNode->right = order_conjuncts(curNode->right, domain);
+		}
+		return curNode;
+	}
+
+	vector<_PREDICATE_NODE*> conj;
+	vector<_PREDICATE_NODE*> ands;
+	collect_conjuncts(curNode, conj, ands);
+	vector<conjunct_rank> rank(conj.size());
+	for (i = 0; i < (int)conj.size(); i++)
+	{
+		rank[i].node = order_conjuncts(conj[i], domain);
+		rank[i].sel = estimateSelectivity(rank[i].node, domain);
+	}
+	stable_sort(rank.begin(), rank.end(), conjunct_less);
+	//left deep, && evaluates the left operand first and skips the rest.
+	_PREDICATE_NODE * result = rank[0].node;
+	for (i = 1; i < (int)rank.size(); i++)
+	{
+		ands[i - 1]->left = result;
+		ands[i - 1]->right = rank[i].node;
+		result = ands[i - 1];
+	}
+	return result;
+}
+
+static bool isStringLiteral(const char * str)
+{
+	int len = (int)strlen(str);
+	return len >= 2 && str[0] == '\'' && str[len - 1] == '\'';
+}
+
+static _PREDICATE_NODE * new_predicate_node(const char * opt, _PREDICATE_NODE * left, _PREDICATE_NODE * right)
+{
+	_PREDICATE_NODE * node = new _PREDICATE_NODE;
+	node->opt = new char [strlen(opt) + 1];
+	strcpy(node->opt, opt);
+	node->left = left;
+	node->right = right;
+	return node;
+}
+
+static void delete_predicate_node(_PREDICATE_NODE * node)
+{
+	if (node == NULL)
+		return;
+	delete_predicate_node(node->left);
+	delete_predicate_node(node->right);
+	delete [] node->opt;
+	delete node;
+}
+
+//col opt code, the code is a number operand.
+static _PREDICATE_NODE * new_code_compare(const char * opt, const char * col, int code)
+{
+	char num[16];
+	sprintf(num, "%d", code);
+	return new_predicate_node(opt, new_predicate_node(col, NULL, NULL), new_predicate_node(num, NULL, NULL));
+}
+
+void PredicateTree::rewriteOnDictionary(Dictionary ** dicts, int num_col)
+{
+	root = rewrite_dictionary(root, dicts, num_col);
+}
+
+//the comparison of a string with a dictionary column as a comparison of codes, the
+//replaced node is deleted.
+_PREDICATE_NODE * PredicateTree::rewrite_dictionary(_PREDICATE_NODE* curNode, Dictionary ** dicts, int num_col)
+{
+	_PREDICATE_NODE * codeNode = rewrite_on_codes(curNode, dicts, num_col);
+	if (codeNode != curNode)
+		delete_predicate_node(curNode);
+	return codeNode;
+}
+
+_PREDICATE_NODE * PredicateTree::rewrite_on_codes(_PREDICATE_NODE* curNode, Dictionary ** dicts, int num_col)
+{
+	if (curNode == NULL || curNode->left == NULL)
+		return curNode;
+	if (strcmp(curNode->opt, "AND") == 0 || strcmp(curNode->opt, "OR") == 0 || strcmp(curNode->opt, "NOT") == 0)
+	{
+		curNode->left = rewrite_dictionary(curNode->left, dicts, num_col);
+		curNode->right = rewrite_dictionary(curNode->right, dicts, num_col);
+		return curNode;
+	}
+	if (curNode->right == NULL)
+		return curNode;
+	//the column on the left, 'x' < col is col > 'x'.
+	_PREDICATE_NODE * colNode = curNode->left;
+	_PREDICATE_NODE * strNode = curNode->right;
+	const char * opt = curNode->opt;
+	if (getOperandType(colNode->opt) != OPT_COL)
+	{
+		colNode = curNode->right;
+		strNode = curNode->left;
+		if (strcmp(opt, "<") == 0)
+			opt = ">";
+		else if (strcmp(opt, ">") == 0)
+			opt = "<";
+		else if (strcmp(opt, "<=") == 0)
+			opt = ">=";
+		else if (strcmp(opt, ">=") == 0)
+			opt = "<=";
+	}
+	if (getOperandType(colNode->opt) != OPT_COL || !isStringLiteral(strNode->opt))
+		return curNode;
+	int k = atoi(colNode->opt + 1);
+	Dictionary * dict = (k < num_col) ? dicts[k] : NULL;
+	if (dict == NULL)
+	{
+		printf("%s is compared with a column without dictionary\n", strNode->opt);
+		return curNode;
+	}
+	char str[MAX_PREDICATE_STRING];
+	int len = (int)strlen(strNode->opt) - 2;
+	if (len > MAX_PREDICATE_STRING - 1)
+		len = MAX_PREDICATE_STRING - 1;
+	strncpy(str, strNode->opt + 1, len);
+	str[len] = '\0';
+
+	//the matching codes are [lo, hi), numValue is a code no value has.
+	int lo = 0;
+	int hi = dict->numValue;
+	if (strcmp(opt, "=") == 0 || strcmp(opt, "<>") == 0)
+	{
+		lo = dict->find(str);
+		if (lo < 0)
+			lo = dict->numValue;
+		if (strcmp(opt, "<>") == 0)
+			return new_code_compare("<>", colNode->opt, lo);
+		hi = lo + 1;
+	}
+	else if (strcmp(opt, "<") == 0)
+		hi = dict->lowerBound(str);
+	else if (strcmp(opt, "<=") == 0)
+		hi = dict->upperBound(str);
+	else if (strcmp(opt, ">") == 0)
+		lo = dict->upperBound(str);
+	else if (strcmp(opt, ">=") == 0)
+		lo = dict->lowerBound(str);
+	else if (strcmp(opt, "LIKE") == 0 && len > 0 && str[len - 1] == '%' && strchr(str, '%') == str + len - 1)
+	{
+		str[len - 1] = '\0';
+		lo = dict->lowerBound(str);
+		hi = dict->prefixEnd(str);
+	}
+	else
+	{
+		printf("%s %s is not supported on a dictionary column\n", curNode->opt, strNode->opt);
+		return curNode;
+	}
+
+	//inclusive bounds, the range selection takes them as they are.
+	if (lo >= hi)
+		return new_code_compare("=", colNode->opt, dict->numValue);
+	if (hi - lo == 1)
+		return new_code_compare("=", colNode->opt, lo);
+	if (lo == 0)
+		return new_code_compare("<=", colNode->opt, hi - 1);
+	if (hi == dict->numValue)
+		return new_code_compare(">=", colNode->opt, lo);
+	return new_predicate_node("AND", new_code_compare(">=", colNode->opt, lo), new_code_compare("<=", colNode->opt, hi - 1));
+}
+
 COMP_TYPE getCompare(_PREDICATE_NODE * node, char ** col, char ** num)
 {
 	char * str = node->opt;
@@ -3,6 +3,7 @@
 #pragma once
 
 #include "db.h"
+#include "Dictionary.h"
 
 #define PREDICATE_END -1
 #define PREDICATE_UNKNOWN 0
@@ -16,6 +17,12 @@
 #define PREDICATE_NOTBIG 8
 #define PREDICATE_NOTSMALL 9
 #define PREDICATE_NOTEQUAL 10
+#define PREDICATE_NOT 11
+
+//constants of one predicate passed to a generated kernel.
+#define MAX_PREDICATE_CONST 16
+//columns of one table a selection can test in a single pass.
+#define MAX_PREDICATE_COL 8
 
 
 
@@ -52,8 +59,24 @@ public:
 	int construct_CC_predicate_string(_PREDICATE_NODE* curNode,char * str);
 
 	int construct_predicate_array(_PREDICATE_NODE* curNode,int index);
+	//OpenCL C of the predicate, column #i becomes col<i>[pos].y and numbers become
+	//c0,c1,... so that the string only depends on the shape of the predicate.
+	char * get_CL_predicate_string(int * constants, int * numConst);
+	int construct_CL_predicate_string(_PREDICATE_NODE* curNode, char * str, int size, int * constants, int * numConst);
+	//the same predicate evaluated on the host, keys[i] is the value of column #i.
+	bool evaluate(int * keys);
+	//fraction of the tuples passing curNode, assuming uniform keys in [0,domain).
+	double estimateSelectivity(_PREDICATE_NODE* curNode, double domain);
+	//reorder every AND chain so that the most selective conjunct is tested first.
+	void orderConjuncts(double domain);
+	_PREDICATE_NODE * order_conjuncts(_PREDICATE_NODE* curNode, double domain);
 //	PREDICATE_NODE * construct_predicate_tree(char * str);
 	_PREDICATE_NODE * construct_predicate_tree(char * str, int * index, int num_col, char **columns);
+	//comparisons and LIKE 'prefix%' of a column with a quoted string become code ranges,
+	//dicts[i] is the dictionary of column #i or NULL.
+	void rewriteOnDictionary(Dictionary ** dicts, int num_col);
+	_PREDICATE_NODE * rewrite_dictionary(_PREDICATE_NODE* curNode, Dictionary ** dicts, int num_col);
+	_PREDICATE_NODE * rewrite_on_codes(_PREDICATE_NODE* curNode, Dictionary ** dicts, int num_col);
 	void init();
 	
 };
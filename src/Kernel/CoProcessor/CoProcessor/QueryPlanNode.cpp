@@ -46,6 +46,12 @@ void QueryPlanNode::initialNode(char * str, ExecStatus *status)
 		optType = ORDER_BY;
 	else if (strcmp(str, "GRP") == 0)
 		optType = GROUP_BY;
+	else if (strcmp(str, "TOP") == 0)
+		optType = TOP_K;
+	else if (strcmp(str, "DIS") == 0)
+		optType = DISTINCT;
+	else if (strcmp(str, "APX") == 0)
+		optType = APPROX_AGG;
 
 	i = j + 1;
 
@@ -84,6 +90,15 @@ void QueryPlanNode::initialNode(char * str, ExecStatus *status)
 	k = 0;
 	predicateRoot = new PredicateTree();
 	predicateRoot->root=predicateRoot->construct_predicate_tree(str + i, &k,num_col,columns);	
+	//strings compared with dictionary columns become code ranges, once, here.
+	if(easedb!=NULL && hasDictColumn())
+	{
+		Dictionary** dicts=(Dictionary**)malloc(sizeof(Dictionary*)*num_col);
+		for(k=0;k<num_col;k++)
+			dicts[k]=easedb->getDictionary(columns[k]);
+		predicateRoot->rewriteOnDictionary(dicts,num_col);
+		free(dicts);
+	}
 	//check the detail type.
 	//1. aggregtion, type is in table2.
 	
@@ -104,6 +119,7 @@ QueryPlanNode::QueryPlanNode()
 	table2 = NULL;
 	columns = NULL;
 	num_col = 0;
+	isRoot = false;
 }
 
 QueryPlanNode::~QueryPlanNode()
@@ -120,9 +136,108 @@ void QueryPlanNode::execute(int nodeLevel)
 	//cout<<"level: "<<nodeLevel<<", "<<OpToString(this->optType)<<endl;
 }
 
+//the bounds of a range selection on a typed column, parsed in the type of the column.
+static typed_value parseTypedValue(char* num, int colType)
+{
+	typed_value v;
+	v.i64=0;
+	if(num==NULL)
+		return v;
+	if(colType==COL_INT64)
+		v.i64=strtoll(num,NULL,10);
+	else if(colType==COL_FLOAT32)
+		v.f32=(float)strtod(num,NULL);
+	else if(colType==COL_FLOAT64)
+		v.f64=strtod(num,NULL);
+	else
+		v.i32=atoi(num);
+	return v;
+}
+
+//true if an operand is a typed column, the node then runs on the typed kernels.
+bool QueryPlanNode::hasTypedColumn()
+{
+	for(int k=0;k<num_col;k++)
+	{
+		if(easedb->getColumnType(columns[k])!=COL_INT32)
+			return true;
+	}
+	return false;
+}
+
+//true if an operand is a dictionary column, its values are codes.
+bool QueryPlanNode::hasDictColumn()
+{
+	for(int k=0;k<num_col;k++)
+	{
+		if(easedb->getDictionary(columns[k])!=NULL)
+			return true;
+	}
+	return false;
+}
+
+//the MULTI_AGG_* bits of an aggregation, table2 is a list like SUM|MIN|MAX|COUNT.
+int QueryPlanNode::getAggMask()
+{
+	const char* names[MULTI_AGG_NUM]={"COUNT","SUM","MIN","MAX","AVG"};
+	int mask=0;
+	char* list=(char*)malloc(strlen(table2)+1);
+	strcpy(list,table2);
+	for(char* name=strtok(list,"|");name!=NULL;name=strtok(NULL,"|"))
+	{
+		int bit=0;
+		while(bit<MULTI_AGG_NUM && strcmp(name,names[bit])!=0)
+			bit++;
+		if(bit==MULTI_AGG_NUM)
+		{
+			cout<<"unknown aggregate, "<<name<<endl;
+			exit(1);
+		}
+		mask|=(1<<bit);
+	}
+	free(list);
+	return mask;
+}
+
+//the column is compressed and the plan has not cut its table down to a RID list,
+//so the op can read the packed words of the whole column.
+bool QueryPlanNode::readsPackedBase(EXEC_MODE eM)
+{
+	if(num_col!=1 || easedb->getCompressedColumn(columns[0])==NULL)
+		return false;
+	ID0=planStatus->getTableID(table1,columns[0]);
+	return planStatus->peekRIDList(ID0,eM)==NULL;
+}
+
 void QueryPlanNode::createOp()
 {
-	if(optType==TYPE_AGGREGATION)
+	if((optType==ORDER_BY || optType==GROUP_BY || optType==TOP_K || optType==DISTINCT || optType==APPROX_AGG) && hasTypedColumn())
+	{
+		cout<<"ORDER BY, TOP, GROUP BY, DISTINCT and APX on a typed column are not supported, "<<columns[0]<<endl;
+		exit(1);
+	}
+	//COUNT, or more than one aggregate, is the fused aggregate: one pass for all of them.
+	if(optType==TYPE_AGGREGATION && strcmp(table2,"SUM")!=0 && strcmp(table2,"AVG")!=0
+		&& strcmp(table2,"MIN")!=0 && strcmp(table2,"MAX")!=0)
+	{
+		if(hasTypedColumn())
+		{
+			cout<<"COUNT and several aggregates are on record columns only, "<<columns[0]<<endl;
+			exit(1);
+		}
+		if(planStatus->hasGroupBy==false)
+		{
+			optType=AGG_COUNT;
+			tOp=new SingularThreadOp(optType);
+		}
+		else
+		{
+			optType=AGG_COUNT_AFTER_GROUP_BY;
+			tOp=new AggAfterGroupByThreadOp(optType);
+		}
+		((SingularThreadOp*)tOp)->aggMask=getAggMask();
+	}
+	else if(optType==TYPE_AGGREGATION)
 	{
 		if(planStatus->hasGroupBy==false)
 		{
@@ -158,6 +273,15 @@ void QueryPlanNode::createOp()
 		Record* Sin=NULL;
 		int sLen=0;
 		optType=getJoinType();
+		//codes are only comparable within one dictionary.
+		if(num_col>=2 && easedb->getDictionary(columns[0])!=easedb->getDictionary(columns[1]))
+		{
+			cout<<"a join of string columns needs a shared dictionary, "<<columns[0]<<", "<<columns[1]<<endl;
+			exit(1);
+		}
+		//the typed keys have their own hash join only.
+		if(hasTypedColumn())
+			optType=JOIN_HJ;
 		if(optType==JOIN_INLJ)
 		{
 			tOp=new IndexJoinThreadOp(optType);
@@ -171,6 +295,14 @@ void QueryPlanNode::createOp()
 	{
 		tOp=new SortThreadOp(optType);
 	}
+	else if(optType==TOP_K)
+	{
+		//table2 is "k", the k largest, or "k|ASC", the k smallest.
+		SortThreadOp* sortOp=new SortThreadOp(optType);
+		sortOp->topK=atoi(table2);
+		sortOp->largest=(strstr(table2,"|ASC")==NULL);
+		tOp=sortOp;
+	}
 	else if(optType==PROJECTION)
 	{
 		tOp=new ProjectionOp(optType);
@@ -179,6 +311,17 @@ void QueryPlanNode::createOp()
 	{
 		tOp=new GroupByThreadOp(optType);		
 	}
+	else if(optType==DISTINCT)
+	{
+		tOp=new DistinctThreadOp(optType);
+	}
+	else if(optType==APPROX_AGG)
+	{
+		//table2 is the aggregate and its error bound, "NDV@0.02" or "P50|P99@0.01".
+		ApproxAggOp* apxOp=new ApproxAggOp(optType);
+		apxOp->parse(table2);
+		tOp=apxOp;
+	}
 }
 
 
@@ -186,7 +329,25 @@ void QueryPlanNode::initOp(EXEC_MODE eM)
 {
 	cl_mem Rin=NULL;
 	int Query_rLen=0;
-	if(optType>=AGG_SUM && optType<=AGG_COUNT)
+	if(optType==AGG_COUNT)
+	{
+		ID0=planStatus->getTableID(table1,columns[0]);
+		Query_rLen=planStatus->getDataTable(ID0,columns[0],&Rin,eM);
+		((SingularThreadOp*)tOp)->init(Rin,Query_rLen);
+	}
+	else if(optType>=AGG_SUM && optType<=AGG_COUNT && hasTypedColumn())
+	{
+		ID0=planStatus->getTableID(table1,columns[0]);
+		Query_rLen=planStatus->getTypedData(ID0,columns[0],&Rin,eM);
+		((SingularThreadOp*)tOp)->initTyped(Rin,Query_rLen,easedb->getColumnType(columns[0]));
+	}
+	else if(optType>=AGG_SUM && optType<=AGG_COUNT && readsPackedBase(eM))
+	{
+		PackedColumn col;
+		easedb->getPackedTable(columns[0],&col);
+		((SingularThreadOp*)tOp)->initPacked(col);
+	}
+	else if(optType>=AGG_SUM && optType<=AGG_COUNT)
 	{
 		ID0=planStatus->getTableID(table1,columns[0]);
 		Query_rLen=planStatus->getDataTable(ID0,columns[0],&Rin,eM);
@@ -194,24 +355,92 @@ void QueryPlanNode::initOp(EXEC_MODE eM)
 	}
 	else if(optType>=AGG_SUM_AFTER_GROUP_BY && optType<=AGG_MIN_AFTER_GROUP_BY)
 	{
-		//ID0=planStatus->getTableID(table1,columns[0]);
-		//Query_rLen=planStatus->getDataTable(ID0,columns[0],&Rin,eM);
-		//((AggAfterGroupByThreadOp*)tOp)->init(Rin,Query_rLen,
-			//planStatus->groupByRelation,planStatus->groupByRlen, planStatus->groupByNumGroup, planStatus->groupByStartPos);
+		//the grouped relation keeps the rids of the table, the aggregated column is gathered from the base table.
+		ID0=planStatus->getTableID(table1,columns[0]);
+		Query_rLen=planStatus->getBaseTable(ID0,columns[0],&Rin);
+		((AggAfterGroupByThreadOp*)tOp)->init(Rin,Query_rLen,
+			planStatus->groupByRelation,planStatus->groupByRlen, planStatus->groupByNumGroup, planStatus->groupByStartPos);
+	}
+	else if(optType==SELECTION && hasTypedColumn())
+	{
+		if(!isRangeSelection())
+		{
+			cout<<"only range selections are supported on a typed column, "<<columns[0]<<endl;
+			exit(1);
+		}
+		int colType=easedb->getColumnType(columns[0]);
+		char *lowerNum=NULL, *higherNum=NULL;
+		getSelOprand(&lowerNum,&higherNum);
+		ID0=planStatus->getTableID(table1,columns[0]);
+		bool toBitmap=!isRoot && planStatus->canAddBitmap(ID0);
+		cl_mem RIDList=NULL;
+		if(toBitmap)
+			Query_rLen=planStatus->getTypedBaseTable(ID0,columns[0],&Rin,eM);
+		else
+		{
+			Query_rLen=planStatus->getTypedData(ID0,columns[0],&Rin,eM);
+			RIDList=planStatus->peekRIDList(ID0,eM);
+		}
+		((SelectionOp*)tOp)->initTyped(Rin,Query_rLen,colType,parseTypedValue(lowerNum,colType),
+			parseTypedValue(higherNum,colType),RIDList);
+		((SelectionOp*)tOp)->toBitmap=toBitmap;
+	}
+	else if(optType==SELECTION && !isRangeSelection())
+	{
+		//any other predicate runs as one generated kernel. the columns of table1 are
+		//gathered by the same RID list, so they line up and one pass tests them all.
+		assert(num_col>=1 && num_col<=MAX_PREDICATE_COL);
+		if(predicateRoot->array==NULL)
+		{
+			predicateRoot->orderConjuncts(TEST_MAX);
+			predicateRoot->init();
+		}
+		cl_mem cols[MAX_PREDICATE_COL];
+		ID0=planStatus->getTableID(table1,columns[0]);
+		//below the root, the result stays a bitmap over the base table.
+		bool toBitmap=!isRoot && planStatus->canAddBitmap(ID0);
+		for(int k=0;k<num_col;k++)
+		{
+			if(toBitmap)
+				Query_rLen=planStatus->getBaseTable(ID0,columns[k],&cols[k]);
+			else
+				Query_rLen=planStatus->getDataTable(ID0,columns[k],&cols[k],eM);
+		}
+		((SelectionOp*)tOp)->init(cols,num_col,Query_rLen,predicateRoot);
+		((SelectionOp*)tOp)->toBitmap=toBitmap;
 	}
 	else if(optType==SELECTION)//we need to get the matching key values.
 	{
 		int lowerKey=0, higherKey=0;
 		getSelOprand(&lowerKey,&higherKey);
-		if(lowerKey==higherKey)//doing point selection, very dangerous!!, modify a little bit.
+		//a code is what the dictionary says it is.
+		if(lowerKey==higherKey && !hasDictColumn())//doing point selection, very dangerous!!, modify a little bit.
 		{
 			lowerKey = rand()%TEST_SMALL;
 			higherKey = lowerKey;
 		}
 		assert(num_col==1);		
 		ID0=planStatus->getTableID(table1,columns[0]);
-		Query_rLen=planStatus->getDataTable(ID0,columns[0],&Rin,eM);
-		((SelectionOp*)tOp)->init(Rin,Query_rLen,lowerKey,higherKey);
+		bool toBitmap=!isRoot && planStatus->canAddBitmap(ID0);
+		CompressedColumn* packed=easedb->getCompressedColumn(columns[0]);
+		if(packed!=NULL && (toBitmap || readsPackedBase(eM)))
+		{
+			//the bounds become codes once, the kernel never decodes a value.
+			PackedColumn col;
+			int codeLow=0, codeHigh=0;
+			packed->codeRange(lowerKey,higherKey,&codeLow,&codeHigh);
+			easedb->getPackedTable(columns[0],&col);
+			((SelectionOp*)tOp)->initPacked(col,codeLow,codeHigh);
+		}
+		else
+		{
+			if(toBitmap)
+				Query_rLen=planStatus->getBaseTable(ID0,columns[0],&Rin);
+			else
+				Query_rLen=planStatus->getDataTable(ID0,columns[0],&Rin,eM);
+			((SelectionOp*)tOp)->init(Rin,Query_rLen,lowerKey,higherKey);
+		}
+		((SelectionOp*)tOp)->toBitmap=toBitmap;
 	}
 	else if(optType>=JOIN_NINLJ && optType<=JOIN_HJ)
 	{
@@ -241,6 +470,15 @@ void QueryPlanNode::initOp(EXEC_MODE eM)
 			CL_RadixSortOnly( Sin,Query_rLen,256,64,eM);
 			//GPUDEBUG_Record(Sin,sLen);
 			((BinaryThreadOp*)tOp)->init(Rin,Query_rLen,Sin,sLen);
+		}else if(hasTypedColumn()){
+			int colType=easedb->getColumnType(columns[0]);
+			assert(colType==easedb->getColumnType(columns[1]));
+			ID0=planStatus->getTableID(table1,columns[0]);
+			Query_rLen=planStatus->getTypedData(ID0,columns[0],&Rin,eM);
+			ID1=planStatus->getTableID(table2,columns[1]);
+			sLen=planStatus->getTypedData(ID1,columns[1],&Sin,eM);
+			((BinaryThreadOp*)tOp)->initTyped(Rin,Query_rLen,planStatus->peekRIDList(ID0,eM),
+				Sin,sLen,planStatus->peekRIDList(ID1,eM),colType);
 		}else{
 			ID0=planStatus->getTableID(table1,columns[0]);
 			Query_rLen=planStatus->getDataTable(ID0,columns[0],&Rin,eM);			
@@ -249,12 +487,35 @@ void QueryPlanNode::initOp(EXEC_MODE eM)
 			((BinaryThreadOp*)tOp)->init(Rin,Query_rLen,Sin,sLen);
 		}
 	}
-	else if(optType==ORDER_BY)
+	else if(optType==ORDER_BY || optType==TOP_K)
 	{
 		ID0=planStatus->getTableID(table1,columns[0]);
 		Query_rLen=planStatus->getDataTable(ID0,columns[0],&Rin,eM);
 		((SortThreadOp*)tOp)->init(Rin,Query_rLen);
 	}
+	else if(optType==APPROX_AGG)
+	{
+		ID0=planStatus->getTableID(table1,columns[0]);
+		Query_rLen=planStatus->getDataTable(ID0,columns[0],&Rin,eM);
+		((ApproxAggOp*)tOp)->init(Rin,Query_rLen);
+	}
+	else if(optType==PROJECTION && hasTypedColumn())
+	{
+		ID0=planStatus->getTableID(table1,columns[0]);
+		Query_rLen=planStatus->getTypedBaseTable(ID0,columns[0],&Rin,eM);
+		cl_mem RIDList=planStatus->peekRIDList(ID0,eM);
+		int RIDLen=(RIDList==NULL)?Query_rLen:planStatus->RIDLen[ID0];
+		((ProjectionOp*)tOp)->initTyped(Rin,Query_rLen,easedb->getColumnType(columns[0]),RIDList,RIDLen);
+	}
+	else if(optType==PROJECTION && easedb->getCompressedColumn(columns[0])!=NULL)
+	{
+		ID0=planStatus->getTableID(table1,columns[0]);
+		PackedColumn col;
+		easedb->getPackedTable(columns[0],&col);
+		cl_mem RIDList=planStatus->peekRIDList(ID0,eM);
+		int RIDLen=(RIDList==NULL)?col.rLen:planStatus->RIDLen[ID0];
+		((ProjectionOp*)tOp)->initPacked(col,RIDList,RIDLen);
+	}
 	else if(optType==PROJECTION)
 	{
 		ID0=planStatus->getTableID(table1,columns[0]);
@@ -270,6 +531,16 @@ void QueryPlanNode::initOp(EXEC_MODE eM)
 		Query_rLen=planStatus->getDataTable(ID0,columns[0],&Rin,eM);
 		((GroupByThreadOp*)tOp)->init(Rin,Query_rLen);		
 	}
+	else if(optType==DISTINCT)
+	{
+		//the columns of table1 are gathered by the same RID list, so they line up.
+		assert(num_col>=1 && num_col<=MAX_DISTINCT_COL);
+		cl_mem cols[MAX_DISTINCT_COL];
+		ID0=planStatus->getTableID(table1,columns[0]);
+		for(int k=0;k<num_col;k++)
+			Query_rLen=planStatus->getDataTable(ID0,columns[k],&cols[k],eM);
+		((DistinctThreadOp*)tOp)->init(cols,num_col,Query_rLen);
+	}
 }
 
 
@@ -278,6 +549,8 @@ void QueryPlanNode::PostExecution(EXEC_MODE eM)
 	cl_mem Rin=NULL;
 	int Query_rLen=0;
 	DATA_RESIDENCE dataStore=DATA_ON_CPU;
+	//the output stays where its last kernel wrote it.
+	CL_TagOutput(tOp->Rout,0);
 	if(optType==TYPE_AGGREGATION)
 	{
 		cout<<"post execution is not required for"<<OpToString(optType,EXEC_CPU)<<endl;
@@ -285,18 +558,32 @@ void QueryPlanNode::PostExecution(EXEC_MODE eM)
 	else if(optType==SELECTION)//we need to get the matching key values.
 	{		
 		//Kernel_bufferchecking(tOp->Rout,tOp->numResult);
-		planStatus->addDataTable(ID0,tOp->Rout,tOp->numResult,dataStore,eM);
+		SelectionOp* selOp=(SelectionOp*)tOp;
+		if(selOp->toBitmap)
+			planStatus->addBitmap(ID0,selOp->bitmap,selOp->Query_rLen,eM);
+		else if(selOp->isTyped)
+		{
+			//Rout is already a RID list, it stays the result of the op.
+			cl_mem RIDList=NULL;
+			CL_CREATE(&RIDList,sizeof(int)*(tOp->numResult>0?tOp->numResult:1));
+			if(tOp->numResult>0)
+				CopyGPUToGPU(tOp->Rout,RIDList,sizeof(int)*tOp->numResult);
+			planStatus->addRIDList(ID0,RIDList,tOp->numResult,dataStore);
+		}
+		else
+			planStatus->addDataTable(ID0,tOp->Rout,tOp->numResult,dataStore,eM);
 	}
 	else if(optType==JOIN_NINLJ||optType==JOIN_INLJ||optType==JOIN_SMJ||optType==JOIN_HJ)
 	{
 		planStatus->addJoinTable(ID0,ID1,tOp->Rout,tOp->numResult,eM);
 	}
-	else if(optType==ORDER_BY)
+	else if(optType==ORDER_BY || optType==TOP_K || optType==DISTINCT)
 	{
 		planStatus->addDataTable(ID0,tOp->Rout,tOp->numResult,dataStore,eM);
 	}
-	else if(optType==PROJECTION)
+	else if(optType==PROJECTION && !tOp->isTyped)
 	{
+		//a typed projection keeps the RID list as it is.
 		planStatus->addDataTable(ID0,tOp->Rout,tOp->numResult,dataStore,eM);
 	}
 	else if(optType==GROUP_BY)
@@ -327,6 +614,18 @@ ThreadOp* QueryPlanNode::getNextOp(EXEC_MODE eM)
 
 //currently we only support range query [] and point query.
 void QueryPlanNode::getSelOprand(int* lowerKey, int* higherKey)
+{
+	char *lowerNum=NULL, *higherNum=NULL;
+	getSelOprand(&lowerNum,&higherNum);
+	if(lowerNum!=NULL)
+	{
+		*lowerKey=atoi(lowerNum);
+		*higherKey=atoi(higherNum);
+	}
+}
+
+//the bounds as they are written, NULL if the predicate is not a range.
+void QueryPlanNode::getSelOprand(char** lowerNum, char** higherNum)
 {
 	COMP_TYPE t1, t2;
 	int leftopt;
@@ -340,7 +639,7 @@ void QueryPlanNode::getSelOprand(int* lowerKey, int* higherKey)
 		{
 			char *col, *num;
 			t1=getCompare(predicateRoot->root,&col,&num);
-			*lowerKey=*higherKey=atoi(num);
+			*lowerNum=*higherNum=num;
 		}
 	}
 	if (strcmp(predicateRoot->root->opt, "AND") == 0)
@@ -353,19 +652,47 @@ void QueryPlanNode::getSelOprand(int* lowerKey, int* higherKey)
 		{
 			if(t1==CMP_BIGER)
 			{
-				*lowerKey=atoi(t1num);
-				*higherKey=atoi(t2num);
+				*lowerNum=t1num;
+				*higherNum=t2num;
 			}
 			else//t2 is the smaller
 			{
-				*lowerKey=atoi(t2num);
-				*higherKey=atoi(t1num);
+				*lowerNum=t2num;
+				*higherNum=t1num;
 			}
 		}
 	}
 
 }
 
+//true for the predicates getSelOprand turns into [lowerKey, higherKey].
+bool QueryPlanNode::isRangeSelection()
+{
+	_PREDICATE_NODE* root=predicateRoot->root;
+	if(root==NULL || num_col!=1)
+		return false;
+	if (strcmp(root->opt, "=") == 0)
+	{
+		int leftopt = getOperandType(root->left->opt);
+		int rightopt = getOperandType(root->right->opt);
+		return (leftopt == OPT_COL && rightopt == OPT_NUM)
+			|| (leftopt == OPT_NUM && rightopt == OPT_COL);
+	}
+	if (strcmp(root->opt, "AND") == 0)
+	{
+		//the range kernels are inclusive on both ends, getCompare does not tell > from >= or =.
+		if ((strcmp(root->left->opt, ">=") != 0 && strcmp(root->left->opt, "<=") != 0)
+			|| (strcmp(root->right->opt, ">=") != 0 && strcmp(root->right->opt, "<=") != 0))
+			return false;
+		char * t1col, * t1num, *t2col, *t2num;
+		COMP_TYPE t1 = getCompare(root->left, &t1col, &t1num);
+		COMP_TYPE t2 = getCompare(root->right, &t2col, &t2num);
+		return ((t1 == CMP_BIGER && t2 == CMP_SMALLER) || (t1 == CMP_SMALLER && t2 == CMP_BIGER))
+			&& strcmp(t1col, t2col) == 0;
+	}
+	return false;
+}
+
 OP_MODE QueryPlanNode::getJoinType(void)
 {
 	int leftopt;
@@ -29,6 +29,7 @@ public:
 	int predicate_num;
 	ThreadOp* tOp;
 	NODE_STATUS nodeStatus;
+	bool isRoot;//its output is the query result, so it is always materialized.
 
 
 	QueryPlanNode();
@@ -41,6 +42,12 @@ public:
 //methods,
 
 	void getSelOprand(int* lowerKey, int* higherKey);
+	void getSelOprand(char** lowerNum, char** higherNum);
+	bool hasTypedColumn();
+	bool hasDictColumn();
+	bool readsPackedBase(EXEC_MODE eM);
+	int getAggMask();
+	bool isRangeSelection();
 	OP_MODE getJoinType(void);
 	ThreadOp* getNextOp(EXEC_MODE eM);
 	void createOp();
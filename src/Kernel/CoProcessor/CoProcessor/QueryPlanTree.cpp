@@ -16,10 +16,54 @@
 #define ADA_END_TYPE (JOIN_HJ)
 extern bool isGPUavailable;
 extern FILE* K_ofp;
+#ifdef _WIN32
+extern CRITICAL_SECTION Query_CPUBurdenCS;
+#define OpBurdenLock() EnterCriticalSection(&(Query_CPUBurdenCS))
+#define OpBurdenUnlock() LeaveCriticalSection(&(Query_CPUBurdenCS))
+#else
+extern pthread_mutex_t Query_CPUBurdenCS;
+#define OpBurdenLock() pthread_mutex_lock(&(Query_CPUBurdenCS))
+#define OpBurdenUnlock() pthread_mutex_unlock(&(Query_CPUBurdenCS))
+#endif
+//operator level placement: greedy on the calibrated operator cost of the
+//operators running now, as pickQueryDevice does with whole queries.
+static double Op_CPUBurden=0;
+static double Op_GPUBurden=0;
+static EXEC_MODE pickOpDevice(OP_MODE optType)
+{
+	EXEC_MODE eM;
+	double toCPU=planOpCost(optType,EXEC_CPU);
+	double toGPU=planOpCost(optType,EXEC_GPU);
+	OpBurdenLock();
+	if((Op_CPUBurden+toCPU)<=(Op_GPUBurden+toGPU))
+	{
+		eM=EXEC_CPU;
+		Op_CPUBurden+=toCPU;
+	}
+	else
+	{
+		eM=EXEC_GPU;
+		Op_GPUBurden+=toGPU;
+	}
+	OpBurdenUnlock();
+	return eM;
+}
+static void doneOpDevice(OP_MODE optType, EXEC_MODE eM)
+{
+	double cost=planOpCost(optType,eM);
+	OpBurdenLock();
+	if(eM==EXEC_GPU)
+		Op_GPUBurden-=cost;
+	else
+		Op_CPUBurden-=cost;
+	OpBurdenUnlock();
+}
 void QueryPlanTree::buildTree(char * str)
 {
 	int i = 0;
 	root = construct_plan_tree(str, &i);
+	if(root!=NULL)
+		root->isRoot=true;
 	curActiveNode=0;
 	totalNumNode=0;
 	Marshup(root);	
@@ -76,20 +120,29 @@ QueryPlanNode * QueryPlanTree::construct_plan_tree(char * str, int * index)
 //the status should be updated into the query plan.
 void QueryPlanTree::execute(EXEC_MODE eM)
 {
+	if(isPipelined() && executePipeline(eM))
+		return;
 	ThreadOp* resultOp=getNextOp(eM);
 	ThreadOp* previousOp=resultOp;
 	QueryPlanNode* curNode=(QueryPlanNode*)(nodeVec[curActiveNode]);
 	EXEC_MODE tempEM=eM;
 
+	bool opLevel=(CL_GetScheduleLevel()==SCHEDULE_OPERATOR);
 	while(resultOp!=NULL)
 	{	
 		//first, we get the type, next, we init the op.
 		curNode=(QueryPlanNode*)(nodeVec[curActiveNode]);	
-		curNode->initOp(eM);
+		//operator level: every operator goes where it finishes first.
+		OP_MODE opType=planOpType(curNode,planStatus->groupByRelation!=NULL);
+		if(opLevel)
+			tempEM=pickOpDevice(opType);
+		curNode->initOp(tempEM);
 
-		resultOp->execute(eM);	
+		resultOp->execute(tempEM);	
 
-		curNode->PostExecution(eM);
+		curNode->PostExecution(tempEM);
+		if(opLevel)
+			doneOpDevice(opType,tempEM);
 		previousOp=resultOp;
 		resultOp=getNextOp(eM);		
 	}
@@ -100,6 +153,26 @@ void QueryPlanTree::execute(EXEC_MODE eM)
 
 
 
+//the strings of the result values if the root reads a dictionary column, the codes are
+//decoded here only. NULL otherwise, the strings belong to the dictionary.
+const char** QueryPlanTree::decodeResult()
+{
+	if(root==NULL || root->num_col<1 || q_numResult<=0)
+		return NULL;
+	Dictionary* dict=easedb->getDictionary(root->columns[0]);
+	if(dict==NULL || root->optType==AGG_SUM || root->optType==AGG_AVG || root->optType==AGG_COUNT
+		|| root->optType==AGG_SUM_AFTER_GROUP_BY || root->optType==AGG_AVG_AFTER_GROUP_BY || root->optType==AGG_COUNT_AFTER_GROUP_BY
+		|| root->optType==APPROX_AGG)
+		return NULL;
+	Record* h_Rout=(Record*)malloc(sizeof(Record)*q_numResult);
+	CopyGPUToCPU(q_Rout,h_Rout,sizeof(Record)*q_numResult);
+	const char** strings=(const char**)malloc(sizeof(char*)*q_numResult);
+	for(int i=0;i<q_numResult;i++)
+		strings[i]=dict->decode(h_Rout[i].value);
+	free(h_Rout);
+	return strings;
+}
+
 ThreadOp* QueryPlanTree::getNextOp(EXEC_MODE eM)
 {
 	ThreadOp* resultOp=NULL;
@@ -7,6 +7,7 @@
 #include "ExecStatus.h"
 #include "ThreadOp.h"
 #include <vector>
+#include <bitset>
 using namespace std;
 
 
@@ -23,6 +24,8 @@ public:
 		planStatus=(ExecStatus*)malloc(sizeof(ExecStatus));
 		planStatus->init();
 		hasLock=false;
+		q_Rout=NULL;
+		q_numResult=0;
 	}
 	~QueryPlanTree();
 	QueryPlanNode * construct_plan_tree(char * str, int * index);
@@ -34,8 +37,24 @@ public:
 	void Marshup(QueryPlanNode * node);
 	cl_mem q_Rout;
 	int q_numResult;
+	const char** decodeResult();
 	bool hasLock;
+	//plan level scheduling (SCHEDULE_PLAN), see PlanScheduler.cpp
+	void executeDAG();
+	void placeDAG();
+	void runSubtree(int idx);
+	int nodeIndex(QueryPlanNode * node);
+	vector<EXEC_MODE> nodeEM;//device of every node, in nodeVec order.
+	vector<int> nodeParent;
+	vector< bitset<MAX_TABLE_PER_QUERY> > nodeTables;//the table IDs touched by the subtree.
+	vector<bool> nodeGroupBy;//the subtree contains a GROUP_BY.
+	//morsel driven execution of plans without pipeline breakers, see Pipeline.cpp
+	bool isPipelined();
+	bool executePipeline(EXEC_MODE eM);
 };
+//the final operator type of a node and its calibrated cost, see PlanScheduler.cpp
+OP_MODE planOpType(QueryPlanNode* node, bool afterGroupBy);
+double planOpCost(OP_MODE optType, int CPU_GPU);
 
 #endif
 
@@ -1,5 +1,9 @@
 #include "SingularThreadOp.h"
 #include "../MyLib/CPU_Dll.h"
+#include "PredicateTree.h"
+#include "Database.h"
+#include "../TonyLib/Sketch.h"
+#include <limits.h>
 
 
 SingularThreadOp::SingularThreadOp(OP_MODE opt)
@@ -7,6 +11,7 @@ SingularThreadOp::SingularThreadOp(OP_MODE opt)
 	optType=opt;
 	R=NULL;
 	Query_rLen=-1;
+	aggMask=0;
 }
 
 void SingularThreadOp::init(cl_mem p_R, int p_rLen)
@@ -15,15 +20,107 @@ void SingularThreadOp::init(cl_mem p_R, int p_rLen)
 	Query_rLen=p_rLen;
 }
 
+void SingularThreadOp::initTyped(cl_mem p_R, int p_rLen, int p_colType)
+{
+	init(p_R,p_rLen);
+	isTyped=true;
+	colType=p_colType;
+}
+
+void SingularThreadOp::initPacked(PackedColumn p_col)
+{
+	init(p_col.d_data,p_col.rLen);
+	isPacked=true;
+	packed=p_col;
+}
+
 SingularThreadOp::~SingularThreadOp(void)
 {
 }
 
+//the partial sums are 64 bit or double, Rout holds aggValue.
+void SingularThreadOp::executeTyped(EXEC_MODE eM)
+{
+	int aggType=TYPED_AGG_SUM;
+	if(optType==AGG_MIN)
+		aggType=TYPED_AGG_MIN;
+	else if(optType==AGG_MAX)
+		aggType=TYPED_AGG_MAX;
+	bool isFloat=(colType==COL_FLOAT32 || colType==COL_FLOAT64);
+	CL_TypedAggOnly(R,colType,Query_rLen,aggType,&aggValue,256,512,eM);
+	if(optType==AGG_AVG && Query_rLen>0)
+	{
+		if(isFloat)
+			aggValue.f64/=Query_rLen;
+		else
+			aggValue.i64/=Query_rLen;
+	}
+	CL_CREATE(&Rout,sizeof(typed_value));
+	CopyCPUToGPU(Rout,&aggValue,sizeof(typed_value));
+}
+
+//the aggregate is taken on the packed words, RLE sums a run at a time.
+void SingularThreadOp::executePacked(EXEC_MODE eM)
+{
+	int aggType=TYPED_AGG_SUM;
+	if(optType==AGG_MIN)
+		aggType=TYPED_AGG_MIN;
+	else if(optType==AGG_MAX)
+		aggType=TYPED_AGG_MAX;
+	long long result=CL_PackedAggOnly(&packed,aggType,256,512,eM);
+	if(optType==AGG_AVG && Query_rLen>0)
+		result/=Query_rLen;
+	Record rec;
+	rec.rid=0;
+	rec.value=(int)result;
+	CL_CREATE(&Rout,sizeof(Record));
+	CopyCPUToGPU(Rout,&rec,sizeof(Record));
+}
+
+//all the aggregates of aggMask in one pass, a record (bit of the aggregate, value) each.
+void SingularThreadOp::executeMulti(EXEC_MODE eM)
+{
+	long long results[MULTI_AGG_NUM];
+	Record recs[MULTI_AGG_NUM];
+	int numAgg=CL_MultiAggOnly(R,Query_rLen,aggMask,results,256,512,eM);
+	int k=0;
+	for(int bit=0;bit<MULTI_AGG_NUM;bit++)
+	{
+		if(aggMask&(1<<bit))
+		{
+			recs[k].rid=bit;
+			recs[k].value=(int)results[k];
+			k++;
+		}
+	}
+	CL_CREATE(&Rout,sizeof(Record)*(numAgg>0?numAgg:1));
+	if(numAgg>0)
+		CopyCPUToGPU(Rout,recs,sizeof(Record)*numAgg);
+	numResult=numAgg;
+}
 
 void SingularThreadOp::execute(EXEC_MODE eM)
 {
 	int result=0;
 	//printf("SingularThreadOp::execute \n");
+	if(isTyped && optType!=SELECTION)
+	{
+		executeTyped(eM);
+		numResult=1;
+		return;
+	}
+	if(isPacked && optType!=SELECTION)
+	{
+		executePacked(eM);
+		numResult=1;
+		return;
+	}
+	if(optType>=AGG_SUM && optType<=AGG_AVG && CO_IsSplit(Query_rLen))
+	{
+		CO_Agg(R,Query_rLen,optType,&Rout);
+		numResult=1;
+		return;
+	}
 	switch(optType)
 	{
 		case AGG_SUM:
@@ -49,11 +146,23 @@ void SingularThreadOp::execute(EXEC_MODE eM)
 			
 			result=CL_AggMinOnly(R,Query_rLen,&Rout,256, 512,eM);			
 		}break;
+		case AGG_COUNT:
+		{
+			executeMulti(eM);
+			return;
+		}
 		case SELECTION:
 		{
 				SelectionOp *sop=(SelectionOp*)this;
 				sop->execute(eM);
 		}break;
+		case TOP_K:
+		default:
+		{
+			//TOP_K and the ops after a group by have their own classes.
+			cout<<"not a singular op, "<<OpToString(optType,eM)<<endl;
+			exit(1);
+		}
 	}
 	numResult=1;
 	//printf("SingularThreadOp::execute done\n");
@@ -70,7 +179,11 @@ ThreadOp* SingularThreadOp::getNextOp(EXEC_MODE eM)
 SelectionOp::SelectionOp(OP_MODE opt):
 SingularThreadOp(opt)
 {
-	
+	predicate=NULL;
+	numCol=0;
+	toBitmap=false;
+	bitmap=NULL;
+	RIDList=NULL;
 }
 
 void SelectionOp::init(cl_mem p_R, int p_rLen, int p_lowerKey, int p_higherKey)
@@ -80,12 +193,163 @@ void SelectionOp::init(cl_mem p_R, int p_rLen, int p_lowerKey, int p_higherKey)
 	//Kernel_bufferchecking(R,1000);
 	lowerKey=p_lowerKey;
 	higherKey=p_higherKey;
+	predicate=NULL;
+	toBitmap=false;
+}
+
+void SelectionOp::init(cl_mem* p_cols, int p_numCol, int p_rLen, PredicateTree* p_predicate)
+{
+	int i=0;
+	numCol=p_numCol;
+	for(i=0;i<numCol;i++)
+		cols[i]=p_cols[i];
+	R=cols[0];
+	Query_rLen=p_rLen;
+	predicate=p_predicate;
+	toBitmap=false;
+}
+
+void SelectionOp::initTyped(cl_mem p_R, int p_rLen, int p_colType, typed_value low, typed_value high, cl_mem p_RIDList)
+{
+	init(p_R,p_rLen,0,0);
+	isTyped=true;
+	colType=p_colType;
+	lowerValue=low;
+	higherValue=high;
+	RIDList=p_RIDList;
+}
+
+void SelectionOp::initPacked(PackedColumn p_col, int codeLow, int codeHigh)
+{
+	init(p_col.d_data,p_col.rLen,codeLow,codeHigh);
+	isPacked=true;
+	packed=p_col;
+}
+
+//the codes are matched as a bitmap, only the records of the matches are decoded.
+void SelectionOp::executePacked(EXEC_MODE eM)
+{
+	CL_PackedRangeSelectionBitmapOnly(&packed,lowerKey,higherKey,&bitmap,256,512,eM);
+	if(toBitmap)
+	{
+		numResult=CL_BitmapCountOnly(bitmap,Query_rLen,256,64,eM);
+		return;
+	}
+	cl_mem positions=NULL;
+	int numMatch=CL_BitmapToRIDListOnly(bitmap,Query_rLen,&positions,256,64,eM);
+	CL_DESTORY(&bitmap);
+	bitmap=NULL;
+	numResult=CL_PackedDecodeOnly(&packed,positions,numMatch,&Rout,256,64,eM);
+	CL_DESTORY(&positions);
+}
+
+//the matches are found as a bitmap over R, which is either kept or turned into rids.
+void SelectionOp::executeTyped(EXEC_MODE eM)
+{
+	CL_TypedRangeSelectionBitmapOnly(R,colType,Query_rLen,&lowerValue,&higherValue,&bitmap,256,512,eM);
+	if(toBitmap)
+	{
+		numResult=CL_BitmapCountOnly(bitmap,Query_rLen,256,64,eM);
+		return;
+	}
+	cl_mem positions=NULL;
+	numResult=CL_BitmapToRIDListOnly(bitmap,Query_rLen,&positions,256,64,eM);
+	CL_DESTORY(&bitmap);
+	bitmap=NULL;
+	if(RIDList==NULL)
+		Rout=positions;
+	else
+	{
+		//the positions index the current RID list, which is an int32 column itself.
+		CL_TypedGatherOnly(RIDList,COL_INT32,positions,numResult,&Rout,256,64,eM);
+		CL_DESTORY(&positions);
+	}
+}
+
+//the predicate evaluated on the host, for shapes the kernel cannot take.
+int SelectionOp::hostSelection()
+{
+	int i=0,j=0;
+	int numMatch=0;
+	int keys[MAX_PREDICATE_COL];
+	Record* h_cols[MAX_PREDICATE_COL];
+	for(j=0;j<numCol;j++)
+	{
+		h_cols[j]=(Record*)malloc(sizeof(Record)*Query_rLen);
+		CopyGPUToCPU(cols[j],h_cols[j],sizeof(Record)*Query_rLen);
+	}
+	Record* h_R=h_cols[0];
+	int numWord=(Query_rLen+31)>>5;
+	unsigned int* h_bitmap=NULL;
+	if(toBitmap)
+		h_bitmap=(unsigned int*)calloc(numWord>0?numWord:1,sizeof(unsigned int));
+	for(i=0;i<Query_rLen;i++)
+	{
+		for(j=0;j<numCol;j++)
+			keys[j]=h_cols[j][i].value;
+		if(!predicate->evaluate(keys))
+			continue;
+		if(toBitmap)
+			h_bitmap[i>>5]|=(1u<<(i&31));
+		else
+			h_R[numMatch]=h_R[i];
+		numMatch++;
+	}
+	for(j=1;j<numCol;j++)
+		free(h_cols[j]);
+	if(toBitmap)
+	{
+		CL_CREATE(&bitmap,sizeof(int)*(numWord>0?numWord:1));
+		CopyCPUToGPU(bitmap,h_bitmap,sizeof(int)*(numWord>0?numWord:1));
+		free(h_bitmap);
+		free(h_R);
+		return numMatch;
+	}
+	CL_CREATE(&Rout,sizeof(Record)*(numMatch>0?numMatch:1));
+	if(numMatch>0)
+		CopyCPUToGPU(Rout,h_R,sizeof(Record)*numMatch);
+	free(h_R);
+	return numMatch;
 }
 
 void SelectionOp::execute(EXEC_MODE eM)
 {
 		//printf("SelectionOp::execute\n");
-	if(lowerKey==higherKey)
+	if(isTyped)
+		executeTyped(eM);
+	else if(isPacked)
+		executePacked(eM);
+	else if(predicate!=NULL)
+	{
+		//the kernel is compiled once per predicate shape, the numbers are arguments.
+		int constants[MAX_PREDICATE_CONST];
+		int numConst=0;
+		char* shape=predicate->get_CL_predicate_string(constants,&numConst);
+		numResult=-1;
+		if(shape!=NULL)
+		{
+			if(toBitmap)
+				numResult=CL_PredicateBitmapOnly(cols,numCol,Query_rLen,shape,constants,numConst,&bitmap,256,512,eM);
+			else
+				numResult=CL_PredicateSelectionOnly(cols,numCol,Query_rLen,shape,constants,numConst,&Rout,256,512,eM);
+			free(shape);
+		}
+		if(numResult<0)
+			numResult=hostSelection();
+		else if(toBitmap)
+			numResult=CL_BitmapCountOnly(bitmap,Query_rLen,256,64,eM);
+		//the other columns were gathered for this selection only, R goes with the op.
+		for(int i=1;i<numCol;i++)
+			CL_DESTORY(&cols[i]);
+		numCol=1;
+	}
+	else if(toBitmap)
+	{
+		//the RIDs wait for materializeBitmap, only the matches are counted here.
+		CL_RangeSelectionBitmapOnly(R,Query_rLen,lowerKey,higherKey,&bitmap,256,512,eM);
+		numResult=CL_BitmapCountOnly(bitmap,Query_rLen,256,64,eM);
+	}
+	else if(lowerKey==higherKey)
 	{
 		////printf("doing point selection, lowerKey is %d, Higher Key is %d",lowerKey,higherKey);
 		//Kernel_bufferchecking(R,1000);
@@ -97,6 +361,8 @@ void SelectionOp::execute(EXEC_MODE eM)
 		numResult=CL_PointSelectionOnly(R,Query_rLen,lowerKey, &Rout,256,512,eM);//pointselection canonly handle up to 100
 		////printf("point selection finished\n");
 	}
+	else if(CO_IsSplit(Query_rLen))
+		numResult=CO_RangeSelection(R,Query_rLen,lowerKey,higherKey,&Rout);
 	else
 	{
 		////printf("doing range selection, lowerKey is %d, Higher Key is %d",lowerKey,higherKey);
@@ -120,12 +386,32 @@ void ProjectionOp::execute(EXEC_MODE eM)
 {
 	//printf("ProjectionOp::execute\n");
 	numResult=RIDLen;
-	if(RIDLen>0)
+	if(isPacked)
+		numResult=CL_PackedDecodeOnly(&packed,RIDList,RIDLen,&Rout,256,64,eM);
+	else if(isTyped)
+	{
+		//the values at the rids, R goes with the op so the base table is copied.
+		if(RIDList!=NULL)
+			CL_TypedGatherOnly(R,colType,RIDList,RIDLen,&Rout,256,64,eM);
+		else
+		{
+			int memSize=Database::colTypeSize(colType)*RIDLen;
+			CL_CREATE(&Rout,memSize>0?memSize:sizeof(typed_value));
+			if(memSize>0)
+				CopyGPUToGPU(R,Rout,memSize);
+		}
+	}
+	else if(RIDLen>0)
 	{
 		CL_CREATE(&Rout, sizeof(Record)*RIDLen);
-		CL_setRIDList(RIDList,RIDLen,Rout,256,64,eM);
-		//Rout[i].rid=RIDList[i];
-		CL_ProjectionOnly(R,Query_rLen,Rout,RIDLen,256,64,eM);	
+		if(CO_IsSplit(RIDLen))
+			CO_Projection(R,Query_rLen,RIDList,RIDLen,Rout);
+		else
+		{
+			CL_setRIDList(RIDList,RIDLen,Rout,256,64,eM);
+			//Rout[i].rid=RIDList[i];
+			CL_ProjectionOnly(R,Query_rLen,Rout,RIDLen,256,64,eM);	
+		}
 		//GPUDEBUG_Record(Rout, RIDLen);
 	}
 	//printf("ProjectionOp::execute done\n");
@@ -154,8 +440,94 @@ void ProjectionOp::init(cl_mem p_R, int p_rLen, cl_mem pRIDList, int pRIDLen)
 	RIDList=pRIDList;
 	RIDLen=pRIDLen;
 }
+void ProjectionOp::initTyped(cl_mem p_R, int p_rLen, int p_colType, cl_mem pRIDList, int pRIDLen)
+{
+	init(p_R,p_rLen,pRIDList,pRIDLen);
+	isTyped=true;
+	colType=p_colType;
+}
+
+void ProjectionOp::initPacked(PackedColumn p_col, cl_mem pRIDList, int pRIDLen)
+{
+	init(p_col.d_data,p_col.rLen,pRIDList,pRIDLen);
+	isPacked=true;
+	packed=p_col;
+}
+
 ThreadOp* ProjectionOp::getNextOp(EXEC_MODE eM)
 {
 	isFinished=true;
 	return this;
-}
\ No newline at end of file
+}
+
+ApproxAggOp::ApproxAggOp(OP_MODE opt):
+SingularThreadOp(opt)
+{
+	countDistinct=true;
+	error=0.02;
+	numQuantile=0;
+}
+
+//"NDV@error", COUNT(DISTINCT) within a relative standard error; "P50|P99@error", the
+//percentiles within a relative error of their value.
+void ApproxAggOp::parse(const char* spec)
+{
+	char* list=(char*)malloc(strlen(spec)+1);
+	strcpy(list,spec);
+	char* at=strchr(list,'@');
+	if(at!=NULL)
+	{
+		*at='\0';
+		error=atof(at+1);
+	}
+	countDistinct=(strcmp(list,"NDV")==0);
+	numQuantile=0;
+	for(char* name=strtok(list,"|");!countDistinct && name!=NULL;name=strtok(NULL,"|"))
+	{
+		if(name[0]!='P' || numQuantile==MAX_APPROX_QUANTILE)
+		{
+			cout<<"unknown approximate aggregate, "<<spec<<endl;
+			exit(1);
+		}
+		quantiles[numQuantile++]=atof(name+1)/100;
+	}
+	free(list);
+	if(error<=0)
+	{
+		cout<<"the error bound must be positive, "<<spec<<endl;
+		exit(1);
+	}
+}
+
+void ApproxAggOp::execute(EXEC_MODE eM)
+{
+	//one scan into a sketch; Rout has a record per answer, the rid is its position.
+	Record h_out[MAX_APPROX_QUANTILE];
+	int answer[MAX_APPROX_QUANTILE];
+	if(countDistinct)
+	{
+		double ndv=CL_ApproxCountDistinctOnly(R,Query_rLen,sketch_hllP(error),256,64,eM);
+		answer[0]=(ndv>INT_MAX)?INT_MAX:(int)(ndv+0.5);
+		numResult=1;
+	}
+	else
+	{
+		CL_ApproxQuantileOnly(R,Query_rLen,error,quantiles,numQuantile,answer,256,64,eM);
+		numResult=numQuantile;
+	}
+	for(int i=0;i<numResult;i++)
+	{
+		h_out[i].rid=i;
+		h_out[i].value=answer[i];
+	}
+	CL_CREATE(&Rout,sizeof(Record)*(numResult>0?numResult:1));
+	if(numResult>0)
+		CopyCPUToGPU(Rout,h_out,sizeof(Record)*numResult);
+}
+
+ThreadOp* ApproxAggOp::getNextOp(EXEC_MODE eM)
+{
+	this->execMode=eM;
+	isFinished=true;
+	return this;
+}
@@ -1,14 +1,25 @@
 #pragma once
 #include "ThreadOp.h"
+#include "PredicateTree.h"
 
 class SingularThreadOp :
 	public ThreadOp
 {
 public:
+	//the aggregate of a typed column: i64 for the integer types, f64 for the float types.
+	typed_value aggValue;
+	//the MULTI_AGG_* bits of the fused aggregate, AGG_COUNT. Rout is then a row of 64 bit results.
+	int aggMask;
 	void init(cl_mem p_R, int p_rLen);
+	void initTyped(cl_mem p_R, int p_rLen, int p_colType);
+	//the whole compressed column, the op owns its buffers.
+	void initPacked(PackedColumn p_col);
 	SingularThreadOp(OP_MODE opt);
 	~SingularThreadOp(void);
 	void execute(EXEC_MODE eM);
+	void executeTyped(EXEC_MODE eM);
+	void executePacked(EXEC_MODE eM);
+	void executeMulti(EXEC_MODE eM);
 	ThreadOp* getNextOp(EXEC_MODE eM);
 };
 
@@ -17,8 +28,26 @@ class SelectionOp: public SingularThreadOp
 public:
 	int lowerKey;
 	int higherKey;
+	PredicateTree* predicate;//NULL for a range selection on [lowerKey, higherKey].
+	//columns of one table lined up by position, cols[0] is R and is the output.
+	int numCol;
+	cl_mem cols[MAX_PREDICATE_COL];
+	//the result is a bitmap over R instead of the matching records.
+	bool toBitmap;
+	cl_mem bitmap;
+	//a range selection on a typed column, the result is the RID list of the matches.
+	typed_value lowerValue;
+	typed_value higherValue;
+	cl_mem RIDList;//the rids of the values in R, NULL if R is the base table.
 	void execute(EXEC_MODE eM);
+	void executeTyped(EXEC_MODE eM);
+	void executePacked(EXEC_MODE eM);
 	void init(cl_mem p_R, int p_rLen, int lowerKey, int higherKey);
+	//[codeLow, codeHigh] as CompressedColumn::codeRange gives it.
+	void initPacked(PackedColumn p_col, int codeLow, int codeHigh);
+	void initTyped(cl_mem p_R, int p_rLen, int p_colType, typed_value low, typed_value high, cl_mem p_RIDList);
+	void init(cl_mem* p_cols, int p_numCol, int p_rLen, PredicateTree* p_predicate);
+	int hostSelection();
 	SelectionOp(OP_MODE opt);
 	ThreadOp* getNextOp(EXEC_MODE eM);
 };
@@ -30,6 +59,25 @@ public:
 	int RIDLen;
 	void execute(EXEC_MODE eM);
 	void init(cl_mem p_R, int p_rLen, cl_mem RIDList, int RIDLen);
+	//RIDList is NULL for the base table, the values are then R itself.
+	void initTyped(cl_mem p_R, int p_rLen, int p_colType, cl_mem RIDList, int RIDLen);
+	//the records are decoded at the rids.
+	void initPacked(PackedColumn p_col, cl_mem RIDList, int RIDLen);
 	ProjectionOp(OP_MODE opt);
 	ThreadOp* getNextOp(EXEC_MODE eM);
 };
+
+//an approximate aggregate over R with an error bound, APPROX_AGG.
+#define MAX_APPROX_QUANTILE (16)
+class ApproxAggOp:public SingularThreadOp
+{
+public:
+	bool countDistinct;//else the quantiles.
+	double error;
+	int numQuantile;
+	double quantiles[MAX_APPROX_QUANTILE];
+	void parse(const char* spec);
+	void execute(EXEC_MODE eM);
+	ApproxAggOp(OP_MODE opt);
+	ThreadOp* getNextOp(EXEC_MODE eM);
+};
@@ -6,7 +6,8 @@
 SortThreadOp::SortThreadOp(OP_MODE opt)
 :SingularThreadOp(opt)
 {
-	
+	topK=0;
+	largest=true;
 }
 
 void SortThreadOp::init(cl_mem p_R, int p_rLen)
@@ -22,6 +23,12 @@ SortThreadOp::~SortThreadOp(void)
 
 void SortThreadOp::execute(EXEC_MODE eM)
 {
+	if(optType==TOP_K)
+	{
+		//a radix select keeps k records, the whole input is not sorted.
+		numResult=CL_TopKOnly(R,Query_rLen,topK,largest?1:0,&Rout,256,512,eM);
+		return;
+	}
 	numResult=Query_rLen;	
 	//printf("SortThreadOp::execute\n");
 	CL_CREATE(&Rout,sizeof(Record)*Query_rLen);
@@ -24,5 +24,8 @@ public:
 	int cpuChunkSize;
 	int gpuChunkSize;
 	vector<Record**> tempResultVec;
+	//TOP_K: the k largest records, the k smallest if largest is false.
+	int topK;
+	bool largest;
 	
 };
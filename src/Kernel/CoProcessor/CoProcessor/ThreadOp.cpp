@@ -7,13 +7,18 @@ using namespace std;
 ThreadOp::ThreadOp()
 {
 	isFinished=false;
+	isTyped=false;
+	colType=COL_INT32;
+	isPacked=false;
 	numResult=Query_rLen;
 	Rout=NULL;
 }
 
 ThreadOp::~ThreadOp()
 {
-	clReleaseMemObject(this->R);
+	CL_DESTORY(&(this->R));
+	if(isPacked && packed.d_aux!=NULL)
+		CL_DESTORY(&(packed.d_aux));
 }
 
 
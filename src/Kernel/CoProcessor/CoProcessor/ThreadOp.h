@@ -19,6 +19,12 @@ public:
 	EXEC_MODE execMode;
 	OP_MODE optType;
 	bool isFinished;
+	//R is a plain array of colType values instead of records.
+	bool isTyped;
+	int colType;
+	//R is packed.d_data, the operator reads the compressed column.
+	bool isPacked;
+	PackedColumn packed;
 	ThreadOp();
 	~ThreadOp();	
 	virtual void execute(EXEC_MODE eM)=0;
@@ -28,6 +28,14 @@ int compareRID (const void * a, const void * b);
 
 typedef int RET_VALUE;
 
+//a value of a typed column, COL_* in OpenCL_DLL.h says which member is used.
+typedef union{
+	int i32;
+	long long i64;
+	float f32;
+	double f64;
+}typed_value;
+
 //the operator type.
 
 #define TYPE_SEL_EQUAL	1
@@ -112,8 +120,12 @@ typedef enum{
 	JOIN_SMJ,
 	JOIN_HJ,
 	DISTINCT,
+	TOP_K,//ORDER BY ... LIMIT k.
+	APPROX_AGG,//COUNT(DISTINCT) and percentiles from a sketch.
 	TYPE_UNKNOWN
 } OP_MODE;
+//the number of OP_MODEs, the size of the per operator costs RunOpInCPU and RunOpInGPU.
+#define NUM_OP_MODE (TYPE_UNKNOWN+1)
 
 typedef enum{
 	STATUS_DONE,
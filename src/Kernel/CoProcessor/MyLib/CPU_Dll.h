@@ -43,6 +43,11 @@ int CPU_TreeSearch(Record *R, int rLen, CC_CSSTree *tree, Record *S, int sLen, R
 
 //for joins
 void CPU_Sort(Record* Rin, int rLen, Record* Rout, int numThread);
+//the k largest (or smallest) records of Rin to Rout in order, returns their number.
+int CPU_TopK(Record* Rin, int rLen, int k, bool largest, Record* Rout, int numThread);
+//the approximate aggregates with the sketches of the device (TonyLib/Sketch.h).
+double CPU_ApproxCountDistinct(Record* Rin, int rLen, int p, int numThread);
+void CPU_ApproxQuantile(Record* Rin, int rLen, double alpha, const double* q, int numQ, int* out, int numThread);
 int CPU_ninlj(Record *R, int rLen, Record *S, int sLen, Record** Rout, int numThread);
 int CPU_inlj(Record *R, int rLen, CC_CSSTree *tree, Record *S, int sLen, Record** Rout, int numThread);
 int CPU_smj(Record *R, int rLen, Record *S, int sLen, Record** Rout, int numThread);
@@ -0,0 +1,150 @@
+#ifndef _SKETCH_H_
+#define _SKETCH_H_
+#include <math.h>
+/*
+ * Mergeable sketches for the approximate aggregates. A work group builds its
+ * sketch in local memory and merges it into one on the device, registers by
+ * max and bins by sum; the CPU operators build the same sketches with these
+ * functions, so both devices give the same answer.
+ *
+ * HyperLogLog: 2^p registers, COUNT(DISTINCT) has a standard error of
+ * 1.04/sqrt(2^p). Quantiles: a log bucket sketch with a bin per power of
+ * gamma=(1+alpha)/(1-alpha) on each side of 0, the answer for a rank is
+ * within relative error alpha of the value of that rank.
+ */
+#define SKETCH_HLL_MIN_P (4)
+#define SKETCH_HLL_MAX_P (12) // 16KB of registers in local memory.
+#define SKETCH_MIN_ALPHA (0.01)
+#define SKETCH_MAX_ALPHA (0.5)
+
+// murmur3's finalizer, hll_hash in primitive.cl.
+static inline unsigned int sketch_hash(int value)
+{
+	unsigned int h = (unsigned int)value;
+	h ^= h >> 16;
+	h *= 0x85ebca6bu;
+	h ^= h >> 13;
+	h *= 0xc2b2ae35u;
+	h ^= h >> 16;
+	return h;
+}
+
+// the smallest p whose standard error is at most error.
+static inline int sketch_hllP(double error)
+{
+	int p = SKETCH_HLL_MIN_P;
+	while (p < SKETCH_HLL_MAX_P && 1.04 / sqrt((double)(1 << p)) > error)
+		p++;
+	return p;
+}
+
+static inline void sketch_hllAdd(int *registers, int p, int value)
+{
+	unsigned int h = sketch_hash(value);
+	unsigned int w = h << p;
+	int rho = 1;
+	while (rho <= 32 - p && (w & 0x80000000u) == 0)
+	{
+		w <<= 1;
+		rho++;
+	}
+	int reg = (int)(h >> (32 - p));
+	if (registers[reg] < rho)
+		registers[reg] = rho;
+}
+
+static inline double sketch_hllEstimate(const int *registers, int p)
+{
+	int m = 1 << p;
+	double alpha = (m == 16) ? 0.673 : (m == 32) ? 0.697 : (m == 64) ? 0.709 : 0.7213 / (1 + 1.079 / m);
+	double sum = 0;
+	int numZero = 0;
+	for (int i = 0; i < m; i++)
+	{
+		sum += ldexp(1.0, -registers[i]);
+		if (registers[i] == 0)
+			numZero++;
+	}
+	double e = alpha * m * m / sum;
+	// small cardinalities count the empty registers instead.
+	if (e <= 2.5 * m && numZero > 0)
+		return m * log((double)m / numZero);
+	// the 32 bit hash saturates near 2^32.
+	double two32 = 4294967296.0;
+	if (e > two32 / 30)
+		return -two32 * log(1 - e / two32);
+	return e;
+}
+
+static inline double sketch_clampAlpha(double alpha)
+{
+	if (alpha < SKETCH_MIN_ALPHA)
+		return SKETCH_MIN_ALPHA;
+	if (alpha > SKETCH_MAX_ALPHA)
+		return SKETCH_MAX_ALPHA;
+	return alpha;
+}
+
+static inline float sketch_invLogGamma(double alpha)
+{
+	return (float)(1 / log((1 + alpha) / (1 - alpha)));
+}
+
+// the bucket of 2^31, the largest magnitude of an int.
+static inline int sketch_maxBucket(double alpha)
+{
+	return (int)ceil(31 * log(2.0) * sketch_invLogGamma(alpha)) + 1;
+}
+
+// the negative buckets downwards, 0, then the positive buckets upwards.
+static inline int sketch_numBin(double alpha)
+{
+	return 2 * sketch_maxBucket(alpha) + 3;
+}
+
+// quantileSketch_bin in primitive.cl, in float as the kernel does it.
+static inline int sketch_bin(int value, float invLogGamma, int maxBucket)
+{
+	if (value == 0)
+		return maxBucket + 1;
+	unsigned int mag = (value > 0) ? (unsigned int)value : 0u - (unsigned int)value;
+	int k = (int)ceilf(logf((float)mag) * invLogGamma);
+	k = (k < 0) ? 0 : ((k > maxBucket) ? maxBucket : k);
+	return (value > 0) ? (maxBucket + 2 + k) : (maxBucket - k);
+}
+
+// 2*gamma^k/(gamma+1) is within alpha of any value of bucket k.
+static inline int sketch_binValue(int bin, double alpha, int maxBucket)
+{
+	if (bin == maxBucket + 1)
+		return 0;
+	double gamma = (1 + alpha) / (1 - alpha);
+	int k = (bin > maxBucket) ? (bin - maxBucket - 2) : (maxBucket - bin);
+	double v = 2 * pow(gamma, k) / (gamma + 1);
+	if (v > 2147483647.0)
+		v = 2147483647.0;
+	return (bin > maxBucket) ? (int)(v + 0.5) : -(int)(v + 0.5);
+}
+
+// the value of rank q*(n-1), 0<=q<=1, of the n values counted in bins.
+static inline int sketch_quantile(const int *bins, double alpha, double q)
+{
+	int maxBucket = sketch_maxBucket(alpha);
+	int numBin = 2 * maxBucket + 3;
+	long long n = 0;
+	for (int i = 0; i < numBin; i++)
+		n += bins[i];
+	if (n == 0)
+		return 0;
+	long long rank = (long long)(q * (n - 1));
+	long long seen = 0;
+	int i = 0;
+	for (i = 0; i < numBin - 1; i++)
+	{
+		seen += bins[i];
+		if (seen > rank)
+			break;
+	}
+	return sketch_binValue(i, alpha, maxBucket);
+}
+#endif
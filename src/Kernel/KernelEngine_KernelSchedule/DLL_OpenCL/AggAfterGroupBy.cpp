@@ -2,6 +2,7 @@
 #include "testAggAfterGB.h"
 #include "OpenCL_DLL.h"
 #include "scheduler.h"
+#include "KernelScheduler.h"
 /*
 aggregation after group by.
 with the known number of groups, we can allocate the output for advance: d_aggResults.
@@ -167,4 +168,114 @@ extern "C" void CL_agg_avg_afterGroupBy(Record* h_Rin, int rLen, int* h_startPos
 	clReleaseKernel(Kernel); 
 	clReleaseEvent(eventList[0]);
 	clReleaseEvent(eventList[1]);
-}
\ No newline at end of file
+}
+/*
+the groups and the column stay on the device. d_Rin is the grouped relation of CL_GroupByOnly, d_Ragg
+the aggregated column with a record at the position of its rid; d_Rout gets one record per group,
+(the value of the group, its aggregate).
+*/
+static void groupResult_int(cl_mem d_Rin, cl_mem d_startPos, cl_mem d_aggResults, int numGroups, cl_mem d_Rout, int numThread, int numBlock,int *index,cl_event *eventList,cl_kernel *kernel,int *Flag_CPU_GPU,double * burden,int _CPU_GPU)
+{
+	size_t numThreadsPerBlock_x=numThread;
+	size_t globalWorkingSetSize=numThread*numBlock;
+	cl_getKernel("groupResult_kernel",kernel);
+	cl_int ciErr1 = clSetKernelArg((*kernel), 0, sizeof(cl_mem), (void*)&d_Rin);	
+	ciErr1 |= clSetKernelArg((*kernel), 1, sizeof(cl_mem), (void*)&d_startPos);
+	ciErr1 |= clSetKernelArg((*kernel), 2, sizeof(cl_mem), (void*)&d_aggResults);
+	ciErr1 |= clSetKernelArg((*kernel), 3, sizeof(cl_int), (void*)&numGroups);
+	ciErr1 |= clSetKernelArg((*kernel), 4, sizeof(cl_mem), (void*)&d_Rout);
+	if (ciErr1 != CL_SUCCESS)
+	{
+		printf("Error in clSetKernelArg, Line %u in file %s !!!\n\n", __LINE__, __FILE__);
+		cl_clean(EXIT_FAILURE);
+	}	
+	kernel_enqueue(numGroups,79, 
+		1, &globalWorkingSetSize, &numThreadsPerBlock_x,eventList,index,kernel,Flag_CPU_GPU,burden,_CPU_GPU);
+}
+static void aggAfterGroupByOnly(cl_mem d_Rin, int rLen, cl_mem d_startPos, int numGroups, cl_mem d_Ragg, cl_mem* d_Rout, int OPERATOR, int numThread,int _CPU_GPU)
+{
+	CL_MALLOC(d_Rout, sizeof(Record)*(numGroups>0?numGroups:1));
+	if(rLen<=0 || numGroups<=0)
+		return;
+	cl_event eventList[2];
+	int index=0;
+	cl_kernel Kernel; 
+	int CPU_GPU;
+	double burden;
+	cl_mem d_aggResults;
+	CL_MALLOC(&d_aggResults, sizeof(int)*numGroups);
+	aggAfterGroupByImpl(d_Rin, rLen, d_startPos, numGroups, d_Ragg, d_aggResults, OPERATOR, numThread,&index,eventList,&Kernel,&CPU_GPU,&burden,_CPU_GPU);
+	clReleaseKernel(Kernel); 
+	groupResult_int(d_Rin, d_startPos, d_aggResults, numGroups, *d_Rout, numThread, 64,&index,eventList,&Kernel,&CPU_GPU,&burden,_CPU_GPU);
+	clWaitForEvents(1,&eventList[(index-1)%2]); 
+	deschedule(CPU_GPU,burden);
+	CL_FREE(d_aggResults);
+	clReleaseKernel(Kernel); 
+	clReleaseEvent(eventList[0]);
+	clReleaseEvent(eventList[1]);
+}
+extern "C" void CL_agg_max_afterGroupByOnly(cl_mem d_Rin, int rLen, cl_mem d_startPos, int numGroups, cl_mem d_Ragg, cl_mem* d_Rout, int numThread,int _CPU_GPU)
+{
+	aggAfterGroupByOnly(d_Rin, rLen, d_startPos, numGroups, d_Ragg, d_Rout, REDUCE_MAX, numThread,_CPU_GPU);
+}
+extern "C" void CL_agg_min_afterGroupByOnly(cl_mem d_Rin, int rLen, cl_mem d_startPos, int numGroups, cl_mem d_Ragg, cl_mem* d_Rout, int numThread,int _CPU_GPU)
+{
+	aggAfterGroupByOnly(d_Rin, rLen, d_startPos, numGroups, d_Ragg, d_Rout, REDUCE_MIN, numThread,_CPU_GPU);
+}
+extern "C" void CL_agg_sum_afterGroupByOnly(cl_mem d_Rin, int rLen, cl_mem d_startPos, int numGroups, cl_mem d_Ragg, cl_mem* d_Rout, int numThread,int _CPU_GPU)
+{
+	aggAfterGroupByOnly(d_Rin, rLen, d_startPos, numGroups, d_Ragg, d_Rout, REDUCE_SUM, numThread,_CPU_GPU);
+}
+extern "C" void CL_agg_avg_afterGroupByOnly(cl_mem d_Rin, int rLen, cl_mem d_startPos, int numGroups, cl_mem d_Ragg, cl_mem* d_Rout, int numThread,int _CPU_GPU)
+{
+	aggAfterGroupByOnly(d_Rin, rLen, d_startPos, numGroups, d_Ragg, d_Rout, REDUCE_AVERAGE, numThread,_CPU_GPU);
+}
+/*
+fused aggregates per group, written by multiAggAfterGroupBy_kernel with one work group per group.
+the accumulators are 64 bit, d_Rout gets numAgg records (group value, aggregate) per group.
+*/
+extern "C" int CL_MultiAggAfterGroupByOnly(cl_mem d_Rin, int rLen, cl_mem d_startPos, int numGroups, cl_mem d_Ragg, int aggMask, cl_mem* d_Rout, int numThread, int _CPU_GPU)
+{
+	int numAgg=0;
+	for(int bit=0;bit<MULTI_AGG_NUM;bit++)
+		if(aggMask&(1<<bit))
+			numAgg++;
+	CL_MALLOC(d_Rout, sizeof(Record)*(numAgg>0?numAgg:1)*(numGroups>0?numGroups:1));
+	if(rLen<=0 || numGroups<=0 || numAgg==0)
+		return numAgg;
+	cl_event eventList[2];
+	int index=0;
+	cl_kernel Kernel; 
+	int CPU_GPU;
+	double burden;
+	if(numThread>256)
+		numThread=256;
+	int numBlock=(numGroups<512)?numGroups:512;
+	size_t numThreadsPerBlock_x=numThread;
+	size_t globalWorkingSetSize=numThread*numBlock;
+	cl_getKernel("multiAggAfterGroupBy_kernel",&Kernel);
+	cl_int ciErr1 = clSetKernelArg(Kernel, 0, sizeof(cl_mem), (void*)&d_Rin);
+	ciErr1 |= clSetKernelArg(Kernel, 1, sizeof(cl_int), (void*)&rLen);
+	ciErr1 |= clSetKernelArg(Kernel, 2, sizeof(cl_mem), (void*)&d_startPos);
+	ciErr1 |= clSetKernelArg(Kernel, 3, sizeof(cl_int), (void*)&numGroups);
+	ciErr1 |= clSetKernelArg(Kernel, 4, sizeof(cl_mem), (void*)&d_Ragg);
+	ciErr1 |= clSetKernelArg(Kernel, 5, sizeof(cl_int), (void*)&aggMask);
+	ciErr1 |= clSetKernelArg(Kernel, 6, sizeof(cl_int), (void*)&numAgg);
+	ciErr1 |= clSetKernelArg(Kernel, 7, sizeof(cl_mem), (void*)d_Rout);
+	ciErr1 |= clSetKernelArg(Kernel, 8, sizeof(cl_long)*numThread, NULL);
+	ciErr1 |= clSetKernelArg(Kernel, 9, sizeof(cl_int)*numThread, NULL);
+	ciErr1 |= clSetKernelArg(Kernel, 10, sizeof(cl_int)*numThread, NULL);
+	if (ciErr1 != CL_SUCCESS)
+	{
+		printf("Error in clSetKernelArg, Line %u in file %s !!!\n\n", __LINE__, __FILE__);
+		cl_clean(EXIT_FAILURE);
+	}
+	kernel_enqueue(rLen,60,
+		1, &globalWorkingSetSize, &numThreadsPerBlock_x,eventList,&index,&Kernel,&CPU_GPU,&burden,_CPU_GPU);
+	clWaitForEvents(1,&eventList[(index-1)%2]); 
+	deschedule(CPU_GPU,burden);
+	clReleaseKernel(Kernel);
+	clReleaseEvent(eventList[0]);
+	clReleaseEvent(eventList[1]);
+	return numAgg;
+}
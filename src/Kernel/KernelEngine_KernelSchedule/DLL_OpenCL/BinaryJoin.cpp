@@ -72,7 +72,8 @@ extern "C" int	CL_smj( Record* h_R, int rLen, Record* h_S, int sLen, Record** h_
 	int numResult = SMJImpl(d_R, rLen, d_S, sLen, &d_Joinout,&index,eventList,&Kernel,&CPU_GPU,&burden,_CPU_GPU);
 
 	*h_Joinout = (Record*)malloc( sizeof(Record)*numResult );
-	cl_readbuffer( *h_Joinout, d_Joinout, sizeof(Record)*numResult ,&index,eventList,&CPU_GPU,&burden,_CPU_GPU);
+	if(numResult>0)
+		cl_readbuffer( *h_Joinout, d_Joinout, sizeof(Record)*numResult ,&index,eventList,&CPU_GPU,&burden,_CPU_GPU);
 	clWaitForEvents(1,&eventList[(index-1)%2]); 
 	deschedule(CPU_GPU,burden);
 	CL_FREE(d_R);
@@ -108,7 +109,8 @@ extern "C" int CL_mj( void * h_Rin, int rLen, Record* h_Sin, int sLen, Record**
 	*h_Joinout = (Record*)malloc( sizeof(Record)*outSize );
 	//HOST_MALLOC( (void**)h_Joinout, sizeof(Record)*outSize );
 
-	cl_readbuffer( *h_Joinout, d_Joinout, sizeof(Record)*outSize,&index,eventList,&CPU_GPU,&burden,_CPU_GPU );
+	if(outSize>0)
+		cl_readbuffer( *h_Joinout, d_Joinout, sizeof(Record)*outSize,&index,eventList,&CPU_GPU,&burden,_CPU_GPU );
 	clWaitForEvents(1,&eventList[(index-1)%2]); 
 	deschedule(CPU_GPU,burden);
 	CL_FREE(d_Rin);
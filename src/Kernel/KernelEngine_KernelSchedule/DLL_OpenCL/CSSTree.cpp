@@ -229,12 +229,9 @@ int cuda_join_after_search(cl_mem d_R, int rLen, cl_mem d_S, cl_mem d_locations,
 
 	cl_mem d_sum;	
 	CL_MALLOC(&d_sum, sizeof(int) * THRD_PER_GRID_join);
-	ScanPara *SP;
-	SP=(ScanPara*)malloc(sizeof(ScanPara));
-	initScan(THRD_PER_GRID_join,SP);
+	ScanPara *SP=scan_getPara(THRD_PER_GRID_join);
 	scanImpl(d_ResNums, THRD_PER_GRID_join, d_sum,index,eventList,Kernel,Flag_CPU_GPU,burden,SP,_CPU_GPU);
 	clWaitForEvents(1,&eventList[(*index-1)%2]); 
-	closeScan(SP);
 
 	int sum = 0;
 	int last;
@@ -0,0 +1,165 @@
+#include "Compression.h"
+#include "KernelScheduler.h"
+#include "scheduler.h"
+#include "testBitmap.h"
+
+extern cl_program Program; // OpenCL program
+
+/*the kernels are in primitive.cl*/
+static cl_kernel packed_kernel(const char *name)
+{
+	cl_int ciErr1;
+	cl_kernel kernel = clCreateKernel(Program, name, &ciErr1);
+	if (ciErr1 != CL_SUCCESS)
+	{
+		printf("Error %d in clCreateKernel %s, Line %u in file %s !!!\n\n", ciErr1, name, __LINE__, __FILE__);
+		cl_clean(EXIT_FAILURE);
+	}
+	return kernel;
+}
+
+/*the arguments 0..5 every packed kernel starts with, or 0..4 without the
+ * base; FOR has no aux buffer, d_data stands in for it.*/
+static cl_int packed_setColumnArgs(cl_kernel kernel, PackedColumn *col, bool withBase)
+{
+	int arg = 0;
+	cl_mem d_aux = (col->d_aux != NULL) ? col->d_aux : col->d_data;
+	cl_int ciErr1 = clSetKernelArg(kernel, arg++, sizeof(cl_int), (void *)&col->scheme);
+	ciErr1 |= clSetKernelArg(kernel, arg++, sizeof(cl_int), (void *)&col->width);
+	if (withBase)
+		ciErr1 |= clSetKernelArg(kernel, arg++, sizeof(cl_int), (void *)&col->base);
+	ciErr1 |= clSetKernelArg(kernel, arg++, sizeof(cl_mem), (void *)&col->d_data);
+	ciErr1 |= clSetKernelArg(kernel, arg++, sizeof(cl_mem), (void *)&d_aux);
+	ciErr1 |= clSetKernelArg(kernel, arg++, sizeof(cl_int), (void *)&col->numAux);
+	return ciErr1;
+}
+
+static void packed_checkArg(cl_int ciErr1)
+{
+	if (ciErr1 != CL_SUCCESS)
+	{
+		printf("Error in clSetKernelArg, Line %u in file %s !!!\n\n", __LINE__, __FILE__);
+		cl_clean(EXIT_FAILURE);
+	}
+}
+
+void packed_decodeImpl(PackedColumn *col, cl_mem d_RIDList, int len, cl_mem d_Rout, int numThreadPB, int numBlock, int *index, cl_event *eventList, cl_kernel *Kernel, int *Flag_CPU_GPU, double *burden, int _CPU_GPU)
+{
+	size_t numThreadsPerBlock_x = numThreadPB;
+	size_t globalWorkingSetSize = numThreadPB * numBlock;
+	int hasRIDList = (d_RIDList != NULL);
+	cl_mem d_RIDArg = hasRIDList ? d_RIDList : col->d_data;
+	(*Kernel) = packed_kernel("packed_decode_kernel");
+	cl_int ciErr1 = packed_setColumnArgs(*Kernel, col, true);
+	ciErr1 |= clSetKernelArg((*Kernel), 6, sizeof(cl_mem), (void *)&d_RIDArg);
+	ciErr1 |= clSetKernelArg((*Kernel), 7, sizeof(cl_int), (void *)&hasRIDList);
+	ciErr1 |= clSetKernelArg((*Kernel), 8, sizeof(cl_int), (void *)&len);
+	ciErr1 |= clSetKernelArg((*Kernel), 9, sizeof(cl_mem), (void *)&d_Rout);
+	packed_checkArg(ciErr1);
+	kernel_enqueue(len, 76, 1, &globalWorkingSetSize, &numThreadsPerBlock_x, eventList, index, Kernel, Flag_CPU_GPU, burden, _CPU_GPU);
+}
+
+void packed_rangeSelectionImpl(PackedColumn *col, int codeLow, int codeHigh, cl_mem d_bitmap, int numThreadPB, int numBlock, int *index, cl_event *eventList, cl_kernel *Kernel, int *Flag_CPU_GPU, double *burden, int _CPU_GPU)
+{
+	size_t numThreadsPerBlock_x = numThreadPB;
+	size_t globalWorkingSetSize = numThreadPB * numBlock;
+	cl_long low = codeLow;
+	cl_long high = codeHigh;
+	(*Kernel) = packed_kernel("packed_rangeSelection_kernel");
+	cl_int ciErr1 = packed_setColumnArgs(*Kernel, col, false);
+	ciErr1 |= clSetKernelArg((*Kernel), 5, sizeof(cl_int), (void *)&col->rLen);
+	ciErr1 |= clSetKernelArg((*Kernel), 6, sizeof(cl_long), (void *)&low);
+	ciErr1 |= clSetKernelArg((*Kernel), 7, sizeof(cl_long), (void *)&high);
+	ciErr1 |= clSetKernelArg((*Kernel), 8, sizeof(cl_mem), (void *)&d_bitmap);
+	packed_checkArg(ciErr1);
+	kernel_enqueue(col->rLen, 77, 1, &globalWorkingSetSize, &numThreadsPerBlock_x, eventList, index, Kernel, Flag_CPU_GPU, burden, _CPU_GPU);
+}
+
+void packed_reduceImpl(PackedColumn *col, int op, cl_mem d_partial, int numThreadPB, int numBlock, int *index, cl_event *eventList, cl_kernel *Kernel, int *Flag_CPU_GPU, double *burden, int _CPU_GPU)
+{
+	size_t numThreadsPerBlock_x = numThreadPB;
+	size_t globalWorkingSetSize = numThreadPB * numBlock;
+	(*Kernel) = packed_kernel("packed_reduce_kernel");
+	cl_int ciErr1 = packed_setColumnArgs(*Kernel, col, true);
+	ciErr1 |= clSetKernelArg((*Kernel), 6, sizeof(cl_int), (void *)&col->rLen);
+	ciErr1 |= clSetKernelArg((*Kernel), 7, sizeof(cl_int), (void *)&op);
+	ciErr1 |= clSetKernelArg((*Kernel), 8, sizeof(cl_mem), (void *)&d_partial);
+	ciErr1 |= clSetKernelArg((*Kernel), 9, sizeof(cl_long) * numThreadPB, NULL);
+	packed_checkArg(ciErr1);
+	kernel_enqueue(col->rLen, 78, 1, &globalWorkingSetSize, &numThreadsPerBlock_x, eventList, index, Kernel, Flag_CPU_GPU, burden, _CPU_GPU);
+}
+
+int CL_PackedDecodeOnly(PackedColumn *col, cl_mem d_RIDList, int RIDLen, cl_mem *d_Rout, int numThreadPB, int numBlock, int _CPU_GPU)
+{
+	int len = (d_RIDList != NULL) ? RIDLen : col->rLen;
+	CL_MALLOC(d_Rout, sizeof(Record) * (len > 0 ? len : 1));
+	if (len <= 0)
+		return 0;
+	cl_event eventList[2];
+	int index = 0;
+	cl_kernel Kernel;
+	int CPU_GPU;
+	double burden;
+	packed_decodeImpl(col, d_RIDList, len, *d_Rout, numThreadPB, numBlock, &index, eventList, &Kernel, &CPU_GPU, &burden, _CPU_GPU);
+	clWaitForEvents(1, &eventList[(index - 1) % 2]);
+	deschedule(CPU_GPU, burden);
+	clReleaseKernel(Kernel);
+	clReleaseEvent(eventList[0]);
+	clReleaseEvent(eventList[1]);
+	return len;
+}
+
+void CL_PackedRangeSelectionBitmapOnly(PackedColumn *col, int codeLow, int codeHigh, cl_mem *d_bitmap, int numThreadPB, int numBlock, int _CPU_GPU)
+{
+	int numWord = BITMAP_NUM_WORD(col->rLen);
+	CL_MALLOC(d_bitmap, sizeof(int) * (numWord > 0 ? numWord : 1));
+	if (col->rLen <= 0)
+		return;
+	cl_event eventList[2];
+	int index = 0;
+	cl_kernel Kernel;
+	int CPU_GPU;
+	double burden;
+	packed_rangeSelectionImpl(col, codeLow, codeHigh, *d_bitmap, numThreadPB, numBlock, &index, eventList, &Kernel, &CPU_GPU, &burden, _CPU_GPU);
+	clWaitForEvents(1, &eventList[(index - 1) % 2]);
+	deschedule(CPU_GPU, burden);
+	clReleaseKernel(Kernel);
+	clReleaseEvent(eventList[0]);
+	clReleaseEvent(eventList[1]);
+}
+
+/*the values are decoded in the kernel that reduces them, the partials of the
+ * work groups are combined here like the ones of CL_TypedAggOnly*/
+long long CL_PackedAggOnly(PackedColumn *col, int aggType, int numThreadPB, int numBlock, int _CPU_GPU)
+{
+	long long result = 0;
+	if (col->rLen <= 0)
+		return 0;
+	cl_event eventList[2];
+	int index = 0;
+	cl_kernel Kernel;
+	int CPU_GPU;
+	double burden;
+	cl_long *h_partial = (cl_long *)malloc(sizeof(cl_long) * numBlock);
+	cl_mem d_partial;
+	CL_MALLOC(&d_partial, sizeof(cl_long) * numBlock);
+	packed_reduceImpl(col, aggType, d_partial, numThreadPB, numBlock, &index, eventList, &Kernel, &CPU_GPU, &burden, _CPU_GPU);
+	cl_readbuffer(h_partial, d_partial, sizeof(cl_long) * numBlock, &index, eventList, &CPU_GPU, &burden, _CPU_GPU);
+	clWaitForEvents(1, &eventList[(index - 1) % 2]);
+	deschedule(CPU_GPU, burden);
+	result = h_partial[0];
+	for (int i = 1; i < numBlock; i++)
+	{
+		long long v = h_partial[i];
+		if (aggType == TYPED_AGG_SUM)
+			result += v;
+		else if ((aggType == TYPED_AGG_MIN) == (v < result))
+			result = v;
+	}
+	free(h_partial);
+	CL_FREE(d_partial);
+	clReleaseKernel(Kernel);
+	clReleaseEvent(eventList[0]);
+	clReleaseEvent(eventList[1]);
+	return result;
+}
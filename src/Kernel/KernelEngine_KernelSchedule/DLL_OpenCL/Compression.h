@@ -0,0 +1,14 @@
+#ifndef _COMPRESSION_H_
+#define _COMPRESSION_H_
+#include "common.h"
+#include "OpenCL_DLL.h"
+/*
+ * Scans over compressed columns (PackedColumn in OpenCL_DLL.h). The kernels
+ * decode a value where they read it, a range selection on FOR or DICT codes
+ * compares the packed codes without decoding them.
+ */
+void packed_decodeImpl(PackedColumn *col, cl_mem d_RIDList, int len, cl_mem d_Rout, int numThreadPB, int numBlock, int *index, cl_event *eventList, cl_kernel *Kernel, int *Flag_CPU_GPU, double *burden, int _CPU_GPU);
+void packed_rangeSelectionImpl(PackedColumn *col, int codeLow, int codeHigh, cl_mem d_bitmap, int numThreadPB, int numBlock, int *index, cl_event *eventList, cl_kernel *Kernel, int *Flag_CPU_GPU, double *burden, int _CPU_GPU);
+/*op is a TYPED_AGG_*, one 64 bit partial per work group in d_partial*/
+void packed_reduceImpl(PackedColumn *col, int op, cl_mem d_partial, int numThreadPB, int numBlock, int *index, cl_event *eventList, cl_kernel *Kernel, int *Flag_CPU_GPU, double *burden, int _CPU_GPU);
+#endif
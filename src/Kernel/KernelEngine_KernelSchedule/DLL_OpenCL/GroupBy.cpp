@@ -39,3 +39,49 @@ extern "C" int CL_GroupBy(Record * h_Rin, int rLen, Record* h_Rout, int** h_star
 	printf("CL_GroupBy\n");
 	return numGroup;
 }
+
+/*the groups stay on the device: d_Rout is R sorted on the value, d_startPos the first position of every group*/
+extern "C" int CL_GroupByOnly(cl_mem d_Rin, int rLen, cl_mem* d_Rout, cl_mem* d_startPos, 
+					int numThread, int numBlock , int _CPU_GPU)
+{
+	cl_event eventList[2];
+	int index=0;
+	cl_kernel Kernel; 
+	int CPU_GPU;
+	double burden;
+	CL_MALLOC(d_Rout, sizeof(Record)*(rLen>0?rLen:1));
+	if(rLen<=0)
+	{
+		CL_MALLOC(d_startPos, sizeof(int));
+		return 0;
+	}
+	int numGroup=groupByImpl(d_Rin, rLen, *d_Rout, d_startPos, numThread, numBlock,&index,eventList,&Kernel,&CPU_GPU,&burden,_CPU_GPU);
+	clWaitForEvents(1,&eventList[(index-1)%2]); 
+	deschedule(CPU_GPU,burden);
+	clReleaseKernel(Kernel);
+	clReleaseEvent(eventList[0]);
+	clReleaseEvent(eventList[1]);
+	return numGroup;
+}
+
+extern "C" int CL_DistinctOnly(cl_mem d_Rin, int rLen, cl_mem d_others, int numOther, cl_mem* d_Rout, 
+					int numThread, int numBlock , int _CPU_GPU)
+{
+	cl_event eventList[2];
+	int index=0;
+	cl_kernel Kernel; 
+	int CPU_GPU;
+	double burden;
+	CL_MALLOC(d_Rout, sizeof(Record)*(rLen>0?rLen:1));
+	if(rLen<=0)
+		return 0;
+	//with no other column the kernel never reads d_others.
+	if(numOther==0)
+		d_others=d_Rin;
+	int numDistinct=distinctImpl(d_Rin, d_others, numOther, rLen, *d_Rout, numThread, numBlock,&index,eventList,&Kernel,&CPU_GPU,&burden,_CPU_GPU);
+	deschedule(CPU_GPU,burden);
+	clReleaseKernel(Kernel);
+	clReleaseEvent(eventList[0]);
+	clReleaseEvent(eventList[1]);
+	return numDistinct;
+}
@@ -1,8 +1,15 @@
 #include "CSSTree.h"
 #include "Helper.h"
+#include "OpenCL_DLL.h"
+#include "PredicateJIT.h"
+#include "Sketch.h"
+#include "TypedColumn.h"
 #include "common.h"
+#include "scheduler.h"
+#include "testGroupBy.h"
 #include "testJoin.h"
 #include "testScan.h"
+#include "testSort.h"
 #include "testSplit.h"
 
 extern cl_context Context; // OpenCL context
@@ -16,10 +23,10 @@ extern double
     AddGPUBurden_Write; //->initial in handshaking. fix rLen to 1024*1024
 extern double AddCPUBurden_Write;
 extern double
-    AddGPUBurden[60]; //->initial in handshaking. fix rLen to 1024*1024
+    AddGPUBurden[NUM_KERNEL_ID]; //->initial in handshaking. fix rLen to 1024*1024
 extern double
-    AddCPUBurden[60]; //->initial in handshaking. fix rLen to 1024*1024
-extern double speedupGPUoverCPU[60 + 3];
+    AddCPUBurden[NUM_KERNEL_ID]; //->initial in handshaking. fix rLen to 1024*1024
+extern double speedupGPUoverCPU[NUM_KERNEL_ID + 3];
 extern double LothresholdForGPUApp;
 extern double LothresholdForCPUApp;
 extern double LoGPUBurden;
@@ -549,7 +556,7 @@ void blockAddition_kernel_handshake(int _HandShakeCPU_GPU,
   static cl_ulong usedLocalMemory; /**< Used local memory by _HandShakeKernel */
   ScanPara *SP;
   SP = (ScanPara *)malloc(sizeof(ScanPara));
-  initScan(rLen, SP);
+  initScanPasses(rLen, SP);
 
   /* Do block-wise sum */
   bScan_int(SP->gLength, &D1, &SP->outputBuffer[0], &SP->blockSumBuffer[0],
@@ -633,7 +640,7 @@ void prefixSum_kernel_handshake(int _HandShakeCPU_GPU,
   static cl_ulong usedLocalMemory; /**< Used local memory by _HandShakeKernel */
   ScanPara *SP;
   SP = (ScanPara *)malloc(sizeof(ScanPara));
-  initScan(rLen, SP);
+  initScanPasses(rLen, SP);
   /* Do block-wise sum */
   bScan_int(SP->gLength, &D1, &SP->outputBuffer[0], &SP->blockSumBuffer[0],
             &index, eventList, &_Kernel, &FLAG_CPU_GPU, &burden, SP, 0);
@@ -719,7 +726,7 @@ void ScanLargeArrays_kernel_handshake(int _HandShakeCPU_GPU,
   /*private*/
   ScanPara *SP;
   SP = (ScanPara *)malloc(sizeof(ScanPara));
-  initScan(rLen, SP);
+  initScanPasses(rLen, SP);
   for (i = 0; i < Count; i++) {
     int timer = DLL_genTimer(kid);
     DLL_getTimer(timer);
@@ -1229,13 +1236,10 @@ void writeHist_kernel_handshake(int _HandShakeCPU_GPU,
 
   // prefix sum
   CL_MALLOC(&D7, sizeof(int) * numInPS);
-  ScanPara *SP;
-  SP = (ScanPara *)malloc(sizeof(ScanPara));
-  initScan(numInPS, SP);
+  ScanPara *SP = scan_getPara(numInPS);
   scanImpl(D6, numInPS, D7, &index, eventList, _HandShakeKernel, &FLAG_CPU_GPU,
            &burden, SP, 0);
   clWaitForEvents(1, &eventList[(index - 1) % 2]);
-  closeScan(SP);
 
   CL_MALLOC(&D6, sizeof(int) * rLen);
   for (i = 0; i < Count; i++) {
@@ -1368,6 +1372,190 @@ void BitonicSort_kernel_handshake(int _HandShakeCPU_GPU,
   }
 }
 
+void mergeSort_blockSort_kernel_handshake(int _HandShakeCPU_GPU,
+                                          cl_kernel *_HandShakeKernel) {
+  double i;
+  double sum = 0;
+  double scaler = 1000;
+  int kid = 32;
+  printf("Kid%d", kid);
+  size_t numThreadsPerBlock_x = MERGESORT_THREAD;
+  size_t globalWorkingSetSize = 32 * 64;
+  for (i = 0; i < Count; i++) {
+    int timer = DLL_genTimer(kid);
+    DLL_getTimer(timer);
+    cl_getKernel("mergeSort_blockSort_kernel", _HandShakeKernel);
+    cl_int err =
+        clSetKernelArg((*_HandShakeKernel), 0, sizeof(cl_mem), (void *)&D1);
+    err |= clSetKernelArg((*_HandShakeKernel), 1, sizeof(cl_int), (void *)&rLen);
+    err |= clSetKernelArg((*_HandShakeKernel), 2,
+                          sizeof(Record) * MERGESORT_TILE, NULL);
+    err |= clSetKernelArg((*_HandShakeKernel), 3,
+                          sizeof(Record) * MERGESORT_TILE, NULL);
+    cl_launchKernel(1, &globalWorkingSetSize, &numThreadsPerBlock_x,
+                    _HandShakeKernel, _HandShakeCPU_GPU);
+    double t = DLL_getTimer(timer);
+    sum += t;
+#ifdef HandshakeDebug
+    printf("mergeSort_blockSort_kernel invocatio overhead, %f\n", t);
+#endif
+  }
+  if (_HandShakeCPU_GPU) {
+    AddGPUBurden[kid] = sum / Count * scaler;
+    printf("sum is %lf\n, mergeSort_blockSort_kernel invocatio overhead in "
+           "average in GPU, %lf\n",
+           sum, AddGPUBurden[kid]);
+  } else {
+    AddCPUBurden[kid] = sum / Count * scaler;
+    printf("sum is %lf\n, mergeSort_blockSort_kernel invocatio overhead in "
+           "average in CPU, %lf\n",
+           sum, AddCPUBurden[kid]);
+  }
+}
+
+void mergeSort_merge_kernel_handshake(int _HandShakeCPU_GPU,
+                                      cl_kernel *_HandShakeKernel) {
+  double i;
+  double sum = 0;
+  double scaler = 1000;
+  int kid = 33;
+  printf("Kid%d", kid);
+  int width = MERGESORT_TILE;
+  size_t numThreadsPerBlock_x = MERGESORT_THREAD;
+  size_t globalWorkingSetSize = 32 * 64;
+  for (i = 0; i < Count; i++) {
+    int timer = DLL_genTimer(kid);
+    DLL_getTimer(timer);
+    cl_getKernel("mergeSort_merge_kernel", _HandShakeKernel);
+    cl_int err =
+        clSetKernelArg((*_HandShakeKernel), 0, sizeof(cl_mem), (void *)&D1);
+    err |=
+        clSetKernelArg((*_HandShakeKernel), 1, sizeof(cl_mem), (void *)&D2);
+    err |= clSetKernelArg((*_HandShakeKernel), 2, sizeof(cl_int), (void *)&rLen);
+    err |=
+        clSetKernelArg((*_HandShakeKernel), 3, sizeof(cl_int), (void *)&width);
+    err |= clSetKernelArg((*_HandShakeKernel), 4,
+                          sizeof(Record) * MERGESORT_TILE * 2, NULL);
+    err |= clSetKernelArg((*_HandShakeKernel), 5, sizeof(cl_int) * 2, NULL);
+    cl_launchKernel(1, &globalWorkingSetSize, &numThreadsPerBlock_x,
+                    _HandShakeKernel, _HandShakeCPU_GPU);
+    double t = DLL_getTimer(timer);
+    sum += t;
+#ifdef HandshakeDebug
+    printf("mergeSort_merge_kernel invocatio overhead, %f\n", t);
+#endif
+  }
+  if (_HandShakeCPU_GPU) {
+    AddGPUBurden[kid] = sum / Count * scaler;
+    printf("sum is %lf\n, mergeSort_merge_kernel invocatio overhead in "
+           "average in GPU, %lf\n",
+           sum, AddGPUBurden[kid]);
+  } else {
+    AddCPUBurden[kid] = sum / Count * scaler;
+    printf("sum is %lf\n, mergeSort_merge_kernel invocatio overhead in "
+           "average in CPU, %lf\n",
+           sum, AddCPUBurden[kid]);
+  }
+}
+
+void mergeJoin_count_kernel_handshake(int _HandShakeCPU_GPU,
+                                      cl_kernel *_HandShakeKernel) {
+  double i;
+  double sum = 0;
+  double scaler = 1000;
+  int kid = 34;
+  printf("Kid%d", kid);
+  size_t numThreadsPerBlock_x = SMJ_NUM_THREADS_PER_BLOCK;
+  size_t globalWorkingSetSize = 32 * 64;
+  for (i = 0; i < Count; i++) {
+    int timer = DLL_genTimer(kid);
+    DLL_getTimer(timer);
+    cl_getKernel("mergeJoin_count_kernel", _HandShakeKernel);
+    cl_int err =
+        clSetKernelArg((*_HandShakeKernel), 0, sizeof(cl_mem), (void *)&D1);
+    err |= clSetKernelArg((*_HandShakeKernel), 1, sizeof(cl_int), (void *)&rLen);
+    err |=
+        clSetKernelArg((*_HandShakeKernel), 2, sizeof(cl_mem), (void *)&D2);
+    err |= clSetKernelArg((*_HandShakeKernel), 3, sizeof(cl_int), (void *)&rLen);
+    err |=
+        clSetKernelArg((*_HandShakeKernel), 4, sizeof(cl_mem), (void *)&D5);
+    err |=
+        clSetKernelArg((*_HandShakeKernel), 5, sizeof(cl_mem), (void *)&D6);
+    err |=
+        clSetKernelArg((*_HandShakeKernel), 6, sizeof(cl_mem), (void *)&D7);
+    cl_launchKernel(1, &globalWorkingSetSize, &numThreadsPerBlock_x,
+                    _HandShakeKernel, _HandShakeCPU_GPU);
+    double t = DLL_getTimer(timer);
+    sum += t;
+#ifdef HandshakeDebug
+    printf("mergeJoin_count_kernel invocatio overhead, %f\n", t);
+#endif
+  }
+  if (_HandShakeCPU_GPU) {
+    AddGPUBurden[kid] = sum / Count * scaler;
+    printf("sum is %lf\n, mergeJoin_count_kernel invocatio overhead in "
+           "average in GPU, %lf\n",
+           sum, AddGPUBurden[kid]);
+  } else {
+    AddCPUBurden[kid] = sum / Count * scaler;
+    printf("sum is %lf\n, mergeJoin_count_kernel invocatio overhead in "
+           "average in CPU, %lf\n",
+           sum, AddCPUBurden[kid]);
+  }
+}
+
+// no output to write, the launch alone.
+void mergeJoin_write_kernel_handshake(int _HandShakeCPU_GPU,
+                                      cl_kernel *_HandShakeKernel) {
+  double i;
+  double sum = 0;
+  double scaler = 1000;
+  int kid = 35;
+  printf("Kid%d", kid);
+  int numResult = 0;
+  size_t numThreadsPerBlock_x = SMJ_NUM_THREADS_PER_BLOCK;
+  size_t globalWorkingSetSize = 32 * 64;
+  for (i = 0; i < Count; i++) {
+    int timer = DLL_genTimer(kid);
+    DLL_getTimer(timer);
+    cl_getKernel("mergeJoin_write_kernel", _HandShakeKernel);
+    cl_int err =
+        clSetKernelArg((*_HandShakeKernel), 0, sizeof(cl_mem), (void *)&D1);
+    err |= clSetKernelArg((*_HandShakeKernel), 1, sizeof(cl_int), (void *)&rLen);
+    err |=
+        clSetKernelArg((*_HandShakeKernel), 2, sizeof(cl_mem), (void *)&D2);
+    err |=
+        clSetKernelArg((*_HandShakeKernel), 3, sizeof(cl_mem), (void *)&D5);
+    err |=
+        clSetKernelArg((*_HandShakeKernel), 4, sizeof(cl_mem), (void *)&D6);
+    err |=
+        clSetKernelArg((*_HandShakeKernel), 5, sizeof(cl_mem), (void *)&D7);
+    err |= clSetKernelArg((*_HandShakeKernel), 6, sizeof(cl_int),
+                          (void *)&numResult);
+    err |=
+        clSetKernelArg((*_HandShakeKernel), 7, sizeof(cl_mem), (void *)&D3);
+    err |= clSetKernelArg((*_HandShakeKernel), 8, sizeof(cl_int) * 2, NULL);
+    cl_launchKernel(1, &globalWorkingSetSize, &numThreadsPerBlock_x,
+                    _HandShakeKernel, _HandShakeCPU_GPU);
+    double t = DLL_getTimer(timer);
+    sum += t;
+#ifdef HandshakeDebug
+    printf("mergeJoin_write_kernel invocatio overhead, %f\n", t);
+#endif
+  }
+  if (_HandShakeCPU_GPU) {
+    AddGPUBurden[kid] = sum / Count * scaler;
+    printf("sum is %lf\n, mergeJoin_write_kernel invocatio overhead in "
+           "average in GPU, %lf\n",
+           sum, AddGPUBurden[kid]);
+  } else {
+    AddCPUBurden[kid] = sum / Count * scaler;
+    printf("sum is %lf\n, mergeJoin_write_kernel invocatio overhead in "
+           "average in CPU, %lf\n",
+           sum, AddCPUBurden[kid]);
+  }
+}
+
 void gpuNLJ_kernel_handshake(int _HandShakeCPU_GPU,
                              cl_kernel *_HandShakeKernel) {
   double i;
@@ -2018,13 +2206,10 @@ void joinMBWrite_kernel_handshake(int _HandShakeCPU_GPU,
   int h_sum = 0;
   joinMBCount(D1, rLen, D2, rLen, D4, numQuanR, D5, grid_NLJ, threads_NLJ,
               &index, eventList, &test_Kernel, &FLAG_CPU_GPU, &burden, 0);
-  ScanPara *SP;
-  SP = (ScanPara *)malloc(sizeof(ScanPara));
-  initScan(resultBuf, SP);
+  ScanPara *SP = scan_getPara(resultBuf);
   scanImpl(D5, resultBuf, D6, &index, eventList, &test_Kernel, &FLAG_CPU_GPU,
            &burden, SP, 0);
   clWaitForEvents(1, &eventList[(index - 1) % 2]);
-  closeScan(SP);
   cl_readbuffer((void *)&h_n, D5, (resultBuf - 1) * sizeof(int), sizeof(int),
                 &index, eventList, &FLAG_CPU_GPU, &burden, 0);
   cl_readbuffer((void *)&h_sum, D6, (resultBuf - 1) * sizeof(int), sizeof(int),
@@ -2221,4 +2406,693 @@ void probe_kernel_handshake(int _HandShakeCPU_GPU,
            "%lf\n",
            sum, AddCPUBurden[kid]);
   }
-}
\ No newline at end of file
+}
+
+// times a kernel given its arguments, a NULL value is a __local argument of
+// that size.
+// one launch of the kernel, returns its time.
+static double launch_kernel_handshake(const char *name, int kid, int numArg,
+                                      const size_t *argSize, void **argValue,
+                                      int _HandShakeCPU_GPU,
+                                      cl_kernel *_HandShakeKernel) {
+  size_t numThreadsPerBlock_x = 256;
+  size_t globalWorkingSetSize = 32 * 64;
+  int timer = DLL_genTimer(kid);
+  DLL_getTimer(timer);
+  cl_getKernel((char *)name, _HandShakeKernel);
+  cl_int ciErr1 = CL_SUCCESS;
+  for (int a = 0; a < numArg; a++)
+    ciErr1 |= clSetKernelArg((*_HandShakeKernel), a, argSize[a], argValue[a]);
+  if (ciErr1 != CL_SUCCESS) {
+    printf("Error in clSetKernelArg, Line %u in file %s !!!\n\n", __LINE__,
+           __FILE__);
+    cl_clean(EXIT_FAILURE);
+  }
+  cl_launchKernel(1, &globalWorkingSetSize, &numThreadsPerBlock_x,
+                  _HandShakeKernel, _HandShakeCPU_GPU);
+  double t = DLL_getTimer(timer);
+  clReleaseKernel(*_HandShakeKernel);
+#ifdef HandshakeDebug
+  printf("%s invocatio overhead, %f\n", name, t);
+#endif
+  return t;
+}
+
+static void record_kernel_handshake(const char *name, int kid, double sum,
+                                    int _HandShakeCPU_GPU) {
+  double scaler = 1000;
+  if (_HandShakeCPU_GPU) {
+    AddGPUBurden[kid] = sum / Count * scaler;
+    printf("sum is %lf\n, %s invocatio overhead in average in GPU, %lf\n", sum,
+           name, AddGPUBurden[kid]);
+  } else {
+    AddCPUBurden[kid] = sum / Count * scaler;
+    printf("sum is %lf\n, %s invocatio overhead in average in CPU, %lf\n", sum,
+           name, AddCPUBurden[kid]);
+  }
+}
+
+static void timed_kernel_handshake(const char *name, int kid, int numArg,
+                                   const size_t *argSize, void **argValue,
+                                   int _HandShakeCPU_GPU,
+                                   cl_kernel *_HandShakeKernel) {
+  double i;
+  double sum = 0;
+  printf("Kid%d", kid);
+  for (i = 0; i < Count; i++)
+    sum += launch_kernel_handshake(name, kid, numArg, argSize, argValue,
+                                   _HandShakeCPU_GPU, _HandShakeKernel);
+  record_kernel_handshake(name, kid, sum, _HandShakeCPU_GPU);
+}
+
+// the bitmaps are over the rLen records of D1, D5 and D6 hold their words.
+void bitmap_rangeSelection_kernel_handshake(int _HandShakeCPU_GPU,
+                                            cl_kernel *_HandShakeKernel) {
+  int smallKey = 0;
+  int largeKey = TEST_MAX / 2;
+  size_t argSize[5] = {sizeof(cl_mem), sizeof(cl_int), sizeof(cl_int),
+                       sizeof(cl_int), sizeof(cl_mem)};
+  void *argValue[5] = {&D1, &rLen, &smallKey, &largeKey, &D5};
+  timed_kernel_handshake("bitmap_rangeSelection_kernel", 51, 5, argSize,
+                         argValue, _HandShakeCPU_GPU, _HandShakeKernel);
+}
+
+void bitmap_combine_kernel_handshake(int _HandShakeCPU_GPU,
+                                     cl_kernel *_HandShakeKernel) {
+  int numWord = (rLen + 31) >> 5;
+  int isOr = 0;
+  size_t argSize[4] = {sizeof(cl_mem), sizeof(cl_mem), sizeof(cl_int),
+                       sizeof(cl_int)};
+  void *argValue[4] = {&D5, &D6, &numWord, &isOr};
+  timed_kernel_handshake("bitmap_combine_kernel", 52, 4, argSize, argValue,
+                         _HandShakeCPU_GPU, _HandShakeKernel);
+}
+
+void bitmap_count_kernel_handshake(int _HandShakeCPU_GPU,
+                                   cl_kernel *_HandShakeKernel) {
+  int numWord = (rLen + 31) >> 5;
+  size_t argSize[3] = {sizeof(cl_mem), sizeof(cl_int), sizeof(cl_mem)};
+  void *argValue[3] = {&D5, &numWord, &D7};
+  timed_kernel_handshake("bitmap_count_kernel", 53, 3, argSize, argValue,
+                         _HandShakeCPU_GPU, _HandShakeKernel);
+}
+
+void bitmap_toRIDList_kernel_handshake(int _HandShakeCPU_GPU,
+                                       cl_kernel *_HandShakeKernel) {
+  int numWord = (rLen + 31) >> 5;
+  // room for every bit of a word, whatever the words hold.
+  for (int w = 0; w < numWord; w++)
+    ((int *)H6)[w] = w << 5;
+  cl_writebuffer(D6, H6, sizeof(int) * numWord, 0);
+  size_t argSize[4] = {sizeof(cl_mem), sizeof(cl_int), sizeof(cl_mem),
+                       sizeof(cl_mem)};
+  void *argValue[4] = {&D5, &numWord, &D6, &D7};
+  timed_kernel_handshake("bitmap_toRIDList_kernel", 54, 4, argSize, argValue,
+                         _HandShakeCPU_GPU, _HandShakeKernel);
+}
+
+void bitmap_total_kernel_handshake(int _HandShakeCPU_GPU,
+                                   cl_kernel *_HandShakeKernel) {
+  int numWord = (rLen + 31) >> 5;
+  size_t argSize[4] = {sizeof(cl_mem), sizeof(cl_int), sizeof(cl_mem),
+                       sizeof(cl_int)};
+  void *argValue[4] = {&D5, &numWord, &D7, NULL};
+  timed_kernel_handshake("bitmap_total_kernel", 55, 4, argSize, argValue,
+                         _HandShakeCPU_GPU, _HandShakeKernel);
+}
+
+// the group by runs over D2, whose keys fit the hash table. D5 holds the keys of
+// the table, D6 the counts, D7 the group count and D3 the overflow flag; numStage
+// of build and rank are run before the kernel is timed. H6 keeps the zeros.
+static void hashGroupBy_handshake_prepare(int numStage, int _HandShakeCPU_GPU,
+                                          cl_kernel *_HandShakeKernel) {
+  int capacity = HASH_GROUPBY_CAPACITY;
+  int maxGroup = HASH_GROUPBY_MAX_GROUP;
+  int localSlots = HASH_GROUPBY_LOCAL_SLOTS;
+  generateRand((Record *)H2, HASH_GROUPBY_MAX_GROUP / 2, rLen, 0);
+  cl_writebuffer(D2, H2, sizeof(Record) * rLen, _HandShakeCPU_GPU);
+  for (int s = 0; s < capacity; s++)
+    ((int *)H5)[s] = INT_MIN;
+  memset(H6, 0, sizeof(int) * (capacity + 1));
+  cl_writebuffer(D5, H5, sizeof(int) * capacity, _HandShakeCPU_GPU);
+  cl_writebuffer(D6, H6, sizeof(int) * (capacity + 1), _HandShakeCPU_GPU);
+  cl_writebuffer(D7, H6, sizeof(int), _HandShakeCPU_GPU);
+  cl_writebuffer(D3, H6, sizeof(int), _HandShakeCPU_GPU);
+  if (numStage > 0) {
+    size_t argSize[11] = {sizeof(cl_mem), sizeof(cl_int), sizeof(cl_mem),
+                          sizeof(cl_mem), sizeof(cl_int), sizeof(cl_int),
+                          sizeof(cl_mem), sizeof(cl_mem),
+                          sizeof(cl_int) * localSlots,
+                          sizeof(cl_int) * localSlots, sizeof(cl_int)};
+    void *argValue[11] = {&D2, &rLen, &D5, &D6, &capacity, &maxGroup,
+                          &D7, &D3, NULL, NULL, &localSlots};
+    launch_kernel_handshake("hashGroupBy_build_kernel", 56, 11, argSize,
+                            argValue, _HandShakeCPU_GPU, _HandShakeKernel);
+  }
+  if (numStage > 1) {
+    // the group ids go to D3, the start positions to D7.
+    size_t argSize[5] = {sizeof(cl_mem), sizeof(cl_mem), sizeof(cl_int),
+                         sizeof(cl_mem), sizeof(cl_mem)};
+    void *argValue[5] = {&D5, &D6, &capacity, &D3, &D7};
+    launch_kernel_handshake("hashGroupBy_rank_kernel", 57, 5, argSize, argValue,
+                            _HandShakeCPU_GPU, _HandShakeKernel);
+  }
+}
+
+void hashGroupBy_build_kernel_handshake(int _HandShakeCPU_GPU,
+                                        cl_kernel *_HandShakeKernel) {
+  int capacity = HASH_GROUPBY_CAPACITY;
+  int maxGroup = HASH_GROUPBY_MAX_GROUP;
+  int localSlots = HASH_GROUPBY_LOCAL_SLOTS;
+  hashGroupBy_handshake_prepare(0, _HandShakeCPU_GPU, _HandShakeKernel);
+  size_t argSize[11] = {sizeof(cl_mem), sizeof(cl_int), sizeof(cl_mem),
+                        sizeof(cl_mem), sizeof(cl_int), sizeof(cl_int),
+                        sizeof(cl_mem), sizeof(cl_mem),
+                        sizeof(cl_int) * localSlots,
+                        sizeof(cl_int) * localSlots, sizeof(cl_int)};
+  void *argValue[11] = {&D2, &rLen, &D5, &D6, &capacity, &maxGroup,
+                        &D7, &D3, NULL, NULL, &localSlots};
+  timed_kernel_handshake("hashGroupBy_build_kernel", 56, 11, argSize, argValue,
+                         _HandShakeCPU_GPU, _HandShakeKernel);
+}
+
+void hashGroupBy_rank_kernel_handshake(int _HandShakeCPU_GPU,
+                                       cl_kernel *_HandShakeKernel) {
+  int capacity = HASH_GROUPBY_CAPACITY;
+  hashGroupBy_handshake_prepare(1, _HandShakeCPU_GPU, _HandShakeKernel);
+  size_t argSize[5] = {sizeof(cl_mem), sizeof(cl_mem), sizeof(cl_int),
+                       sizeof(cl_mem), sizeof(cl_mem)};
+  void *argValue[5] = {&D5, &D6, &capacity, &D3, &D7};
+  timed_kernel_handshake("hashGroupBy_rank_kernel", 57, 5, argSize, argValue,
+                         _HandShakeCPU_GPU, _HandShakeKernel);
+}
+
+void hashGroupBy_scatter_kernel_handshake(int _HandShakeCPU_GPU,
+                                          cl_kernel *_HandShakeKernel) {
+  int capacity = HASH_GROUPBY_CAPACITY;
+  double i;
+  double sum = 0;
+  printf("Kid%d", 58);
+  hashGroupBy_handshake_prepare(2, _HandShakeCPU_GPU, _HandShakeKernel);
+  // the cursors in D1 are reset before each run, the records go to D4.
+  size_t argSize[8] = {sizeof(cl_mem), sizeof(cl_int), sizeof(cl_mem),
+                       sizeof(cl_int), sizeof(cl_mem), sizeof(cl_mem),
+                       sizeof(cl_mem), sizeof(cl_mem)};
+  void *argValue[8] = {&D2, &rLen, &D5, &capacity, &D3, &D7, &D1, &D4};
+  for (i = 0; i < Count; i++) {
+    cl_writebuffer(D1, H6, sizeof(int) * (capacity + 1), _HandShakeCPU_GPU);
+    sum += launch_kernel_handshake("hashGroupBy_scatter_kernel", 58, 8,
+                                   argSize, argValue, _HandShakeCPU_GPU,
+                                   _HandShakeKernel);
+  }
+  record_kernel_handshake("hashGroupBy_scatter_kernel", 58, sum,
+                          _HandShakeCPU_GPU);
+}
+
+// the partials of the 8 work groups go to D3, D5 and D6.
+void multiAgg_kernel_handshake(int _HandShakeCPU_GPU,
+                               cl_kernel *_HandShakeKernel) {
+  size_t argSize[8] = {sizeof(cl_mem),        sizeof(cl_int),
+                       sizeof(cl_mem),        sizeof(cl_mem),
+                       sizeof(cl_mem),        sizeof(cl_long) * 256,
+                       sizeof(cl_int) * 256, sizeof(cl_int) * 256};
+  void *argValue[8] = {&D1, &rLen, &D3, &D5, &D6, NULL, NULL, NULL};
+  timed_kernel_handshake("multiAgg_kernel", 59, 8, argSize, argValue,
+                         _HandShakeCPU_GPU, _HandShakeKernel);
+}
+
+// D1 is cut into 1024 groups of the same size, their rids lead to D2. the
+// records of all the aggregates go to D3.
+void multiAggAfterGroupBy_kernel_handshake(int _HandShakeCPU_GPU,
+                                           cl_kernel *_HandShakeKernel) {
+  int numGroups = 1024;
+  int aggMask = (1 << MULTI_AGG_NUM) - 1;
+  int numAgg = MULTI_AGG_NUM;
+  for (int g = 0; g < numGroups; g++)
+    ((int *)H6)[g] = g * (rLen / numGroups);
+  cl_writebuffer(D7, H6, sizeof(int) * numGroups, _HandShakeCPU_GPU);
+  size_t argSize[11] = {sizeof(cl_mem),       sizeof(cl_int),
+                        sizeof(cl_mem),       sizeof(cl_int),
+                        sizeof(cl_mem),       sizeof(cl_int),
+                        sizeof(cl_int),       sizeof(cl_mem),
+                        sizeof(cl_long) * 256, sizeof(cl_int) * 256,
+                        sizeof(cl_int) * 256};
+  void *argValue[11] = {&D1,     &rLen, &D7,  &numGroups, &D2, &aggMask,
+                        &numAgg, &D3,   NULL, NULL,       NULL};
+  timed_kernel_handshake("multiAggAfterGroupBy_kernel", 60, 11, argSize,
+                         argValue, _HandShakeCPU_GPU, _HandShakeKernel);
+}
+
+// the first pass of the k largest over D1, the histogram goes to D7.
+void topK_histogram_kernel_handshake(int _HandShakeCPU_GPU,
+                                     cl_kernel *_HandShakeKernel) {
+  int largest = 1;
+  cl_ulong prefix = 0;
+  cl_ulong prefixMask = 0;
+  int shift = 56;
+  size_t argSize[8] = {sizeof(cl_mem),   sizeof(cl_int), sizeof(cl_int),
+                       sizeof(cl_ulong), sizeof(cl_ulong), sizeof(cl_int),
+                       sizeof(cl_mem),   sizeof(cl_int) * 256};
+  void *argValue[8] = {&D1,         &rLen,  &largest, &prefix,
+                       &prefixMask, &shift, &D7,      NULL};
+  timed_kernel_handshake("topK_histogram_kernel", 61, 8, argSize, argValue,
+                         _HandShakeCPU_GPU, _HandShakeKernel);
+}
+
+// the larger half of D1 goes to D3, D7 counts the records.
+void topK_write_kernel_handshake(int _HandShakeCPU_GPU,
+                                 cl_kernel *_HandShakeKernel) {
+  int largest = 1;
+  cl_ulong threshold = ((cl_ulong)0x80000000u) << 32;
+  int k = rLen / 2;
+  memset(H6, 0, sizeof(int));
+  cl_writebuffer(D7, H6, sizeof(int), _HandShakeCPU_GPU);
+  size_t argSize[7] = {sizeof(cl_mem), sizeof(cl_int), sizeof(cl_int),
+                       sizeof(cl_ulong), sizeof(cl_int), sizeof(cl_mem),
+                       sizeof(cl_mem)};
+  void *argValue[7] = {&D1, &rLen, &largest, &threshold, &k, &D7, &D3};
+  timed_kernel_handshake("topK_write_kernel", 62, 7, argSize, argValue,
+                         _HandShakeCPU_GPU, _HandShakeKernel);
+}
+
+// the tuples are a record of D1 and one of D2. the first half of the rows goes
+// into a set of rLen slots in D5, emptied before each run as the counter in D7.
+void distinct_insert_kernel_handshake(int _HandShakeCPU_GPU,
+                                      cl_kernel *_HandShakeKernel) {
+  int numOther = 1;
+  int numRow = rLen / 2;
+  int capacity = rLen;
+  double i;
+  double sum = 0;
+  printf("Kid%d", 63);
+  for (int s = 0; s < capacity; s++)
+    ((int *)H5)[s] = DISTINCT_EMPTY;
+  memset(H6, 0, sizeof(int));
+  size_t argSize[8] = {sizeof(cl_mem), sizeof(cl_mem), sizeof(cl_int),
+                       sizeof(cl_int), sizeof(cl_mem), sizeof(cl_int),
+                       sizeof(cl_mem), sizeof(cl_mem)};
+  void *argValue[8] = {&D1, &D2, &numOther, &numRow, &D5, &capacity, &D7, &D3};
+  for (i = 0; i < Count; i++) {
+    cl_writebuffer(D5, H5, sizeof(int) * capacity, _HandShakeCPU_GPU);
+    cl_writebuffer(D7, H6, sizeof(int), _HandShakeCPU_GPU);
+    sum += launch_kernel_handshake("distinct_insert_kernel", 63, 8, argSize,
+                                   argValue, _HandShakeCPU_GPU,
+                                   _HandShakeKernel);
+  }
+  record_kernel_handshake("distinct_insert_kernel", 63, sum,
+                          _HandShakeCPU_GPU);
+}
+
+// D1 in groups of two records, their starts in D7.
+void distinct_gatherFirst_kernel_handshake(int _HandShakeCPU_GPU,
+                                           cl_kernel *_HandShakeKernel) {
+  int numGroup = rLen / 2;
+  for (int g = 0; g < numGroup; g++)
+    ((int *)H5)[g] = g * 2;
+  cl_writebuffer(D7, H5, sizeof(int) * numGroup, _HandShakeCPU_GPU);
+  size_t argSize[4] = {sizeof(cl_mem), sizeof(cl_mem), sizeof(cl_int),
+                       sizeof(cl_mem)};
+  void *argValue[4] = {&D1, &D7, &numGroup, &D3};
+  timed_kernel_handshake("distinct_gatherFirst_kernel", 64, 4, argSize,
+                         argValue, _HandShakeCPU_GPU, _HandShakeKernel);
+}
+
+void distinct_hashKey_kernel_handshake(int _HandShakeCPU_GPU,
+                                       cl_kernel *_HandShakeKernel) {
+  int numOther = 1;
+  size_t argSize[5] = {sizeof(cl_mem), sizeof(cl_mem), sizeof(cl_int),
+                       sizeof(cl_int), sizeof(cl_mem)};
+  void *argValue[5] = {&D1, &D2, &numOther, &rLen, &D3};
+  timed_kernel_handshake("distinct_hashKey_kernel", 65, 5, argSize, argValue,
+                         _HandShakeCPU_GPU, _HandShakeKernel);
+}
+
+// D1 read as the sorted rows, in runs of two starting in D7; the counter in
+// D6 is emptied before each run.
+void distinct_firstInRun_kernel_handshake(int _HandShakeCPU_GPU,
+                                          cl_kernel *_HandShakeKernel) {
+  int numOther = 1;
+  int numRun = rLen / 2;
+  double i;
+  double sum = 0;
+  printf("Kid%d", 66);
+  for (int g = 0; g < numRun; g++)
+    ((int *)H5)[g] = g * 2;
+  cl_writebuffer(D7, H5, sizeof(int) * numRun, _HandShakeCPU_GPU);
+  memset(H6, 0, sizeof(int));
+  size_t argSize[9] = {sizeof(cl_mem), sizeof(cl_mem), sizeof(cl_int),
+                       sizeof(cl_int), sizeof(cl_mem), sizeof(cl_mem),
+                       sizeof(cl_int), sizeof(cl_mem), sizeof(cl_mem)};
+  void *argValue[9] = {&D1, &D2,     &numOther, &rLen, &D1,
+                       &D7, &numRun, &D6,       &D3};
+  for (i = 0; i < Count; i++) {
+    cl_writebuffer(D6, H6, sizeof(int), _HandShakeCPU_GPU);
+    sum += launch_kernel_handshake("distinct_firstInRun_kernel", 66, 9,
+                                   argSize, argValue, _HandShakeCPU_GPU,
+                                   _HandShakeKernel);
+  }
+  record_kernel_handshake("distinct_firstInRun_kernel", 66, sum,
+                          _HandShakeCPU_GPU);
+}
+
+// a tile per work group of the launch, the ints of D5 are scanned into D6 and
+// the status words are in D7; each run continues the ticket count of the last.
+void scanSinglePass_kernel_handshake(int _HandShakeCPU_GPU,
+                                     cl_kernel *_HandShakeKernel) {
+  int numTile = 32 * 64 / SCAN_TILE_THREAD;
+  int numValue = numTile * SCAN_TILE_SIZE;
+  cl_uint ticketBase = 0;
+  cl_uint epoch = 0;
+  double i;
+  double sum = 0;
+  printf("Kid%d", 67);
+  memset(H6, 0, sizeof(int) * (1 + 3 * numTile));
+  cl_writebuffer(D7, H6, sizeof(int) * (1 + 3 * numTile), _HandShakeCPU_GPU);
+  size_t argSize[8] = {sizeof(cl_mem),  sizeof(cl_mem),
+                       sizeof(cl_int),  sizeof(cl_mem),
+                       sizeof(cl_uint), sizeof(cl_uint),
+                       sizeof(cl_int) * SCAN_TILE_THREAD, sizeof(cl_int) * 3};
+  void *argValue[8] = {&D5, &D6, &numValue, &D7, &ticketBase, &epoch, NULL,
+                       NULL};
+  for (i = 0; i < Count; i++) {
+    epoch++;
+    sum += launch_kernel_handshake("scanSinglePass_kernel", 67, 8, argSize,
+                                   argValue, _HandShakeCPU_GPU,
+                                   _HandShakeKernel);
+    ticketBase += numTile;
+  }
+  record_kernel_handshake("scanSinglePass_kernel", 67, sum, _HandShakeCPU_GPU);
+}
+
+// selects half of D1 into D3, the output count in D7 is emptied before each run.
+void filterImpl_fused_kernel_handshake(int _HandShakeCPU_GPU,
+                                       cl_kernel *_HandShakeKernel) {
+  int beginPos = 0;
+  int smallKey = 0;
+  int largeKey = TEST_MAX / 2;
+  int outCap = rLen;
+  double i;
+  double sum = 0;
+  printf("Kid%d", 68);
+  memset(H6, 0, sizeof(int));
+  size_t argSize[8] = {sizeof(cl_mem), sizeof(cl_int), sizeof(cl_int),
+                       sizeof(cl_int), sizeof(cl_int), sizeof(cl_mem),
+                       sizeof(cl_int), sizeof(cl_mem)};
+  void *argValue[8] = {&D1,       &beginPos, &rLen,   &smallKey,
+                       &largeKey, &D3,       &outCap, &D7};
+  for (i = 0; i < Count; i++) {
+    cl_writebuffer(D7, H6, sizeof(int), _HandShakeCPU_GPU);
+    sum += launch_kernel_handshake("filterImpl_fused_kernel", 68, 8, argSize,
+                                   argValue, _HandShakeCPU_GPU,
+                                   _HandShakeKernel);
+  }
+  record_kernel_handshake("filterImpl_fused_kernel", 68, sum,
+                          _HandShakeCPU_GPU);
+}
+
+// the generated kernels are timed on the shape of a range selection over D1,
+// built as any other predicate.
+#define HANDSHAKE_PREDICATE "col0[pos].y>=c0 && col0[pos].y<=c1"
+static void timed_predicate_handshake(const char *name, int kid, int numArg,
+                                      const size_t *argSize, void **argValue,
+                                      int _HandShakeCPU_GPU,
+                                      cl_kernel *_HandShakeKernel) {
+  size_t numThreadsPerBlock_x = 256;
+  size_t globalWorkingSetSize = 32 * 64;
+  double i;
+  double sum = 0;
+  printf("Kid%d", kid);
+  cl_program program = predicate_getProgram(HANDSHAKE_PREDICATE, 1, 2);
+  if (program == NULL)
+    return;
+  for (i = 0; i < Count; i++) {
+    // the selection count is emptied before each run.
+    cl_writebuffer(D7, H6, sizeof(int), _HandShakeCPU_GPU);
+    int timer = DLL_genTimer(kid);
+    DLL_getTimer(timer);
+    cl_int ciErr1;
+    (*_HandShakeKernel) = clCreateKernel(program, name, &ciErr1);
+    for (int a = 0; a < numArg; a++)
+      ciErr1 |= clSetKernelArg((*_HandShakeKernel), a, argSize[a], argValue[a]);
+    if (ciErr1 != CL_SUCCESS) {
+      printf("Error in clSetKernelArg, Line %u in file %s !!!\n\n", __LINE__,
+             __FILE__);
+      cl_clean(EXIT_FAILURE);
+    }
+    cl_launchKernel(1, &globalWorkingSetSize, &numThreadsPerBlock_x,
+                    _HandShakeKernel, _HandShakeCPU_GPU);
+    sum += DLL_getTimer(timer);
+    clReleaseKernel(*_HandShakeKernel);
+  }
+  clReleaseProgram(program);
+  record_kernel_handshake(name, kid, sum, _HandShakeCPU_GPU);
+}
+
+// selects the lower half of D1 into D3, counted in D7.
+void predicate_kernel_handshake(int _HandShakeCPU_GPU,
+                                cl_kernel *_HandShakeKernel) {
+  int smallKey = 0;
+  int largeKey = TEST_MAX / 2;
+  memset(H6, 0, sizeof(int));
+  size_t argSize[6] = {sizeof(cl_int), sizeof(cl_mem), sizeof(cl_mem),
+                       sizeof(cl_mem), sizeof(cl_int), sizeof(cl_int)};
+  void *argValue[6] = {&rLen, &D3, &D7, &D1, &smallKey, &largeKey};
+  timed_predicate_handshake("predicate_kernel", 69, 6, argSize, argValue,
+                            _HandShakeCPU_GPU, _HandShakeKernel);
+}
+
+// the bitmap of the same selection goes to D5.
+void predicate_bitmap_kernel_handshake(int _HandShakeCPU_GPU,
+                                       cl_kernel *_HandShakeKernel) {
+  int smallKey = 0;
+  int largeKey = TEST_MAX / 2;
+  memset(H6, 0, sizeof(int));
+  size_t argSize[5] = {sizeof(cl_int), sizeof(cl_mem), sizeof(cl_mem),
+                       sizeof(cl_int), sizeof(cl_int)};
+  void *argValue[5] = {&rLen, &D5, &D1, &smallKey, &largeKey};
+  timed_predicate_handshake("predicate_bitmap_kernel", 70, 5, argSize,
+                            argValue, _HandShakeCPU_GPU, _HandShakeKernel);
+}
+
+// the typed kernels are timed on their int instances. D5 holds the values and
+// D6 the rids of a gather, every value and rid in range.
+static void typed_handshake_prepare(int _HandShakeCPU_GPU) {
+  for (int i = 0; i < rLen; i++) {
+    ((int *)H5)[i] = i;
+    ((int *)H6)[rLen - 1 - i] = i;
+  }
+  cl_writebuffer(D5, H5, sizeof(int) * rLen, _HandShakeCPU_GPU);
+  cl_writebuffer(D6, H6, sizeof(int) * rLen, _HandShakeCPU_GPU);
+}
+
+void typed_gather_kernel_handshake(int _HandShakeCPU_GPU,
+                                   cl_kernel *_HandShakeKernel) {
+  typed_handshake_prepare(_HandShakeCPU_GPU);
+  size_t argSize[4] = {sizeof(cl_mem), sizeof(cl_mem), sizeof(cl_int),
+                       sizeof(cl_mem)};
+  void *argValue[4] = {&D5, &D6, &rLen, &D7};
+  timed_kernel_handshake("typed_gather_kernel_int", 71, 4, argSize, argValue,
+                         _HandShakeCPU_GPU, _HandShakeKernel);
+}
+
+// a sum, the partials of the 8 work groups go to D3.
+void typed_reduce_kernel_handshake(int _HandShakeCPU_GPU,
+                                   cl_kernel *_HandShakeKernel) {
+  int op = TYPED_AGG_SUM;
+  typed_handshake_prepare(_HandShakeCPU_GPU);
+  size_t argSize[5] = {sizeof(cl_mem), sizeof(cl_int), sizeof(cl_int),
+                       sizeof(cl_mem), sizeof(cl_long) * 256};
+  void *argValue[5] = {&D5, &rLen, &op, &D3, NULL};
+  timed_kernel_handshake("typed_reduce_kernel_int", 72, 5, argSize, argValue,
+                         _HandShakeCPU_GPU, _HandShakeKernel);
+}
+
+// the bitmap of the lower half of D5 goes to D6.
+void typed_rangeSelection_kernel_handshake(int _HandShakeCPU_GPU,
+                                           cl_kernel *_HandShakeKernel) {
+  int low = 0;
+  int high = rLen / 2;
+  typed_handshake_prepare(_HandShakeCPU_GPU);
+  size_t argSize[5] = {sizeof(cl_mem), sizeof(cl_int), sizeof(cl_int),
+                       sizeof(cl_int), sizeof(cl_mem)};
+  void *argValue[5] = {&D5, &rLen, &low, &high, &D6};
+  timed_kernel_handshake("typed_rangeSelection_kernel_int", 73, 5, argSize,
+                         argValue, _HandShakeCPU_GPU, _HandShakeKernel);
+}
+
+// the keys of D5 into the 2*rLen slots of D3, emptied before each run.
+void typed_hashBuild_kernel_handshake(int _HandShakeCPU_GPU,
+                                      cl_kernel *_HandShakeKernel) {
+  int mask = rLen * TYPED_HASH_LOAD - 1;
+  double i;
+  double sum = 0;
+  printf("Kid%d", 74);
+  typed_handshake_prepare(_HandShakeCPU_GPU);
+  memset(H3, 0xff, sizeof(int) * (mask + 1));
+  size_t argSize[4] = {sizeof(cl_mem), sizeof(cl_int), sizeof(cl_mem),
+                       sizeof(cl_int)};
+  void *argValue[4] = {&D5, &rLen, &D3, &mask};
+  for (i = 0; i < Count; i++) {
+    cl_writebuffer(D3, H3, sizeof(int) * (mask + 1), _HandShakeCPU_GPU);
+    sum += launch_kernel_handshake("typed_hashBuild_kernel_int", 74, 4,
+                                   argSize, argValue, _HandShakeCPU_GPU,
+                                   _HandShakeKernel);
+  }
+  record_kernel_handshake("typed_hashBuild_kernel_int", 74, sum,
+                          _HandShakeCPU_GPU);
+}
+
+// D5 is built into D3 once and probed with itself, the counting pass; the
+// counts go to D6.
+void typed_hashProbe_kernel_handshake(int _HandShakeCPU_GPU,
+                                      cl_kernel *_HandShakeKernel) {
+  int mask = rLen * TYPED_HASH_LOAD - 1;
+  int toWrite = 0;
+  int hasRID = 0;
+  typed_handshake_prepare(_HandShakeCPU_GPU);
+  memset(H3, 0xff, sizeof(int) * (mask + 1));
+  cl_writebuffer(D3, H3, sizeof(int) * (mask + 1), _HandShakeCPU_GPU);
+  size_t buildSize[4] = {sizeof(cl_mem), sizeof(cl_int), sizeof(cl_mem),
+                         sizeof(cl_int)};
+  void *buildValue[4] = {&D5, &rLen, &D3, &mask};
+  launch_kernel_handshake("typed_hashBuild_kernel_int", 74, 4, buildSize,
+                          buildValue, _HandShakeCPU_GPU, _HandShakeKernel);
+  size_t argSize[13] = {sizeof(cl_mem), sizeof(cl_mem), sizeof(cl_int),
+                        sizeof(cl_mem), sizeof(cl_int), sizeof(cl_int),
+                        sizeof(cl_mem), sizeof(cl_mem), sizeof(cl_mem),
+                        sizeof(cl_int), sizeof(cl_mem), sizeof(cl_int),
+                        sizeof(cl_mem)};
+  void *argValue[13] = {&D5, &D3, &mask,   &D5, &rLen,   &toWrite, &D6,
+                        &D7, &D5, &hasRID, &D5, &hasRID, &D3};
+  timed_kernel_handshake("typed_hashProbe_kernel_int", 75, 13, argSize,
+                         argValue, _HandShakeCPU_GPU, _HandShakeKernel);
+}
+
+// a FOR column of 16 bits, the words of D5; FOR has no aux buffer, D5 stands
+// in for it as it does in Compression.cpp.
+static int packedScheme = PACK_FOR;
+static int packedWidth = 16;
+
+// the records at the rids of D6 go to D3.
+void packed_decode_kernel_handshake(int _HandShakeCPU_GPU,
+                                    cl_kernel *_HandShakeKernel) {
+  int base = 0;
+  int numAux = 0;
+  int hasRIDList = 1;
+  typed_handshake_prepare(_HandShakeCPU_GPU);
+  size_t argSize[10] = {sizeof(cl_int), sizeof(cl_int), sizeof(cl_int),
+                        sizeof(cl_mem), sizeof(cl_mem), sizeof(cl_int),
+                        sizeof(cl_mem), sizeof(cl_int), sizeof(cl_int),
+                        sizeof(cl_mem)};
+  void *argValue[10] = {&packedScheme, &packedWidth, &base,       &D5,   &D5,
+                        &numAux,       &D6,          &hasRIDList, &rLen, &D3};
+  timed_kernel_handshake("packed_decode_kernel", 76, 10, argSize, argValue,
+                         _HandShakeCPU_GPU, _HandShakeKernel);
+}
+
+// the bitmap of the lower half of the codes goes to D7.
+void packed_rangeSelection_kernel_handshake(int _HandShakeCPU_GPU,
+                                            cl_kernel *_HandShakeKernel) {
+  int numAux = 0;
+  cl_long low = 0;
+  cl_long high = 1 << (packedWidth - 1);
+  typed_handshake_prepare(_HandShakeCPU_GPU);
+  size_t argSize[9] = {sizeof(cl_int),  sizeof(cl_int),  sizeof(cl_mem),
+                       sizeof(cl_mem),  sizeof(cl_int),  sizeof(cl_int),
+                       sizeof(cl_long), sizeof(cl_long), sizeof(cl_mem)};
+  void *argValue[9] = {&packedScheme, &packedWidth, &D5,   &D5, &numAux,
+                       &rLen,         &low,         &high, &D7};
+  timed_kernel_handshake("packed_rangeSelection_kernel", 77, 9, argSize,
+                         argValue, _HandShakeCPU_GPU, _HandShakeKernel);
+}
+
+// a sum, the partials of the 8 work groups go to D3.
+void packed_reduce_kernel_handshake(int _HandShakeCPU_GPU,
+                                    cl_kernel *_HandShakeKernel) {
+  int base = 0;
+  int numAux = 0;
+  int op = TYPED_AGG_SUM;
+  typed_handshake_prepare(_HandShakeCPU_GPU);
+  size_t argSize[10] = {sizeof(cl_int), sizeof(cl_int), sizeof(cl_int),
+                        sizeof(cl_mem), sizeof(cl_mem), sizeof(cl_int),
+                        sizeof(cl_int), sizeof(cl_int), sizeof(cl_mem),
+                        sizeof(cl_long) * 256};
+  void *argValue[10] = {&packedScheme, &packedWidth, &base, &D5, &D5,
+                        &numAux,       &rLen,        &op,   &D3, NULL};
+  timed_kernel_handshake("packed_reduce_kernel", 78, 10, argSize, argValue,
+                         _HandShakeCPU_GPU, _HandShakeKernel);
+}
+
+// one group per record, the group of D5[i] starts at i; the records go to D3.
+void groupResult_kernel_handshake(int _HandShakeCPU_GPU,
+                                  cl_kernel *_HandShakeKernel) {
+  typed_handshake_prepare(_HandShakeCPU_GPU);
+  size_t argSize[5] = {sizeof(cl_mem), sizeof(cl_mem), sizeof(cl_mem),
+                       sizeof(cl_int), sizeof(cl_mem)};
+  void *argValue[5] = {&D1, &D5, &D6, &rLen, &D3};
+  timed_kernel_handshake("groupResult_kernel", 79, 5, argSize, argValue,
+                         _HandShakeCPU_GPU, _HandShakeKernel);
+}
+
+// the largest sketch, 2^SKETCH_HLL_MAX_P registers in D5, over the records of
+// D1. A register only grows, so a run on the registers of the last one costs
+// the same.
+void hll_build_kernel_handshake(int _HandShakeCPU_GPU,
+                                cl_kernel *_HandShakeKernel) {
+  int p = SKETCH_HLL_MAX_P;
+  memset(H5, 0, sizeof(int) * (1 << p));
+  cl_writebuffer(D5, H5, sizeof(int) * (1 << p), _HandShakeCPU_GPU);
+  size_t argSize[5] = {sizeof(cl_mem), sizeof(cl_int), sizeof(cl_int),
+                       sizeof(cl_mem), sizeof(cl_int) * (1 << p)};
+  void *argValue[5] = {&D1, &rLen, &p, &D5, NULL};
+  timed_kernel_handshake("hll_build_kernel", 80, 5, argSize, argValue,
+                         _HandShakeCPU_GPU, _HandShakeKernel);
+}
+
+// the bins of the finest sketch in D5 over the records of D1, emptied before
+// each run.
+void quantileSketch_build_kernel_handshake(int _HandShakeCPU_GPU,
+                                           cl_kernel *_HandShakeKernel) {
+  cl_float invLogGamma = sketch_invLogGamma(SKETCH_MIN_ALPHA);
+  int maxBucket = sketch_maxBucket(SKETCH_MIN_ALPHA);
+  int numBin = sketch_numBin(SKETCH_MIN_ALPHA);
+  double i;
+  double sum = 0;
+  printf("Kid%d", 81);
+  memset(H5, 0, sizeof(int) * numBin);
+  size_t argSize[6] = {sizeof(cl_mem),   sizeof(cl_int),
+                       sizeof(cl_float), sizeof(cl_int),
+                       sizeof(cl_mem),   sizeof(cl_int) * numBin};
+  void *argValue[6] = {&D1, &rLen, &invLogGamma, &maxBucket, &D5, NULL};
+  for (i = 0; i < Count; i++) {
+    cl_writebuffer(D5, H5, sizeof(int) * numBin, _HandShakeCPU_GPU);
+    sum += launch_kernel_handshake("quantileSketch_build_kernel", 81, 6,
+                                   argSize, argValue, _HandShakeCPU_GPU,
+                                   _HandShakeKernel);
+  }
+  record_kernel_handshake("quantileSketch_build_kernel", 81, sum,
+                          _HandShakeCPU_GPU);
+}
+
+// the max of the records of D1 into D3, the partials of the 8 work groups
+// behind the ticket counter D5[0], which is zeroed before each run.
+void reduceSinglePass_kernel_handshake(int _HandShakeCPU_GPU,
+                                       cl_kernel *_HandShakeKernel) {
+  int op = REDUCE_MAX;
+  int ticket = 0;
+  double i;
+  double sum = 0;
+  printf("Kid%d", 82);
+  size_t argSize[7] = {sizeof(cl_mem), sizeof(cl_int), sizeof(cl_int),
+                       sizeof(cl_mem), sizeof(cl_mem), sizeof(cl_int) * 256,
+                       sizeof(cl_int)};
+  void *argValue[7] = {&D1, &rLen, &op, &D5, &D3, NULL, NULL};
+  for (i = 0; i < Count; i++) {
+    cl_writebuffer(D5, &ticket, sizeof(int), _HandShakeCPU_GPU);
+    sum += launch_kernel_handshake("reduceSinglePass_kernel", 82, 7, argSize,
+                                   argValue, _HandShakeCPU_GPU,
+                                   _HandShakeKernel);
+  }
+  record_kernel_handshake("reduceSinglePass_kernel", 82, sum,
+                          _HandShakeCPU_GPU);
+}
@@ -24,6 +24,10 @@ void countHist_kernel_handshake(int HandShakeCPU_GPU,cl_kernel *HandShakeKernel)
 void writeHist_kernel_handshake(int HandShakeCPU_GPU,cl_kernel *HandShakeKernel);
 void getBound_kernel_handshake(int HandShakeCPU_GPU,cl_kernel *HandShakeKernel);
 void BitonicSort_kernel_handshake(int HandShakeCPU_GPU,cl_kernel *HandShakeKernel);
+void mergeSort_blockSort_kernel_handshake(int HandShakeCPU_GPU,cl_kernel *HandShakeKernel);
+void mergeSort_merge_kernel_handshake(int HandShakeCPU_GPU,cl_kernel *HandShakeKernel);
+void mergeJoin_count_kernel_handshake(int HandShakeCPU_GPU,cl_kernel *HandShakeKernel);
+void mergeJoin_write_kernel_handshake(int HandShakeCPU_GPU,cl_kernel *HandShakeKernel);
 void memset_int_kernel_handshake(int HandShakeCPU_GPU, cl_kernel  *HandShakeKernel);
 void mapImpl_kernel_handshake(int HandShakeCPU_GPU, cl_kernel  *HandShakeKernel);
 
@@ -49,3 +53,48 @@ void joinMBWrite_kernel_handshake(int HandShakeCPU_GPU, cl_kernel  *HandShakeKer
 
 void build_kernel_handshake(int HandShakeCPU_GPU, cl_kernel  *HandShakeKernel);
 void probe_kernel_handshake(int HandShakeCPU_GPU, cl_kernel  *HandShakeKernel);
+
+void bitmap_rangeSelection_kernel_handshake(int HandShakeCPU_GPU, cl_kernel  *HandShakeKernel);
+void bitmap_combine_kernel_handshake(int HandShakeCPU_GPU, cl_kernel  *HandShakeKernel);
+void bitmap_count_kernel_handshake(int HandShakeCPU_GPU, cl_kernel  *HandShakeKernel);
+void bitmap_toRIDList_kernel_handshake(int HandShakeCPU_GPU, cl_kernel  *HandShakeKernel);
+void bitmap_total_kernel_handshake(int HandShakeCPU_GPU, cl_kernel  *HandShakeKernel);
+
+void hashGroupBy_build_kernel_handshake(int HandShakeCPU_GPU, cl_kernel  *HandShakeKernel);
+void hashGroupBy_rank_kernel_handshake(int HandShakeCPU_GPU, cl_kernel  *HandShakeKernel);
+void hashGroupBy_scatter_kernel_handshake(int HandShakeCPU_GPU, cl_kernel  *HandShakeKernel);
+
+void multiAgg_kernel_handshake(int HandShakeCPU_GPU, cl_kernel  *HandShakeKernel);
+void multiAggAfterGroupBy_kernel_handshake(int HandShakeCPU_GPU, cl_kernel  *HandShakeKernel);
+
+void topK_histogram_kernel_handshake(int HandShakeCPU_GPU, cl_kernel  *HandShakeKernel);
+void topK_write_kernel_handshake(int HandShakeCPU_GPU, cl_kernel  *HandShakeKernel);
+
+void distinct_insert_kernel_handshake(int HandShakeCPU_GPU, cl_kernel  *HandShakeKernel);
+void distinct_gatherFirst_kernel_handshake(int HandShakeCPU_GPU, cl_kernel  *HandShakeKernel);
+void distinct_hashKey_kernel_handshake(int HandShakeCPU_GPU, cl_kernel  *HandShakeKernel);
+void distinct_firstInRun_kernel_handshake(int HandShakeCPU_GPU, cl_kernel  *HandShakeKernel);
+
+void scanSinglePass_kernel_handshake(int HandShakeCPU_GPU, cl_kernel  *HandShakeKernel);
+
+void filterImpl_fused_kernel_handshake(int HandShakeCPU_GPU, cl_kernel  *HandShakeKernel);
+
+void predicate_kernel_handshake(int HandShakeCPU_GPU, cl_kernel  *HandShakeKernel);
+void predicate_bitmap_kernel_handshake(int HandShakeCPU_GPU, cl_kernel  *HandShakeKernel);
+
+void typed_gather_kernel_handshake(int HandShakeCPU_GPU, cl_kernel  *HandShakeKernel);
+void typed_reduce_kernel_handshake(int HandShakeCPU_GPU, cl_kernel  *HandShakeKernel);
+void typed_rangeSelection_kernel_handshake(int HandShakeCPU_GPU, cl_kernel  *HandShakeKernel);
+void typed_hashBuild_kernel_handshake(int HandShakeCPU_GPU, cl_kernel  *HandShakeKernel);
+void typed_hashProbe_kernel_handshake(int HandShakeCPU_GPU, cl_kernel  *HandShakeKernel);
+
+void packed_decode_kernel_handshake(int HandShakeCPU_GPU, cl_kernel  *HandShakeKernel);
+void packed_rangeSelection_kernel_handshake(int HandShakeCPU_GPU, cl_kernel  *HandShakeKernel);
+void packed_reduce_kernel_handshake(int HandShakeCPU_GPU, cl_kernel  *HandShakeKernel);
+
+void groupResult_kernel_handshake(int HandShakeCPU_GPU, cl_kernel  *HandShakeKernel);
+
+void hll_build_kernel_handshake(int HandShakeCPU_GPU, cl_kernel  *HandShakeKernel);
+void quantileSketch_build_kernel_handshake(int HandShakeCPU_GPU, cl_kernel  *HandShakeKernel);
+
+void reduceSinglePass_kernel_handshake(int HandShakeCPU_GPU, cl_kernel  *HandShakeKernel);
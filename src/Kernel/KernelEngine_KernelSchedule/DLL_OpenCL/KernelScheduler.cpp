@@ -1,6 +1,7 @@
 #include "KernelScheduler.h"
 #include "Helper.h"
 #include "MyThreadPoolCop.h"
+#include "Residency.h"
 #include "common.h"
 #include "scheduler.h"
 
@@ -22,10 +23,10 @@ extern double
     AddGPUBurden_Write; //->initial in handshaking. fix rLen to 1024*1024
 extern double AddCPUBurden_Write;
 extern double
-    AddGPUBurden[58]; //->initial in handshaking. fix rLen to 1024*1024
+    AddGPUBurden[NUM_KERNEL_ID]; //->initial in handshaking. fix rLen to 1024*1024
 extern double
-    AddCPUBurden[58]; //->initial in handshaking. fix rLen to 1024*1024
-extern double speedupGPUoverCPU[58];
+    AddCPUBurden[NUM_KERNEL_ID]; //->initial in handshaking. fix rLen to 1024*1024
+extern double speedupGPUoverCPU[NUM_KERNEL_ID + 3];
 extern double LothresholdForGPUApp;
 extern double LothresholdForCPUApp;
 extern double LoGPUBurden;
@@ -103,8 +104,18 @@ void kernel_enqueue(int size, int kid, cl_uint work_dim, const size_t *groups,
 	printf("CPUBurden is %lf,,GPUBurden is %lf\n",CPUBurden,GPUBurden);
 
 #endif
-  CPU_GPU = Kernelscheduler(size, kid, Flag_CPU_GPU, burden, _CPU_GPU);
+  /*the previous kernel of this chain wrote the input, stay there if cheaper;
+   * the first kernel goes by the inputs set with residence_setInputs*/
+  int residence =
+      ((*index) != 0) ? preFlag : residence_inputDevice();
+  CPU_GPU =
+      Kernelscheduler(size, kid, residence, Flag_CPU_GPU, burden, _CPU_GPU);
   (*Flag_CPU_GPU) = CPU_GPU;
+  if ((*index) == 0)
+    residence_migrateInputs(CPU_GPU);
+  else if (residence != CPU_GPU)
+    residence_count((size_t)size * sizeof(Record));
+  residence_setLastDevice(CPU_GPU);
   cl_int ciErr1;
   if (CPU_GPU && threads[0] > 256) {
     // printf("!!!exceed GPU limit:max work item is 256!\n");
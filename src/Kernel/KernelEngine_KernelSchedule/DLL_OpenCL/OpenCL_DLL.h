@@ -32,12 +32,22 @@ void DLL_EXPORT CL_DESTORY(cl_mem *mem);
 void DLL_EXPORT CopyCPUToGPU(cl_mem to, void* from, size_t size);
 void DLL_EXPORT CopyGPUToCPU(cl_mem from, void* to, size_t size);
 void DLL_EXPORT CopyGPUToGPU(cl_mem from, cl_mem to, size_t size);
+void DLL_EXPORT CopyGPUToGPU(cl_mem from, size_t fromOffset, cl_mem to, size_t toOffset, size_t size);
+void DLL_EXPORT CL_SubBuffer(cl_mem mem, size_t offset, size_t size, cl_mem* sub);
 extern "C" void DLL_EXPORT CL_setRIDList(cl_mem h_RIDList, int rLen, cl_mem h_destRin, int numThreadPB, int numBlock,int _CPU_GPU);
 extern "C" void DLL_EXPORT CL_getRIDList( cl_mem h_Rin, int rLen, cl_mem* h_RIDList,int numThreadPB, int numBlock,int _CPU_GPU);
 extern "C" void DLL_EXPORT CL_setValueList(cl_mem h_ValueList, int rLen, cl_mem h_destRin, int numThreadPB, int numBlock,int _CPU_GPU);
 extern "C" void DLL_EXPORT CL_RadixSortOnly(cl_mem d_Rin, int rLen,int numThread, int numBlock, int _CPU_GPU);
 extern "C" void DLL_EXPORT CL_BitonicSortOnly(cl_mem d_Rin, int rLen,cl_mem d_Rout,int numThread, int numBlock, int _CPU_GPU);
+//ORDER BY ... LIMIT k: the k largest records (the k smallest if largest is 0) to d_Rout in order, returns their number.
+extern "C" int DLL_EXPORT CL_TopKOnly(cl_mem d_Rin, int rLen, int k, int largest, cl_mem* d_Rout, int numThread, int numBlock, int _CPU_GPU);
 extern "C" void DLL_EXPORT CL_getValueList( cl_mem h_Rin, int rLen, cl_mem* h_ValueList,int numThreadPB, int numBlock,int _CPU_GPU);
+//bitmaps over a base table, bit i stands for the record at position i.
+#define BITMAP_AND (0)
+#define BITMAP_OR (1)
+extern "C" void DLL_EXPORT CL_BitmapCombineOnly(cl_mem d_bitmap, cl_mem d_other, int numBit, int op, int numThreadPB, int numBlock,int _CPU_GPU);
+extern "C" int DLL_EXPORT CL_BitmapToRIDListOnly(cl_mem d_bitmap, int numBit, cl_mem* d_RIDList, int numThreadPB, int numBlock,int _CPU_GPU);
+extern "C" int DLL_EXPORT CL_BitmapCountOnly(cl_mem d_bitmap, int numBit, int numThreadPB, int numBlock,int _CPU_GPU);
 int DLL_EXPORT CL_AggMaxOnly( cl_mem d_Rin, int rLen, cl_mem* d_Rout,
 													  int numThread, int numBlock , int _CPU_GPU);
 int DLL_EXPORT CL_AggSumOnly( cl_mem d_Rin, int rLen, cl_mem* d_Rout,
@@ -53,6 +63,65 @@ extern "C" int DLL_EXPORT CL_PointSelectionOnly(cl_mem d_Rin, int rLen, int matc
 
 extern "C" int DLL_EXPORT CL_RangeSelectionOnly(cl_mem d_Rin, int rLen, int rangeSmallKey, int rangeLargeKey, cl_mem* d_Rout, 
 															  int numThreadPB, int numBlock,int _CPU_GPU );
+extern "C" void DLL_EXPORT CL_RangeSelectionBitmapOnly(cl_mem d_Rin, int rLen, int rangeSmallKey, int rangeLargeKey, cl_mem* d_bitmap, 
+															  int numThreadPB, int numBlock,int _CPU_GPU );
+//predicate is OpenCL C over col<i>[pos].y and c0..c<numConst-1>, compiled once per shape. -1 if it does not compile.
+//the columns line up by position, the records of d_cols[0] that match are written to d_Rout.
+extern "C" int DLL_EXPORT CL_PredicateSelectionOnly(cl_mem* d_cols, int numCol, int rLen, const char* predicate, int* constants, int numConst, cl_mem* d_Rout, 
+															  int numThreadPB, int numBlock,int _CPU_GPU );
+//the same predicate kept as a bitmap over the columns, -1 if it does not compile.
+extern "C" int DLL_EXPORT CL_PredicateBitmapOnly(cl_mem* d_cols, int numCol, int rLen, const char* predicate, int* constants, int numConst, cl_mem* d_bitmap, 
+															  int numThreadPB, int numBlock,int _CPU_GPU );
+
+//typed value columns, a plain array of values of one of the COL_* types, the rid of a value is its position.
+#define COL_INT32 (0)
+#define COL_INT64 (1)
+#define COL_FLOAT32 (2)
+#define COL_FLOAT64 (3)
+#define COL_NUM_TYPE (4)
+#define TYPED_AGG_SUM (0)
+#define TYPED_AGG_MIN (1)
+#define TYPED_AGG_MAX (2)
+//the values of d_col at the rids of d_RIDList, in their order.
+extern "C" int DLL_EXPORT CL_TypedGatherOnly(cl_mem d_col, int colType, cl_mem d_RIDList, int RIDLen, cl_mem* d_out, 
+															  int numThreadPB, int numBlock,int _CPU_GPU );
+//h_result is a long long for the integer types and a double for the float types, sums do not overflow the value type.
+extern "C" void DLL_EXPORT CL_TypedAggOnly(cl_mem d_vals, int colType, int rLen, int aggType, void* h_result, 
+															  int numThreadPB, int numBlock,int _CPU_GPU );
+//low and high point to values of colType, the bitmap is over the positions of d_vals.
+extern "C" void DLL_EXPORT CL_TypedRangeSelectionBitmapOnly(cl_mem d_vals, int colType, int rLen, const void* low, const void* high, cl_mem* d_bitmap, 
+															  int numThreadPB, int numBlock,int _CPU_GPU );
+//equi join of two typed key columns of the same type, the output records are (rid in R, rid in S).
+//d_RIDR/d_RIDS give the rids of the keys, NULL if the keys are the base column itself.
+extern "C" int DLL_EXPORT CL_TypedHjOnly(cl_mem d_R, cl_mem d_RIDR, int rLen, cl_mem d_S, cl_mem d_RIDS, int sLen, int colType, cl_mem* d_Rout, 
+															  int numThreadPB, int numBlock,int _CPU_GPU );
+
+//a compressed column of records whose rid is their position, the scheme is chosen when it is loaded.
+//FOR: d_data holds value-base in width bits, packed from bit 0 of word 0, with one word of padding.
+//DICT: d_data holds codes in width bits the same way, d_aux the sorted distinct values, the code of a value is its position.
+//RLE: d_data holds the value of every run, d_aux the position of its first record; numAux is the number of runs.
+#define PACK_FOR (0)
+#define PACK_RLE (1)
+#define PACK_DICT (2)
+typedef struct
+{
+	int scheme;
+	int width;
+	int base;
+	int rLen;
+	int numAux;
+	cl_mem d_data;
+	cl_mem d_aux;	//NULL for FOR.
+}PackedColumn;
+//the records (rid,value) at the rids of d_RIDList in their order, or the whole column if d_RIDList is NULL.
+extern "C" int DLL_EXPORT CL_PackedDecodeOnly(PackedColumn* col, cl_mem d_RIDList, int RIDLen, cl_mem* d_Rout, 
+															  int numThreadPB, int numBlock,int _CPU_GPU );
+//codeLow..codeHigh are codes for FOR and DICT and are matched on the packed words, values for RLE.
+extern "C" void DLL_EXPORT CL_PackedRangeSelectionBitmapOnly(PackedColumn* col, int codeLow, int codeHigh, cl_mem* d_bitmap, 
+															  int numThreadPB, int numBlock,int _CPU_GPU );
+//aggType is a TYPED_AGG_*, the sum is in 64 bits.
+extern "C" long long DLL_EXPORT CL_PackedAggOnly(PackedColumn* col, int aggType, 
+															  int numThreadPB, int numBlock,int _CPU_GPU );
 
 extern "C" void DLL_EXPORT CL_ProjectionOnly(cl_mem d_Rin,int rLen, cl_mem d_projTable, int pLen, 
 														   int numThread, int numBlock , int _CPU_GPU);
@@ -112,6 +181,30 @@ extern "C" void DLL_EXPORT CL_agg_min_afterGroupBy( Record* h_Rin, int rLen, int
 extern "C" void DLL_EXPORT CL_agg_sum_afterGroupBy(Record* h_Rin, int rLen, int* h_startPos, int numGroups, Record* h_Ragg, int* h_aggResults, int numThread,int _CPU_GPU);
 
 extern "C" void DLL_EXPORT CL_agg_avg_afterGroupBy(Record* h_Rin, int rLen, int* h_startPos, int numGroups, Record* h_Ragg, int* h_aggResults, int numThread,int _CPU_GPU);
+//the same with everything on the device: d_Rout is R sorted on the value, d_startPos the first position of every group.
+extern "C" int DLL_EXPORT CL_GroupByOnly(cl_mem d_Rin, int rLen, cl_mem* d_Rout, cl_mem* d_startPos, 
+					int numThread , int numBlock, int _CPU_GPU);
+//DISTINCT over d_Rin and the numOther columns in d_others, rLen records each aligned by row;
+//one record of d_Rin per distinct tuple to d_Rout, in no order. returns their number.
+extern "C" int DLL_EXPORT CL_DistinctOnly(cl_mem d_Rin, int rLen, cl_mem d_others, int numOther, cl_mem* d_Rout, 
+					int numThread , int numBlock, int _CPU_GPU);
+//d_Rin is the output of CL_GroupByOnly, d_Ragg the aggregated column with a record at the position of its rid.
+//d_Rout gets one record per group, (the value of the group, its aggregate).
+extern "C" void DLL_EXPORT CL_agg_max_afterGroupByOnly(cl_mem d_Rin, int rLen, cl_mem d_startPos, int numGroups, cl_mem d_Ragg, cl_mem* d_Rout, int numThread,int _CPU_GPU);
+extern "C" void DLL_EXPORT CL_agg_min_afterGroupByOnly(cl_mem d_Rin, int rLen, cl_mem d_startPos, int numGroups, cl_mem d_Ragg, cl_mem* d_Rout, int numThread,int _CPU_GPU);
+extern "C" void DLL_EXPORT CL_agg_sum_afterGroupByOnly(cl_mem d_Rin, int rLen, cl_mem d_startPos, int numGroups, cl_mem d_Ragg, cl_mem* d_Rout, int numThread,int _CPU_GPU);
+extern "C" void DLL_EXPORT CL_agg_avg_afterGroupByOnly(cl_mem d_Rin, int rLen, cl_mem d_startPos, int numGroups, cl_mem d_Ragg, cl_mem* d_Rout, int numThread,int _CPU_GPU);
+//fused aggregates, any set of them in one pass over the values. the results are 64 bit, in the order of the bits.
+#define MULTI_AGG_COUNT (1)
+#define MULTI_AGG_SUM (2)
+#define MULTI_AGG_MIN (4)
+#define MULTI_AGG_MAX (8)
+#define MULTI_AGG_AVG (16)
+#define MULTI_AGG_NUM (5)
+//h_result gets one value per bit of aggMask, returns their number.
+extern "C" int DLL_EXPORT CL_MultiAggOnly(cl_mem d_Rin, int rLen, int aggMask, long long* h_result, int numThread, int numBlock, int _CPU_GPU);
+//d_Rout gets a record (value of the group, aggregate) per aggregate of a group; returns the aggregates per group.
+extern "C" int DLL_EXPORT CL_MultiAggAfterGroupByOnly(cl_mem d_Rin, int rLen, cl_mem d_startPos, int numGroups, cl_mem d_Ragg, int aggMask, cl_mem* d_Rout, int numThread, int _CPU_GPU);
 //for joins
 
 //sort
@@ -128,6 +221,35 @@ extern "C" int DLL_EXPORT CL_hj( Record* h_R, int rLen, Record* h_S, int sLen, R
 extern "C" int DLL_EXPORT CL_inlj( Record* h_Rin, int rLen, CUDA_CSSTree** h_tree, Record* h_Sin, int sLen, Record** h_Rout, int _CPU_GPU );
 
 extern "C" int DLL_EXPORT CL_mj( void * h_Rin, int rLen, Record* h_Sin, int sLen, Record** h_Joinout, int _CPU_GPU );
+//scheduling granularity of the query running on the calling thread
+#define SCHEDULE_DEFAULT (-1)//follow EngineStart(,_KernelSchedule)
+#define SCHEDULE_KERNEL (0)
+#define SCHEDULE_OPERATOR (1)
+#define SCHEDULE_QUERY (2)
+#define SCHEDULE_HYBRID (3)//query level, heavy kernels rebalanced on divergence
+#define SCHEDULE_PLAN (4)//operators placed over the plan DAG by the CoProcessor
+extern "C" void DLL_EXPORT CL_SetScheduleLevel(int level);
+extern "C" int DLL_EXPORT CL_GetScheduleLevel();
+extern "C" void DLL_EXPORT CL_SetHybridThreshold(double threshold);
+extern "C" double DLL_EXPORT CL_getBurden(int _CPU_GPU);
+//data residency
+extern "C" void DLL_EXPORT CL_TagResidence(cl_mem mem, int size, int _CPU_GPU);
+//tags mem with the device of the last kernel of this thread, size 0 for the whole buffer.
+extern "C" void DLL_EXPORT CL_TagOutput(cl_mem mem, int size);
+//the buffers the next kernel of this thread reads, migrated ahead of it.
+extern "C" void DLL_EXPORT CL_SetInputs(cl_mem* mems, int num);
+extern "C" int DLL_EXPORT CL_GetResidence(cl_mem mem);
+extern "C" void DLL_EXPORT CL_Prefetch(cl_mem mem, int _CPU_GPU);
+extern "C" double DLL_EXPORT CL_MigrationBurden(cl_mem mem, int _CPU_GPU);
+extern "C" double DLL_EXPORT CL_TransferBurden(int from, int to, int size);
+extern "C" void DLL_EXPORT CL_SetResidencyAware(int _ResidencyAware);
+extern "C" double DLL_EXPORT CL_getMigratedBytes();
+extern "C" void DLL_EXPORT CL_resetMigratedBytes();
+//approximate aggregates, one scan into a sketch of a few KB (Sketch.h).
+//COUNT(DISTINCT) by HyperLogLog with 2^p registers, SKETCH_HLL_MIN_P<=p<=SKETCH_HLL_MAX_P.
+extern "C" double DLL_EXPORT CL_ApproxCountDistinctOnly(cl_mem d_Rin, int rLen, int p, int numThread, int numBlock, int _CPU_GPU);
+//the values of rank q[i]*(rLen-1) to h_out[i], each within relative error alpha.
+extern "C" void DLL_EXPORT CL_ApproxQuantileOnly(cl_mem d_Rin, int rLen, double alpha, const double* q, int numQ, int* h_out, int numThread, int numBlock, int _CPU_GPU);
 extern "C" void DLL_EXPORT EngineStart(bool handShake,int _KernelSchedule);
 extern "C" void DLL_EXPORT EngineStop();
 #endif
@@ -0,0 +1,276 @@
+#include "PredicateJIT.h"
+#include "KernelScheduler.h"
+#include "OpenCL_DLL.h"
+#include "scheduler.h"
+#include "testBitmap.h"
+#include <string>
+
+extern cl_context Context;       // OpenCL context
+extern cl_device_id Device[2];   // OpenCL device
+
+struct predicate_entry {
+	char *predicate;
+	int numCol;
+	int numConst;
+	cl_program program;
+	unsigned int lastUse;
+};
+
+static predicate_entry predicateCache[PREDICATE_CACHE_SIZE];
+static int numPredicate = 0;
+static unsigned int predicateClock = 0;
+static pthread_mutex_t predicateCS = PTHREAD_MUTEX_INITIALIZER;
+
+/*the columns and the constants, the common tail of both kernels*/
+static std::string predicate_params(int numCol, int numConst)
+{
+	char param[32];
+	std::string params;
+	for (int i = 0; i < numCol; i++)
+	{
+		sprintf(param, ", __global Record* col%d", i);
+		params += param;
+	}
+	for (int i = 0; i < numConst; i++)
+	{
+		sprintf(param, ", int c%d", i);
+		params += param;
+	}
+	return params;
+}
+
+/*predicate_kernel is the compaction of filterImpl_fused_kernel with the
+ * predicate inlined, the columns line up by position and a match writes the
+ * record of col0. predicate_bitmap_kernel sets bit pos instead, like
+ * bitmap_rangeSelection_kernel. Record is int2 here, so the keys compare
+ * with the int constants as signed, as on the CPU.*/
+static std::string predicate_source(const char *predicate, int numCol, int numConst)
+{
+	std::string params = predicate_params(numCol, numConst);
+	std::string source = "typedef int2 Record;\n"
+		"__kernel void predicate_kernel(int rLen, __global "
+		"Record* d_Rout, __global int* d_outSize";
+	source += params;
+	source += ")\n{\n"
+		"\t__local int s_count;\n"
+		"\t__local int s_base;\n"
+		"\tint lid = get_local_id(0);\n"
+		"\tint tileSize = get_local_size(0);\n"
+		"\tint delta = get_num_groups(0)*tileSize;\n"
+		"\tfor(int tile=get_group_id(0)*tileSize;tile<rLen;tile+=delta)\n"
+		"\t{\n"
+		"\t\tint pos = tile+lid;\n"
+		"\t\tRecord value;\n"
+		"\t\tint flag = 0;\n"
+		"\t\tif(pos<rLen)\n"
+		"\t\t{\n"
+		"\t\t\tvalue = col0[pos];\n"
+		"\t\t\tflag = (";
+	source += predicate;
+	source += ") ? 1 : 0;\n"
+		"\t\t}\n"
+		"\t\tif(lid==0)\n"
+		"\t\t\ts_count=0;\n"
+		"\t\tbarrier(CLK_LOCAL_MEM_FENCE);\n"
+		"\t\tint slot = flag ? atomic_inc(&s_count) : 0;\n"
+		"\t\tbarrier(CLK_LOCAL_MEM_FENCE);\n"
+		"\t\tif(lid==0)\n"
+		"\t\t\ts_base = (s_count>0) ? atomic_add(d_outSize,s_count) : 0;\n"
+		"\t\tbarrier(CLK_LOCAL_MEM_FENCE);\n"
+		"\t\tif(flag)\n"
+		"\t\t\td_Rout[s_base+slot] = value;\n"
+		"\t\tbarrier(CLK_LOCAL_MEM_FENCE);\n"
+		"\t}\n"
+		"}\n";
+	source += "__kernel void predicate_bitmap_kernel(int rLen, __global uint* "
+		"d_bitmap";
+	source += params;
+	source += ")\n{\n"
+		"\tint numWord = (rLen+31)>>5;\n"
+		"\tfor(int w=get_global_id(0);w<numWord;w+=get_global_size(0))\n"
+		"\t{\n"
+		"\t\tuint bits = 0;\n"
+		"\t\tint pos = w<<5;\n"
+		"\t\tint endPos = min(pos+32,rLen);\n"
+		"\t\tfor(int b=0;pos<endPos;pos++,b++)\n"
+		"\t\t{\n"
+		"\t\t\tif(";
+	source += predicate;
+	source += ")\n"
+		"\t\t\t\tbits |= (1u<<b);\n"
+		"\t\t}\n"
+		"\t\td_bitmap[w] = bits;\n"
+		"\t}\n"
+		"}\n";
+	return source;
+}
+
+static cl_program predicate_build(const char *predicate, int numCol, int numConst)
+{
+	cl_int ciErr1;
+	std::string sourceStr = predicate_source(predicate, numCol, numConst);
+	const char *source = sourceStr.c_str();
+	cl_program program = clCreateProgramWithSource(Context, 1, &source, NULL, &ciErr1);
+	if (ciErr1 != CL_SUCCESS)
+	{
+		printf("Error %d in clCreateProgramWithSource, Line %u in file %s !!!\n\n", ciErr1, __LINE__, __FILE__);
+		return NULL;
+	}
+	ciErr1 = clBuildProgram(program, 2, Device, "-cl-fast-relaxed-math", NULL, NULL);
+	if (ciErr1 != CL_SUCCESS)
+	{
+		size_t log_size;
+		clGetProgramBuildInfo(program, Device[0], CL_PROGRAM_BUILD_LOG, 0, NULL, &log_size);
+		char *log = (char *)malloc(log_size);
+		clGetProgramBuildInfo(program, Device[0], CL_PROGRAM_BUILD_LOG, log_size, log, NULL);
+		printf("predicate %s does not compile:\n%s\n", predicate, log);
+		free(log);
+		clReleaseProgram(program);
+		return NULL;
+	}
+	return program;
+}
+
+cl_program predicate_getProgram(const char *predicate, int numCol, int numConst)
+{
+	cl_program program = NULL;
+	int i;
+	if (numCol < 1 || numCol > PREDICATE_MAX_COL || numConst > PREDICATE_MAX_CONST)
+		return NULL;
+	pthread_mutex_lock(&predicateCS);
+	for (i = 0; i < numPredicate; i++)
+	{
+		if (predicateCache[i].numCol == numCol && predicateCache[i].numConst == numConst && strcmp(predicateCache[i].predicate, predicate) == 0)
+		{
+			program = predicateCache[i].program;
+			break;
+		}
+	}
+	/*built under the lock, so a shape is compiled only once*/
+	if (i == numPredicate)
+	{
+		program = predicate_build(predicate, numCol, numConst);
+		if (program != NULL)
+		{
+			/*a full cache drops the least recently used shape, the caller
+			 * still holding its program keeps it alive*/
+			if (numPredicate == PREDICATE_CACHE_SIZE)
+			{
+				int j;
+				for (i = 0, j = 1; j < numPredicate; j++)
+					if (predicateCache[j].lastUse < predicateCache[i].lastUse)
+						i = j;
+				free(predicateCache[i].predicate);
+				clReleaseProgram(predicateCache[i].program);
+			}
+			else
+				numPredicate++;
+			predicateCache[i].predicate = strdup(predicate);
+			predicateCache[i].numCol = numCol;
+			predicateCache[i].numConst = numConst;
+			predicateCache[i].program = program;
+		}
+	}
+	if (program != NULL)
+	{
+		predicateCache[i].lastUse = ++predicateClock;
+		clRetainProgram(program);
+	}
+	pthread_mutex_unlock(&predicateCS);
+	return program;
+}
+
+int predicate_selection(cl_mem *d_cols, int numCol, int rLen, cl_program program, int *constants, int numConst, cl_mem *d_Rout, int numThreadPB, int numBlock, int *index, cl_event *eventList, cl_kernel *Kernel, int *Flag_CPU_GPU, double *burden, int _CPU_GPU)
+{
+	size_t numThreadsPerBlock_x = numThreadPB;
+	size_t globalWorkingSetSize = numThreadPB * numBlock;
+	int outSize = 0;
+	cl_mem d_outSize;
+	CL_MALLOC(&d_outSize, sizeof(int));
+	cl_writebuffer(d_outSize, &outSize, sizeof(int), index, eventList, Flag_CPU_GPU, burden, _CPU_GPU);
+	CL_MALLOC(d_Rout, sizeof(Record) * rLen);
+
+	cl_int ciErr1;
+	(*Kernel) = clCreateKernel(program, "predicate_kernel", &ciErr1);
+	ciErr1 |= clSetKernelArg((*Kernel), 0, sizeof(cl_int), (void *)&rLen);
+	ciErr1 |= clSetKernelArg((*Kernel), 1, sizeof(cl_mem), (void *)d_Rout);
+	ciErr1 |= clSetKernelArg((*Kernel), 2, sizeof(cl_mem), (void *)&d_outSize);
+	for (int i = 0; i < numCol; i++)
+		ciErr1 |= clSetKernelArg((*Kernel), 3 + i, sizeof(cl_mem), (void *)&d_cols[i]);
+	for (int i = 0; i < numConst; i++)
+		ciErr1 |= clSetKernelArg((*Kernel), 3 + numCol + i, sizeof(cl_int), (void *)&constants[i]);
+	if (ciErr1 != CL_SUCCESS)
+	{
+		printf("Error in clSetKernelArg, Line %u in file %s !!!\n\n", __LINE__, __FILE__);
+		cl_clean(EXIT_FAILURE);
+	}
+	kernel_enqueue(rLen * numCol, 69, 1, &globalWorkingSetSize, &numThreadsPerBlock_x, eventList, index, Kernel, Flag_CPU_GPU, burden, _CPU_GPU);
+	clWaitForEvents(1, &eventList[(*index - 1) % 2]);
+	cl_readbuffer(&outSize, d_outSize, sizeof(int), index, eventList, Flag_CPU_GPU, burden, _CPU_GPU);
+	CL_FREE(d_outSize);
+	return outSize;
+}
+
+void predicate_bitmap(cl_mem *d_cols, int numCol, int rLen, cl_program program, int *constants, int numConst, cl_mem d_bitmap, int numThreadPB, int numBlock, int *index, cl_event *eventList, cl_kernel *Kernel, int *Flag_CPU_GPU, double *burden, int _CPU_GPU)
+{
+	size_t numThreadsPerBlock_x = numThreadPB;
+	size_t globalWorkingSetSize = numThreadPB * numBlock;
+	cl_int ciErr1;
+	(*Kernel) = clCreateKernel(program, "predicate_bitmap_kernel", &ciErr1);
+	ciErr1 |= clSetKernelArg((*Kernel), 0, sizeof(cl_int), (void *)&rLen);
+	ciErr1 |= clSetKernelArg((*Kernel), 1, sizeof(cl_mem), (void *)&d_bitmap);
+	for (int i = 0; i < numCol; i++)
+		ciErr1 |= clSetKernelArg((*Kernel), 2 + i, sizeof(cl_mem), (void *)&d_cols[i]);
+	for (int i = 0; i < numConst; i++)
+		ciErr1 |= clSetKernelArg((*Kernel), 2 + numCol + i, sizeof(cl_int), (void *)&constants[i]);
+	if (ciErr1 != CL_SUCCESS)
+	{
+		printf("Error in clSetKernelArg, Line %u in file %s !!!\n\n", __LINE__, __FILE__);
+		cl_clean(EXIT_FAILURE);
+	}
+	kernel_enqueue(rLen * numCol, 70, 1, &globalWorkingSetSize, &numThreadsPerBlock_x, eventList, index, Kernel, Flag_CPU_GPU, burden, _CPU_GPU);
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+// exported
+/////////////////////////////////////////////////////////////////////////////////
+int CL_PredicateSelectionOnly(cl_mem *d_cols, int numCol, int rLen, const char *predicate, int *constants, int numConst, cl_mem *d_Rout, int numThreadPB, int numBlock, int _CPU_GPU)
+{
+	cl_program program = predicate_getProgram(predicate, numCol, numConst);
+	if (program == NULL)
+		return -1;
+	cl_event eventList[2];
+	int index = 0;
+	cl_kernel Kernel;
+	int CPU_GPU;
+	double burden;
+	int outSize = predicate_selection(d_cols, numCol, rLen, program, constants, numConst, d_Rout, numThreadPB, numBlock, &index, eventList, &Kernel, &CPU_GPU, &burden, _CPU_GPU);
+	clWaitForEvents(1, &eventList[(index - 1) % 2]);
+	deschedule(CPU_GPU, burden);
+	clReleaseKernel(Kernel);
+	clReleaseProgram(program);
+	clReleaseEvent(eventList[0]);
+	clReleaseEvent(eventList[1]);
+	return outSize;
+}
+int CL_PredicateBitmapOnly(cl_mem *d_cols, int numCol, int rLen, const char *predicate, int *constants, int numConst, cl_mem *d_bitmap, int numThreadPB, int numBlock, int _CPU_GPU)
+{
+	cl_program program = predicate_getProgram(predicate, numCol, numConst);
+	if (program == NULL)
+		return -1;
+	cl_event eventList[2];
+	int index = 0;
+	cl_kernel Kernel;
+	int CPU_GPU;
+	double burden;
+	int numWord = BITMAP_NUM_WORD(rLen);
+	CL_MALLOC(d_bitmap, sizeof(int) * (numWord > 0 ? numWord : 1));
+	predicate_bitmap(d_cols, numCol, rLen, program, constants, numConst, *d_bitmap, numThreadPB, numBlock, &index, eventList, &Kernel, &CPU_GPU, &burden, _CPU_GPU);
+	clWaitForEvents(1, &eventList[(index - 1) % 2]);
+	deschedule(CPU_GPU, burden);
+	clReleaseKernel(Kernel);
+	clReleaseProgram(program);
+	clReleaseEvent(eventList[0]);
+	clReleaseEvent(eventList[1]);
+	return 0;
+}
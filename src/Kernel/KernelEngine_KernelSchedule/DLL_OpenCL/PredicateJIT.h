@@ -0,0 +1,21 @@
+#ifndef _PREDICATE_JIT_H_
+#define _PREDICATE_JIT_H_
+#include "common.h"
+/*
+ * Selection kernels generated from a predicate expression.
+ * The expression is OpenCL C over the columns col0..col<numCol-1>, read as
+ * col<i>[pos].y, and the constants c0..c<numConst-1>, which are passed as
+ * kernel arguments, so one program is built per predicate shape and reused
+ * for any constants.
+ */
+#define PREDICATE_CACHE_SIZE 64
+#define PREDICATE_MAX_CONST 16
+#define PREDICATE_MAX_COL 8
+
+/*built program of the shape, NULL if it does not compile. the caller owns a
+ * reference and releases it with clReleaseProgram*/
+cl_program predicate_getProgram(const char *predicate, int numCol, int numConst);
+int predicate_selection(cl_mem *d_cols, int numCol, int rLen, cl_program program, int *constants, int numConst, cl_mem *d_Rout, int numThreadPB, int numBlock, int *index, cl_event *eventList, cl_kernel *Kernel, int *Flag_CPU_GPU, double *burden, int _CPU_GPU);
+/*bit pos of d_bitmap is set when the predicate holds at pos*/
+void predicate_bitmap(cl_mem *d_cols, int numCol, int rLen, cl_program program, int *constants, int numConst, cl_mem d_bitmap, int numThreadPB, int numBlock, int *index, cl_event *eventList, cl_kernel *Kernel, int *Flag_CPU_GPU, double *burden, int _CPU_GPU);
+#endif
@@ -0,0 +1,34 @@
+#ifndef _RESIDENCY_H_
+#define _RESIDENCY_H_
+#include "common.h"
+/*
+ * Data residency of buffers on the shared context.
+ * Every buffer is tagged with the device (0 for CPU, 1 for GPU) that wrote it last,
+ * so that placement can charge the migration cost and prefetch ahead of time.
+ * The table starts at RESIDENCE_TABLE_SIZE entries and doubles when half full.
+ */
+#define RESIDENCE_UNKNOWN (-1)
+#define RESIDENCE_TABLE_SIZE 4096
+#define RESIDENCE_MAX_INPUT 4 // inputs of the next kernel, see residence_setInputs.
+
+void residence_tag(cl_mem mem, size_t size, int CPU_GPU);
+int residence_get(cl_mem mem);
+size_t residence_size(cl_mem mem);
+void residence_forget(cl_mem mem);
+/*move mem to CPU_GPU with clEnqueueMigrateMemObjects, return the bytes migrated*/
+size_t residence_prefetch(cl_mem mem, int CPU_GPU);
+/*
+ * the buffers the next kernel of this thread reads. The first kernel of a chain is
+ * placed by where they are, and they are migrated on its queue before it runs.
+ */
+void residence_setInputs(cl_mem *mems, int num);
+int residence_inputDevice();
+void residence_migrateInputs(int CPU_GPU);
+/*the device of the last kernel of this thread, it wrote the outputs*/
+void residence_setLastDevice(int CPU_GPU);
+int residence_lastDevice();
+/*bytes migrated by all threads*/
+void residence_count(size_t bytes);
+size_t residence_migratedBytes();
+void residence_resetMigratedBytes();
+#endif
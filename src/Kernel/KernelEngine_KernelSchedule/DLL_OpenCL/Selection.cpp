@@ -1,4 +1,5 @@
 #include "testFilter.h"
+#include "testBitmap.h"
 #include "KernelScheduler.h"
 #include "OpenCL_DLL.h"
 int point_selection(cl_mem d_Rin, int rLen, int matchingKeyValue, cl_mem* d_Rout, 
@@ -118,3 +119,22 @@ extern "C" int CL_RangeSelection(Record* h_Rin, int rLen, int rangeSmallKey, int
 	//printf("FilterFinish\n");
 	return outSize;
 }
+//the selection kept as a bitmap over d_Rin, no record is written.
+extern "C" void CL_RangeSelectionBitmapOnly(cl_mem d_Rin, int rLen, int rangeSmallKey, int rangeLargeKey, cl_mem* d_bitmap, 
+															  int numThreadPB, int numBlock,int _CPU_GPU )
+{
+	cl_event eventList[2];
+	int index=0;
+	cl_kernel Kernel; 
+	int CPU_GPU;
+	double burden;
+	int numWord=BITMAP_NUM_WORD(rLen);
+	CL_MALLOC( d_bitmap, sizeof(int)*(numWord>0?numWord:1) );
+	bitmap_rangeSelectionImpl( d_Rin, rLen, rangeSmallKey, rangeLargeKey, *d_bitmap, 
+										numThreadPB, numBlock,&index,eventList,&Kernel,&CPU_GPU,&burden,_CPU_GPU);
+	clWaitForEvents(1,&eventList[(index-1)%2]); 
+	deschedule(CPU_GPU,burden);
+	clReleaseKernel(Kernel);  
+	clReleaseEvent(eventList[0]);
+	clReleaseEvent(eventList[1]);
+}
@@ -1,6 +1,7 @@
 #include "common.h"
 #include "testRIDList.h"
 #include "testValue.h"
+#include "testBitmap.h"
 #include "OpenCL_DLL.h"
 #include "KernelScheduler.h"
 extern "C" void CL_setRIDList(cl_mem h_RIDList, int rLen, cl_mem h_destRin, int numThreadPB, int numBlock,int _CPU_GPU)
@@ -100,4 +101,50 @@ extern "C" void CL_getValueList( cl_mem h_Rin, int rLen, cl_mem* h_ValueList,int
 	clReleaseEvent(eventList[0]);
 	CL_FREE(d_tempOutput);
 	//bufferchecking(*h_ValueList,sizeof(Record)*1);
-}
\ No newline at end of file
+}
+//d_bitmap = d_bitmap AND/OR d_other, both over the same numBit records.
+extern "C" void CL_BitmapCombineOnly(cl_mem d_bitmap, cl_mem d_other, int numBit, int op, int numThreadPB, int numBlock,int _CPU_GPU)
+{
+	cl_event eventList[2];
+	int index=0;
+	cl_kernel Kernel; 
+	int CPU_GPU;
+	double burden;
+	bitmap_combineImpl(d_bitmap,d_other,numBit,(op==BITMAP_OR),numThreadPB,numBlock,&index,eventList,&Kernel,&CPU_GPU,&burden,_CPU_GPU);
+	clWaitForEvents(1,&eventList[(index-1)%2]); 
+	deschedule(CPU_GPU,burden);
+	clReleaseKernel(Kernel);  
+	clReleaseEvent(eventList[0]);
+	clReleaseEvent(eventList[1]);
+}
+//the sorted RID list of the set bits, returns its length.
+extern "C" int CL_BitmapToRIDListOnly(cl_mem d_bitmap, int numBit, cl_mem* d_RIDList, int numThreadPB, int numBlock,int _CPU_GPU)
+{
+	cl_event eventList[2];
+	int index=0;
+	cl_kernel Kernel; 
+	int CPU_GPU;
+	double burden;
+	int numResult=bitmap_toRIDListImpl(d_bitmap,numBit,d_RIDList,numThreadPB,numBlock,&index,eventList,&Kernel,&CPU_GPU,&burden,_CPU_GPU);
+	clWaitForEvents(1,&eventList[(index-1)%2]); 
+	deschedule(CPU_GPU,burden);
+	clReleaseKernel(Kernel);  
+	clReleaseEvent(eventList[0]);
+	clReleaseEvent(eventList[1]);
+	return numResult;
+}
+//the number of set bits, the selectivity of a bitmap that is not turned into RIDs yet.
+extern "C" int CL_BitmapCountOnly(cl_mem d_bitmap, int numBit, int numThreadPB, int numBlock,int _CPU_GPU)
+{
+	cl_event eventList[2];
+	int index=0;
+	cl_kernel Kernel; 
+	int CPU_GPU;
+	double burden;
+	int numResult=bitmap_totalImpl(d_bitmap,numBit,numThreadPB,numBlock,&index,eventList,&Kernel,&CPU_GPU,&burden,_CPU_GPU);
+	deschedule(CPU_GPU,burden);
+	clReleaseKernel(Kernel);  
+	clReleaseEvent(eventList[0]);
+	clReleaseEvent(eventList[1]);
+	return numResult;
+}
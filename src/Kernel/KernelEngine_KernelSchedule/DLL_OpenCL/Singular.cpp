@@ -3,17 +3,6 @@
 #include "testReduce.h"
 #include "KernelScheduler.h"
 #include "OpenCL_DLL.h"
-inline void reduce_deallocBlockSums(tempResult *tR, int _CPU_GPU)
-{
-    for (int i = 0; i < tR->d_numLevelsAllocated; i++)
-    {
-		CL_FREE(tR->d_scanBlockSums[i]);
-    }
-
-    free((void**)tR->d_scanBlockSums);
-    tR->d_numLevelsAllocated = 0;
-}
-
 inline int agg_max(cl_mem d_Rin, int rLen, cl_mem d_Rout, int numThread, int numBlock,int *index,cl_event *eventList,cl_kernel *kernel,int *Flag_CPU_GPU,double * burden,tempResult *tR, int _CPU_GPU)
 {	
 	return reduceImpl( d_Rin, rLen, d_Rout, REDUCE_MAX, numThread, numBlock,index,eventList,kernel,Flag_CPU_GPU,burden,tR,_CPU_GPU);
@@ -47,6 +36,7 @@ int CL_AggMaxOnly( cl_mem d_Rin, int rLen, cl_mem* d_Rout,
 	result=agg_max( d_Rin, rLen, *d_Rout, numThread, numBlock,&index,eventList,&Kernel,&CPU_GPU,&burden,tR,_CPU_GPU);
 	clWaitForEvents(1,&eventList[(index-1)%2]);
 	deschedule(CPU_GPU,burden);
+	reduce_dealloc(tR);
 	HOST_FREE(tR);
 	clReleaseKernel(Kernel);  
 	clReleaseEvent(eventList[0]);
@@ -70,6 +60,7 @@ int CL_AggSumOnly( cl_mem d_Rin, int rLen, cl_mem* d_Rout,
 	result=agg_sum( d_Rin, rLen, *d_Rout, numThread, numBlock,&index,eventList,&Kernel,&CPU_GPU,&burden,tR,_CPU_GPU);
 	clWaitForEvents(1,&eventList[(index-1)%2]);
 	deschedule(CPU_GPU,burden);
+	reduce_dealloc(tR);
 	HOST_FREE(tR);
 	clReleaseKernel(Kernel);  
 	clReleaseEvent(eventList[0]);
@@ -93,6 +84,7 @@ int CL_AggAvgOnly( cl_mem d_Rin, int rLen, cl_mem* d_Rout,
 	result=agg_avg( d_Rin, rLen, *d_Rout, numThread, numBlock,&index,eventList,&Kernel,&CPU_GPU,&burden,tR,_CPU_GPU);
 	clWaitForEvents(1,&eventList[(index-1)%2]);
 	deschedule(CPU_GPU,burden);
+	reduce_dealloc(tR);
 	HOST_FREE(tR);
 	clReleaseKernel(Kernel);  
 	clReleaseEvent(eventList[0]);
@@ -116,6 +108,7 @@ int CL_AggMinOnly( cl_mem d_Rin, int rLen, cl_mem* d_Rout,
 	result=agg_min( d_Rin, rLen, *d_Rout, numThread, numBlock,&index,eventList,&Kernel,&CPU_GPU,&burden,tR,_CPU_GPU);
 	clWaitForEvents(1,&eventList[(index-1)%2]);
 	deschedule(CPU_GPU,burden);
+	reduce_dealloc(tR);
 	HOST_FREE(tR);
 	clReleaseKernel(Kernel);  
 	clReleaseEvent(eventList[0]);
@@ -149,6 +142,7 @@ int CL_AggMax( Record * h_Rin, int rLen, Record** h_Rout,
 	deschedule(CPU_GPU,burden);
 	CL_FREE( d_Rin );
 	CL_FREE( d_Rout );
+	reduce_dealloc(tR);
 	HOST_FREE(tR);
 	clReleaseKernel(Kernel);  
 	clReleaseEvent(eventList[0]);
@@ -182,6 +176,7 @@ int CL_AggMin(Record * h_Rin, int rLen, Record** h_Rout,
 	deschedule(CPU_GPU,burden);
 	CL_FREE( d_Rin );
 	CL_FREE( d_Rout );
+	reduce_dealloc(tR);
 	HOST_FREE(tR);
 	clReleaseKernel(Kernel);  
 	clReleaseEvent(eventList[0]);
@@ -215,6 +210,7 @@ int CL_AggSum( Record * h_Rin, int rLen, Record** h_Rout,
 	deschedule(CPU_GPU,burden);
 	CL_FREE( d_Rin );
 	CL_FREE( d_Rout );
+	reduce_dealloc(tR);
 	HOST_FREE(tR);
 	clReleaseKernel(Kernel);  
 	clReleaseEvent(eventList[0]);
@@ -249,6 +245,7 @@ int CL_AggAvg( Record * h_Rin, int rLen, Record** h_Rout,
 	deschedule(CPU_GPU,burden);
 	CL_FREE( d_Rin );
 	CL_FREE( d_Rout );
+	reduce_dealloc(tR);
 	HOST_FREE(tR);
 	clReleaseKernel(Kernel);  
 	clReleaseEvent(eventList[0]);
@@ -256,3 +253,91 @@ int CL_AggAvg( Record * h_Rin, int rLen, Record** h_Rout,
 	//printf("CL_AggAvgFinish\n");
 	return result;
 }
+/*
+fused aggregates: one pass of multiAgg_kernel leaves a partial sum, min and max per work group,
+the partials are combined here. COUNT is the length of the input.
+*/
+static void multiAgg_int(cl_mem d_Rin, int rLen, cl_mem d_sum, cl_mem d_min, cl_mem d_max, int numThread, int numBlock,int *index,cl_event *eventList,cl_kernel *kernel,int *Flag_CPU_GPU,double * burden,int _CPU_GPU)
+{
+	size_t numThreadsPerBlock_x=numThread;
+	size_t globalWorkingSetSize=numThread*numBlock;
+	cl_getKernel("multiAgg_kernel",kernel);
+	cl_int ciErr1 = clSetKernelArg((*kernel), 0, sizeof(cl_mem), (void*)&d_Rin);
+	ciErr1 |= clSetKernelArg((*kernel), 1, sizeof(cl_int), (void*)&rLen);
+	ciErr1 |= clSetKernelArg((*kernel), 2, sizeof(cl_mem), (void*)&d_sum);
+	ciErr1 |= clSetKernelArg((*kernel), 3, sizeof(cl_mem), (void*)&d_min);
+	ciErr1 |= clSetKernelArg((*kernel), 4, sizeof(cl_mem), (void*)&d_max);
+	ciErr1 |= clSetKernelArg((*kernel), 5, sizeof(cl_long)*numThread, NULL);
+	ciErr1 |= clSetKernelArg((*kernel), 6, sizeof(cl_int)*numThread, NULL);
+	ciErr1 |= clSetKernelArg((*kernel), 7, sizeof(cl_int)*numThread, NULL);
+	if (ciErr1 != CL_SUCCESS)
+	{
+		printf("Error in clSetKernelArg, Line %u in file %s !!!\n\n", __LINE__, __FILE__);
+		cl_clean(EXIT_FAILURE);
+	}
+	kernel_enqueue(rLen,59,
+		1, &globalWorkingSetSize, &numThreadsPerBlock_x,eventList,index,kernel,Flag_CPU_GPU,burden,_CPU_GPU);
+}
+extern "C" int CL_MultiAggOnly(cl_mem d_Rin, int rLen, int aggMask, long long* h_result, int numThread, int numBlock, int _CPU_GPU)
+{
+	long long sum=0;
+	long long minValue=0;
+	long long maxValue=0;
+	if(rLen>0 && (aggMask&(MULTI_AGG_SUM|MULTI_AGG_MIN|MULTI_AGG_MAX|MULTI_AGG_AVG)))
+	{
+		cl_event eventList[2];
+		int index=0;
+		cl_kernel Kernel; 
+		int CPU_GPU;
+		double burden;
+		//the work groups stay within 256 work items on either device.
+		if(numThread>256)
+			numThread=256;
+		cl_mem d_sum;
+		cl_mem d_min;
+		cl_mem d_max;
+		CL_MALLOC(&d_sum,sizeof(cl_long)*numBlock);
+		CL_MALLOC(&d_min,sizeof(int)*numBlock);
+		CL_MALLOC(&d_max,sizeof(int)*numBlock);
+		multiAgg_int(d_Rin,rLen,d_sum,d_min,d_max,numThread,numBlock,&index,eventList,&Kernel,&CPU_GPU,&burden,_CPU_GPU);
+		cl_long* h_sum=(cl_long*)malloc(sizeof(cl_long)*numBlock);
+		int* h_min=(int*)malloc(sizeof(int)*numBlock);
+		int* h_max=(int*)malloc(sizeof(int)*numBlock);
+		cl_readbuffer(h_sum,d_sum,sizeof(cl_long)*numBlock,&index,eventList,&CPU_GPU,&burden,_CPU_GPU);
+		cl_readbuffer(h_min,d_min,sizeof(int)*numBlock,&index,eventList,&CPU_GPU,&burden,_CPU_GPU);
+		cl_readbuffer(h_max,d_max,sizeof(int)*numBlock,&index,eventList,&CPU_GPU,&burden,_CPU_GPU);
+		clWaitForEvents(1,&eventList[(index-1)%2]);
+		deschedule(CPU_GPU,burden);
+		minValue=h_min[0];
+		maxValue=h_max[0];
+		for(int i=0;i<numBlock;i++)
+		{
+			sum+=h_sum[i];
+			if(h_min[i]<minValue)
+				minValue=h_min[i];
+			if(h_max[i]>maxValue)
+				maxValue=h_max[i];
+		}
+		free(h_sum);
+		free(h_min);
+		free(h_max);
+		CL_FREE(d_sum);
+		CL_FREE(d_min);
+		CL_FREE(d_max);
+		clReleaseKernel(Kernel);  
+		clReleaseEvent(eventList[0]);
+		clReleaseEvent(eventList[1]);
+	}
+	int k=0;
+	if(aggMask&MULTI_AGG_COUNT)
+		h_result[k++]=rLen;
+	if(aggMask&MULTI_AGG_SUM)
+		h_result[k++]=sum;
+	if(aggMask&MULTI_AGG_MIN)
+		h_result[k++]=minValue;
+	if(aggMask&MULTI_AGG_MAX)
+		h_result[k++]=maxValue;
+	if(aggMask&MULTI_AGG_AVG)
+		h_result[k++]=(rLen>0)?sum/rLen:0;
+	return k;
+}
@@ -0,0 +1,108 @@
+#include "Sketch.h"
+#include "common.h"
+#include "Helper.h"
+#include "KernelScheduler.h"
+#include "OpenCL_DLL.h"
+#include "scheduler.h"
+
+static void sketch_checkArg(cl_int ciErr1)
+{
+	if (ciErr1 != CL_SUCCESS)
+	{
+		printf("Error in clSetKernelArg, Line %u in file %s !!!\n\n", __LINE__, __FILE__);
+		cl_clean(EXIT_FAILURE);
+	}
+}
+
+static void hll_buildImpl(cl_mem d_R, int rLen, int p, cl_mem d_registers, int numThreadPB, int numBlock, int *index, cl_event *eventList, cl_kernel *Kernel, int *Flag_CPU_GPU, double *burden, int _CPU_GPU)
+{
+	size_t numThreadsPerBlock_x = numThreadPB;
+	size_t globalWorkingSetSize = numThreadPB * numBlock;
+	cl_getKernel("hll_build_kernel", Kernel);
+	cl_int ciErr1 = clSetKernelArg((*Kernel), 0, sizeof(cl_mem), (void *)&d_R);
+	ciErr1 |= clSetKernelArg((*Kernel), 1, sizeof(cl_int), (void *)&rLen);
+	ciErr1 |= clSetKernelArg((*Kernel), 2, sizeof(cl_int), (void *)&p);
+	ciErr1 |= clSetKernelArg((*Kernel), 3, sizeof(cl_mem), (void *)&d_registers);
+	ciErr1 |= clSetKernelArg((*Kernel), 4, sizeof(cl_int) * (1 << p), NULL);
+	sketch_checkArg(ciErr1);
+	kernel_enqueue(rLen, 80, 1, &globalWorkingSetSize, &numThreadsPerBlock_x, eventList, index, Kernel, Flag_CPU_GPU, burden, _CPU_GPU);
+}
+
+static void quantileSketch_buildImpl(cl_mem d_R, int rLen, double alpha, cl_mem d_bins, int numThreadPB, int numBlock, int *index, cl_event *eventList, cl_kernel *Kernel, int *Flag_CPU_GPU, double *burden, int _CPU_GPU)
+{
+	size_t numThreadsPerBlock_x = numThreadPB;
+	size_t globalWorkingSetSize = numThreadPB * numBlock;
+	cl_float invLogGamma = sketch_invLogGamma(alpha);
+	int maxBucket = sketch_maxBucket(alpha);
+	cl_getKernel("quantileSketch_build_kernel", Kernel);
+	cl_int ciErr1 = clSetKernelArg((*Kernel), 0, sizeof(cl_mem), (void *)&d_R);
+	ciErr1 |= clSetKernelArg((*Kernel), 1, sizeof(cl_int), (void *)&rLen);
+	ciErr1 |= clSetKernelArg((*Kernel), 2, sizeof(cl_float), (void *)&invLogGamma);
+	ciErr1 |= clSetKernelArg((*Kernel), 3, sizeof(cl_int), (void *)&maxBucket);
+	ciErr1 |= clSetKernelArg((*Kernel), 4, sizeof(cl_mem), (void *)&d_bins);
+	ciErr1 |= clSetKernelArg((*Kernel), 5, sizeof(cl_int) * sketch_numBin(alpha), NULL);
+	sketch_checkArg(ciErr1);
+	kernel_enqueue(rLen, 81, 1, &globalWorkingSetSize, &numThreadsPerBlock_x, eventList, index, Kernel, Flag_CPU_GPU, burden, _CPU_GPU);
+}
+
+double CL_ApproxCountDistinctOnly(cl_mem d_Rin, int rLen, int p, int numThread, int numBlock, int _CPU_GPU)
+{
+	if (rLen <= 0)
+		return 0;
+	p = (p < SKETCH_HLL_MIN_P) ? SKETCH_HLL_MIN_P : ((p > SKETCH_HLL_MAX_P) ? SKETCH_HLL_MAX_P : p);
+	int m = 1 << p;
+	cl_event eventList[2];
+	int index = 0;
+	cl_kernel Kernel;
+	int CPU_GPU;
+	double burden;
+	cl_mem d_registers;
+	CL_MALLOC(&d_registers, sizeof(int) * m);
+	memset_int(d_registers, m, 0, numThread, numBlock, &index, eventList, &Kernel, &CPU_GPU, &burden, _CPU_GPU);
+	hll_buildImpl(d_Rin, rLen, p, d_registers, numThread, numBlock, &index, eventList, &Kernel, &CPU_GPU, &burden, _CPU_GPU);
+	clWaitForEvents(1, &eventList[(index - 1) % 2]);
+	deschedule(CPU_GPU, burden);
+	clReleaseKernel(Kernel);
+	clReleaseEvent(eventList[0]);
+	clReleaseEvent(eventList[1]);
+	// the sketch is 2^p ints, the only data back to the host.
+	int *h_registers = (int *)malloc(sizeof(int) * m);
+	cl_readbuffer(h_registers, d_registers, sizeof(int) * m, 0);
+	double result = sketch_hllEstimate(h_registers, p);
+	free(h_registers);
+	CL_FREE(d_registers);
+	return result;
+}
+
+void CL_ApproxQuantileOnly(cl_mem d_Rin, int rLen, double alpha, const double *q, int numQ, int *h_out, int numThread, int numBlock, int _CPU_GPU)
+{
+	int i = 0;
+	if (rLen <= 0)
+	{
+		for (i = 0; i < numQ; i++)
+			h_out[i] = 0;
+		return;
+	}
+	alpha = sketch_clampAlpha(alpha);
+	int numBin = sketch_numBin(alpha);
+	cl_event eventList[2];
+	int index = 0;
+	cl_kernel Kernel;
+	int CPU_GPU;
+	double burden;
+	cl_mem d_bins;
+	CL_MALLOC(&d_bins, sizeof(int) * numBin);
+	memset_int(d_bins, numBin, 0, numThread, numBlock, &index, eventList, &Kernel, &CPU_GPU, &burden, _CPU_GPU);
+	quantileSketch_buildImpl(d_Rin, rLen, alpha, d_bins, numThread, numBlock, &index, eventList, &Kernel, &CPU_GPU, &burden, _CPU_GPU);
+	clWaitForEvents(1, &eventList[(index - 1) % 2]);
+	deschedule(CPU_GPU, burden);
+	clReleaseKernel(Kernel);
+	clReleaseEvent(eventList[0]);
+	clReleaseEvent(eventList[1]);
+	int *h_bins = (int *)malloc(sizeof(int) * numBin);
+	cl_readbuffer(h_bins, d_bins, sizeof(int) * numBin, 0);
+	for (i = 0; i < numQ; i++)
+		h_out[i] = sketch_quantile(h_bins, alpha, q[i]);
+	free(h_bins);
+	CL_FREE(d_bins);
+}
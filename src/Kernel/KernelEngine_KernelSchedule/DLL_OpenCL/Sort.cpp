@@ -8,9 +8,15 @@ extern "C" void CL_RadixSortOnly(cl_mem d_Rin, int rLen,int numThread, int numBl
 	cl_kernel Kernel; 
 	int CPU_GPU;
 	double burden;
-	radixSortImpl(d_Rin, rLen, 32, numThread, numBlock,&index,eventList,&Kernel,&CPU_GPU,&burden,_CPU_GPU);
+	mergeSortImpl(d_Rin, rLen, numThread, numBlock,&index,eventList,&Kernel,&CPU_GPU,&burden,_CPU_GPU);
+	if(index>0)
+	{
+		clWaitForEvents(1,&eventList[(index-1)%2]);
+		clReleaseKernel(Kernel);
+	}
 	deschedule(CPU_GPU,burden);
 }
+//stable, d_Rin is left as it is.
 extern "C" void CL_BitonicSortOnly(cl_mem d_Rin, int rLen,cl_mem d_Rout,int numThread, int numBlock, int _CPU_GPU)
 {
 	cl_event eventList[2];
@@ -19,8 +25,11 @@ extern "C" void CL_BitonicSortOnly(cl_mem d_Rin, int rLen,cl_mem d_Rout,int numT
 	int CPU_GPU;
 	double burden;
 	cl_copyBuffer(d_Rout,d_Rin,sizeof(Record) * rLen,&index,eventList,&CPU_GPU,&burden,_CPU_GPU);
-	radixSortImpl(d_Rin, rLen, 32, numThread, numBlock,&index,eventList,&Kernel,&CPU_GPU,&burden,_CPU_GPU);
+	mergeSortImpl(d_Rout, rLen, numThread, numBlock,&index,eventList,&Kernel,&CPU_GPU,&burden,_CPU_GPU);
+	clWaitForEvents(1,&eventList[(index-1)%2]);
 	deschedule(CPU_GPU,burden);
+	if(rLen>1)
+		clReleaseKernel(Kernel);
 }
 extern "C" void CL_RadixSort(Record* h_Rin, int rLen,Record* h_Rout,int numThread, int numBlock, int _CPU_GPU)
 {
@@ -36,7 +45,7 @@ extern "C" void CL_RadixSort(Record* h_Rin, int rLen,Record* h_Rout,int numThrea
 
 	cl_writebuffer(d_Rin, h_Rin, memSize,&index,eventList,&CPU_GPU,&burden,_CPU_GPU);
 
-	radixSortImpl( d_Rin, rLen, 32, numThread, numBlock,&index,eventList,&Kernel,&CPU_GPU,&burden,_CPU_GPU);
+	mergeSortImpl( d_Rin, rLen, numThread, numBlock,&index,eventList,&Kernel,&CPU_GPU,&burden,_CPU_GPU);
 
 	cl_readbuffer( h_Rout, d_Rin, memSize,&index,eventList,&CPU_GPU,&burden,_CPU_GPU);
 	
@@ -47,4 +56,47 @@ extern "C" void CL_RadixSort(Record* h_Rin, int rLen,Record* h_Rout,int numThrea
 	clReleaseKernel(Kernel);  
 	clReleaseEvent(eventList[0]);
 	clReleaseEvent(eventList[1]);
-}
\ No newline at end of file
+}
+static int topK_ascending(const void* p, const void* q)
+{
+	const Record* a=(const Record*)p;
+	const Record* b=(const Record*)q;
+	if((int)a->y!=(int)b->y)
+		return ((int)a->y<(int)b->y)?-1:1;
+	return (a->x<b->x)?-1:((a->x>b->x)?1:0);
+}
+static int topK_descending(const void* p, const void* q)
+{
+	const Record* a=(const Record*)p;
+	const Record* b=(const Record*)q;
+	if((int)a->y!=(int)b->y)
+		return ((int)a->y>(int)b->y)?-1:1;
+	return (a->x<b->x)?-1:((a->x>b->x)?1:0);
+}
+extern "C" int CL_TopKOnly(cl_mem d_Rin, int rLen, int k, int largest, cl_mem* d_Rout, int numThread, int numBlock, int _CPU_GPU)
+{
+	if(k>rLen)
+		k=rLen;
+	if(k<0)
+		k=0;
+	CL_MALLOC(d_Rout,sizeof(Record)*(k>0?k:1));
+	if(k==0)
+		return 0;
+	cl_event eventList[2];
+	int index=0;
+	cl_kernel Kernel; 
+	int CPU_GPU;
+	double burden;
+	topKImpl(d_Rin,rLen,k,largest,*d_Rout,numThread,numBlock,&index,eventList,&Kernel,&CPU_GPU,&burden,_CPU_GPU);
+	deschedule(CPU_GPU,burden);
+	clReleaseKernel(Kernel);
+	clReleaseEvent(eventList[0]);
+	clReleaseEvent(eventList[1]);
+	//the k records are few, they are ordered on the host; ties go by rid.
+	Record* h_R=(Record*)malloc(sizeof(Record)*k);
+	cl_readbuffer(h_R,*d_Rout,sizeof(Record)*k,0);
+	qsort(h_R,k,sizeof(Record),largest?topK_descending:topK_ascending);
+	cl_writebuffer(*d_Rout,h_R,sizeof(Record)*k,0);
+	free(h_R);
+	return k;
+}
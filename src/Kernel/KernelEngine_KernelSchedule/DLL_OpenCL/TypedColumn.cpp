@@ -0,0 +1,306 @@
+#include "TypedColumn.h"
+#include "KernelScheduler.h"
+#include "OpenCL_DLL.h"
+#include "scheduler.h"
+#include "testBitmap.h"
+#include "testScan.h"
+
+extern cl_program Program; // OpenCL program
+
+/*the suffix of the kernels of every type, TYPED_KERNELS in primitive.cl*/
+static const char *typedSuffix[COL_NUM_TYPE] = {"int", "long", "float", "double"};
+
+int typed_size(int colType)
+{
+	switch (colType)
+	{
+	case COL_INT64:
+	case COL_FLOAT64:
+		return 8;
+	default:
+		return 4;
+	}
+}
+
+/*the floats need cl_khr_fp64 on the device, they sum in double*/
+static cl_kernel typed_kernel(int colType, const char *name)
+{
+	assert(colType >= 0 && colType < COL_NUM_TYPE);
+	char kernelName[64];
+	snprintf(kernelName, sizeof(kernelName), "%s_%s", name, typedSuffix[colType]);
+	cl_int ciErr1;
+	cl_kernel kernel = clCreateKernel(Program, kernelName, &ciErr1);
+	if (ciErr1 != CL_SUCCESS)
+	{
+		printf("Error %d in clCreateKernel %s, Line %u in file %s !!!\n\n", ciErr1, kernelName, __LINE__, __FILE__);
+		cl_clean(EXIT_FAILURE);
+	}
+	return kernel;
+}
+
+static void typed_checkArg(cl_int ciErr1)
+{
+	if (ciErr1 != CL_SUCCESS)
+	{
+		printf("Error in clSetKernelArg, Line %u in file %s !!!\n\n", __LINE__, __FILE__);
+		cl_clean(EXIT_FAILURE);
+	}
+}
+
+void typed_gatherImpl(int colType, cl_mem d_col, cl_mem d_RIDList, int RIDLen, cl_mem d_out, int numThreadPB, int numBlock, int *index, cl_event *eventList, cl_kernel *Kernel, int *Flag_CPU_GPU, double *burden, int _CPU_GPU)
+{
+	size_t numThreadsPerBlock_x = numThreadPB;
+	size_t globalWorkingSetSize = numThreadPB * numBlock;
+	(*Kernel) = typed_kernel(colType, "typed_gather_kernel");
+	cl_int ciErr1 = clSetKernelArg((*Kernel), 0, sizeof(cl_mem), (void *)&d_col);
+	ciErr1 |= clSetKernelArg((*Kernel), 1, sizeof(cl_mem), (void *)&d_RIDList);
+	ciErr1 |= clSetKernelArg((*Kernel), 2, sizeof(cl_int), (void *)&RIDLen);
+	ciErr1 |= clSetKernelArg((*Kernel), 3, sizeof(cl_mem), (void *)&d_out);
+	typed_checkArg(ciErr1);
+	kernel_enqueue(RIDLen, 71, 1, &globalWorkingSetSize, &numThreadsPerBlock_x, eventList, index, Kernel, Flag_CPU_GPU, burden, _CPU_GPU);
+}
+
+void typed_reduceImpl(int colType, int accSize, cl_mem d_in, int rLen, int op, cl_mem d_partial, int numThreadPB, int numBlock, int *index, cl_event *eventList, cl_kernel *Kernel, int *Flag_CPU_GPU, double *burden, int _CPU_GPU)
+{
+	size_t numThreadsPerBlock_x = numThreadPB;
+	size_t globalWorkingSetSize = numThreadPB * numBlock;
+	(*Kernel) = typed_kernel(colType, "typed_reduce_kernel");
+	cl_int ciErr1 = clSetKernelArg((*Kernel), 0, sizeof(cl_mem), (void *)&d_in);
+	ciErr1 |= clSetKernelArg((*Kernel), 1, sizeof(cl_int), (void *)&rLen);
+	ciErr1 |= clSetKernelArg((*Kernel), 2, sizeof(cl_int), (void *)&op);
+	ciErr1 |= clSetKernelArg((*Kernel), 3, sizeof(cl_mem), (void *)&d_partial);
+	ciErr1 |= clSetKernelArg((*Kernel), 4, accSize * numThreadPB, NULL);
+	typed_checkArg(ciErr1);
+	kernel_enqueue(rLen, 72, 1, &globalWorkingSetSize, &numThreadsPerBlock_x, eventList, index, Kernel, Flag_CPU_GPU, burden, _CPU_GPU);
+}
+
+/*
+ * host side, per value type T: acc_t is ACC_T of its kernels.
+ */
+template <class T> struct typed_traits
+{
+	typedef long long acc_t;
+};
+template <> struct typed_traits<float>
+{
+	typedef double acc_t;
+};
+template <> struct typed_traits<double>
+{
+	typedef double acc_t;
+};
+
+template <class T> static void typed_agg(int colType, cl_mem d_vals, int rLen, int op, void *h_result, int numThreadPB, int numBlock, int _CPU_GPU)
+{
+	typedef typename typed_traits<T>::acc_t acc_t;
+	acc_t result = 0;
+	if (rLen > 0)
+	{
+		cl_event eventList[2];
+		int index = 0;
+		cl_kernel Kernel;
+		int CPU_GPU;
+		double burden;
+		acc_t *h_partial = (acc_t *)malloc(sizeof(acc_t) * numBlock);
+		cl_mem d_partial;
+		CL_MALLOC(&d_partial, sizeof(acc_t) * numBlock);
+		typed_reduceImpl(colType, sizeof(acc_t), d_vals, rLen, op, d_partial, numThreadPB, numBlock, &index, eventList, &Kernel, &CPU_GPU, &burden, _CPU_GPU);
+		cl_readbuffer(h_partial, d_partial, sizeof(acc_t) * numBlock, &index, eventList, &CPU_GPU, &burden, _CPU_GPU);
+		clWaitForEvents(1, &eventList[(index - 1) % 2]);
+		deschedule(CPU_GPU, burden);
+		result = h_partial[0];
+		for (int i = 1; i < numBlock; i++)
+		{
+			acc_t v = h_partial[i];
+			if (op == TYPED_AGG_SUM)
+				result += v;
+			else if ((op == TYPED_AGG_MIN) == (v < result))
+				result = v;
+		}
+		free(h_partial);
+		CL_FREE(d_partial);
+		clReleaseKernel(Kernel);
+		clReleaseEvent(eventList[0]);
+		clReleaseEvent(eventList[1]);
+	}
+	*(acc_t *)h_result = result;
+}
+
+template <class T> static void typed_rangeSelectionBitmap(int colType, cl_mem d_vals, int rLen, const void *low, const void *high, cl_mem *d_bitmap, int numThreadPB, int numBlock, int _CPU_GPU)
+{
+	cl_event eventList[2];
+	int index = 0;
+	cl_kernel Kernel;
+	int CPU_GPU;
+	double burden;
+	size_t numThreadsPerBlock_x = numThreadPB;
+	size_t globalWorkingSetSize = numThreadPB * numBlock;
+	T lowKey = *(const T *)low;
+	T highKey = *(const T *)high;
+	int numWord = BITMAP_NUM_WORD(rLen);
+	CL_MALLOC(d_bitmap, sizeof(int) * (numWord > 0 ? numWord : 1));
+	Kernel = typed_kernel(colType, "typed_rangeSelection_kernel");
+	cl_int ciErr1 = clSetKernelArg(Kernel, 0, sizeof(cl_mem), (void *)&d_vals);
+	ciErr1 |= clSetKernelArg(Kernel, 1, sizeof(cl_int), (void *)&rLen);
+	ciErr1 |= clSetKernelArg(Kernel, 2, sizeof(T), (void *)&lowKey);
+	ciErr1 |= clSetKernelArg(Kernel, 3, sizeof(T), (void *)&highKey);
+	ciErr1 |= clSetKernelArg(Kernel, 4, sizeof(cl_mem), (void *)d_bitmap);
+	typed_checkArg(ciErr1);
+	kernel_enqueue(rLen, 73, 1, &globalWorkingSetSize, &numThreadsPerBlock_x, eventList, &index, &Kernel, &CPU_GPU, &burden, _CPU_GPU);
+	clWaitForEvents(1, &eventList[(index - 1) % 2]);
+	deschedule(CPU_GPU, burden);
+	clReleaseKernel(Kernel);
+	clReleaseEvent(eventList[0]);
+	clReleaseEvent(eventList[1]);
+}
+
+int CL_TypedGatherOnly(cl_mem d_col, int colType, cl_mem d_RIDList, int RIDLen, cl_mem *d_out, int numThreadPB, int numBlock, int _CPU_GPU)
+{
+	CL_MALLOC(d_out, typed_size(colType) * (RIDLen > 0 ? RIDLen : 1));
+	if (RIDLen <= 0)
+		return 0;
+	cl_event eventList[2];
+	int index = 0;
+	cl_kernel Kernel;
+	int CPU_GPU;
+	double burden;
+	typed_gatherImpl(colType, d_col, d_RIDList, RIDLen, *d_out, numThreadPB, numBlock, &index, eventList, &Kernel, &CPU_GPU, &burden, _CPU_GPU);
+	clWaitForEvents(1, &eventList[(index - 1) % 2]);
+	deschedule(CPU_GPU, burden);
+	clReleaseKernel(Kernel);
+	clReleaseEvent(eventList[0]);
+	clReleaseEvent(eventList[1]);
+	return RIDLen;
+}
+
+void CL_TypedAggOnly(cl_mem d_vals, int colType, int rLen, int aggType, void *h_result, int numThreadPB, int numBlock, int _CPU_GPU)
+{
+	switch (colType)
+	{
+	case COL_INT32:
+		typed_agg<int>(colType, d_vals, rLen, aggType, h_result, numThreadPB, numBlock, _CPU_GPU);
+		break;
+	case COL_INT64:
+		typed_agg<long long>(colType, d_vals, rLen, aggType, h_result, numThreadPB, numBlock, _CPU_GPU);
+		break;
+	case COL_FLOAT32:
+		typed_agg<float>(colType, d_vals, rLen, aggType, h_result, numThreadPB, numBlock, _CPU_GPU);
+		break;
+	case COL_FLOAT64:
+		typed_agg<double>(colType, d_vals, rLen, aggType, h_result, numThreadPB, numBlock, _CPU_GPU);
+		break;
+	}
+}
+
+void CL_TypedRangeSelectionBitmapOnly(cl_mem d_vals, int colType, int rLen, const void *low, const void *high, cl_mem *d_bitmap, int numThreadPB, int numBlock, int _CPU_GPU)
+{
+	switch (colType)
+	{
+	case COL_INT32:
+		typed_rangeSelectionBitmap<int>(colType, d_vals, rLen, low, high, d_bitmap, numThreadPB, numBlock, _CPU_GPU);
+		break;
+	case COL_INT64:
+		typed_rangeSelectionBitmap<long long>(colType, d_vals, rLen, low, high, d_bitmap, numThreadPB, numBlock, _CPU_GPU);
+		break;
+	case COL_FLOAT32:
+		typed_rangeSelectionBitmap<float>(colType, d_vals, rLen, low, high, d_bitmap, numThreadPB, numBlock, _CPU_GPU);
+		break;
+	case COL_FLOAT64:
+		typed_rangeSelectionBitmap<double>(colType, d_vals, rLen, low, high, d_bitmap, numThreadPB, numBlock, _CPU_GPU);
+		break;
+	}
+}
+
+/*hash join on equal keys of one type: R is built into an open addressing
+ * table, every key of S probes it twice, to count its matches and to write
+ * them. d_RIDR/d_RIDS map the positions to base rids, NULL for the base.*/
+int CL_TypedHjOnly(cl_mem d_R, cl_mem d_RIDR, int rLen, cl_mem d_S, cl_mem d_RIDS, int sLen, int colType, cl_mem *d_Rout, int numThreadPB, int numBlock, int _CPU_GPU)
+{
+	if (rLen <= 0 || sLen <= 0)
+	{
+		CL_MALLOC(d_Rout, sizeof(Record));
+		return 0;
+	}
+	cl_event eventList[2];
+	int index = 0;
+	cl_kernel Kernel;
+	int CPU_GPU;
+	double burden;
+	size_t numThreadsPerBlock_x = numThreadPB;
+	size_t globalWorkingSetSize = numThreadPB * numBlock;
+	int numSlot = 1;
+	while (numSlot < rLen * TYPED_HASH_LOAD)
+		numSlot <<= 1;
+	int mask = numSlot - 1;
+	int hasRIDR = (d_RIDR != NULL);
+	int hasRIDS = (d_RIDS != NULL);
+	/*unused buffer arguments still need a buffer*/
+	cl_mem d_RIDRArg = hasRIDR ? d_RIDR : d_R;
+	cl_mem d_RIDSArg = hasRIDS ? d_RIDS : d_S;
+	cl_mem d_slot;
+	cl_mem d_count;
+	cl_mem d_sum;
+	CL_MALLOC(&d_slot, sizeof(int) * numSlot);
+	CL_MALLOC(&d_count, sizeof(int) * sLen);
+	CL_MALLOC(&d_sum, sizeof(int) * sLen);
+	int *h_slot = (int *)malloc(sizeof(int) * numSlot);
+	memset(h_slot, 0xff, sizeof(int) * numSlot);
+	cl_writebuffer(d_slot, h_slot, sizeof(int) * numSlot, &index, eventList, &CPU_GPU, &burden, _CPU_GPU);
+	free(h_slot);
+
+	Kernel = typed_kernel(colType, "typed_hashBuild_kernel");
+	cl_int ciErr1 = clSetKernelArg(Kernel, 0, sizeof(cl_mem), (void *)&d_R);
+	ciErr1 |= clSetKernelArg(Kernel, 1, sizeof(cl_int), (void *)&rLen);
+	ciErr1 |= clSetKernelArg(Kernel, 2, sizeof(cl_mem), (void *)&d_slot);
+	ciErr1 |= clSetKernelArg(Kernel, 3, sizeof(cl_int), (void *)&mask);
+	typed_checkArg(ciErr1);
+	kernel_enqueue(rLen, 74, 1, &globalWorkingSetSize, &numThreadsPerBlock_x, eventList, &index, &Kernel, &CPU_GPU, &burden, _CPU_GPU);
+	clWaitForEvents(1, &eventList[(index - 1) % 2]);
+	clReleaseKernel(Kernel);
+
+	int numResult = 0;
+	for (int toWrite = 0; toWrite < 2; toWrite++)
+	{
+		if (toWrite)
+		{
+			/*the exclusive prefix sum of the counts is where every key writes*/
+			ScanPara *SP = scan_getPara(sLen);
+			scanImpl(d_count, sLen, d_sum, &index, eventList, &Kernel, &CPU_GPU, &burden, SP, _CPU_GPU);
+			clWaitForEvents(1, &eventList[(index - 1) % 2]);
+			int lastCount = 0, lastSum = 0;
+			cl_readbuffer(&lastCount, d_count, (sLen - 1) * sizeof(int), sizeof(int), &index, eventList, &CPU_GPU, &burden, _CPU_GPU);
+			cl_readbuffer(&lastSum, d_sum, (sLen - 1) * sizeof(int), sizeof(int), &index, eventList, &CPU_GPU, &burden, _CPU_GPU);
+			clWaitForEvents(1, &eventList[(index - 1) % 2]);
+			numResult = lastCount + lastSum;
+			CL_MALLOC(d_Rout, sizeof(Record) * (numResult > 0 ? numResult : 1));
+			if (numResult == 0)
+				break;
+		}
+		Kernel = typed_kernel(colType, "typed_hashProbe_kernel");
+		cl_mem d_out = toWrite ? *d_Rout : d_slot;
+		ciErr1 = clSetKernelArg(Kernel, 0, sizeof(cl_mem), (void *)&d_R);
+		ciErr1 |= clSetKernelArg(Kernel, 1, sizeof(cl_mem), (void *)&d_slot);
+		ciErr1 |= clSetKernelArg(Kernel, 2, sizeof(cl_int), (void *)&mask);
+		ciErr1 |= clSetKernelArg(Kernel, 3, sizeof(cl_mem), (void *)&d_S);
+		ciErr1 |= clSetKernelArg(Kernel, 4, sizeof(cl_int), (void *)&sLen);
+		ciErr1 |= clSetKernelArg(Kernel, 5, sizeof(cl_int), (void *)&toWrite);
+		ciErr1 |= clSetKernelArg(Kernel, 6, sizeof(cl_mem), (void *)&d_count);
+		ciErr1 |= clSetKernelArg(Kernel, 7, sizeof(cl_mem), (void *)&d_sum);
+		ciErr1 |= clSetKernelArg(Kernel, 8, sizeof(cl_mem), (void *)&d_RIDRArg);
+		ciErr1 |= clSetKernelArg(Kernel, 9, sizeof(cl_int), (void *)&hasRIDR);
+		ciErr1 |= clSetKernelArg(Kernel, 10, sizeof(cl_mem), (void *)&d_RIDSArg);
+		ciErr1 |= clSetKernelArg(Kernel, 11, sizeof(cl_int), (void *)&hasRIDS);
+		ciErr1 |= clSetKernelArg(Kernel, 12, sizeof(cl_mem), (void *)&d_out);
+		typed_checkArg(ciErr1);
+		kernel_enqueue(sLen, 75, 1, &globalWorkingSetSize, &numThreadsPerBlock_x, eventList, &index, &Kernel, &CPU_GPU, &burden, _CPU_GPU);
+		clWaitForEvents(1, &eventList[(index - 1) % 2]);
+		clReleaseKernel(Kernel);
+	}
+	deschedule(CPU_GPU, burden);
+	CL_FREE(d_slot);
+	CL_FREE(d_count);
+	CL_FREE(d_sum);
+	clReleaseEvent(eventList[0]);
+	clReleaseEvent(eventList[1]);
+	return numResult;
+}
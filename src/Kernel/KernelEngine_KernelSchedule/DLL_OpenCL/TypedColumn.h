@@ -0,0 +1,16 @@
+#ifndef _TYPED_COLUMN_H_
+#define _TYPED_COLUMN_H_
+#include "common.h"
+/*
+ * Typed value columns: a plain array of int32, int64, float32 or float64
+ * values (COL_* in OpenCL_DLL.h), the rid of a value is its position. The
+ * kernels of every type are made by TYPED_KERNELS in primitive.cl, the host
+ * side is templated on the value type.
+ */
+#define TYPED_HASH_LOAD (2) // slots per key of the join hash table.
+
+int typed_size(int colType);
+void typed_gatherImpl(int colType, cl_mem d_col, cl_mem d_RIDList, int RIDLen, cl_mem d_out, int numThreadPB, int numBlock, int *index, cl_event *eventList, cl_kernel *Kernel, int *Flag_CPU_GPU, double *burden, int _CPU_GPU);
+/*one partial per work group in d_partial*/
+void typed_reduceImpl(int colType, int accSize, cl_mem d_in, int rLen, int op, cl_mem d_partial, int numThreadPB, int numBlock, int *index, cl_event *eventList, cl_kernel *Kernel, int *Flag_CPU_GPU, double *burden, int _CPU_GPU);
+#endif
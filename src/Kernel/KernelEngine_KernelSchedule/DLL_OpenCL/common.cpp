@@ -1,6 +1,7 @@
 #include "common.h"
 #include "KernelScheduler.h"
 #include "OpenCL_DLL.h"
+#include "Residency.h"
 #include "scheduler.h"
 
 // OpenCL Vars---------0 for CPU, 1 for GPU
@@ -237,8 +238,8 @@ void cl_prepareProgram(char *cSourceFile, char *dir) {
     printf("compilation success!\n");
   }
 }
-void cl_getKernel(char *kernelName, int CPU_GPU) {};
-void cl_getKernel(char *kernelName, cl_kernel *Kernel) {
+void cl_getKernel(const char *kernelName, int CPU_GPU) {};
+void cl_getKernel(const char *kernelName, cl_kernel *Kernel) {
   cl_int ciErr1;
   (*Kernel) = clCreateKernel(Program, kernelName, &ciErr1);
   // shrLog("clCreateKernel (VectorAdd)...\n");
@@ -260,8 +261,10 @@ void cl_getKernelByKernelFunction(char *kernelName, cl_kernel *Kernel) {
 }
 void CL_CREATE(cl_mem *mem, cl_int size) { CL_MALLOC(mem, size); }
 void CL_DESTORY(cl_mem *mem) {
-  if (mem)
+  if (mem) {
+    residence_forget(*mem);
     clReleaseMemObject(*mem);
+  }
 }
 cl_int cl_malloc(cl_mem *mem, cl_mem_flags flag, cl_int size) {
   cl_int ciErr1;
@@ -327,6 +330,7 @@ void cl_writebuffer(cl_mem to, void *from, size_t size, int *index,
     ciErr1 = clEnqueueWriteBuffer(CommandQueue[CPU_GPU], to, CL_FALSE, 0, size,
                                   from, 0, NULL, &eventList[*index]);
   (*index)++;
+  residence_tag(to, size, CPU_GPU);
 
   if (ciErr1 != CL_SUCCESS) {
     printf("ciErr1 is %d, Error in clEnqueueWriteBuffer, Line %u in file %s "
@@ -355,6 +359,7 @@ void cl_copyBuffer(cl_mem dest, cl_mem src, size_t size, int *index,
                                  0, NULL, &eventList[*index]);
 
   (*index)++;
+  residence_tag(dest, size, CPU_GPU);
   if (ciErr1 != CL_SUCCESS) {
     printf(" Error %d, in //cl_copyBuffer, Line %u in file %s !!!\n\n", ciErr1,
            __LINE__, __FILE__);
@@ -382,6 +387,7 @@ void cl_copyBuffer(cl_mem dest, int destOffset, cl_mem src, size_t size,
                                  destOffset, size, 0, NULL, &eventList[*index]);
 
   (*index)++;
+  residence_tag(dest, destOffset + size, CPU_GPU);
   // clEnqueueWriteBuffer(CommandQueue[CPU_GPU], to, CL_FALSE, 0, size, from, 0,
   // NULL, NULL);
   if (ciErr1 != CL_SUCCESS) {
@@ -410,6 +416,7 @@ void cl_copyBuffer(cl_mem dest, int destOffset, cl_mem src, int srcOffset,
                                  destOffset, size, 0, NULL, &eventList[*index]);
 
   (*index)++;
+  residence_tag(dest, destOffset + size, CPU_GPU);
   // clEnqueueWriteBuffer(CommandQueue[CPU_GPU], to, CL_FALSE, 0, size, from, 0,
   // NULL, NULL);
   if (ciErr1 != CL_SUCCESS) {
@@ -461,6 +468,31 @@ void CopyCPUToGPU(cl_mem to, void *from, size_t size) {
 void CopyGPUToGPU(cl_mem from, cl_mem to, size_t size) {
   cl_copyBuffer(to, from, size, 0);
 }
+void CopyGPUToGPU(cl_mem from, size_t fromOffset, cl_mem to, size_t toOffset,
+                  size_t size) {
+  cl_int ciErr1 = clEnqueueCopyBuffer(CommandQueue[0], from, to, fromOffset,
+                                      toOffset, size, 0, NULL, NULL);
+  if (ciErr1 != CL_SUCCESS) {
+    printf("Error %d in CopyGPUToGPU, Line %u in file %s !!!\n\n", ciErr1,
+           __LINE__, __FILE__);
+    cl_clean(EXIT_FAILURE);
+  }
+  clFinish(CommandQueue[0]);
+}
+/*a window of mem without copy, offset must respect CL_DEVICE_MEM_BASE_ADDR_ALIGN*/
+void CL_SubBuffer(cl_mem mem, size_t offset, size_t size, cl_mem *sub) {
+  cl_int ciErr1;
+  cl_buffer_region region;
+  region.origin = offset;
+  region.size = size;
+  *sub = clCreateSubBuffer(mem, CL_MEM_READ_WRITE, CL_BUFFER_CREATE_TYPE_REGION,
+                           &region, &ciErr1);
+  if (ciErr1 != CL_SUCCESS) {
+    printf("Error %d in clCreateSubBuffer, Line %u in file %s !!!\n\n", ciErr1,
+           __LINE__, __FILE__);
+    cl_clean(EXIT_FAILURE);
+  }
+}
 
 void CopyGPUToCPU(cl_mem from, void *to, size_t size) {
   cl_readbuffer(to, from, size, 0);
@@ -20,6 +20,7 @@
 #include "SDKApplication.hpp"
 #include "verctor_types.h"
 #define _tonyPrint_(STR) printf(STR)
+#define THREAD_LOCAL __thread
 //#define _tonyPrint_(STR)
 // Note: assert is included via <cassert> above
 #define COALESCED
@@ -68,8 +69,8 @@ void cl_init(cl_device_type TYPE);
 void cl_init_common ();
 void cl_clean (int iExitCode);
 void cl_prepareProgram(char* cSourceFile, char* dir);
-void cl_getKernel(char* kernelName,cl_kernel *kernel);
-void cl_getKernel(char* kernelName,int CPU_GPU);
+void cl_getKernel(const char* kernelName,cl_kernel *kernel);
+void cl_getKernel(const char* kernelName,int CPU_GPU);
 void cl_launchKernel(cl_uint work_dim, const size_t *groups, size_t *threads,cl_kernel *Kernel,int CPU_GPU);
 
 #define HOST_MALLOC(PTR,SIZE) PTR=(void *)malloc(SIZE);
@@ -78,7 +79,8 @@ void cl_launchKernel(cl_uint work_dim, const size_t *groups, size_t *threads,cl_
 #define CL_MALLOC_R(PTR,SIZE) cl_malloc(PTR,CL_MEM_READ_ONLY,SIZE)
 #define CL_MALLOC(PTR,SIZE) cl_malloc(PTR,CL_MEM_READ_WRITE,SIZE)
 #define CL_MALLOC_W(PTR,SIZE) cl_malloc(PTR,CL_MEM_WRITE_ONLY,SIZE)
-#define CL_FREE(PTR) if(PTR)clReleaseMemObject(PTR);
+void residence_forget(cl_mem mem);
+#define CL_FREE(PTR) if(PTR)residence_forget(PTR),clReleaseMemObject(PTR);
 
 #define __DEBUG__(STR) printf(STR);
 
@@ -101,6 +103,7 @@ void cl_launchKernel(cl_uint work_dim, const size_t *groups, size_t *threads,cl_
 
 #define NUM_DELTA_PER_BLOCK 8 
 #define SMJ_NUM_THREADS_PER_BLOCK 256
+#define MERGEJOIN_TILE (1024) //outputs of a work group of mergeJoin_write_kernel.
 #define IntCeilDiv(a, b) ( (int)ceilf((a) / float(b))	)
 
 #define MaxTag 64
@@ -95,7 +95,6 @@ void generateRandInt(int *R, int max, int rLen, int seed)
 //dup=1,2,4,8,16,32
 void generateSkewDuplicates(int2 *R,  int rLen,int2 *S, int sLen, int max, int dup, int seed)
 {
-	int a=0;
 	int i=0;
 	int minmin=0;
 	int maxmax=2;
@@ -117,10 +116,10 @@ void generateSkewDuplicates(int2 *R,  int rLen,int2 *S, int sLen, int max, int d
 		R[i].x=i+1;
 	}
 	//copy the seg to all other segs.
-	for(a=1;a<dup;a++)
+	for(i=seg;i<rLen;i++)
 	{
-		for(i=0;i<seg;i++)
-			R[a*seg+i].y=R[i].y;
+		R[i].y=R[i%seg].y;
+		R[i].x=i+1;
 	}
 	const int offset=(1<<15)-1;
 	for(i=0;i<sLen;i++)
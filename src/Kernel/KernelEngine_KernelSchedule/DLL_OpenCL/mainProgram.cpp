@@ -49,9 +49,9 @@ double AddGPUBurden_Read;
 double AddCPUBurden_Read;
 double AddGPUBurden_Write;
 double AddCPUBurden_Write;
-double AddGPUBurden[60];
-double AddCPUBurden[60];
-double speedupGPUoverCPU[60 + 3];
+double AddGPUBurden[NUM_KERNEL_ID];
+double AddCPUBurden[NUM_KERNEL_ID];
+double speedupGPUoverCPU[NUM_KERNEL_ID + 3];
 double LothresholdForGPUApp;
 double LothresholdForCPUApp;
 cl_mem D1;
@@ -101,6 +101,7 @@ pthread_t h_thread2;
 pthread_t h_thread3;
 pthread_t h_thread4;
 int global_KernelSchedule = 0;
+int global_ResidencyAware = 1;
 volatile int thread_running = 1; // Flag for thread control
 using namespace std;
 char *dir = "";
@@ -128,6 +129,9 @@ void testJoin(int argc, char **argv) {
   case 4:
     testMJ(rLen, rLen);
     break;
+  case 5:
+    testSMJSkew(rLen, rLen, 16);
+    break;
   }
 }
 void testAllPrimitive(int argc, char **argv) {
@@ -281,7 +285,7 @@ void handShaking() {
   int CPU_GPU = 0;
   int kid;
   cl_kernel testkernel;
-  for (kid = 0; kid < 51; kid++) {
+  for (kid = 0; kid < NUM_KERNEL_ID; kid++) {
     for (CPU_GPU = 0; CPU_GPU < 2; CPU_GPU++) {
       printf("CPU_GPU:%d, KID:%d\n", CPU_GPU, kid);
       switch (kid) {
@@ -448,20 +452,28 @@ void handShaking() {
         AnyHowFree();
         break;
       }
-      case 32: { /*projection_map_kernel*/
-
+      case 32: { /*mergeSort_blockSort_kernel*/
+        inital();
+        mergeSort_blockSort_kernel_handshake(CPU_GPU, &testkernel);
+        AnyHowFree();
         break;
       }
-      case 33: { /*projection_map_kernel*/
-
+      case 33: { /*mergeSort_merge_kernel*/
+        inital();
+        mergeSort_merge_kernel_handshake(CPU_GPU, &testkernel);
+        AnyHowFree();
         break;
       }
-      case 34: { /*projection_map_kernel*/
-
+      case 34: { /*mergeJoin_count_kernel*/
+        inital();
+        mergeJoin_count_kernel_handshake(CPU_GPU, &testkernel);
+        AnyHowFree();
         break;
       }
-      case 35: { /*projection_map_kernel*/
-
+      case 35: { /*mergeJoin_write_kernel*/
+        inital();
+        mergeJoin_write_kernel_handshake(CPU_GPU, &testkernel);
+        AnyHowFree();
         break;
       }
       case 36: { /*projection_map_kernel*/
@@ -549,6 +561,198 @@ void handShaking() {
         AnyHowFree();
         break;
       }
+      case 51: { /*bitmap_rangeSelection_kernel*/
+        inital();
+        bitmap_rangeSelection_kernel_handshake(CPU_GPU, &testkernel);
+        AnyHowFree();
+        break;
+      }
+      case 52: { /*bitmap_combine_kernel*/
+        inital();
+        bitmap_combine_kernel_handshake(CPU_GPU, &testkernel);
+        AnyHowFree();
+        break;
+      }
+      case 53: { /*bitmap_count_kernel*/
+        inital();
+        bitmap_count_kernel_handshake(CPU_GPU, &testkernel);
+        AnyHowFree();
+        break;
+      }
+      case 54: { /*bitmap_toRIDList_kernel*/
+        inital();
+        bitmap_toRIDList_kernel_handshake(CPU_GPU, &testkernel);
+        AnyHowFree();
+        break;
+      }
+      case 55: { /*bitmap_total_kernel*/
+        inital();
+        bitmap_total_kernel_handshake(CPU_GPU, &testkernel);
+        AnyHowFree();
+        break;
+      }
+      case 56: { /*hashGroupBy_build_kernel*/
+        inital();
+        hashGroupBy_build_kernel_handshake(CPU_GPU, &testkernel);
+        AnyHowFree();
+        break;
+      }
+      case 57: { /*hashGroupBy_rank_kernel*/
+        inital();
+        hashGroupBy_rank_kernel_handshake(CPU_GPU, &testkernel);
+        AnyHowFree();
+        break;
+      }
+      case 58: { /*hashGroupBy_scatter_kernel*/
+        inital();
+        hashGroupBy_scatter_kernel_handshake(CPU_GPU, &testkernel);
+        AnyHowFree();
+        break;
+      }
+      case 59: { /*multiAgg_kernel*/
+        inital();
+        multiAgg_kernel_handshake(CPU_GPU, &testkernel);
+        AnyHowFree();
+        break;
+      }
+      case 60: { /*multiAggAfterGroupBy_kernel*/
+        inital();
+        multiAggAfterGroupBy_kernel_handshake(CPU_GPU, &testkernel);
+        AnyHowFree();
+        break;
+      }
+      case 61: { /*topK_histogram_kernel*/
+        inital();
+        topK_histogram_kernel_handshake(CPU_GPU, &testkernel);
+        AnyHowFree();
+        break;
+      }
+      case 62: { /*topK_write_kernel*/
+        inital();
+        topK_write_kernel_handshake(CPU_GPU, &testkernel);
+        AnyHowFree();
+        break;
+      }
+      case 63: { /*distinct_insert_kernel*/
+        inital();
+        distinct_insert_kernel_handshake(CPU_GPU, &testkernel);
+        AnyHowFree();
+        break;
+      }
+      case 64: { /*distinct_gatherFirst_kernel*/
+        inital();
+        distinct_gatherFirst_kernel_handshake(CPU_GPU, &testkernel);
+        AnyHowFree();
+        break;
+      }
+      case 65: { /*distinct_hashKey_kernel*/
+        inital();
+        distinct_hashKey_kernel_handshake(CPU_GPU, &testkernel);
+        AnyHowFree();
+        break;
+      }
+      case 66: { /*distinct_firstInRun_kernel*/
+        inital();
+        distinct_firstInRun_kernel_handshake(CPU_GPU, &testkernel);
+        AnyHowFree();
+        break;
+      }
+      case 67: { /*scanSinglePass_kernel*/
+        inital();
+        scanSinglePass_kernel_handshake(CPU_GPU, &testkernel);
+        AnyHowFree();
+        break;
+      }
+      case 68: { /*filterImpl_fused_kernel*/
+        inital();
+        filterImpl_fused_kernel_handshake(CPU_GPU, &testkernel);
+        AnyHowFree();
+        break;
+      }
+      case 69: { /*predicate_kernel*/
+        inital();
+        predicate_kernel_handshake(CPU_GPU, &testkernel);
+        AnyHowFree();
+        break;
+      }
+      case 70: { /*predicate_bitmap_kernel*/
+        inital();
+        predicate_bitmap_kernel_handshake(CPU_GPU, &testkernel);
+        AnyHowFree();
+        break;
+      }
+      case 71: { /*typed_gather_kernel_int*/
+        inital();
+        typed_gather_kernel_handshake(CPU_GPU, &testkernel);
+        AnyHowFree();
+        break;
+      }
+      case 72: { /*typed_reduce_kernel_int*/
+        inital();
+        typed_reduce_kernel_handshake(CPU_GPU, &testkernel);
+        AnyHowFree();
+        break;
+      }
+      case 73: { /*typed_rangeSelection_kernel_int*/
+        inital();
+        typed_rangeSelection_kernel_handshake(CPU_GPU, &testkernel);
+        AnyHowFree();
+        break;
+      }
+      case 74: { /*typed_hashBuild_kernel_int*/
+        inital();
+        typed_hashBuild_kernel_handshake(CPU_GPU, &testkernel);
+        AnyHowFree();
+        break;
+      }
+      case 75: { /*typed_hashProbe_kernel_int*/
+        inital();
+        typed_hashProbe_kernel_handshake(CPU_GPU, &testkernel);
+        AnyHowFree();
+        break;
+      }
+      case 76: { /*packed_decode_kernel*/
+        inital();
+        packed_decode_kernel_handshake(CPU_GPU, &testkernel);
+        AnyHowFree();
+        break;
+      }
+      case 77: { /*packed_rangeSelection_kernel*/
+        inital();
+        packed_rangeSelection_kernel_handshake(CPU_GPU, &testkernel);
+        AnyHowFree();
+        break;
+      }
+      case 78: { /*packed_reduce_kernel*/
+        inital();
+        packed_reduce_kernel_handshake(CPU_GPU, &testkernel);
+        AnyHowFree();
+        break;
+      }
+      case 79: { /*groupResult_kernel*/
+        inital();
+        groupResult_kernel_handshake(CPU_GPU, &testkernel);
+        AnyHowFree();
+        break;
+      }
+      case 80: { /*hll_build_kernel*/
+        inital();
+        hll_build_kernel_handshake(CPU_GPU, &testkernel);
+        AnyHowFree();
+        break;
+      }
+      case 81: { /*quantileSketch_build_kernel*/
+        inital();
+        quantileSketch_build_kernel_handshake(CPU_GPU, &testkernel);
+        AnyHowFree();
+        break;
+      }
+      case 82: { /*reduceSinglePass_kernel*/
+        inital();
+        reduceSinglePass_kernel_handshake(CPU_GPU, &testkernel);
+        AnyHowFree();
+        break;
+      }
       } // end of switch
     } // end of inner for loop
   } // end of outer for loop
@@ -587,11 +791,11 @@ void handShaking() {
   double *sortSpeedUp;
   double *sortCPUBurden;
   double *sortGPUBurden;
-  sortSpeedUp = (double *)malloc(sizeof(double) * 60);
-  sortCPUBurden = (double *)malloc(sizeof(double) * 60);
-  sortGPUBurden = (double *)malloc(sizeof(double) * 60);
+  sortSpeedUp = (double *)malloc(sizeof(double) * NUM_KERNEL_ID);
+  sortCPUBurden = (double *)malloc(sizeof(double) * NUM_KERNEL_ID);
+  sortGPUBurden = (double *)malloc(sizeof(double) * NUM_KERNEL_ID);
   /*SORT for KERNEL*/
-  for (i = 0; i < 60; i++) {
+  for (i = 0; i < NUM_KERNEL_ID; i++) {
     if (AddGPUBurden[i] != 0) {
       fprintf(ofp, "kc %d  %lf\n", i, AddCPUBurden[i]);
       fprintf(ofp, "kg %d  %lf\n", i, AddGPUBurden[i]);
@@ -710,6 +914,7 @@ void *performanceTester(void *lpParam) {
     testSortImpl(rLen, 256, 4);
     testFilterImpl(rLen, 256, 128);
     testSMJ(256 * 1024, 256 * 1024);
+    testSMJSkew(256 * 1024, 256 * 1024, 16);
     // testNINLJ(256*1024/numthread, 256*1024/numthread);
     // testMJ(256*1024,256*1024);
     break;
@@ -808,11 +1013,11 @@ void readFromFile() {
         double *sortSpeedUp;
         double *sortCPUBurden;
         double *sortGPUBurden;
-        sortSpeedUp = (double *)malloc(sizeof(double) * 60);
-        sortCPUBurden = (double *)malloc(sizeof(double) * 60);
-        sortGPUBurden = (double *)malloc(sizeof(double) * 60);
+        sortSpeedUp = (double *)malloc(sizeof(double) * NUM_KERNEL_ID);
+        sortCPUBurden = (double *)malloc(sizeof(double) * NUM_KERNEL_ID);
+        sortGPUBurden = (double *)malloc(sizeof(double) * NUM_KERNEL_ID);
         /*SORT for KERNEL*/
-        for (i = 0; i < 60; i++) {
+        for (i = 0; i < NUM_KERNEL_ID; i++) {
           if (AddGPUBurden[i] != 0) {
             speedupGPUoverCPU[i] = AddCPUBurden[i] / AddGPUBurden[i];
             sortSpeedUp[counter] = speedupGPUoverCPU[i];
@@ -77,6 +77,7 @@ typedef struct {
 //for smj
 #define NUM_DELTA_PER_BLOCK 8 
 #define SMJ_NUM_THREADS_PER_BLOCK 256
+#define MERGEJOIN_TILE (1024)
 
 #define TEST_MAX (1<<30)
 #define TEST_MIN (0)
@@ -908,6 +909,347 @@ filterImpl_map_kernel(__global Record* d_Rin, int beginPos, int rLen, __global i
 	}	
 }
 
+__kernel void//kid=68, fused map, scan and write in one pass
+filterImpl_fused_kernel(__global Record* d_Rin, int beginPos, int rLen, int smallKey, int largeKey,
+								  __global Record* d_Rout, int outCap, __global int* d_outSize )
+{
+	__local int s_count;
+	__local int s_base;
+	int lid = get_local_id(0);
+	int tileSize = get_local_size(0);
+	int delta = get_num_groups(0)*tileSize;
+	for(int tile=get_group_id(0)*tileSize;tile<rLen;tile+=delta)
+	{
+		int pos = tile+lid;
+		Record value;
+		int flag = 0;
+		if(pos<rLen)
+		{
+			value = d_Rin[pos];
+			flag = ( value.y >= smallKey ) && ( value.y <= largeKey );
+		}
+		if(lid==0)
+			s_count=0;
+		barrier(CLK_LOCAL_MEM_FENCE);
+		//compact the tile in local memory
+		int slot = flag ? atomic_inc(&s_count) : 0;
+		barrier(CLK_LOCAL_MEM_FENCE);
+		//one global atomic per tile reserves its output range
+		if(lid==0)
+			s_base = (s_count>0) ? atomic_add(d_outSize,s_count) : 0;
+		barrier(CLK_LOCAL_MEM_FENCE);
+		//past outCap the matches are only counted, the host grows the output.
+		if(flag && s_base+slot<outCap)
+			d_Rout[s_base+slot] = value;
+		barrier(CLK_LOCAL_MEM_FENCE);
+	}
+}
+
+//bitmaps over a base table, bit i of word i/32 stands for the record at position i.
+__kernel void//kid=51, one word per work item
+bitmap_rangeSelection_kernel(__global Record* d_Rin, int rLen, int smallKey, int largeKey,
+								  __global uint* d_bitmap )
+{
+	int numWord = (rLen+31)>>5;
+	for(int w=get_global_id(0);w<numWord;w+=get_global_size(0))
+	{
+		uint bits = 0;
+		int pos = w<<5;
+		int endPos = min(pos+32,rLen);
+		for(int b=0;pos<endPos;pos++,b++)
+		{
+			Record value = d_Rin[pos];
+			if(( value.y >= smallKey ) && ( value.y <= largeKey ))
+				bits |= (1u<<b);
+		}
+		d_bitmap[w] = bits;
+	}
+}
+
+__kernel void//kid=52, d_A = d_A & d_B, or d_A | d_B
+bitmap_combine_kernel(__global uint* d_A, __global uint* d_B, int numWord, int isOr )
+{
+	for(int w=get_global_id(0);w<numWord;w+=get_global_size(0))
+		d_A[w] = isOr ? (d_A[w]|d_B[w]) : (d_A[w]&d_B[w]);
+}
+
+__kernel void//kid=53, d_count has numWord+1 entries, the last is 0 so its prefix sum is the total
+bitmap_count_kernel(__global uint* d_bitmap, int numWord, __global int* d_count )
+{
+	for(int w=get_global_id(0);w<=numWord;w+=get_global_size(0))
+		d_count[w] = (w<numWord) ? popcount(d_bitmap[w]) : 0;
+}
+
+__kernel void//kid=55, *d_total += the number of set bits, one atomic per work group
+bitmap_total_kernel(__global uint* d_bitmap, int numWord, __global int* d_total, __local int* s_total )
+{
+	if(get_local_id(0)==0)
+		s_total[0] = 0;
+	barrier(CLK_LOCAL_MEM_FENCE);
+	int count = 0;
+	for(int w=get_global_id(0);w<numWord;w+=get_global_size(0))
+		count += popcount(d_bitmap[w]);
+	if(count>0)
+		atomic_add(s_total,count);
+	barrier(CLK_LOCAL_MEM_FENCE);
+	if(get_local_id(0)==0 && s_total[0]>0)
+		atomic_add(d_total,s_total[0]);
+}
+
+__kernel void//kid=54, d_sum is the exclusive prefix sum of bitmap_count_kernel
+bitmap_toRIDList_kernel(__global uint* d_bitmap, int numWord, __global int* d_sum,
+								  __global int* d_RIDList )
+{
+	for(int w=get_global_id(0);w<numWord;w+=get_global_size(0))
+	{
+		uint bits = d_bitmap[w];
+		int outPos = d_sum[w];
+		for(int b=0;bits!=0;b++,bits>>=1)
+		{
+			if(bits&1)
+				d_RIDList[outPos++] = (w<<5)+b;
+		}
+	}
+}
+
+//typed value columns (COL_* in OpenCL_DLL.h), the rid of a value is its position.
+//TYPED_KERNELS(T,ACC_T) makes the kernels of one value type, named <kernel>_T;
+//ACC_T holds its sums, 64 bit integers for the integers and double for the floats.
+inline ulong typed_keyBits_int(int k) { return (ulong)(uint)k; }
+inline ulong typed_keyBits_long(long k) { return (ulong)k; }
+#ifdef cl_khr_fp64
+#pragma OPENCL EXTENSION cl_khr_fp64 : enable
+//+0.0 folds -0.0 into 0.0, they are equal keys.
+inline ulong typed_keyBits_float(float k) { return (ulong)as_uint(k+0.0f); }
+inline ulong typed_keyBits_double(double k) { return as_ulong(k+0.0); }
+#endif
+
+#define TYPED_KERNELS(T, ACC_T) \
+inline uint typed_hash_##T(T key) \
+{ \
+	ulong x = typed_keyBits_##T(key); \
+	x ^= x>>33; \
+	x *= 0xff51afd7ed558ccdUL; \
+	x ^= x>>33; \
+	return (uint)x; \
+} \
+__kernel void/*kid=71*/ \
+typed_gather_kernel_##T(__global T* d_col, __global int* d_RIDList, int RIDLen, __global T* d_out) \
+{ \
+	for(int i=get_global_id(0);i<RIDLen;i+=get_global_size(0)) \
+		d_out[i] = d_col[d_RIDList[i]]; \
+} \
+/*kid=72, op 0 sum, 1 min, 2 max; rLen>0, one partial per work group*/ \
+__kernel void \
+typed_reduce_kernel_##T(__global T* d_in, int rLen, int op, __global ACC_T* d_partial, __local ACC_T* s_acc) \
+{ \
+	int lid = get_local_id(0); \
+	ACC_T acc = (op==0) ? 0 : (ACC_T)d_in[0]; \
+	for(int i=get_global_id(0);i<rLen;i+=get_global_size(0)) \
+	{ \
+		ACC_T v = (ACC_T)d_in[i]; \
+		acc = (op==0) ? acc+v : ((op==1) == (v<acc) ? v : acc); \
+	} \
+	s_acc[lid] = acc; \
+	barrier(CLK_LOCAL_MEM_FENCE); \
+	for(int s=get_local_size(0)>>1;s>0;s>>=1) \
+	{ \
+		if(lid<s) \
+		{ \
+			ACC_T v = s_acc[lid+s]; \
+			acc = s_acc[lid]; \
+			s_acc[lid] = (op==0) ? acc+v : ((op==1) == (v<acc) ? v : acc); \
+		} \
+		barrier(CLK_LOCAL_MEM_FENCE); \
+	} \
+	if(lid==0) \
+		d_partial[get_group_id(0)] = s_acc[0]; \
+} \
+/*kid=73, bitmap_rangeSelection_kernel over the typed values*/ \
+__kernel void \
+typed_rangeSelection_kernel_##T(__global T* d_in, int rLen, T low, T high, __global uint* d_bitmap) \
+{ \
+	int numWord = (rLen+31)>>5; \
+	for(int w=get_global_id(0);w<numWord;w+=get_global_size(0)) \
+	{ \
+		uint bits = 0; \
+		int pos = w<<5; \
+		int endPos = min(pos+32,rLen); \
+		for(int b=0;pos<endPos;pos++,b++) \
+		{ \
+			T v = d_in[pos]; \
+			if(v>=low && v<=high) \
+				bits |= (1u<<b); \
+		} \
+		d_bitmap[w] = bits; \
+	} \
+} \
+/*kid=74, open addressing, d_slot holds the position in R of its key or -1*/ \
+__kernel void \
+typed_hashBuild_kernel_##T(__global T* d_R, int rLen, __global int* d_slot, int mask) \
+{ \
+	for(int i=get_global_id(0);i<rLen;i+=get_global_size(0)) \
+	{ \
+		uint h = typed_hash_##T(d_R[i])&mask; \
+		while(atomic_cmpxchg(&d_slot[h],-1,i)!=-1) \
+			h = (h+1)&mask; \
+	} \
+} \
+/*kid=75, the matches of every key of S, counted first, then written from their prefix sum. the output is (rid in R, rid in S)*/ \
+__kernel void \
+typed_hashProbe_kernel_##T(__global T* d_R, __global int* d_slot, int mask, __global T* d_S, int sLen, int toWrite, \
+	__global int* d_count, __global int* d_sum, __global int* d_RIDR, int hasRIDR, __global int* d_RIDS, int hasRIDS, __global Record* d_Rout) \
+{ \
+	for(int j=get_global_id(0);j<sLen;j+=get_global_size(0)) \
+	{ \
+		T key = d_S[j]; \
+		uint h = typed_hash_##T(key)&mask; \
+		int n = 0; \
+		int out = toWrite ? d_sum[j] : 0; \
+		int r; \
+		while((r=d_slot[h])!=-1) \
+		{ \
+			if(d_R[r]==key) \
+			{ \
+				if(toWrite) \
+				{ \
+					Record rec; \
+					rec.x = hasRIDR ? d_RIDR[r] : r; \
+					rec.y = hasRIDS ? d_RIDS[j] : j; \
+					d_Rout[out+n] = rec; \
+				} \
+				n++; \
+			} \
+			h = (h+1)&mask; \
+		} \
+		if(!toWrite) \
+			d_count[j] = n; \
+	} \
+}
+
+TYPED_KERNELS(int, long)
+TYPED_KERNELS(long, long)
+#ifdef cl_khr_fp64
+TYPED_KERNELS(float, double)
+TYPED_KERNELS(double, double)
+#endif
+
+//packed columns (PackedColumn in OpenCL_DLL.h), a value is decoded where it is read.
+#define PACK_RLE 1
+#define PACK_DICT 2
+//code i of width bits, d_data has one word of padding.
+inline uint packed_code(__global uint* d_data, int width, int i)
+{
+	if(width==0)
+		return 0;
+	ulong bit = (ulong)i*width;
+	int w = (int)(bit>>5);
+	ulong word = (ulong)d_data[w] | ((ulong)d_data[w+1]<<32);
+	return (uint)((word>>(bit&31)) & ((1UL<<width)-1));
+}
+//the last run starting at or before i.
+inline int packed_run(__global int* d_start, int numRun, int i)
+{
+	int lo = 0, hi = numRun-1;
+	while(lo<hi)
+	{
+		int mid = (lo+hi+1)>>1;
+		if(d_start[mid]<=i)
+			lo = mid;
+		else
+			hi = mid-1;
+	}
+	return lo;
+}
+inline int packed_value(int scheme, int width, int base, __global uint* d_data, __global int* d_aux, int numAux, int i)
+{
+	if(scheme==PACK_RLE)
+		return ((__global int*)d_data)[packed_run(d_aux,numAux,i)];
+	uint code = packed_code(d_data,width,i);
+	if(scheme==PACK_DICT)
+		return d_aux[code];
+	return base+(int)code;
+}
+
+__kernel void//kid=76, the records (rid,value) at the rids of d_RIDList, or of every rid
+packed_decode_kernel(int scheme, int width, int base, __global uint* d_data, __global int* d_aux, int numAux,
+					 __global int* d_RIDList, int hasRIDList, int len, __global Record* d_Rout)
+{
+	for(int i=get_global_id(0);i<len;i+=get_global_size(0))
+	{
+		int rid = hasRIDList ? d_RIDList[i] : i;
+		Record rec;
+		rec.x = rid;
+		rec.y = packed_value(scheme,width,base,d_data,d_aux,numAux,rid);
+		d_Rout[i] = rec;
+	}
+}
+
+__kernel void//kid=78, typed_reduce_kernel_int over the values decoded where they are read; RLE reads every run once, a sum weighs it by its length
+packed_reduce_kernel(int scheme, int width, int base, __global uint* d_data, __global int* d_aux, int numAux,
+					 int rLen, int op, __global long* d_partial, __local long* s_acc)
+{
+	int lid = get_local_id(0);
+	int n = (scheme==PACK_RLE) ? numAux : rLen;
+	long acc = (op==0) ? 0 : (long)packed_value(scheme,width,base,d_data,d_aux,numAux,0);
+	for(int i=get_global_id(0);i<n;i+=get_global_size(0))
+	{
+		long v;
+		if(scheme==PACK_RLE)
+		{
+			v = ((__global int*)d_data)[i];
+			if(op==0)
+				v *= ((i+1<numAux) ? d_aux[i+1] : rLen)-d_aux[i];
+		}
+		else
+			v = packed_value(scheme,width,base,d_data,d_aux,numAux,i);
+		acc = (op==0) ? acc+v : ((op==1) == (v<acc) ? v : acc);
+	}
+	s_acc[lid] = acc;
+	barrier(CLK_LOCAL_MEM_FENCE);
+	for(int s=get_local_size(0)>>1;s>0;s>>=1)
+	{
+		if(lid<s)
+		{
+			long v = s_acc[lid+s];
+			acc = s_acc[lid];
+			s_acc[lid] = (op==0) ? acc+v : ((op==1) == (v<acc) ? v : acc);
+		}
+		barrier(CLK_LOCAL_MEM_FENCE);
+	}
+	if(lid==0)
+		d_partial[get_group_id(0)] = s_acc[0];
+}
+
+__kernel void//kid=77, FOR and DICT compare the codes without decoding them, RLE compares the value of the run and steps to the next run
+packed_rangeSelection_kernel(int scheme, int width, __global uint* d_data, __global int* d_aux, int numAux,
+							 int rLen, long low, long high, __global uint* d_bitmap)
+{
+	int numWord = (rLen+31)>>5;
+	for(int w=get_global_id(0);w<numWord;w+=get_global_size(0))
+	{
+		uint bits = 0;
+		int pos = w<<5;
+		int endPos = min(pos+32,rLen);
+		int run = (scheme==PACK_RLE) ? packed_run(d_aux,numAux,pos) : 0;
+		for(int b=0;pos<endPos;pos++,b++)
+		{
+			long v;
+			if(scheme==PACK_RLE)
+			{
+				while(run+1<numAux && d_aux[run+1]<=pos)
+					run++;
+				v = ((__global int*)d_data)[run];
+			}
+			else
+				v = packed_code(d_data,width,pos);
+			if(v>=low && v<=high)
+				bits |= (1u<<b);
+		}
+		d_bitmap[w] = bits;
+	}
+}
+
 /*__kernel void //kid=21
 filterImpl_map_noCoalesced_kernel(__global Record* d_Rin, int beginPos, int rLen, __global int* d_mark, 
 								  int smallKey, int largeKey, __global int* d_temp )
@@ -2638,4 +2980,839 @@ void probe_kernel(__global uint * rHashTable,
 		
 		tid += numWorkItems;
 	}
-}
\ No newline at end of file
+}
+__kernel//kid=79
+void groupResult_kernel(__global Record* d_Rin, __global int* d_startPos, __global int* d_aggResults, int numGroups, __global Record* d_Rout)
+{
+	for(int idx=get_global_id(0);idx<numGroups;idx+=get_global_size(0))
+	{
+		Record rec;
+		rec.x = d_Rin[d_startPos[idx]].y;
+		rec.y = d_aggResults[idx];
+		d_Rout[idx] = rec;
+	}
+}
+//hash group by: the keys are counted in a local table per work group, flushed into a global
+//open addressing table of capacity slots. INT_MIN marks an empty slot, that key has slot capacity.
+#define HASH_GROUPBY_EMPTY (INT_MIN)
+inline
+void hashGroupBy_insertGlobal(int key, int count, __global int* d_keys, __global int* d_counts, int capacity, __global int* d_numGroup, __global int* d_overflow)
+{
+	if(key==HASH_GROUPBY_EMPTY)
+	{
+		if(atomic_add(&d_counts[capacity],count)==0)
+			atomic_inc(d_numGroup);
+		return;
+	}
+	int slot=RSHash(key,capacity-1);
+	for(int probe=0;probe<capacity;probe++)
+	{
+		int old=atomic_cmpxchg(&d_keys[slot],HASH_GROUPBY_EMPTY,key);
+		if(old==HASH_GROUPBY_EMPTY)
+			atomic_inc(d_numGroup);
+		if(old==HASH_GROUPBY_EMPTY || old==key)
+		{
+			atomic_add(&d_counts[slot],count);
+			return;
+		}
+		slot=(slot+1)&(capacity-1);
+	}
+	d_overflow[0]=1;
+}
+inline
+bool hashGroupBy_insertLocal(int key, __local int* l_keys, __local int* l_counts, int localSlots)
+{
+	if(key==HASH_GROUPBY_EMPTY)
+		return false;
+	int slot=RSHash(key,localSlots-1);
+	//a full neighbourhood goes to the global table.
+	for(int probe=0;probe<8;probe++)
+	{
+		int old=atomic_cmpxchg(&l_keys[slot],HASH_GROUPBY_EMPTY,key);
+		if(old==HASH_GROUPBY_EMPTY || old==key)
+		{
+			atomic_inc(&l_counts[slot]);
+			return true;
+		}
+		slot=(slot+1)&(localSlots-1);
+	}
+	return false;
+}
+inline
+int hashGroupBy_find(int key, __global int* d_keys, int capacity)
+{
+	if(key==HASH_GROUPBY_EMPTY)
+		return capacity;
+	int slot=RSHash(key,capacity-1);
+	while(d_keys[slot]!=key)
+		slot=(slot+1)&(capacity-1);
+	return slot;
+}
+__kernel//kid=56
+void hashGroupBy_build_kernel(__global Record* d_R, int rLen, __global int* d_keys, __global int* d_counts, int capacity, int maxGroup,
+							  __global int* d_numGroup, __global int* d_overflow, __local int* l_keys, __local int* l_counts, int localSlots)
+{
+	int tx=get_local_id(0);
+	int blockDimX=get_local_size(0);
+	for(int i=tx;i<localSlots;i+=blockDimX)
+	{
+		l_keys[i]=HASH_GROUPBY_EMPTY;
+		l_counts[i]=0;
+	}
+	barrier(CLK_LOCAL_MEM_FENCE);
+	for(int idx=get_global_id(0);idx<rLen;idx+=get_global_size(0))
+	{
+		//too many groups, the sort path takes over.
+		if(d_numGroup[0]>maxGroup)
+			break;
+		int key=(int)d_R[idx].y;
+		if(!hashGroupBy_insertLocal(key,l_keys,l_counts,localSlots))
+			hashGroupBy_insertGlobal(key,1,d_keys,d_counts,capacity,d_numGroup,d_overflow);
+	}
+	barrier(CLK_LOCAL_MEM_FENCE);
+	for(int i=tx;i<localSlots;i+=blockDimX)
+	{
+		if(l_counts[i]>0)
+			hashGroupBy_insertGlobal(l_keys[i],l_counts[i],d_keys,d_counts,capacity,d_numGroup,d_overflow);
+	}
+}
+__kernel void//kid=57
+hashGroupBy_rank_kernel(__global int* d_keys, __global int* d_counts, int capacity, __global int* d_groupId, __global int* d_startPos)
+{
+	//the groups are numbered in the order of their keys, as the sort path does: the keys
+	//of Record are unsigned, so are the comparisons.
+	for(int s=get_global_id(0);s<=capacity;s+=get_global_size(0))
+	{
+		if(s==capacity?(d_counts[s]==0):(d_keys[s]==HASH_GROUPBY_EMPTY))
+			continue;
+		uint key=(s==capacity)?(uint)HASH_GROUPBY_EMPTY:(uint)d_keys[s];
+		int rank=0;
+		int start=0;
+		if(d_counts[capacity]>0 && (uint)HASH_GROUPBY_EMPTY<key)
+		{
+			rank++;
+			start+=d_counts[capacity];
+		}
+		for(int t=0;t<capacity;t++)
+		{
+			int other=d_keys[t];
+			if(other!=HASH_GROUPBY_EMPTY && (uint)other<key)
+			{
+				rank++;
+				start+=d_counts[t];
+			}
+		}
+		d_groupId[s]=rank;
+		d_startPos[rank]=start;
+	}
+}
+__kernel void//kid=58
+hashGroupBy_scatter_kernel(__global Record* d_R, int rLen, __global int* d_keys, int capacity, __global int* d_groupId,
+						   __global int* d_startPos, __global int* d_cursor, __global Record* d_Rout)
+{
+	for(int idx=get_global_id(0);idx<rLen;idx+=get_global_size(0))
+	{
+		Record rec=d_R[idx];
+		int gid=d_groupId[hashGroupBy_find((int)rec.y,d_keys,capacity)];
+		d_Rout[d_startPos[gid]+atomic_inc(&d_cursor[gid])]=rec;
+	}
+}
+
+//fused aggregates: the sum, min and max of the values in one pass, the sum in 64 bits.
+//the work group size is a power of two.
+#define MULTI_AGG_COUNT (1)
+#define MULTI_AGG_SUM (2)
+#define MULTI_AGG_MIN (4)
+#define MULTI_AGG_MAX (8)
+#define MULTI_AGG_AVG (16)
+#define MULTI_AGG_NUM (5)
+inline
+void multiAgg_reduceLocal(__local long* l_sum, __local int* l_min, __local int* l_max)
+{
+	int tx=get_local_id(0);
+	for(int s=get_local_size(0)>>1;s>0;s>>=1)
+	{
+		barrier(CLK_LOCAL_MEM_FENCE);
+		if(tx<s)
+		{
+			l_sum[tx]+=l_sum[tx+s];
+			l_min[tx]=min(l_min[tx],l_min[tx+s]);
+			l_max[tx]=max(l_max[tx],l_max[tx+s]);
+		}
+	}
+	barrier(CLK_LOCAL_MEM_FENCE);
+}
+__kernel//kid=59
+void multiAgg_kernel(__global Record* d_R, int rLen, __global long* d_sum, __global int* d_min, __global int* d_max,
+					 __local long* l_sum, __local int* l_min, __local int* l_max)
+{
+	int tx=get_local_id(0);
+	long sum=0;
+	int minValue=INT_MAX;
+	int maxValue=INT_MIN;
+	for(int idx=get_global_id(0);idx<rLen;idx+=get_global_size(0))
+	{
+		int v=(int)d_R[idx].y;
+		sum+=v;
+		minValue=min(minValue,v);
+		maxValue=max(maxValue,v);
+	}
+	l_sum[tx]=sum;
+	l_min[tx]=minValue;
+	l_max[tx]=maxValue;
+	multiAgg_reduceLocal(l_sum,l_min,l_max);
+	if(tx==0)
+	{
+		d_sum[get_group_id(0)]=l_sum[0];
+		d_min[get_group_id(0)]=l_min[0];
+		d_max[get_group_id(0)]=l_max[0];
+	}
+}
+//one work group per group. a group has numAgg records in d_Rout, (value of the group, aggregate)
+//for the aggregates of aggMask in the order of the bits.
+__kernel//kid=60
+void multiAggAfterGroupBy_kernel(__global Record* d_Rin, int rLen, __global int* d_startPos, int numGroups, __global Record* d_Ragg,
+								 int aggMask, int numAgg, __global Record* d_Rout, __local long* l_sum, __local int* l_min, __local int* l_max)
+{
+	int tx=get_local_id(0);
+	for(int g=get_group_id(0);g<numGroups;g+=get_num_groups(0))
+	{
+		int start=d_startPos[g];
+		int end=(g==numGroups-1)?rLen:d_startPos[g+1];
+		long sum=0;
+		int minValue=INT_MAX;
+		int maxValue=INT_MIN;
+		for(int i=start+tx;i<end;i+=get_local_size(0))
+		{
+			int v=(int)d_Ragg[d_Rin[i].x].y;
+			sum+=v;
+			minValue=min(minValue,v);
+			maxValue=max(maxValue,v);
+		}
+		l_sum[tx]=sum;
+		l_min[tx]=minValue;
+		l_max[tx]=maxValue;
+		multiAgg_reduceLocal(l_sum,l_min,l_max);
+		if(tx==0)
+		{
+			long count=end-start;
+			long values[MULTI_AGG_NUM]={count,l_sum[0],l_min[0],l_max[0],l_sum[0]/count};
+			int k=0;
+			for(int bit=0;bit<MULTI_AGG_NUM;bit++)
+			{
+				if(aggMask&(1<<bit))
+				{
+					Record rec;
+					rec.x=d_Rin[start].y;
+					rec.y=(uint)values[bit];
+					d_Rout[g*numAgg+(k++)]=rec;
+				}
+			}
+		}
+		//l_* are reused by the next group.
+		barrier(CLK_LOCAL_MEM_FENCE);
+	}
+}
+
+//top k: a radix select finds the key of the k-th record 8 bits at a time, the records up to
+//it are then written out. the key is the value with the sign bit flipped, complemented for
+//the k largest, so the k smallest keys are taken either way; the rid below it breaks ties.
+inline
+ulong topK_key(Record rec, int largest)
+{
+	uint u=((uint)rec.y)^0x80000000u;
+	return (((ulong)(largest?~u:u))<<32)|rec.x;
+}
+__kernel//kid=61
+void topK_histogram_kernel(__global Record* d_R, int rLen, int largest, ulong prefix, ulong prefixMask, int shift,
+						   __global int* d_hist, __local int* l_hist)
+{
+	int tx=get_local_id(0);
+	for(int i=tx;i<256;i+=get_local_size(0))
+		l_hist[i]=0;
+	barrier(CLK_LOCAL_MEM_FENCE);
+	for(int idx=get_global_id(0);idx<rLen;idx+=get_global_size(0))
+	{
+		ulong key=topK_key(d_R[idx],largest);
+		if((key&prefixMask)==prefix)
+			atomic_inc(&l_hist[(int)(key>>shift)&255]);
+	}
+	barrier(CLK_LOCAL_MEM_FENCE);
+	for(int i=tx;i<256;i+=get_local_size(0))
+	{
+		if(l_hist[i]>0)
+			atomic_add(&d_hist[i],l_hist[i]);
+	}
+}
+//the records with a key up to threshold, at most k of them should a rid repeat.
+__kernel void//kid=62
+topK_write_kernel(__global Record* d_R, int rLen, int largest, ulong threshold, int k,
+				  __global int* d_counter, __global Record* d_Rout)
+{
+	for(int idx=get_global_id(0);idx<rLen;idx+=get_global_size(0))
+	{
+		Record rec=d_R[idx];
+		if(topK_key(rec,largest)<=threshold)
+		{
+			int pos=atomic_inc(&d_counter[0]);
+			if(pos<k)
+				d_Rout[pos]=rec;
+		}
+	}
+}
+//DISTINCT: an open addressing set of row numbers, sized to at least twice the rows so a probe
+//always ends. the tuple of row i is d_R[i].y followed by d_others[c*rLen+i].y, c<numOther.
+#define DISTINCT_EMPTY (-1)
+inline
+uint distinct_hash(__global Record* d_R, __global Record* d_others, int numOther, int rLen, int row, int mask)
+{
+	uint h=RSHash((int)d_R[row].y,mask);
+	for(int c=0;c<numOther;c++)
+		h=h*31+RSHash((int)d_others[c*rLen+row].y,mask);
+	return h&mask;
+}
+inline
+bool distinct_equal(__global Record* d_R, __global Record* d_others, int numOther, int rLen, int a, int b)
+{
+	if(d_R[a].y!=d_R[b].y)
+		return false;
+	for(int c=0;c<numOther;c++)
+		if(d_others[c*rLen+a].y!=d_others[c*rLen+b].y)
+			return false;
+	return true;
+}
+__kernel//kid=63
+void distinct_insert_kernel(__global Record* d_R, __global Record* d_others, int numOther, int rLen,
+							__global int* d_table, int capacity, __global int* d_counter, __global Record* d_Rout)
+{
+	for(int idx=get_global_id(0);idx<rLen;idx+=get_global_size(0))
+	{
+		int slot=distinct_hash(d_R,d_others,numOther,rLen,idx,capacity-1);
+		while(true)
+		{
+			//the row that claims the empty slot of its tuple is the one kept.
+			int old=atomic_cmpxchg(&d_table[slot],DISTINCT_EMPTY,idx);
+			if(old==DISTINCT_EMPTY)
+			{
+				d_Rout[atomic_inc(&d_counter[0])]=d_R[idx];
+				break;
+			}
+			if(distinct_equal(d_R,d_others,numOther,rLen,old,idx))
+				break;
+			slot=(slot+1)&(capacity-1);
+		}
+	}
+}
+__kernel void//kid=64
+distinct_gatherFirst_kernel(__global Record* d_R, __global int* d_startPos, int numGroup, __global Record* d_Rout)
+{
+	for(int g=get_global_id(0);g<numGroup;g+=get_global_size(0))
+		d_Rout[g]=d_R[d_startPos[g]];
+}
+//tuples too many for the set are sorted by their hash, (row, hash) records in d_keys.
+__kernel void//kid=65
+distinct_hashKey_kernel(__global Record* d_R, __global Record* d_others, int numOther, int rLen, __global Record* d_keys)
+{
+	for(int idx=get_global_id(0);idx<rLen;idx+=get_global_size(0))
+	{
+		Record rec;
+		rec.x=idx;
+		rec.y=distinct_hash(d_R,d_others,numOther,rLen,idx,-1);
+		d_keys[idx]=rec;
+	}
+}
+//a row of d_sorted is kept when no row before it in its run of equal hashes has its tuple.
+__kernel void//kid=66
+distinct_firstInRun_kernel(__global Record* d_R, __global Record* d_others, int numOther, int rLen, __global Record* d_sorted,
+						   __global int* d_startPos, int numRun, __global int* d_counter, __global Record* d_Rout)
+{
+	for(int i=get_global_id(0);i<rLen;i+=get_global_size(0))
+	{
+		int lo=0;
+		int hi=numRun-1;
+		while(lo<hi)
+		{
+			int mid=(lo+hi+1)>>1;
+			if(d_startPos[mid]<=i)
+				lo=mid;
+			else
+				hi=mid-1;
+		}
+		int row=(int)d_sorted[i].x;
+		bool first=true;
+		for(int j=d_startPos[lo];j<i && first;j++)
+			first=!distinct_equal(d_R,d_others,numOther,rLen,(int)d_sorted[j].x,row);
+		if(first)
+			d_Rout[atomic_inc(&d_counter[0])]=d_R[row];
+	}
+}
+//approximate aggregates, the host side is in Sketch.h. a work group builds its sketch in local
+//memory and merges it into d_registers or d_bins, which start at 0.
+inline
+uint hll_hash(int value)
+{
+	uint h=(uint)value;
+	h^=h>>16;
+	h*=0x85ebca6bu;
+	h^=h>>13;
+	h*=0xc2b2ae35u;
+	h^=h>>16;
+	return h;
+}
+__kernel//kid=80
+void hll_build_kernel(__global Record* d_R, int rLen, int p, __global int* d_registers, __local int* l_registers)
+{
+	int tx=get_local_id(0);
+	int blockDimX=get_local_size(0);
+	int m=1<<p;
+	for(int i=tx;i<m;i+=blockDimX)
+		l_registers[i]=0;
+	barrier(CLK_LOCAL_MEM_FENCE);
+	for(int idx=get_global_id(0);idx<rLen;idx+=get_global_size(0))
+	{
+		uint h=hll_hash((int)d_R[idx].y);
+		uint w=h<<p;
+		//the position of the first 1 bit after the register number.
+		int rho=(w==0)?(32-p+1):((int)clz(w)+1);
+		atomic_max(&l_registers[h>>(32-p)],rho);
+	}
+	barrier(CLK_LOCAL_MEM_FENCE);
+	for(int i=tx;i<m;i+=blockDimX)
+		if(l_registers[i]>0)
+			atomic_max(&d_registers[i],l_registers[i]);
+}
+inline
+int quantileSketch_bin(int value, float invLogGamma, int maxBucket)
+{
+	if(value==0)
+		return maxBucket+1;
+	uint mag=(value>0)?(uint)value:(0u-(uint)value);
+	int k=(int)ceil(log((float)mag)*invLogGamma);
+	k=clamp(k,0,maxBucket);
+	return (value>0)?(maxBucket+2+k):(maxBucket-k);
+}
+__kernel//kid=81
+void quantileSketch_build_kernel(__global Record* d_R, int rLen, float invLogGamma, int maxBucket, __global int* d_bins, __local int* l_bins)
+{
+	int tx=get_local_id(0);
+	int blockDimX=get_local_size(0);
+	int numBin=2*maxBucket+3;
+	for(int i=tx;i<numBin;i+=blockDimX)
+		l_bins[i]=0;
+	barrier(CLK_LOCAL_MEM_FENCE);
+	for(int idx=get_global_id(0);idx<rLen;idx+=get_global_size(0))
+		atomic_inc(&l_bins[quantileSketch_bin((int)d_R[idx].y,invLogGamma,maxBucket)]);
+	barrier(CLK_LOCAL_MEM_FENCE);
+	for(int i=tx;i<numBin;i+=blockDimX)
+		if(l_bins[i]>0)
+			atomic_add(&d_bins[i],l_bins[i]);
+}
+//single pass reduction: a work group reduces its part in local memory and leaves a partial,
+//the last work group to finish, found with the ticket counter d_partial[0], combines the
+//partials into d_Rout[0]. The counter is zero on entry.
+inline
+int reduceSinglePass_combine(int OPERATOR, int a, int b)
+{
+	if(OPERATOR==REDUCE_MAX)
+		return max(a,b);
+	if(OPERATOR==REDUCE_MIN)
+		return min(a,b);
+	return a+b;
+}
+inline
+int reduceSinglePass_identity(int OPERATOR)
+{
+	return (OPERATOR==REDUCE_MAX)?INT_MIN:((OPERATOR==REDUCE_MIN)?INT_MAX:0);
+}
+inline
+void reduceSinglePass_local(int OPERATOR, __local int* l_value)
+{
+	int tx=get_local_id(0);
+	for(int s=get_local_size(0)>>1;s>0;s>>=1)
+	{
+		barrier(CLK_LOCAL_MEM_FENCE);
+		if(tx<s)
+			l_value[tx]=reduceSinglePass_combine(OPERATOR,l_value[tx],l_value[tx+s]);
+	}
+	barrier(CLK_LOCAL_MEM_FENCE);
+}
+__kernel//kid=82
+void reduceSinglePass_kernel(__global Record* d_R, int rLen, int OPERATOR, __global int* d_partial, __global Record* d_Rout,
+							 __local int* l_value, __local int* l_isLast)
+{
+	int tx=get_local_id(0);
+	int numGroup=get_num_groups(0);
+	int value=reduceSinglePass_identity(OPERATOR);
+	for(int idx=get_global_id(0);idx<rLen;idx+=get_global_size(0))
+		value=reduceSinglePass_combine(OPERATOR,value,d_R[idx].y);
+	l_value[tx]=value;
+	reduceSinglePass_local(OPERATOR,l_value);
+	if(tx==0)
+	{
+		atomic_xchg(&d_partial[1+get_group_id(0)],l_value[0]);
+		mem_fence(CLK_GLOBAL_MEM_FENCE);
+		l_isLast[0]=(atomic_inc(&d_partial[0])==numGroup-1);
+	}
+	barrier(CLK_LOCAL_MEM_FENCE);
+	if(!l_isLast[0])
+		return;
+	value=reduceSinglePass_identity(OPERATOR);
+	for(int g=tx;g<numGroup;g+=get_local_size(0))
+		value=reduceSinglePass_combine(OPERATOR,value,atomic_add(&d_partial[1+g],0));
+	l_value[tx]=value;
+	reduceSinglePass_local(OPERATOR,l_value);
+	if(tx==0)
+	{
+		d_Rout[0].x=0;
+		d_Rout[0].y=(OPERATOR!=REDUCE_AVERAGE)?l_value[0]:((rLen>0)?(l_value[0]/rLen):0);
+	}
+}
+//single pass exclusive scan with decoupled look-back. A work group takes the next tile from the
+//ticket counter d_status[0], so tiles start in order, and publishes its tile sum and then its
+//inclusive prefix in the status words of the tile. It adds up the status of the tiles before it
+//until it meets a prefix. A status is (epoch<<2)|state, words of an older scan read as invalid.
+//Without forward progress between work groups, e.g. PoCL on the CPU, a tile it waited on for
+//SCAN_SPIN_LIMIT polls may never run, so the work group sums the input of that tile itself.
+#define SCAN_ITEMS_PER_THREAD (4)
+#define SCAN_SPIN_LIMIT (1024)
+#define SCAN_STATE_INVALID (0)
+#define SCAN_STATE_AGGREGATE (1)
+#define SCAN_STATE_PREFIX (2)
+inline
+int scanSinglePass_localSum(int value, __local int* l_value)
+{
+	int tx=get_local_id(0);
+	l_value[tx]=value;
+	for(int s=get_local_size(0)>>1;s>0;s>>=1)
+	{
+		barrier(CLK_LOCAL_MEM_FENCE);
+		if(tx<s)
+			l_value[tx]+=l_value[tx+s];
+	}
+	barrier(CLK_LOCAL_MEM_FENCE);
+	int sum=l_value[0];
+	barrier(CLK_LOCAL_MEM_FENCE);
+	return sum;
+}
+__kernel//kid=67
+void scanSinglePass_kernel(__global int* d_in, __global int* d_out, int rLen, __global int* d_status,
+						   uint ticketBase, uint epoch, __local int* l_value, __local int* l_share)
+{
+	int tx=get_local_id(0);
+	int numThread=get_local_size(0);
+	int tileSize=numThread*SCAN_ITEMS_PER_THREAD;
+	if(tx==0)
+		l_share[0]=(int)((uint)atomic_inc(&d_status[0])-ticketBase);
+	barrier(CLK_LOCAL_MEM_FENCE);
+	int tile=l_share[0];
+	int base=tile*tileSize+tx*SCAN_ITEMS_PER_THREAD;
+	int v[SCAN_ITEMS_PER_THREAD];
+	int sum=0;
+	for(int k=0;k<SCAN_ITEMS_PER_THREAD;k++)
+	{
+		v[k]=(base+k<rLen)?d_in[base+k]:0;
+		sum+=v[k];
+	}
+	//inclusive scan of the thread sums.
+	l_value[tx]=sum;
+	for(int off=1;off<numThread;off<<=1)
+	{
+		barrier(CLK_LOCAL_MEM_FENCE);
+		int t=(tx>=off)?l_value[tx-off]:0;
+		barrier(CLK_LOCAL_MEM_FENCE);
+		l_value[tx]+=t;
+	}
+	barrier(CLK_LOCAL_MEM_FENCE);
+	int threadPrefix=l_value[tx]-sum;
+	int aggregate=l_value[numThread-1];
+	barrier(CLK_LOCAL_MEM_FENCE);
+	__global int* status=d_status+1+3*tile;
+	if(tx==0)
+	{
+		status[1]=aggregate;
+		status[2]=aggregate;
+		mem_fence(CLK_GLOBAL_MEM_FENCE);
+		atomic_xchg(&status[0],(int)((epoch<<2)|((tile==0)?SCAN_STATE_PREFIX:SCAN_STATE_AGGREGATE)));
+	}
+	int exclusive=0;
+	for(int pred=tile-1;pred>=0;pred--)
+	{
+		if(tx==0)
+		{
+			__global int* predStatus=d_status+1+3*pred;
+			int state=SCAN_STATE_INVALID;
+			for(int spin=0;spin<SCAN_SPIN_LIMIT && state==SCAN_STATE_INVALID;spin++)
+			{
+				uint word=(uint)atomic_add(&predStatus[0],0);
+				if((word>>2)==epoch)
+					state=word&3;
+			}
+			mem_fence(CLK_GLOBAL_MEM_FENCE);
+			l_share[1]=state;
+			if(state==SCAN_STATE_PREFIX)
+				l_share[2]=atomic_add(&predStatus[2],0);
+			else if(state==SCAN_STATE_AGGREGATE)
+				l_share[2]=atomic_add(&predStatus[1],0);
+		}
+		barrier(CLK_LOCAL_MEM_FENCE);
+		int state=l_share[1];
+		int predSum=l_share[2];
+		barrier(CLK_LOCAL_MEM_FENCE);
+		if(state==SCAN_STATE_INVALID)
+		{
+			int predBase=pred*tileSize+tx*SCAN_ITEMS_PER_THREAD;
+			int s=0;
+			for(int k=0;k<SCAN_ITEMS_PER_THREAD;k++)
+				s+=d_in[predBase+k];
+			predSum=scanSinglePass_localSum(s,l_value);
+		}
+		exclusive+=predSum;
+		if(state==SCAN_STATE_PREFIX)
+			break;
+	}
+	if(tx==0 && tile>0)
+	{
+		status[2]=exclusive+aggregate;
+		mem_fence(CLK_GLOBAL_MEM_FENCE);
+		atomic_xchg(&status[0],(int)((epoch<<2)|SCAN_STATE_PREFIX));
+	}
+	int running=exclusive+threadPrefix;
+	for(int k=0;k<SCAN_ITEMS_PER_THREAD;k++)
+	{
+		if(base+k<rLen)
+			d_out[base+k]=running;
+		running+=v[k];
+	}
+}
+//stable merge sort of records by key (y), any length. A work group sorts a tile of
+//MERGESORT_TILE records in local memory, then each level merges pairs of sorted runs of
+//width records. An element of the left run goes before the equal keys of the right run: its
+//rank in the right run is a lower bound, the rank of a right element in the left run an
+//upper bound. A merge splits the output into chunks of MERGESORT_TILE records and a work
+//group finds the start of its chunk in both runs by a merge path search, so the work groups
+//of a level get equal work whatever the keys are.
+#define MERGESORT_TILE (512)
+inline
+int mergeSort_lowerBound(__local Record* a, int len, uint key)
+{
+	int lo=0;
+	int hi=len;
+	while(lo<hi)
+	{
+		int mid=(lo+hi)>>1;
+		if(a[mid].y<key)
+			lo=mid+1;
+		else
+			hi=mid;
+	}
+	return lo;
+}
+inline
+int mergeSort_upperBound(__local Record* a, int len, uint key)
+{
+	int lo=0;
+	int hi=len;
+	while(lo<hi)
+	{
+		int mid=(lo+hi)>>1;
+		if(a[mid].y<=key)
+			lo=mid+1;
+		else
+			hi=mid;
+	}
+	return lo;
+}
+//the number of records of the left run a among the first diag records of the merge.
+inline
+int mergeSort_coRank(__global Record* a, int la, __global Record* b, int lb, int diag)
+{
+	int lo=max(0,diag-lb);
+	int hi=min(diag,la);
+	while(lo<hi)
+	{
+		int mid=(lo+hi)>>1;
+		if(a[mid].y<=b[diag-1-mid].y)
+			lo=mid+1;
+		else
+			hi=mid;
+	}
+	return lo;
+}
+//merges l_a[0,la) and l_a[la,la+lb) to l_out from position outBase.
+inline
+void mergeSort_mergeLocal(__local Record* l_a, int la, int lb, __local Record* l_out, int outBase)
+{
+	__local Record* l_b=l_a+la;
+	for(int i=get_local_id(0);i<la+lb;i+=get_local_size(0))
+	{
+		if(i<la)
+			l_out[outBase+i+mergeSort_lowerBound(l_b,lb,l_a[i].y)]=l_a[i];
+		else
+			l_out[outBase+(i-la)+mergeSort_upperBound(l_a,la,l_b[i-la].y)]=l_b[i-la];
+	}
+}
+__kernel//kid=32
+void mergeSort_blockSort_kernel(__global Record* d_R, int rLen, __local Record* l_src, __local Record* l_dst)
+{
+	int tx=get_local_id(0);
+	int base=get_group_id(0)*MERGESORT_TILE;
+	int n=min(MERGESORT_TILE,rLen-base);
+	for(int i=tx;i<n;i+=get_local_size(0))
+		l_src[i]=d_R[base+i];
+	barrier(CLK_LOCAL_MEM_FENCE);
+	for(int width=1;width<n;width<<=1)
+	{
+		//every run pair of the tile at once, a work item places its records of the tile.
+		for(int i=tx;i<n;i+=get_local_size(0))
+		{
+			int ps=(i/(2*width))*(2*width);
+			int la=min(width,n-ps);
+			int lb=min(width,max(0,n-ps-width));
+			if(i-ps<la)
+				l_dst[i+mergeSort_lowerBound(l_src+ps+la,lb,l_src[i].y)]=l_src[i];
+			else
+				l_dst[ps+(i-ps-la)+mergeSort_upperBound(l_src+ps,la,l_src[i].y)]=l_src[i];
+		}
+		barrier(CLK_LOCAL_MEM_FENCE);
+		__local Record* t=l_src;
+		l_src=l_dst;
+		l_dst=t;
+	}
+	for(int i=tx;i<n;i+=get_local_size(0))
+		d_R[base+i]=l_src[i];
+}
+__kernel//kid=33
+void mergeSort_merge_kernel(__global Record* d_src, __global Record* d_dst, int rLen, int width, __local Record* l_R, __local int* l_bound)
+{
+	int tx=get_local_id(0);
+	int d0=get_group_id(0)*MERGESORT_TILE;
+	int ps=(d0/(2*width))*(2*width);
+	int la=min(width,rLen-ps);
+	int lb=min(width,max(0,rLen-ps-width));
+	__global Record* a=d_src+ps;
+	__global Record* b=a+la;
+	int t0=d0-ps;
+	int t1=min(d0+MERGESORT_TILE,rLen)-ps;
+	if(tx==0)
+		l_bound[0]=mergeSort_coRank(a,la,b,lb,t0);
+	if(tx==1 || get_local_size(0)==1)
+		l_bound[1]=mergeSort_coRank(a,la,b,lb,t1);
+	barrier(CLK_LOCAL_MEM_FENCE);
+	int a0=l_bound[0];
+	int a1=l_bound[1];
+	int b0=t0-a0;
+	int b1=t1-a1;
+	for(int i=tx;i<t1-t0;i+=get_local_size(0))
+		l_R[i]=(i<a1-a0)?a[a0+i]:b[b0+i-(a1-a0)];
+	barrier(CLK_LOCAL_MEM_FENCE);
+	mergeSort_mergeLocal(l_R,a1-a0,b1-b0,l_R+MERGESORT_TILE,0);
+	barrier(CLK_LOCAL_MEM_FENCE);
+	for(int i=tx;i<t1-t0;i+=get_local_size(0))
+		d_dst[d0+i]=l_R[MERGESORT_TILE+i];
+}
+
+//merge join of sorted R and S. A run of equal keys in R is joined with the run
+//of its key in S, the co-rank of the run; the output of the run is the product
+//of the two lengths and the runs are laid out by a prefix sum of the products.
+//the first position of key in d_X[lo,hi).
+int mergeJoin_lowerBound(__global Record* d_X,int lo,int hi,uint key)
+{
+	while(lo<hi)
+	{
+		int mid=(lo+hi)>>1;
+		if(d_X[mid].y<key)
+			lo=mid+1;
+		else
+			hi=mid;
+	}
+	return lo;
+}
+
+int mergeJoin_upperBound(__global Record* d_X,int lo,int hi,uint key)
+{
+	while(lo<hi)
+	{
+		int mid=(lo+hi)>>1;
+		if(d_X[mid].y<=key)
+			lo=mid+1;
+		else
+			hi=mid;
+	}
+	return lo;
+}
+
+//the run of output k, the last i in [lo,hi) with d_sum[i]<=k; d_sum[lo]<=k.
+int mergeJoin_findRun(__global int* d_sum,int lo,int hi,int k)
+{
+	while(lo+1<hi)
+	{
+		int mid=(lo+hi)>>1;
+		if(d_sum[mid]<=k)
+			lo=mid;
+		else
+			hi=mid;
+	}
+	return lo;
+}
+
+//the first record of a run of R gets the size of its output and its run in S, the others 0.
+__kernel void //kid=34
+mergeJoin_count_kernel(__global Record* d_R,int rLen,__global Record* d_S,int sLen,
+					   __global int* d_n,__global int* d_sStart,__global int* d_sLen)
+{
+	int pos=0;
+	for(pos=get_global_id(0);pos<rLen;pos+=get_global_size(0))
+	{
+		uint key=d_R[pos].y;
+		int n=0;
+		int sStart=0;
+		int sRun=0;
+		if(pos==0||d_R[pos-1].y!=key)
+		{
+			int rEnd=mergeJoin_upperBound(d_R,pos+1,rLen,key);
+			sStart=mergeJoin_lowerBound(d_S,0,sLen,key);
+			sRun=mergeJoin_upperBound(d_S,sStart,sLen,key)-sStart;
+			n=(rEnd-pos)*sRun;
+		}
+		d_n[pos]=n;
+		d_sStart[pos]=sStart;
+		d_sLen[pos]=sRun;
+	}
+}
+
+//a work group writes MERGEJOIN_TILE outputs; the runs of the first and the last
+//output of the tile bound the search of every output in it. Output l of the run
+//starting at h is R[h+l/sRun] joined with S[sStart+l%sRun].
+__kernel void //kid=35
+mergeJoin_write_kernel(__global Record* d_R,int rLen,__global Record* d_S,
+					   __global int* d_sum,__global int* d_sStart,__global int* d_sLen,
+					   int numResult,__global Record* d_output,__local int* l_run /*2*/)
+{
+	int tid=get_local_id(0);
+	int numThread=get_local_size(0);
+	int numTile=(numResult+MERGEJOIN_TILE-1)/MERGEJOIN_TILE;
+	int tile=0;
+	for(tile=get_group_id(0);tile<numTile;tile+=get_num_groups(0))
+	{
+		int kStart=tile*MERGEJOIN_TILE;
+		int kEnd=min(kStart+MERGEJOIN_TILE,numResult);
+		if(tid==0)
+		{
+			l_run[0]=mergeJoin_findRun(d_sum,0,rLen,kStart);
+			l_run[1]=mergeJoin_findRun(d_sum,l_run[0],rLen,kEnd-1)+1;
+		}
+		barrier(CLK_LOCAL_MEM_FENCE);
+		int hLo=l_run[0];
+		int hHi=l_run[1];
+		int k=0;
+		for(k=kStart+tid;k<kEnd;k+=numThread)
+		{
+			int h=mergeJoin_findRun(d_sum,hLo,hHi,k);
+			int l=k-d_sum[h];
+			int sRun=d_sLen[h];
+			d_output[k].x=d_R[h+l/sRun].x;
+			d_output[k].y=d_S[d_sStart[h]+l%sRun].x;
+		}
+		barrier(CLK_LOCAL_MEM_FENCE);
+	}
+}
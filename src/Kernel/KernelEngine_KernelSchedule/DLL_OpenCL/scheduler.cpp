@@ -1,5 +1,6 @@
 #include "scheduler.h"
 #include "common.h"
+#include "OpenCL_DLL.h"
 #include <pthread.h>
 extern double
     AddGPUBurden_Copy; //->initial in handshaking. fix rLen to 1024*1024
@@ -11,10 +12,10 @@ extern double
     AddGPUBurden_Write; //->initial in handshaking. fix rLen to 1024*1024
 extern double AddCPUBurden_Write;
 extern double
-    AddGPUBurden[58]; //->initial in handshaking. fix rLen to 1024*1024
+    AddGPUBurden[NUM_KERNEL_ID]; //->initial in handshaking. fix rLen to 1024*1024
 extern double
-    AddCPUBurden[58]; //->initial in handshaking. fix rLen to 1024*1024
-extern double speedupGPUoverCPU[58];
+    AddCPUBurden[NUM_KERNEL_ID]; //->initial in handshaking. fix rLen to 1024*1024
+extern double speedupGPUoverCPU[NUM_KERNEL_ID + 3];
 extern double LothresholdForGPUApp;
 extern double LothresholdForCPUApp;
 extern double LoGPUBurden;
@@ -45,6 +46,18 @@ extern pthread_mutex_t deschedulerflag;
 /*buffer operation is by default greedy*/
 #define Continuous
 extern int global_KernelSchedule;
+extern int global_ResidencyAware;
+/*scheduling level of the query on this thread, SCHEDULE_DEFAULT follows
+ * global_KernelSchedule*/
+static THREAD_LOCAL int scheduleLevel = SCHEDULE_DEFAULT;
+/*hybrid: a kernel is moved off the query's device when that device carries
+ * more than threshold times the burden of the other one*/
+double global_HybridThreshold = 2.0;
+static inline int kernelLevel() {
+  if (scheduleLevel == SCHEDULE_DEFAULT)
+    return global_KernelSchedule;
+  return scheduleLevel == SCHEDULE_KERNEL;
+}
 double inline getAddBurden_Copy(const int *Flag_CPU_GPU, double size) {
   if ((*Flag_CPU_GPU))
     return AddGPUBurden_Copy / base * size;
@@ -64,11 +77,33 @@ double inline getAddBurden_Write(const int *Flag_CPU_GPU, double size) {
   else
     return AddCPUBurden_Write / base * size;
 }
+/*a kernel without kc/kg entries of its own is charged as the calibrated
+ * kernel it replaced until the handshake measures it, -1 if there is none*/
+static int uncalibratedAs(const int kid) {
+  switch (kid) {
+  case 32: /*mergeSort_blockSort_kernel*/
+  case 33: /*mergeSort_merge_kernel*/
+    return 31; /*BitonicSort_kernel*/
+  case 34: /*mergeJoin_count_kernel*/
+    return 46; /*joinMBCount_kernel*/
+  case 35: /*mergeJoin_write_kernel*/
+    return 47; /*joinMBWrite_kernel*/
+  }
+  return -1;
+}
+static inline int costKid(const int kid) {
+  if (AddGPUBurden[kid] == 0 && AddCPUBurden[kid] == 0) {
+    int as = uncalibratedAs(kid);
+    if (as >= 0)
+      return as;
+  }
+  return kid;
+}
 double inline getAddGPUBurden(const int kid, double size) {
-  return AddGPUBurden[kid] / base * size;
+  return AddGPUBurden[costKid(kid)] / base * size;
 }
 double inline getAddCPUBurden(const int kid, double size) {
-  return AddCPUBurden[kid] / base * size;
+  return AddCPUBurden[costKid(kid)] / base * size;
 }
 void inline GPUBurdenINC(const double *burden) {
   pthread_mutex_lock(&GPUBurdenCS);
@@ -83,13 +118,31 @@ void inline CPUBurdenINC(const double *burden) {
   // recordUpdate(GPUBurden,CPUBurden);
 }
 
+/*moving size bytes off a device is charged as a read there, onto a device as a
+ * write there*/
+double getMigrationBurden(int from, int to, double size) {
+  if (from == to || from < 0)
+    return 0;
+  return getAddBurden_Read(&from, size) + getAddBurden_Write(&to, size);
+}
+
 int Kernelscheduler(int size, int kid, int *Flag_CPU_GPU, double *burden,
                     int _CPU_GPU) {
+  return Kernelscheduler(size, kid, -1, Flag_CPU_GPU, burden, _CPU_GPU);
+}
+/*residence is the device holding the input of this kernel, -1 if unknown*/
+int Kernelscheduler(int size, int kid, int residence, int *Flag_CPU_GPU,
+                    double *burden, int _CPU_GPU) {
   int CPU_GPU = 0;
-  if (global_KernelSchedule) {
+  if (kernelLevel()) {
 #ifdef Greedy
-    if ((CPUBurden + getAddCPUBurden(kid, size)) <
-        (GPUBurden + getAddGPUBurden(kid, size))) {
+    double toCPU = 0, toGPU = 0;
+    if (global_ResidencyAware) {
+      toCPU = getMigrationBurden(residence, 0, (double)size * sizeof(Record));
+      toGPU = getMigrationBurden(residence, 1, (double)size * sizeof(Record));
+    }
+    if ((CPUBurden + getAddCPUBurden(kid, size) + toCPU) <
+        (GPUBurden + getAddGPUBurden(kid, size) + toGPU)) {
       CPU_GPU = 0;
       (*burden) = getAddCPUBurden(kid, size);
       CPUBurdenINC(burden);
@@ -132,6 +185,18 @@ int Kernelscheduler(int size, int kid, int *Flag_CPU_GPU, double *burden,
 #endif
   } else { // this part is used by O and Q schedule
     CPU_GPU = _CPU_GPU;
+    if (scheduleLevel == SCHEDULE_HYBRID) {
+      /*only heavy kernels are worth moving away from the query's device*/
+      double here = CPU_GPU ? getAddGPUBurden(kid, size)
+                            : getAddCPUBurden(kid, size);
+      double there = CPU_GPU ? getAddCPUBurden(kid, size)
+                             : getAddGPUBurden(kid, size);
+      double load = CPU_GPU ? GPUBurden : CPUBurden;
+      double otherLoad = CPU_GPU ? CPUBurden : GPUBurden;
+      if (here >= (CPU_GPU ? LoGPUBurden : LoCPUBurden) &&
+          (load + here) > global_HybridThreshold * (otherLoad + there))
+        CPU_GPU = !CPU_GPU;
+    }
     if (CPU_GPU) {
       (*burden) = getAddGPUBurden(kid, size);
       GPUBurdenINC(burden);
@@ -164,7 +229,7 @@ int cl_readbufferscheduler(int size, int *Flag_CPU_GPU, double *burden,
                            int _CPU_GPU) {
   int CPU_GPU;
   (*burden) = getAddBurden_Read(Flag_CPU_GPU, size);
-  if (global_KernelSchedule) {
+  if (kernelLevel()) {
 #ifdef Continuous
     if (*Flag_CPU_GPU) {
       CPU_GPU = 1;
@@ -204,7 +269,7 @@ int cl_writebufferscheduler(int size, int *Flag_CPU_GPU, double *burden,
                             int _CPU_GPU) {
   int CPU_GPU;
   (*burden) = getAddBurden_Write(Flag_CPU_GPU, size);
-  if (global_KernelSchedule) {
+  if (kernelLevel()) {
 #ifdef Continuous
     if (*Flag_CPU_GPU) {
       CPU_GPU = 1;
@@ -244,7 +309,7 @@ int cl_copyBufferscheduler(int size, int *Flag_CPU_GPU, double *burden,
                            int _CPU_GPU) {
   int CPU_GPU;
   (*burden) = getAddBurden_Copy(Flag_CPU_GPU, size);
-  if (global_KernelSchedule) {
+  if (kernelLevel()) {
 #ifdef Continuous
     if (*Flag_CPU_GPU) {
       CPU_GPU = 1;
@@ -274,4 +339,10 @@ int cl_copyBufferscheduler(int size, int *Flag_CPU_GPU, double *burden,
     }
   }
   return CPU_GPU;
-}
\ No newline at end of file
+}
+void CL_SetScheduleLevel(int level) { scheduleLevel = level; }
+int CL_GetScheduleLevel() { return scheduleLevel; }
+void CL_SetHybridThreshold(double threshold) {
+  global_HybridThreshold = threshold;
+}
+double CL_getBurden(int _CPU_GPU) { return _CPU_GPU ? GPUBurden : CPUBurden; }
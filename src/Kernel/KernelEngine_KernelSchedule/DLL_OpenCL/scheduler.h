@@ -1,4 +1,8 @@
+//the kernel ids the handshake calibrates, AddCPUBurden/AddGPUBurden are indexed by them.
+#define NUM_KERNEL_ID (83)
 int  Kernelscheduler(int size,int kid,int *Flag_CPU_GPU,double * burden,int _CPU_GPU);
+int  Kernelscheduler(int size,int kid,int residence,int *Flag_CPU_GPU,double * burden,int _CPU_GPU);
+double getMigrationBurden(int from,int to,double size);
 void deschedule(const int preFlag, const double preBurden);
 int  cl_readbufferscheduler(int size,int *Flag_CPU_GPU,double * burden,int _CPU_GPU);
 int  cl_writebufferscheduler(int size,int *Flag_CPU_GPU,double * burden,int _CPU_GPU);
@@ -39,7 +39,8 @@ void gatherBeforeAgg(cl_mem d_Rin, int rLen, cl_mem d_Ragg, cl_mem d_S, int numT
 {
 	cl_mem d_loc;
 	CL_MALLOC(&d_loc, sizeof(int)*rLen ) ;
-	clWaitForEvents(1,&eventList[(*index-1)%2]);
+	if(*index>0)//nothing is enqueued yet when the input is already on the device.
+		clWaitForEvents(1,&eventList[(*index-1)%2]);
 	cl_mem d_temp;
 	CL_MALLOC(&d_temp, sizeof(int)*rLen ) ;
 
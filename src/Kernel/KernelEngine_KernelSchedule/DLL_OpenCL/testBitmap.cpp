@@ -0,0 +1,134 @@
+#include "common.h"
+#include "testBitmap.h"
+#include "testScan.h"
+#include "KernelScheduler.h"
+#include "OpenCL_DLL.h"
+
+void bitmap_rangeSelectionImpl( cl_mem d_Rin, int rLen, int smallKey, int largeKey, cl_mem d_bitmap,
+				int numThreadPB, int numBlock,int *index,cl_event *eventList,cl_kernel *Kernel,int *Flag_CPU_GPU,double * burden,int _CPU_GPU)
+{
+	size_t numThreadsPerBlock_x=numThreadPB;
+	size_t globalWorkingSetSize=numThreadPB*numBlock;
+	cl_getKernel("bitmap_rangeSelection_kernel",Kernel);
+    // Set the Argument values
+    cl_int ciErr1 = clSetKernelArg((*Kernel), 0, sizeof(cl_mem), (void*)&d_Rin);
+	ciErr1 |= clSetKernelArg((*Kernel), 1, sizeof(cl_int), (void*)&rLen);
+	ciErr1 |= clSetKernelArg((*Kernel), 2, sizeof(cl_int), (void*)&smallKey);
+	ciErr1 |= clSetKernelArg((*Kernel), 3, sizeof(cl_int), (void*)&largeKey);
+	ciErr1 |= clSetKernelArg((*Kernel), 4, sizeof(cl_mem), (void*)&d_bitmap);
+    if (ciErr1 != CL_SUCCESS)
+    {
+        printf("Error in clSetKernelArg, Line %u in file %s !!!\n\n", __LINE__, __FILE__);
+        cl_clean(EXIT_FAILURE);
+    }
+	//the same pass over the input as the fused selection, without the output records.
+	kernel_enqueue(rLen,51, 
+		1, &globalWorkingSetSize, &numThreadsPerBlock_x,eventList,index,Kernel,Flag_CPU_GPU,burden,_CPU_GPU);
+}
+
+void bitmap_combineImpl( cl_mem d_A, cl_mem d_B, int numBit, int isOr,
+				int numThreadPB, int numBlock,int *index,cl_event *eventList,cl_kernel *Kernel,int *Flag_CPU_GPU,double * burden,int _CPU_GPU)
+{
+	size_t numThreadsPerBlock_x=numThreadPB;
+	size_t globalWorkingSetSize=numThreadPB*numBlock;
+	int numWord=BITMAP_NUM_WORD(numBit);
+	cl_getKernel("bitmap_combine_kernel",Kernel);
+    cl_int ciErr1 = clSetKernelArg((*Kernel), 0, sizeof(cl_mem), (void*)&d_A);
+	ciErr1 |= clSetKernelArg((*Kernel), 1, sizeof(cl_mem), (void*)&d_B);
+	ciErr1 |= clSetKernelArg((*Kernel), 2, sizeof(cl_int), (void*)&numWord);
+	ciErr1 |= clSetKernelArg((*Kernel), 3, sizeof(cl_int), (void*)&isOr);
+    if (ciErr1 != CL_SUCCESS)
+    {
+        printf("Error in clSetKernelArg, Line %u in file %s !!!\n\n", __LINE__, __FILE__);
+        cl_clean(EXIT_FAILURE);
+    }
+	kernel_enqueue(numWord,52, 
+		1, &globalWorkingSetSize, &numThreadsPerBlock_x,eventList,index,Kernel,Flag_CPU_GPU,burden,_CPU_GPU);
+}
+
+int bitmap_toRIDListImpl( cl_mem d_bitmap, int numBit, cl_mem* d_RIDList,
+				int numThreadPB, int numBlock,int *index,cl_event *eventList,cl_kernel *Kernel,int *Flag_CPU_GPU,double * burden,int _CPU_GPU)
+{
+	size_t numThreadsPerBlock_x=numThreadPB;
+	size_t globalWorkingSetSize=numThreadPB*numBlock;
+	int numWord=BITMAP_NUM_WORD(numBit);
+	if(numWord==0)
+	{
+		CL_MALLOC(d_RIDList, sizeof(int));
+		return 0;
+	}
+	cl_mem d_count;
+	cl_mem d_sum;
+	//one count past the words, its prefix sum is the number of set bits.
+	CL_MALLOC(&d_count, sizeof(int)*(numWord+1));
+	CL_MALLOC(&d_sum, sizeof(int)*(numWord+1));
+
+	cl_getKernel("bitmap_count_kernel",Kernel);
+    cl_int ciErr1 = clSetKernelArg((*Kernel), 0, sizeof(cl_mem), (void*)&d_bitmap);
+	ciErr1 |= clSetKernelArg((*Kernel), 1, sizeof(cl_int), (void*)&numWord);
+	ciErr1 |= clSetKernelArg((*Kernel), 2, sizeof(cl_mem), (void*)&d_count);
+    if (ciErr1 != CL_SUCCESS)
+    {
+        printf("Error in clSetKernelArg, Line %u in file %s !!!\n\n", __LINE__, __FILE__);
+        cl_clean(EXIT_FAILURE);
+    }
+	kernel_enqueue(numWord+1,53, 
+		1, &globalWorkingSetSize, &numThreadsPerBlock_x,eventList,index,Kernel,Flag_CPU_GPU,burden,_CPU_GPU);
+	clReleaseKernel(*Kernel);
+
+	//the exclusive prefix sum of the counts is where every word writes its RIDs.
+	ScanPara *SP=scan_getPara(numWord+1);
+	scanImpl(d_count,numWord+1,d_sum,index,eventList,Kernel,Flag_CPU_GPU,burden,SP,_CPU_GPU);
+	//the only readback, blocking and chained after the scan.
+	int numResult=0;
+	cl_readbuffer((void*)&numResult, d_sum, numWord*sizeof(int), sizeof(int),index,eventList,Flag_CPU_GPU,burden,_CPU_GPU);
+
+	CL_MALLOC(d_RIDList, sizeof(int)*(numResult>0?numResult:1));
+	if(numResult>0)
+	{
+		clReleaseKernel(*Kernel);
+		cl_getKernel("bitmap_toRIDList_kernel",Kernel);
+	    ciErr1 = clSetKernelArg((*Kernel), 0, sizeof(cl_mem), (void*)&d_bitmap);
+		ciErr1 |= clSetKernelArg((*Kernel), 1, sizeof(cl_int), (void*)&numWord);
+		ciErr1 |= clSetKernelArg((*Kernel), 2, sizeof(cl_mem), (void*)&d_sum);
+		ciErr1 |= clSetKernelArg((*Kernel), 3, sizeof(cl_mem), (void*)d_RIDList);
+	    if (ciErr1 != CL_SUCCESS)
+	    {
+	        printf("Error in clSetKernelArg, Line %u in file %s !!!\n\n", __LINE__, __FILE__);
+	        cl_clean(EXIT_FAILURE);
+	    }
+		kernel_enqueue(numWord,54, 
+			1, &globalWorkingSetSize, &numThreadsPerBlock_x,eventList,index,Kernel,Flag_CPU_GPU,burden,_CPU_GPU);
+		clWaitForEvents(1,&eventList[(*index-1)%2]); 
+	}
+	CL_FREE(d_count);
+	CL_FREE(d_sum);
+	return numResult;
+}
+
+int bitmap_totalImpl( cl_mem d_bitmap, int numBit,
+				int numThreadPB, int numBlock,int *index,cl_event *eventList,cl_kernel *Kernel,int *Flag_CPU_GPU,double * burden,int _CPU_GPU)
+{
+	size_t numThreadsPerBlock_x=numThreadPB;
+	size_t globalWorkingSetSize=numThreadPB*numBlock;
+	int numWord=BITMAP_NUM_WORD(numBit);
+	int numResult=0;
+	cl_mem d_total;
+	CL_MALLOC(&d_total, sizeof(int));
+	cl_writebuffer(d_total, &numResult, sizeof(int),index,eventList,Flag_CPU_GPU,burden,_CPU_GPU);
+	cl_getKernel("bitmap_total_kernel",Kernel);
+    cl_int ciErr1 = clSetKernelArg((*Kernel), 0, sizeof(cl_mem), (void*)&d_bitmap);
+	ciErr1 |= clSetKernelArg((*Kernel), 1, sizeof(cl_int), (void*)&numWord);
+	ciErr1 |= clSetKernelArg((*Kernel), 2, sizeof(cl_mem), (void*)&d_total);
+	ciErr1 |= clSetKernelArg((*Kernel), 3, sizeof(cl_int), NULL);
+    if (ciErr1 != CL_SUCCESS)
+    {
+        printf("Error in clSetKernelArg, Line %u in file %s !!!\n\n", __LINE__, __FILE__);
+        cl_clean(EXIT_FAILURE);
+    }
+	kernel_enqueue(numWord,55, 
+		1, &globalWorkingSetSize, &numThreadsPerBlock_x,eventList,index,Kernel,Flag_CPU_GPU,burden,_CPU_GPU);
+	cl_readbuffer((void*)&numResult, d_total, sizeof(int),index,eventList,Flag_CPU_GPU,burden,_CPU_GPU);
+	CL_FREE(d_total);
+	return numResult;
+}
@@ -0,0 +1,14 @@
+#include "common.h"
+//bitmaps over a base table: bit i of word i/32 stands for the record at position i.
+#define BITMAP_NUM_WORD(numBit) (((numBit)+31)>>5)
+
+void bitmap_rangeSelectionImpl( cl_mem d_Rin, int rLen, int smallKey, int largeKey, cl_mem d_bitmap,
+				int numThreadPB, int numBlock,int *index,cl_event *eventList,cl_kernel *Kernel,int *Flag_CPU_GPU,double * burden,int _CPU_GPU);
+void bitmap_combineImpl( cl_mem d_A, cl_mem d_B, int numBit, int isOr,
+				int numThreadPB, int numBlock,int *index,cl_event *eventList,cl_kernel *Kernel,int *Flag_CPU_GPU,double * burden,int _CPU_GPU);
+//the positions of the set bits in increasing order, returns their number.
+int bitmap_toRIDListImpl( cl_mem d_bitmap, int numBit, cl_mem* d_RIDList,
+				int numThreadPB, int numBlock,int *index,cl_event *eventList,cl_kernel *Kernel,int *Flag_CPU_GPU,double * burden,int _CPU_GPU);
+//the number of set bits, with a single readback.
+int bitmap_totalImpl( cl_mem d_bitmap, int numBit,
+				int numThreadPB, int numBlock,int *index,cl_event *eventList,cl_kernel *Kernel,int *Flag_CPU_GPU,double * burden,int _CPU_GPU);
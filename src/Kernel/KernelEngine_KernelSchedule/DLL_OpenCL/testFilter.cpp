@@ -14,115 +14,69 @@ extern cl_platform_id Platform[2];      // OpenCL platform
 extern cl_device_id Device[2];          // OpenCL device
 extern cl_ulong totalLocalMemory[2];      /**< Max local memory allowed */
 extern cl_device_id allDevices[10];
+//the selection output starts at 1/FILTER_OUT_FRACTION of the input, at least FILTER_MIN_OUT records.
+#define FILTER_OUT_FRACTION 8
+#define FILTER_MIN_OUT 4096
 
-void filterImpl_map_int(cl_mem d_Rin, int beginPos, int rLen, 
-					cl_mem d_mark, int smallKey, int largeKey, cl_mem d_temp,
+void filterImpl_fused_int(cl_mem d_Rin, int beginPos, int rLen, cl_mem d_Rout, int outCap, cl_mem d_outSize,
+					int smallKey, int largeKey,
 					int numThreadPB, int numBlock,int *index,cl_event *eventList,cl_kernel *Kernel,int *Flag_CPU_GPU,double * burden,int _CPU_GPU)
 {
 	size_t numThreadsPerBlock_x=numThreadPB;
 	size_t globalWorkingSetSize=numThreadPB*numBlock;
 
-	cl_getKernel("filterImpl_map_kernel",Kernel);
+	cl_getKernel("filterImpl_fused_kernel",Kernel);
 
     // Set the Argument values
     cl_int ciErr1 = clSetKernelArg((*Kernel), 0, sizeof(cl_mem), (void*)&d_Rin);	
 	ciErr1 |= clSetKernelArg((*Kernel), 1, sizeof(cl_int), (void*)&beginPos);
 	ciErr1 |= clSetKernelArg((*Kernel), 2, sizeof(cl_int), (void*)&rLen);
-	ciErr1 = clSetKernelArg((*Kernel), 3, sizeof(cl_mem), (void*)&d_mark);	
-	ciErr1 |= clSetKernelArg((*Kernel), 4, sizeof(cl_int), (void*)&smallKey);
-	ciErr1 |= clSetKernelArg((*Kernel), 5, sizeof(cl_int), (void*)&largeKey);
-    ciErr1 |= clSetKernelArg((*Kernel), 6, sizeof(cl_mem), (void*)&d_temp); 
-       if (ciErr1 != CL_SUCCESS)
-    {
-        printf("Error in clSetKernelArg, Line %u in file %s !!!\n\n", __LINE__, __FILE__);
-        cl_clean(EXIT_FAILURE);
-    }
-	//printf("clSetKernelArg 0 - 6...\n\n"); 
-	kernel_enqueue(rLen,20, 
-		1, &globalWorkingSetSize, &numThreadsPerBlock_x,eventList,index,Kernel,Flag_CPU_GPU,burden,_CPU_GPU);
-
-}
-void filterImpl_outSize_int(cl_mem d_outSize,cl_mem d_mark,cl_mem d_markOutput,int rLen,int numThreadPB, int numBlock,int *index,cl_event *eventList,cl_kernel *Kernel,int *Flag_CPU_GPU,double * burden,int _CPU_GPU )
-{
-	size_t numThreadsPerBlock_x=numThreadPB;
-	size_t globalWorkingSetSize=numThreadPB*numBlock;
-	cl_getKernel("filterImpl_outSize_kernel",Kernel);
-    // Set the Argument values
-    cl_int ciErr1 = clSetKernelArg((*Kernel), 0, sizeof(cl_mem), (void*)&d_outSize);	
-	ciErr1 = clSetKernelArg((*Kernel), 1, sizeof(cl_mem), (void*)&d_mark);	
-	ciErr1 = clSetKernelArg((*Kernel), 2, sizeof(cl_mem), (void*)&d_markOutput);
-	ciErr1 = clSetKernelArg((*Kernel), 3, sizeof(cl_int), (void*)&rLen);
+	ciErr1 |= clSetKernelArg((*Kernel), 3, sizeof(cl_int), (void*)&smallKey);
+	ciErr1 |= clSetKernelArg((*Kernel), 4, sizeof(cl_int), (void*)&largeKey);
+	ciErr1 |= clSetKernelArg((*Kernel), 5, sizeof(cl_mem), (void*)&d_Rout);
+	ciErr1 |= clSetKernelArg((*Kernel), 6, sizeof(cl_int), (void*)&outCap);
+	ciErr1 |= clSetKernelArg((*Kernel), 7, sizeof(cl_mem), (void*)&d_outSize);
     if (ciErr1 != CL_SUCCESS)
     {
         printf("Error in clSetKernelArg, Line %u in file %s !!!\n\n", __LINE__, __FILE__);
         cl_clean(EXIT_FAILURE);
     }
-	kernel_enqueue(rLen, 21, 
-		1, &globalWorkingSetSize, &numThreadsPerBlock_x,eventList,index,Kernel,Flag_CPU_GPU,burden,_CPU_GPU);
-
-
-}
-void filterImpl_write_int( cl_mem d_Rout, cl_mem d_Rin, cl_mem d_mark, 
-						cl_mem d_markOutput, int beginPos, int rLen,
-						int numThreadPB, int numBlock,int *index,cl_event *eventList,cl_kernel *Kernel,int *Flag_CPU_GPU,double * burden,int _CPU_GPU)
-{
-	size_t numThreadsPerBlock_x=numThreadPB;
-	size_t globalWorkingSetSize=numThreadPB*numBlock;
-	cl_getKernel("filterImpl_write_kernel",Kernel);
-    // Set the Argument values
-    cl_int ciErr1 = clSetKernelArg((*Kernel), 0, sizeof(cl_mem), (void*)&d_Rout);	
-	ciErr1 = clSetKernelArg((*Kernel), 1, sizeof(cl_mem), (void*)&d_Rin);	
-	ciErr1 = clSetKernelArg((*Kernel), 2, sizeof(cl_mem), (void*)&d_mark);
-	ciErr1 = clSetKernelArg((*Kernel), 3, sizeof(cl_mem), (void*)&d_markOutput);
-	ciErr1 |= clSetKernelArg((*Kernel), 4, sizeof(cl_int), (void*)&beginPos);
-	ciErr1 |= clSetKernelArg((*Kernel), 5, sizeof(cl_int), (void*)&rLen);
-    //printf("clSetKernelArg 0 - 5...\n\n"); 
-    if (ciErr1 != CL_SUCCESS)
-    {
-        printf("Error in clSetKernelArg, Line %u in file %s !!!\n\n", __LINE__, __FILE__);
-        cl_clean(EXIT_FAILURE);
-    }
-	kernel_enqueue(rLen, 23, 
+	kernel_enqueue(rLen,68, 
 		1, &globalWorkingSetSize, &numThreadsPerBlock_x,eventList,index,Kernel,Flag_CPU_GPU,burden,_CPU_GPU);
 }
 
+//single pass selection: every work-group compacts its tile locally, reserves
+//its output range with one atomic on d_outSize and writes the matches directly.
 void filterImpl( cl_mem d_Rin, int beginPos, int rLen, cl_mem* d_Rout, int* outSize, 
 				int numThread, int numBlock, int smallKey, int largeKey,int *index,cl_event *eventList,cl_kernel *Kernel, int *Flag_CPU_GPU,double * burden,int _CPU_GPU)
 {
-	cl_mem d_mark;
-	CL_MALLOC( &d_mark, sizeof(int)*rLen ) ;
-
-	cl_mem d_markOutput;
-	CL_MALLOC( &d_markOutput, sizeof(int)*rLen ) ;
-
-	cl_mem d_temp;
-	CL_MALLOC( &d_temp, sizeof(int)*rLen ) ;
-
-	filterImpl_map_int( d_Rin, beginPos, rLen, d_mark, smallKey, largeKey, d_temp, numThread, numBlock,index,eventList,Kernel,Flag_CPU_GPU,burden,_CPU_GPU);
-	clWaitForEvents(1,&eventList[(*index-1)%2]);
-	//prefex sum
-	ScanPara *SP;
-	SP=(ScanPara*)malloc(sizeof(ScanPara));
-	initScan(rLen,SP);
-	scanImpl( d_mark, rLen, d_markOutput,index,eventList,Kernel,Flag_CPU_GPU,burden,SP,_CPU_GPU);
-	clWaitForEvents(1,&eventList[(*index-1)%2]); 
-	closeScan(SP);
-
-	//get the outSize
+	int zero=0;
 	cl_mem d_outSize;
 	CL_MALLOC(&d_outSize, sizeof(int)) ;
-	filterImpl_outSize_int(d_outSize, d_mark, d_markOutput, rLen,1,1,index,eventList,Kernel,Flag_CPU_GPU,burden,_CPU_GPU);
+	cl_writebuffer(d_outSize,&zero,sizeof(int),index,eventList,Flag_CPU_GPU,burden,_CPU_GPU);
+
+	//the size is only known once the kernel is done. the output starts at a fraction
+	//of the input; the kernel still counts the matches it cannot write, and if they
+	//overflow it is run again on an output of the exact size.
+	int outCap=rLen/FILTER_OUT_FRACTION;
+	if(outCap<FILTER_MIN_OUT)
+		outCap=min(rLen,FILTER_MIN_OUT);
+	CL_MALLOC( d_Rout, sizeof(Record)*(outCap>0?outCap:1) );
+	filterImpl_fused_int( d_Rin, beginPos, rLen, *d_Rout, outCap, d_outSize, smallKey, largeKey, numThread, numBlock,index,eventList,Kernel,Flag_CPU_GPU,burden,_CPU_GPU);
 	clWaitForEvents(1,&eventList[(*index-1)%2]); 
-	//bufferchecking(d_outSize,sizeof(int));
 	cl_readbuffer(outSize,d_outSize, sizeof(int),index,eventList,Flag_CPU_GPU,burden,_CPU_GPU);
-
-	//write the reduced result
-	CL_MALLOC( d_Rout, sizeof(Record)*(*outSize) );
-	filterImpl_write_int( *d_Rout, d_Rin, d_mark, d_markOutput, beginPos, rLen,numThread, numBlock,index,eventList,Kernel,Flag_CPU_GPU,burden,_CPU_GPU );
-	clWaitForEvents(1,&eventList[(*index-1)%2]); 
-	CL_FREE(d_mark);
-	CL_FREE(d_markOutput);
-	CL_FREE( d_temp );
+	if((*outSize)>outCap)
+	{
+		outCap=(*outSize);
+		CL_FREE(*d_Rout);
+		CL_MALLOC( d_Rout, sizeof(Record)*outCap );
+		clReleaseKernel(*Kernel);
+		cl_writebuffer(d_outSize,&zero,sizeof(int),index,eventList,Flag_CPU_GPU,burden,_CPU_GPU);
+		filterImpl_fused_int( d_Rin, beginPos, rLen, *d_Rout, outCap, d_outSize, smallKey, largeKey, numThread, numBlock,index,eventList,Kernel,Flag_CPU_GPU,burden,_CPU_GPU);
+		clWaitForEvents(1,&eventList[(*index-1)%2]); 
+		cl_readbuffer(outSize,d_outSize, sizeof(int),index,eventList,Flag_CPU_GPU,burden,_CPU_GPU);
+	}
+	CL_FREE(d_outSize);
 }
 
 void testFilterImpl( int rLen, int numThreadPB, int numBlock)//->corresponding to selection
@@ -3,6 +3,7 @@
 #include "testGroupBy.h"
 #include "KernelScheduler.h"
 #include "OpenCL_DLL.h"
+#include <limits.h>
 // OpenCL Vars---------0 for CPU, 1 for GPU
 extern cl_context Context;        // OpenCL context
 extern cl_program Program;           // OpenCL program
@@ -68,7 +69,119 @@ void groupByImpl_write_int(cl_mem d_startPos,cl_mem d_groupLabel,cl_mem d_writeP
 		1, &globalWorkingSetSize, &numThreadsPerBlock_x,eventList,index,kernel,Flag_CPU_GPU,burden,_CPU_GPU);
 
 }
-int groupByImpl(cl_mem d_Rin, int rLen, cl_mem d_Rout, cl_mem* d_startPos, int numThread, int numBlock,int *index,cl_event *eventList,cl_kernel *kernel,int *Flag_CPU_GPU,double * burden,int _CPU_GPU)
+void hashGroupBy_build_int(cl_mem d_R, int rLen, cl_mem d_keys, cl_mem d_counts, int capacity, cl_mem d_numGroup, cl_mem d_overflow, int numThreadPB, int numBlock,int *index,cl_event *eventList,cl_kernel *kernel,int *Flag_CPU_GPU,double * burden,int _CPU_GPU)
+{
+	size_t numThreadsPerBlock_x=numThreadPB;
+	size_t globalWorkingSetSize=numThreadPB*numBlock;
+	int maxGroup=HASH_GROUPBY_MAX_GROUP;
+	int localSlots=HASH_GROUPBY_LOCAL_SLOTS;
+	cl_getKernel("hashGroupBy_build_kernel",kernel);
+	cl_int ciErr1 = clSetKernelArg((*kernel), 0, sizeof(cl_mem), (void*)&d_R);
+	ciErr1 |= clSetKernelArg((*kernel), 1, sizeof(cl_int), (void*)&rLen);
+	ciErr1 |= clSetKernelArg((*kernel), 2, sizeof(cl_mem), (void*)&d_keys);
+	ciErr1 |= clSetKernelArg((*kernel), 3, sizeof(cl_mem), (void*)&d_counts);
+	ciErr1 |= clSetKernelArg((*kernel), 4, sizeof(cl_int), (void*)&capacity);
+	ciErr1 |= clSetKernelArg((*kernel), 5, sizeof(cl_int), (void*)&maxGroup);
+	ciErr1 |= clSetKernelArg((*kernel), 6, sizeof(cl_mem), (void*)&d_numGroup);
+	ciErr1 |= clSetKernelArg((*kernel), 7, sizeof(cl_mem), (void*)&d_overflow);
+	ciErr1 |= clSetKernelArg((*kernel), 8, sizeof(cl_int)*localSlots, NULL);
+	ciErr1 |= clSetKernelArg((*kernel), 9, sizeof(cl_int)*localSlots, NULL);
+	ciErr1 |= clSetKernelArg((*kernel), 10, sizeof(cl_int), (void*)&localSlots);
+	if (ciErr1 != CL_SUCCESS)
+	{
+		printf("Error in clSetKernelArg, Line %u in file %s !!!\n\n", __LINE__, __FILE__);
+		cl_clean(EXIT_FAILURE);
+	}
+	kernel_enqueue(rLen,56,
+		1, &globalWorkingSetSize, &numThreadsPerBlock_x,eventList,index,kernel,Flag_CPU_GPU,burden,_CPU_GPU);
+}
+void hashGroupBy_rank_int(cl_mem d_keys, cl_mem d_counts, int capacity, cl_mem d_groupId, cl_mem d_startPos, int numThreadPB, int numBlock,int *index,cl_event *eventList,cl_kernel *kernel,int *Flag_CPU_GPU,double * burden,int _CPU_GPU)
+{
+	size_t numThreadsPerBlock_x=numThreadPB;
+	size_t globalWorkingSetSize=numThreadPB*numBlock;
+	cl_getKernel("hashGroupBy_rank_kernel",kernel);
+	cl_int ciErr1 = clSetKernelArg((*kernel), 0, sizeof(cl_mem), (void*)&d_keys);
+	ciErr1 |= clSetKernelArg((*kernel), 1, sizeof(cl_mem), (void*)&d_counts);
+	ciErr1 |= clSetKernelArg((*kernel), 2, sizeof(cl_int), (void*)&capacity);
+	ciErr1 |= clSetKernelArg((*kernel), 3, sizeof(cl_mem), (void*)&d_groupId);
+	ciErr1 |= clSetKernelArg((*kernel), 4, sizeof(cl_mem), (void*)&d_startPos);
+	if (ciErr1 != CL_SUCCESS)
+	{
+		printf("Error in clSetKernelArg, Line %u in file %s !!!\n\n", __LINE__, __FILE__);
+		cl_clean(EXIT_FAILURE);
+	}
+	kernel_enqueue(capacity+1,57,
+		1, &globalWorkingSetSize, &numThreadsPerBlock_x,eventList,index,kernel,Flag_CPU_GPU,burden,_CPU_GPU);
+}
+void hashGroupBy_scatter_int(cl_mem d_R, int rLen, cl_mem d_keys, int capacity, cl_mem d_groupId, cl_mem d_startPos, cl_mem d_cursor, cl_mem d_Rout, int numThreadPB, int numBlock,int *index,cl_event *eventList,cl_kernel *kernel,int *Flag_CPU_GPU,double * burden,int _CPU_GPU)
+{
+	size_t numThreadsPerBlock_x=numThreadPB;
+	size_t globalWorkingSetSize=numThreadPB*numBlock;
+	cl_getKernel("hashGroupBy_scatter_kernel",kernel);
+	cl_int ciErr1 = clSetKernelArg((*kernel), 0, sizeof(cl_mem), (void*)&d_R);
+	ciErr1 |= clSetKernelArg((*kernel), 1, sizeof(cl_int), (void*)&rLen);
+	ciErr1 |= clSetKernelArg((*kernel), 2, sizeof(cl_mem), (void*)&d_keys);
+	ciErr1 |= clSetKernelArg((*kernel), 3, sizeof(cl_int), (void*)&capacity);
+	ciErr1 |= clSetKernelArg((*kernel), 4, sizeof(cl_mem), (void*)&d_groupId);
+	ciErr1 |= clSetKernelArg((*kernel), 5, sizeof(cl_mem), (void*)&d_startPos);
+	ciErr1 |= clSetKernelArg((*kernel), 6, sizeof(cl_mem), (void*)&d_cursor);
+	ciErr1 |= clSetKernelArg((*kernel), 7, sizeof(cl_mem), (void*)&d_Rout);
+	if (ciErr1 != CL_SUCCESS)
+	{
+		printf("Error in clSetKernelArg, Line %u in file %s !!!\n\n", __LINE__, __FILE__);
+		cl_clean(EXIT_FAILURE);
+	}
+	kernel_enqueue(rLen,58,
+		1, &globalWorkingSetSize, &numThreadsPerBlock_x,eventList,index,kernel,Flag_CPU_GPU,burden,_CPU_GPU);
+}
+/*one pass over R counts the groups in a hash table, the groups are then ranked by key and
+the records scattered to them. returns -1 when there are more than HASH_GROUPBY_MAX_GROUP groups.*/
+int hashGroupByImpl(cl_mem d_Rin, int rLen, cl_mem d_Rout, cl_mem* d_startPos, int numThread, int numBlock,int *index,cl_event *eventList,cl_kernel *kernel,int *Flag_CPU_GPU,double * burden,int _CPU_GPU)
+{
+	int capacity=HASH_GROUPBY_CAPACITY;
+	cl_mem d_keys=NULL;
+	cl_mem d_counts=NULL;
+	cl_mem d_numGroup=NULL;
+	cl_mem d_overflow=NULL;
+	int numGroup=0;
+	int overflow=0;
+	CL_MALLOC(&d_keys, sizeof(int)*capacity);
+	CL_MALLOC(&d_counts, sizeof(int)*(capacity+1));
+	CL_MALLOC(&d_numGroup, sizeof(int));
+	CL_MALLOC(&d_overflow, sizeof(int));
+	memset_int(d_keys,capacity,INT_MIN,numThread,numBlock,index,eventList,kernel,Flag_CPU_GPU,burden,_CPU_GPU);
+	memset_int(d_counts,capacity+1,0,numThread,numBlock,index,eventList,kernel,Flag_CPU_GPU,burden,_CPU_GPU);
+	memset_int(d_numGroup,1,0,1,1,index,eventList,kernel,Flag_CPU_GPU,burden,_CPU_GPU);
+	memset_int(d_overflow,1,0,1,1,index,eventList,kernel,Flag_CPU_GPU,burden,_CPU_GPU);
+	hashGroupBy_build_int(d_Rin,rLen,d_keys,d_counts,capacity,d_numGroup,d_overflow,numThread,numBlock,index,eventList,kernel,Flag_CPU_GPU,burden,_CPU_GPU);
+	clWaitForEvents(1,&eventList[(*index-1)%2]); 
+	cl_readbuffer(&numGroup,d_numGroup,sizeof(int),0);
+	cl_readbuffer(&overflow,d_overflow,sizeof(int),0);
+	if(overflow || numGroup>HASH_GROUPBY_MAX_GROUP)
+	{
+		numGroup=-1;
+	}
+	else
+	{
+		cl_mem d_groupId=NULL;
+		cl_mem d_cursor=NULL;
+		CL_MALLOC(d_startPos, sizeof(int)*numGroup);
+		CL_MALLOC(&d_groupId, sizeof(int)*(capacity+1));
+		CL_MALLOC(&d_cursor, sizeof(int)*numGroup);
+		memset_int(d_cursor,numGroup,0,numThread,numBlock,index,eventList,kernel,Flag_CPU_GPU,burden,_CPU_GPU);
+		hashGroupBy_rank_int(d_keys,d_counts,capacity,d_groupId,(*d_startPos),numThread,numBlock,index,eventList,kernel,Flag_CPU_GPU,burden,_CPU_GPU);
+		hashGroupBy_scatter_int(d_Rin,rLen,d_keys,capacity,d_groupId,(*d_startPos),d_cursor,d_Rout,numThread,numBlock,index,eventList,kernel,Flag_CPU_GPU,burden,_CPU_GPU);
+		clWaitForEvents(1,&eventList[(*index-1)%2]); 
+		CL_FREE(d_groupId);
+		CL_FREE(d_cursor);
+	}
+	CL_FREE(d_keys);
+	CL_FREE(d_counts);
+	CL_FREE(d_numGroup);
+	CL_FREE(d_overflow);
+	return numGroup;
+}
+int sortGroupByImpl(cl_mem d_Rin, int rLen, cl_mem d_Rout, cl_mem* d_startPos, int numThread, int numBlock,int *index,cl_event *eventList,cl_kernel *kernel,int *Flag_CPU_GPU,double * burden,int _CPU_GPU)
 {
 	cl_mem d_groupLabel=NULL;
 	cl_mem d_writePos=NULL;
@@ -77,32 +190,169 @@ int groupByImpl(cl_mem d_Rin, int rLen, cl_mem d_Rout, cl_mem* d_startPos, int n
 	int memSize=sizeof(Record)*rLen;	
 	//sort
 	cl_copyBuffer(d_Rout,d_Rin,memSize,index,eventList,Flag_CPU_GPU,burden,_CPU_GPU);
-	radixSortImpl(d_Rout, rLen,32, numThread, numBlock,index,eventList,kernel,Flag_CPU_GPU,burden,_CPU_GPU );
+	mergeSortImpl(d_Rout, rLen, numThread, numBlock,index,eventList,kernel,Flag_CPU_GPU,burden,_CPU_GPU );
 	CL_MALLOC(&d_groupLabel, sizeof(int)*rLen );
+	//scanGroupLabel_kernel only writes the 1s.
+	int* h_zero=(int*)calloc(rLen,sizeof(int));
+	cl_writebuffer(d_groupLabel,h_zero,sizeof(int)*rLen,index,eventList,Flag_CPU_GPU,burden,_CPU_GPU);
+	free(h_zero);
 	groupByImpl_int(d_Rout, rLen, d_groupLabel,numThread, numBlock,index,eventList,kernel,Flag_CPU_GPU,burden,_CPU_GPU);
 	CL_MALLOC( &d_writePos, sizeof(int)*rLen );
-	ScanPara *SP;
-	SP=(ScanPara*)malloc(sizeof(ScanPara));
-	initScan(rLen,SP);
+	ScanPara *SP=scan_getPara(rLen);
 	scanImpl( d_groupLabel, rLen, d_writePos,index,eventList,kernel,Flag_CPU_GPU,burden,SP,_CPU_GPU );
 	CL_MALLOC( &d_numGroup, sizeof(int));
 	groupByImpl_outSize_int( d_numGroup, d_groupLabel, d_writePos, rLen,1, 1,index,eventList,kernel,Flag_CPU_GPU,burden,_CPU_GPU);
 	clWaitForEvents(1,&eventList[(*index-1)%2]); 
 
-	int test;
-	cl_readbuffer(&test,d_numGroup,sizeof(int),0);
-
-
-
+	cl_readbuffer(&numGroup,d_numGroup,sizeof(int),0);
 	CL_MALLOC(d_startPos, sizeof(int)*numGroup );
 	groupByImpl_write_int((*d_startPos), d_groupLabel, d_writePos, rLen,numThread, numBlock,index,eventList,kernel,Flag_CPU_GPU,burden,_CPU_GPU);
 	clWaitForEvents(1,&eventList[(*index-1)%2]); 
-	closeScan(SP);
 	CL_FREE(d_groupLabel);
 	CL_FREE( d_writePos);
 	CL_FREE(d_numGroup );
 	return numGroup;
 }
+/*few groups take the hash path, a single pass over R; many groups the sort path.*/
+int groupByImpl(cl_mem d_Rin, int rLen, cl_mem d_Rout, cl_mem* d_startPos, int numThread, int numBlock,int *index,cl_event *eventList,cl_kernel *kernel,int *Flag_CPU_GPU,double * burden,int _CPU_GPU)
+{
+	int numGroup=hashGroupByImpl(d_Rin,rLen,d_Rout,d_startPos,numThread,numBlock,index,eventList,kernel,Flag_CPU_GPU,burden,_CPU_GPU);
+	if(numGroup<0)
+		numGroup=sortGroupByImpl(d_Rin,rLen,d_Rout,d_startPos,numThread,numBlock,index,eventList,kernel,Flag_CPU_GPU,burden,_CPU_GPU);
+	return numGroup;
+}
+void distinct_insert_int(cl_mem d_R, cl_mem d_others, int numOther, int rLen, cl_mem d_table, int capacity, cl_mem d_counter, cl_mem d_Rout, int numThreadPB, int numBlock,int *index,cl_event *eventList,cl_kernel *kernel,int *Flag_CPU_GPU,double * burden,int _CPU_GPU)
+{
+	size_t numThreadsPerBlock_x=numThreadPB;
+	size_t globalWorkingSetSize=numThreadPB*numBlock;
+	cl_getKernel("distinct_insert_kernel",kernel);
+	cl_int ciErr1 = clSetKernelArg((*kernel), 0, sizeof(cl_mem), (void*)&d_R);
+	ciErr1 |= clSetKernelArg((*kernel), 1, sizeof(cl_mem), (void*)&d_others);
+	ciErr1 |= clSetKernelArg((*kernel), 2, sizeof(cl_int), (void*)&numOther);
+	ciErr1 |= clSetKernelArg((*kernel), 3, sizeof(cl_int), (void*)&rLen);
+	ciErr1 |= clSetKernelArg((*kernel), 4, sizeof(cl_mem), (void*)&d_table);
+	ciErr1 |= clSetKernelArg((*kernel), 5, sizeof(cl_int), (void*)&capacity);
+	ciErr1 |= clSetKernelArg((*kernel), 6, sizeof(cl_mem), (void*)&d_counter);
+	ciErr1 |= clSetKernelArg((*kernel), 7, sizeof(cl_mem), (void*)&d_Rout);
+	if (ciErr1 != CL_SUCCESS)
+	{
+		printf("Error in clSetKernelArg, Line %u in file %s !!!\n\n", __LINE__, __FILE__);
+		cl_clean(EXIT_FAILURE);
+	}
+	kernel_enqueue(rLen,63,
+		1, &globalWorkingSetSize, &numThreadsPerBlock_x,eventList,index,kernel,Flag_CPU_GPU,burden,_CPU_GPU);
+}
+void distinct_gatherFirst_int(cl_mem d_R, cl_mem d_startPos, int numGroup, cl_mem d_Rout, int numThreadPB, int numBlock,int *index,cl_event *eventList,cl_kernel *kernel,int *Flag_CPU_GPU,double * burden,int _CPU_GPU)
+{
+	size_t numThreadsPerBlock_x=numThreadPB;
+	size_t globalWorkingSetSize=numThreadPB*numBlock;
+	cl_getKernel("distinct_gatherFirst_kernel",kernel);
+	cl_int ciErr1 = clSetKernelArg((*kernel), 0, sizeof(cl_mem), (void*)&d_R);
+	ciErr1 |= clSetKernelArg((*kernel), 1, sizeof(cl_mem), (void*)&d_startPos);
+	ciErr1 |= clSetKernelArg((*kernel), 2, sizeof(cl_int), (void*)&numGroup);
+	ciErr1 |= clSetKernelArg((*kernel), 3, sizeof(cl_mem), (void*)&d_Rout);
+	if (ciErr1 != CL_SUCCESS)
+	{
+		printf("Error in clSetKernelArg, Line %u in file %s !!!\n\n", __LINE__, __FILE__);
+		cl_clean(EXIT_FAILURE);
+	}
+	kernel_enqueue(numGroup,64,
+		1, &globalWorkingSetSize, &numThreadsPerBlock_x,eventList,index,kernel,Flag_CPU_GPU,burden,_CPU_GPU);
+}
+void distinct_hashKey_int(cl_mem d_R, cl_mem d_others, int numOther, int rLen, cl_mem d_keys, int numThreadPB, int numBlock,int *index,cl_event *eventList,cl_kernel *kernel,int *Flag_CPU_GPU,double * burden,int _CPU_GPU)
+{
+	size_t numThreadsPerBlock_x=numThreadPB;
+	size_t globalWorkingSetSize=numThreadPB*numBlock;
+	cl_getKernel("distinct_hashKey_kernel",kernel);
+	cl_int ciErr1 = clSetKernelArg((*kernel), 0, sizeof(cl_mem), (void*)&d_R);
+	ciErr1 |= clSetKernelArg((*kernel), 1, sizeof(cl_mem), (void*)&d_others);
+	ciErr1 |= clSetKernelArg((*kernel), 2, sizeof(cl_int), (void*)&numOther);
+	ciErr1 |= clSetKernelArg((*kernel), 3, sizeof(cl_int), (void*)&rLen);
+	ciErr1 |= clSetKernelArg((*kernel), 4, sizeof(cl_mem), (void*)&d_keys);
+	if (ciErr1 != CL_SUCCESS)
+	{
+		printf("Error in clSetKernelArg, Line %u in file %s !!!\n\n", __LINE__, __FILE__);
+		cl_clean(EXIT_FAILURE);
+	}
+	kernel_enqueue(rLen,65,
+		1, &globalWorkingSetSize, &numThreadsPerBlock_x,eventList,index,kernel,Flag_CPU_GPU,burden,_CPU_GPU);
+}
+void distinct_firstInRun_int(cl_mem d_R, cl_mem d_others, int numOther, int rLen, cl_mem d_sorted, cl_mem d_startPos, int numRun, cl_mem d_counter, cl_mem d_Rout, int numThreadPB, int numBlock,int *index,cl_event *eventList,cl_kernel *kernel,int *Flag_CPU_GPU,double * burden,int _CPU_GPU)
+{
+	size_t numThreadsPerBlock_x=numThreadPB;
+	size_t globalWorkingSetSize=numThreadPB*numBlock;
+	cl_getKernel("distinct_firstInRun_kernel",kernel);
+	cl_int ciErr1 = clSetKernelArg((*kernel), 0, sizeof(cl_mem), (void*)&d_R);
+	ciErr1 |= clSetKernelArg((*kernel), 1, sizeof(cl_mem), (void*)&d_others);
+	ciErr1 |= clSetKernelArg((*kernel), 2, sizeof(cl_int), (void*)&numOther);
+	ciErr1 |= clSetKernelArg((*kernel), 3, sizeof(cl_int), (void*)&rLen);
+	ciErr1 |= clSetKernelArg((*kernel), 4, sizeof(cl_mem), (void*)&d_sorted);
+	ciErr1 |= clSetKernelArg((*kernel), 5, sizeof(cl_mem), (void*)&d_startPos);
+	ciErr1 |= clSetKernelArg((*kernel), 6, sizeof(cl_int), (void*)&numRun);
+	ciErr1 |= clSetKernelArg((*kernel), 7, sizeof(cl_mem), (void*)&d_counter);
+	ciErr1 |= clSetKernelArg((*kernel), 8, sizeof(cl_mem), (void*)&d_Rout);
+	if (ciErr1 != CL_SUCCESS)
+	{
+		printf("Error in clSetKernelArg, Line %u in file %s !!!\n\n", __LINE__, __FILE__);
+		cl_clean(EXIT_FAILURE);
+	}
+	kernel_enqueue(rLen,66,
+		1, &globalWorkingSetSize, &numThreadsPerBlock_x,eventList,index,kernel,Flag_CPU_GPU,burden,_CPU_GPU);
+}
+/*one pass inserts the row numbers into a hash set of twice the rows, the first row of each
+tuple is written out; no sort, whatever the number of distinct tuples. past the largest set
+a single column is grouped by sorting and the first record of each group kept; several columns
+are sorted by the hash of their tuple and the first row of each tuple in a run of equal hashes
+kept.*/
+int distinctImpl(cl_mem d_Rin, cl_mem d_others, int numOther, int rLen, cl_mem d_Rout, int numThread, int numBlock,int *index,cl_event *eventList,cl_kernel *kernel,int *Flag_CPU_GPU,double * burden,int _CPU_GPU)
+{
+	int numDistinct=0;
+	int capacity=1;
+	while(capacity<2*rLen)
+		capacity<<=1;
+	if(capacity>DISTINCT_HASH_MAX_CAPACITY)
+	{
+		cl_mem d_sorted=NULL;
+		cl_mem d_startPos=NULL;
+		CL_MALLOC(&d_sorted, sizeof(Record)*rLen);
+		if(numOther==0)
+		{
+			numDistinct=sortGroupByImpl(d_Rin,rLen,d_sorted,&d_startPos,numThread,numBlock,index,eventList,kernel,Flag_CPU_GPU,burden,_CPU_GPU);
+			distinct_gatherFirst_int(d_sorted,d_startPos,numDistinct,d_Rout,numThread,numBlock,index,eventList,kernel,Flag_CPU_GPU,burden,_CPU_GPU);
+			clWaitForEvents(1,&eventList[(*index-1)%2]); 
+		}
+		else
+		{
+			cl_mem d_keys=NULL;
+			cl_mem d_counter=NULL;
+			CL_MALLOC(&d_keys, sizeof(Record)*rLen);
+			CL_MALLOC(&d_counter, sizeof(int));
+			distinct_hashKey_int(d_Rin,d_others,numOther,rLen,d_keys,numThread,numBlock,index,eventList,kernel,Flag_CPU_GPU,burden,_CPU_GPU);
+			int numRun=sortGroupByImpl(d_keys,rLen,d_sorted,&d_startPos,numThread,numBlock,index,eventList,kernel,Flag_CPU_GPU,burden,_CPU_GPU);
+			memset_int(d_counter,1,0,1,1,index,eventList,kernel,Flag_CPU_GPU,burden,_CPU_GPU);
+			distinct_firstInRun_int(d_Rin,d_others,numOther,rLen,d_sorted,d_startPos,numRun,d_counter,d_Rout,numThread,numBlock,index,eventList,kernel,Flag_CPU_GPU,burden,_CPU_GPU);
+			clWaitForEvents(1,&eventList[(*index-1)%2]); 
+			cl_readbuffer(&numDistinct,d_counter,sizeof(int),0);
+			CL_FREE(d_keys);
+			CL_FREE(d_counter);
+		}
+		CL_FREE(d_sorted);
+		CL_FREE(d_startPos);
+		return numDistinct;
+	}
+	cl_mem d_table=NULL;
+	cl_mem d_counter=NULL;
+	CL_MALLOC(&d_table, sizeof(int)*capacity);
+	CL_MALLOC(&d_counter, sizeof(int));
+	memset_int(d_table,capacity,DISTINCT_EMPTY,numThread,numBlock,index,eventList,kernel,Flag_CPU_GPU,burden,_CPU_GPU);
+	memset_int(d_counter,1,0,1,1,index,eventList,kernel,Flag_CPU_GPU,burden,_CPU_GPU);
+	distinct_insert_int(d_Rin,d_others,numOther,rLen,d_table,capacity,d_counter,d_Rout,numThread,numBlock,index,eventList,kernel,Flag_CPU_GPU,burden,_CPU_GPU);
+	clWaitForEvents(1,&eventList[(*index-1)%2]); 
+	cl_readbuffer(&numDistinct,d_counter,sizeof(int),0);
+	CL_FREE(d_table);
+	CL_FREE(d_counter);
+	return numDistinct;
+}
 void testGroupByImpl( int rLen, int numThread, int numBlock)
 {
 	int _CPU_GPU=0;
@@ -2,5 +2,15 @@
 #include "common.h"
 #include "testSort.h"
 #include "testScan.h"
+//the hash path is taken while the groups fit its table, beyond that the sort path.
+#define HASH_GROUPBY_MAX_GROUP (1024)
+#define HASH_GROUPBY_CAPACITY (2*HASH_GROUPBY_MAX_GROUP) //slots of the global table, a power of two.
+#define HASH_GROUPBY_LOCAL_SLOTS (256) //slots of the table of a work group, a power of two.
+//DISTINCT hashes into a set of row numbers; tuples that need more slots are sorted.
+#define DISTINCT_EMPTY (-1)
+#define DISTINCT_HASH_MAX_CAPACITY (1<<26)
+//the distinct tuples of d_Rin and the numOther columns after it in d_others (rLen records
+//each, aligned by row), one record of d_Rin per tuple in d_Rout, in no order.
+int distinctImpl(cl_mem d_Rin, cl_mem d_others, int numOther, int rLen, cl_mem d_Rout, int numThread, int numBlock,int *index,cl_event *eventList,cl_kernel *kernel,int *Flag_CPU_GPU,double * burden,int _CPU_GPU);
 int groupByImpl(cl_mem d_Rin, int rLen, cl_mem d_Rout, cl_mem* d_startPos, int numThread, int numBlock,int *index,cl_event *eventList,cl_kernel *kernel,int *Flag_CPU_GPU,double * burden,int _CPU_GPU);
 void testGroupByImpl( int rLen, int numThread , int numBlock);
\ No newline at end of file
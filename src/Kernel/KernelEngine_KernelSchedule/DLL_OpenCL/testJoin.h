@@ -17,6 +17,7 @@ void joinMBCount(cl_mem d_R, int rLen, cl_mem d_S,
 void getQuantile(cl_mem d_R, int rLen, int interval, cl_mem d_output, int numQuantile,int *index,cl_event *eventList,cl_kernel *kernel,int *Flag_CPU_GPU,double * burden,int _CPU_GPU);
 
 void testSMJ(int rLen, int sLen);
+void testSMJSkew(int rLen, int sLen, int dup);
 void testMJ(int rLen, int sLen);
 
 int HJImpl(cl_mem d_R, cl_uint rLen, cl_mem d_S, cl_uint sLen, cl_mem rHashTable, cl_mem* d_Rout,int *index,cl_event *eventList,cl_kernel *kernel,int *Flag_CPU_GPU,double * burden,int _CPU_GPU);
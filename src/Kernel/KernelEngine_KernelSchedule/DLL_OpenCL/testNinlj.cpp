@@ -123,9 +123,7 @@ int NINJImpl(cl_mem d_R, int rLen, cl_mem d_S, int sLen, cl_mem* d_Rout,int *ind
 	CL_MALLOC( &d_outBuf, sizeof(Record)*outSize);
 
 	int sStart=0;
-	ScanPara *SP;
-	SP=(ScanPara*)malloc(sizeof(ScanPara));
-	initScan(resultBuf,SP);	
+	ScanPara *SP=scan_getPara(resultBuf);
 	cl_mem d_temp;
 	CL_MALLOC( &d_temp, sizeof(int)*rLen );
 	for(int sg=0;sg<numGrid;sg++)	
@@ -159,7 +157,6 @@ int NINJImpl(cl_mem d_R, int rLen, cl_mem d_S, int sLen, cl_mem* d_Rout,int *ind
 		clWaitForEvents(1,&eventList[(*index-1)%2]); 
 	}
 	clWaitForEvents(1,&eventList[(*index-1)%2]); 
-	closeScan(SP);
 	//dump the final results to Rout;
 	if(numResults!=0){
 	CL_MALLOC(d_Rout,sizeof(Record)*numResults);
@@ -1,8 +1,9 @@
 #include "common.h"
+//scratch of a reduction, released with reduce_dealloc once its events are waited on.
 struct tempResult{
-unsigned int d_numLevelsAllocated;
-cl_mem* d_scanBlockSums;//assume max 1000 level.....
-int * levelSize;
+cl_mem d_partial;//the ticket counter, then a partial per work group.
+int ticket;//the zero written to the counter.
 };
 int reduceImpl( cl_mem d_Rin, int rLen, cl_mem d_Rout, int OPERATOR, int numThread, int numMaxBlock,int *index,cl_event *eventList,cl_kernel *kernel,int *Flag_CPU_GPU,double * burden,tempResult *tR, int _CPU_GPU);
+void reduce_dealloc(tempResult *tR);
 void testReduceImpl( int rLen, int OPERATOR, int numThreadPB, int numMaxBlock);
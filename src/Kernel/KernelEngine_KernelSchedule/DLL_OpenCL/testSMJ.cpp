@@ -76,110 +76,100 @@ void joinMBCount(cl_mem d_R, int rLen, cl_mem d_S,
 }
 
 
-void joinMBWrite(cl_mem d_R, int rLen, cl_mem d_S, 
-			int sLen, cl_mem d_quanLocS, int numQuan,
-			cl_mem d_sum, cl_mem d_outBuf, dim3 grid_NLJ, dim3 threads_NLJ,int *index,cl_event *eventList,cl_kernel *kernel,int *Flag_CPU_GPU,double * burden,int _CPU_GPU)
+void mergeJoin_count(cl_mem d_R, int rLen, cl_mem d_S, int sLen,
+			cl_mem d_n, cl_mem d_sStart, cl_mem d_sLen,int *index,cl_event *eventList,cl_kernel *kernel,int *Flag_CPU_GPU,double * burden,int _CPU_GPU)
 {
-	size_t numThreadsPerBlock_x=threads_NLJ.x;
-	size_t globalWorkingSetSize=grid_NLJ.x*grid_NLJ.y*threads_NLJ.x;
-	cl_getKernel("joinMBWrite_kernel",kernel);
+	size_t numThreadsPerBlock_x=SMJ_NUM_THREADS_PER_BLOCK;
+	int numBlock=divRoundUp(rLen,SMJ_NUM_THREADS_PER_BLOCK);
+	if(numBlock>NLJ_MAX_NUM_BLOCK_PER_DIM)
+		numBlock=NLJ_MAX_NUM_BLOCK_PER_DIM;
+	size_t globalWorkingSetSize=numBlock*numThreadsPerBlock_x;
+	cl_getKernel("mergeJoin_count_kernel",kernel);
 
-    // Set the Argument values
-	//gpuNLJ_int_kernel(cl_mem d_temp, Record *d_R, Record *d_S, int sStart, int rLen, int sLen, int *d_n) 
     cl_int ciErr1 = clSetKernelArg((*kernel), 0, sizeof(cl_mem), (void*)&d_R);	
 	ciErr1 |= clSetKernelArg((*kernel), 1, sizeof(cl_int), (void*)&rLen);
 	ciErr1 |= clSetKernelArg((*kernel), 2, sizeof(cl_mem), (void*)&d_S);
 	ciErr1 |= clSetKernelArg((*kernel), 3, sizeof(cl_int), (void*)&sLen);
-	ciErr1 |= clSetKernelArg((*kernel), 4, sizeof(cl_mem), (void*)&d_quanLocS);
-	ciErr1 |= clSetKernelArg((*kernel), 5, sizeof(cl_int), (void*)&numQuan);	
-	ciErr1 |= clSetKernelArg((*kernel), 6, sizeof(cl_mem), (void*)&d_sum);	
-	ciErr1 |= clSetKernelArg((*kernel), 7, sizeof(cl_mem), (void*)&d_outBuf);	
+	ciErr1 |= clSetKernelArg((*kernel), 4, sizeof(cl_mem), (void*)&d_n);
+	ciErr1 |= clSetKernelArg((*kernel), 5, sizeof(cl_mem), (void*)&d_sStart);
+	ciErr1 |= clSetKernelArg((*kernel), 6, sizeof(cl_mem), (void*)&d_sLen);
 
     if (ciErr1 != CL_SUCCESS)
     {
         printf("Error in clSetKernelArg, Line %u in file %s !!!\n\n", __LINE__, __FILE__);
         cl_clean(EXIT_FAILURE);
     }
-		kernel_enqueue(rLen, 47
+		kernel_enqueue(rLen, 34
 		,1, &globalWorkingSetSize, &numThreadsPerBlock_x,eventList,index,kernel,Flag_CPU_GPU,burden,_CPU_GPU);
 }
 
-int joinMatchingBlocks(cl_mem d_R, int rLen, cl_mem d_S, int sLen, 
-					   cl_mem d_quanLocS, int numQuan, cl_mem * d_Rout,int *index,cl_event *eventList,cl_kernel *kernel,int *Flag_CPU_GPU,double * burden,int _CPU_GPU)
+void mergeJoin_write(cl_mem d_R, int rLen, cl_mem d_S, cl_mem d_sum, cl_mem d_sStart, cl_mem d_sLen,
+			int numResult, cl_mem d_outBuf,int *index,cl_event *eventList,cl_kernel *kernel,int *Flag_CPU_GPU,double * burden,int _CPU_GPU)
 {
-	int numResults=0;
-	int numThreadPerBlock =SMJ_NUM_THREADS_PER_BLOCK;
-	int numBlock_X=numQuan;
-	int numBlock_Y=1;
-	if(numBlock_X>NLJ_MAX_NUM_BLOCK_PER_DIM)
-	{
-		numBlock_Y=numBlock_X/NLJ_MAX_NUM_BLOCK_PER_DIM;
-		if(numBlock_X%NLJ_MAX_NUM_BLOCK_PER_DIM!=0)
-			numBlock_Y++;
-		numBlock_X=NLJ_MAX_NUM_BLOCK_PER_DIM;
-	}
-	dim3  threads_NLJ( numThreadPerBlock, 1, 1);
-	dim3  grid_NLJ( numBlock_X, numBlock_Y, 1);
-	int resultBuf=grid_NLJ.x*grid_NLJ.y*numThreadPerBlock;
+	size_t numThreadsPerBlock_x=SMJ_NUM_THREADS_PER_BLOCK;
+	int numBlock=divRoundUp(numResult,MERGEJOIN_TILE);
+	if(numBlock>NLJ_MAX_NUM_BLOCK_PER_DIM)
+		numBlock=NLJ_MAX_NUM_BLOCK_PER_DIM;
+	size_t globalWorkingSetSize=numBlock*numThreadsPerBlock_x;
+	cl_getKernel("mergeJoin_write_kernel",kernel);
+
+    cl_int ciErr1 = clSetKernelArg((*kernel), 0, sizeof(cl_mem), (void*)&d_R);	
+	ciErr1 |= clSetKernelArg((*kernel), 1, sizeof(cl_int), (void*)&rLen);
+	ciErr1 |= clSetKernelArg((*kernel), 2, sizeof(cl_mem), (void*)&d_S);
+	ciErr1 |= clSetKernelArg((*kernel), 3, sizeof(cl_mem), (void*)&d_sum);
+	ciErr1 |= clSetKernelArg((*kernel), 4, sizeof(cl_mem), (void*)&d_sStart);
+	ciErr1 |= clSetKernelArg((*kernel), 5, sizeof(cl_mem), (void*)&d_sLen);
+	ciErr1 |= clSetKernelArg((*kernel), 6, sizeof(cl_int), (void*)&numResult);
+	ciErr1 |= clSetKernelArg((*kernel), 7, sizeof(cl_mem), (void*)&d_outBuf);
+	ciErr1 |= clSetKernelArg((*kernel), 8, sizeof(cl_int)*2, NULL);
+
+    if (ciErr1 != CL_SUCCESS)
+    {
+        printf("Error in clSetKernelArg, Line %u in file %s !!!\n\n", __LINE__, __FILE__);
+        cl_clean(EXIT_FAILURE);
+    }
+		kernel_enqueue(numResult, 35
+		,1, &globalWorkingSetSize, &numThreadsPerBlock_x,eventList,index,kernel,Flag_CPU_GPU,burden,_CPU_GPU);
+}
+
+//R and S are sorted. The output is split by its size, not by the inputs: the
+//runs of equal keys are laid out by a prefix sum of their products and every
+//work group writes MERGEJOIN_TILE outputs, however skewed the keys are.
+int MJImpl( cl_mem d_Rin, int rLen, cl_mem d_Sin, int sLen, cl_mem* d_Joinout,int *index,cl_event *eventList,cl_kernel *kernel,int *Flag_CPU_GPU,double * burden, int _CPU_GPU)
+{
+	int numResult = 0;
+	*d_Joinout=NULL;
+	if(rLen<=0||sLen<=0)
+		return 0;
 	cl_mem d_n;
-	CL_MALLOC(&d_n, sizeof(int)*resultBuf );
-	//the prefix sum for d_n
-	cl_mem d_sum;//the prefix sum for d_n[1,...,n]
-	CL_MALLOC(&d_sum, sizeof(int)*resultBuf );
-	
-	
+	CL_MALLOC(&d_n, sizeof(int)*rLen );
+	cl_mem d_sum;//the prefix sum for d_n
+	CL_MALLOC(&d_sum, sizeof(int)*rLen );
+	cl_mem d_sStart;
+	CL_MALLOC(&d_sStart, sizeof(int)*rLen );
+	cl_mem d_sLen;
+	CL_MALLOC(&d_sLen, sizeof(int)*rLen );
+
+	mergeJoin_count(d_Rin, rLen, d_Sin, sLen, d_n, d_sStart, d_sLen,index,eventList,kernel,Flag_CPU_GPU,burden,_CPU_GPU);
+	ScanPara *SP=scan_getPara(rLen);
+	scanImpl(d_n, rLen, d_sum,index,eventList,kernel,Flag_CPU_GPU,burden,SP,_CPU_GPU);
+	clWaitForEvents(1,&eventList[(*index-1)%2]); 
 	int h_n =0;	
 	int h_sum =0;
-	joinMBCount(d_R, rLen, d_S, sLen, 
-				d_quanLocS, numQuan, d_n, grid_NLJ, threads_NLJ,index,eventList,kernel,Flag_CPU_GPU,burden,_CPU_GPU);
-	ScanPara *SP;
-	SP=(ScanPara*)malloc(sizeof(ScanPara));
-	initScan(resultBuf,SP);
-	scanImpl(d_n, resultBuf, d_sum,index,eventList,kernel,Flag_CPU_GPU,burden,SP,_CPU_GPU);
-	clWaitForEvents(1,&eventList[(*index-1)%2]); 
-	closeScan(SP);
-	cl_readbuffer((void*)&h_n, d_n, (resultBuf-1)*sizeof(int), sizeof(int),index,eventList,Flag_CPU_GPU,burden,_CPU_GPU);
-	cl_readbuffer((void*)&h_sum, d_sum, (resultBuf-1)*sizeof(int), sizeof(int),index,eventList,Flag_CPU_GPU,burden,_CPU_GPU);
+	cl_readbuffer((void*)&h_n, d_n, (rLen-1)*sizeof(int), sizeof(int),index,eventList,Flag_CPU_GPU,burden,_CPU_GPU);
+	cl_readbuffer((void*)&h_sum, d_sum, (rLen-1)*sizeof(int), sizeof(int),index,eventList,Flag_CPU_GPU,burden,_CPU_GPU);
 	clWaitForEvents(1,&eventList[(*index-1)%2]); 
-	numResults=h_n+h_sum;
-	cl_mem d_outBuf;
-	if(numResults>0)
+	numResult=h_n+h_sum;
+	if(numResult>0)
 	{
-		CL_MALLOC(&d_outBuf, sizeof(Record)*numResults );
-		*d_Rout=d_outBuf;
-			joinMBWrite(d_R, rLen, d_S, sLen, 
-				d_quanLocS, numQuan,d_sum, d_outBuf, grid_NLJ, threads_NLJ,index,eventList,kernel,Flag_CPU_GPU,burden,_CPU_GPU);
+		CL_MALLOC(d_Joinout, sizeof(Record)*numResult );
+		mergeJoin_write(d_Rin, rLen, d_Sin, d_sum, d_sStart, d_sLen, numResult, *d_Joinout,index,eventList,kernel,Flag_CPU_GPU,burden,_CPU_GPU);
+		clWaitForEvents(1,&eventList[(*index-1)%2]); 
 	}
-	clWaitForEvents(1,&eventList[(*index-1)%2]); 
 	CL_FREE(d_n);
 	CL_FREE(d_sum);
-	return numResults;
-}
-
-int MJImpl( cl_mem d_Rin, int rLen, cl_mem d_Sin, int sLen, cl_mem* d_Joinout,int *index,cl_event *eventList,cl_kernel *kernel,int *Flag_CPU_GPU,double * burden, int _CPU_GPU)
-{
-	int numResult = 0;
-
-	int interval=SMJ_NUM_THREADS_PER_BLOCK;
-	int numQuanR=divRoundUp(rLen,interval);
-	cl_mem d_quanKeyR;
-	CL_MALLOC(&d_quanKeyR,numQuanR*sizeof(int)*2); 
-
-	getQuantile(d_Rin, rLen, interval,d_quanKeyR,numQuanR,index,eventList,kernel,Flag_CPU_GPU,burden,_CPU_GPU);
-
-	cl_mem d_quanLocS;
-	CL_MALLOC(&d_quanLocS,numQuanR*sizeof(int)*2); 
-	CUDA_CSSTree* tree;
-	gpu_constructCSSTreeImpl(d_Rin, rLen, &tree,index,eventList,kernel,Flag_CPU_GPU,burden,_CPU_GPU);
-	cuda_search_index_usingKeys(tree->data, tree->nDataNodes, tree->dir,
-		tree->nDirNodes, d_quanKeyR, d_quanLocS, numQuanR*2,index,eventList,kernel,Flag_CPU_GPU,burden,_CPU_GPU);	
-	clWaitForEvents(1,&eventList[(*index-1)%2]); 
-	numResult=joinMatchingBlocks(d_Rin, rLen,d_Sin,sLen, 
-		d_quanLocS, numQuanR, d_Joinout,index,eventList,kernel,Flag_CPU_GPU,burden,_CPU_GPU);
-	clWaitForEvents(1,&eventList[(*index-1)%2]); 
-	CL_FREE(d_quanKeyR);
-	CL_FREE(d_quanLocS);
-	delete tree;
+	CL_FREE(d_sStart);
+	CL_FREE(d_sLen);
 	return numResult;
 }
 
@@ -187,12 +177,10 @@ int MJImpl( cl_mem d_Rin, int rLen, cl_mem d_Sin, int sLen, cl_mem* d_Joinout,in
 int SMJImpl(cl_mem d_R, int rLen, cl_mem d_S, int sLen, cl_mem* d_Joinout,int *index,cl_event *eventList,cl_kernel *kernel,int *Flag_CPU_GPU,double * burden,int _CPU_GPU)
 {
 	int numResult=0;
-	//radixSortImpl(d_R,rLen,d_Rout);
-	//int numThreadPB=ctaSize;
 	int numThreadPB=256;
 	int numBlock=64;
-	radixSortImpl(d_R,rLen,32,numThreadPB, numBlock,index,eventList,kernel,Flag_CPU_GPU,burden,_CPU_GPU);
-	radixSortImpl(d_S,sLen,32,numThreadPB, numBlock,index,eventList,kernel,Flag_CPU_GPU,burden,_CPU_GPU);
+	mergeSortImpl(d_R,rLen,numThreadPB, numBlock,index,eventList,kernel,Flag_CPU_GPU,burden,_CPU_GPU);
+	mergeSortImpl(d_S,sLen,numThreadPB, numBlock,index,eventList,kernel,Flag_CPU_GPU,burden,_CPU_GPU);
 	numResult = MJImpl( d_R, rLen, d_S, sLen, d_Joinout,index,eventList,kernel,Flag_CPU_GPU,burden,_CPU_GPU);
 
 	return numResult;
@@ -231,4 +219,24 @@ void testMJ(int rLen, int sLen)
 	Record* h_Joinout;
 	CL_mj( (Record* )h_R,rLen, (Record* )h_S, sLen, &h_Joinout,_CPU_GPU );
 	printf("MJ finished!\n");
-}
\ No newline at end of file
+}
+
+//R repeats every key dup times and S draws from rLen/dup keys, so both sides
+//have runs of equal keys; about sLen*dup results.
+void testSMJSkew(int rLen, int sLen, int dup)
+{
+	int _CPU_GPU=0;
+	int memSizeR=sizeof(Record)*rLen;
+	int memSizeS=sizeof(Record)*sLen;
+	void *h_R;
+	HOST_MALLOC(h_R, memSizeR);
+	void *h_S;
+	HOST_MALLOC(h_S, memSizeS);
+	generateSkewDuplicates((int2*)h_R, rLen, (int2*)h_S, sLen, rLen/dup, dup, 0);
+	Record* h_Joinout;
+	int numResult=CL_smj( (Record* )h_R,rLen, (Record* )h_S, sLen, &h_Joinout,_CPU_GPU);
+	printf("SMJ with %d duplicates finished, %d results!\n", dup, numResult);
+	free(h_Joinout);
+	HOST_FREE(h_R);
+	HOST_FREE(h_S);
+}
@@ -13,10 +13,77 @@ extern cl_device_id Device[2];          // OpenCL device
 extern cl_ulong totalLocalMemory[2];      /**< Max local memory allowed */
 extern cl_device_id allDevices[10];
 static cl_ulong usedLocalMemory;       /**< Used local memory by kernel */
+static pthread_key_t scanParaKey;
+static pthread_once_t scanParaOnce=PTHREAD_ONCE_INIT;
+
+static void scan_freePara(void* para)
+{
+	ScanPara* SP=(ScanPara*)para;
+	closeScan(SP);
+	free(SP);
+}
+
+static void scan_createKey()
+{
+	pthread_key_create(&scanParaKey,scan_freePara);
+}
+
+ScanPara* scan_getPara(int rLen)
+{
+	pthread_once(&scanParaOnce,scan_createKey);
+	ScanPara* SP=(ScanPara*)pthread_getspecific(scanParaKey);
+	if(SP==NULL)
+	{
+		SP=(ScanPara*)malloc(sizeof(ScanPara));
+		initScan(rLen,SP);
+		pthread_setspecific(scanParaKey,SP);
+	}
+	SP->gLength=rLen;
+	return SP;
+}
+
+/*
+the status words for numTile tiles, 1 if they have to be zeroed before the scan: a new
+buffer rather than the old one cleared, a scan may still be running on it.
+*/
+static int scan_reserveStatus(int numTile,ScanPara* SP)
+{
+	if(numTile<=SP->numTileAllocated && SP->epoch<SCAN_MAX_EPOCH)
+		return 0;
+	//grow by half again, the sizes of a thread's scans creep up.
+	int numAlloc=numTile+numTile/2;
+	if(numAlloc<SP->numTileAllocated)
+		numAlloc=SP->numTileAllocated;
+	CL_FREE(SP->d_status);
+	CL_MALLOC(&SP->d_status,sizeof(int)*(1+3*numAlloc));
+	SP->numTileAllocated=numAlloc;
+	SP->ticketBase=0;
+	SP->epoch=0;
+	return 1;
+}
+
+static void scan_initStatus(ScanPara* SP)
+{
+	SP->d_status=NULL;
+	SP->numTileAllocated=0;
+	SP->ticketBase=0;
+	SP->epoch=0;
+}
 
 void initScan(int rLen,ScanPara* SP){
+	SP->gLength=rLen;
+	SP->blockSize=SCAN_TILE_THREAD;
+	SP->pass=0;
+	SP->outputBuffer=NULL;
+	SP->blockSumBuffer=NULL;
+	SP->tempBuffer=NULL;
+	scan_initStatus(SP);
+}
+
+void initScanPasses(int rLen,ScanPara* SP){
 	SP->gLength=rLen;
 	SP->blockSize=256;
+	scan_initStatus(SP);
 	usedLocalMemory=0;
 	cl_int status;
 	float t = log((float)SP->gLength) / log((float)SP->blockSize);
@@ -249,6 +316,10 @@ void bAddition_int(cl_uint len,
 void closeScan(ScanPara* SP){
     cl_int status;
 	cl_uint refCount;
+	CL_FREE(SP->d_status);
+	SP->d_status=NULL;
+	if(SP->tempBuffer==NULL)
+		return;
 	status = clGetMemObjectInfo(SP->tempBuffer,
                 		        CL_MEM_REFERENCE_COUNT,
 							    sizeof(cl_uint),
@@ -293,36 +364,45 @@ void closeScan(ScanPara* SP){
 
 	//HOST_FREE(SP);
 }
+void scanSinglePass_int(cl_mem d_Src, int rLen, cl_mem d_Dst, ScanPara* SP, int numTile,int *index,cl_event *eventList,cl_kernel *kernel,int *Flag_CPU_GPU,double * burden,int _CPU_GPU)
+{
+	size_t numThreadsPerBlock_x=SCAN_TILE_THREAD;
+	size_t globalWorkingSetSize=SCAN_TILE_THREAD*numTile;
+	cl_getKernel("scanSinglePass_kernel",kernel);
+	cl_int ciErr1 = clSetKernelArg((*kernel), 0, sizeof(cl_mem), (void*)&d_Src);
+	ciErr1 |= clSetKernelArg((*kernel), 1, sizeof(cl_mem), (void*)&d_Dst);
+	ciErr1 |= clSetKernelArg((*kernel), 2, sizeof(cl_int), (void*)&rLen);
+	ciErr1 |= clSetKernelArg((*kernel), 3, sizeof(cl_mem), (void*)&SP->d_status);
+	ciErr1 |= clSetKernelArg((*kernel), 4, sizeof(cl_uint), (void*)&SP->ticketBase);
+	ciErr1 |= clSetKernelArg((*kernel), 5, sizeof(cl_uint), (void*)&SP->epoch);
+	ciErr1 |= clSetKernelArg((*kernel), 6, sizeof(cl_int)*SCAN_TILE_THREAD, NULL);
+	ciErr1 |= clSetKernelArg((*kernel), 7, sizeof(cl_int)*3, NULL);
+	if (ciErr1 != CL_SUCCESS)
+	{
+		printf("Error in clSetKernelArg, Line %u in file %s !!!\n\n", __LINE__, __FILE__);
+		cl_clean(EXIT_FAILURE);
+	}
+	kernel_enqueue(rLen,67,1, &globalWorkingSetSize, &numThreadsPerBlock_x,eventList,index,kernel,Flag_CPU_GPU,burden,_CPU_GPU);
+}
+/*
+one launch of scanSinglePass_kernel with the status words of SP, in place of the block sum
+passes of bScan_int, pScan_int and bAddition_int; the handshake still times those.
+*/
 void scanImpl(cl_mem d_Src, int rLen, cl_mem d_Dst,int *index,cl_event *eventList,cl_kernel *kernel,int *Flag_CPU_GPU,double * burden,ScanPara* SP,int _CPU_GPU)
 {
-	
-    /* Do block-wise sum */
-    bScan_int(SP->gLength, &d_Src, &SP->outputBuffer[0], &SP->blockSumBuffer[0],index,eventList,kernel,Flag_CPU_GPU,burden,SP,_CPU_GPU);
-
-    for(int i = 1; i < (int)SP->pass; i++)
-    {
-        bScan_int((cl_uint)(SP->gLength / pow((float)SP->blockSize, (float)i)), 
-            &SP->blockSumBuffer[i - 1],
-            &SP->outputBuffer[i],
-            &SP->blockSumBuffer[i],index,eventList,kernel,Flag_CPU_GPU,burden,SP,_CPU_GPU);
-    }
-
-    int tempLength = (int)(SP->gLength / pow((float)SP->blockSize, (float)SP->pass));
-
-    /* Do scan to SP->tempBuffer */
-    pScan_int(tempLength, &SP->blockSumBuffer[SP->pass - 1], &SP->tempBuffer,index,eventList,kernel,Flag_CPU_GPU,burden,SP,_CPU_GPU);
-
-    /* Do block-addition on SP->outputBuffers */
-    bAddition_int((cl_uint)(SP->gLength / pow((float)SP->blockSize, (float)(SP->pass - 1))),
-        &SP->tempBuffer, &SP->outputBuffer[SP->pass - 1],index,eventList,kernel,Flag_CPU_GPU,burden,SP,_CPU_GPU);
-	for(int i = SP->pass - 1; i > 0; i--)
-    {
-        bAddition_int((cl_uint)(SP->gLength / pow((float)SP->blockSize, (float)(i - 1))),
-            &SP->outputBuffer[i], &SP->outputBuffer[i - 1],index,eventList,kernel,Flag_CPU_GPU,burden,SP,_CPU_GPU);
-    }
-	cl_copyBuffer(d_Dst, SP->outputBuffer[0], rLen*sizeof(int),index,eventList,Flag_CPU_GPU,burden,_CPU_GPU);
+	if(rLen<=0)
+		return;
+	int numTile=(rLen+SCAN_TILE_SIZE-1)/SCAN_TILE_SIZE;
+	if(scan_reserveStatus(numTile,SP))
+	{
+		//zeroed on the device, ahead of the scan on eventList.
+		memset_int(SP->d_status,1+3*SP->numTileAllocated,0,SCAN_TILE_THREAD,numTile,index,eventList,kernel,Flag_CPU_GPU,burden,_CPU_GPU);
+		clReleaseKernel(*kernel);
+	}
+	SP->epoch++;
+	scanSinglePass_int(d_Src,rLen,d_Dst,SP,numTile,index,eventList,kernel,Flag_CPU_GPU,burden,_CPU_GPU);
+	SP->ticketBase+=numTile;
 }
-
 void testScanImpl(int rLen)
 {
 	int _CPU_GPU=0;
@@ -344,13 +424,10 @@ void testScanImpl(int rLen)
 	cl_mem d_Rout;
 	CL_MALLOC(&d_Rout, outSize);
 	cl_writebuffer(d_Rin, Rin, memSize,&index,eventList,&CPU_GPU,&burden,_CPU_GPU);
-	ScanPara *SP;
-	SP=(ScanPara*)malloc(sizeof(ScanPara));
-	initScan(rLen,SP);
+	ScanPara *SP=scan_getPara(rLen);
 	scanImpl(d_Rin,rLen,d_Rout,&index,eventList,&Kernel,&CPU_GPU,&burden,SP,_CPU_GPU);	
 	cl_readbuffer(Rout, d_Rout, outSize,&index,eventList,&CPU_GPU,&burden,_CPU_GPU);
 	clWaitForEvents(1,&eventList[(index-1)%2]);
-	closeScan(SP);
 	deschedule(CPU_GPU,burden);
 	//validateScan( (int*)Rin, rLen, (int*)Rout );
 	HOST_FREE(Rin);
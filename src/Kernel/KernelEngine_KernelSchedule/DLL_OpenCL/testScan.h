@@ -9,13 +9,31 @@ cl_mem              tempBuffer;             /**< Temporary bufer */
 cl_uint             pass;                   /**< Number of passes */
 cl_uint				gLength;
 cl_uint             blockSize;              /**< Size of a block */
+/*the status words of scanSinglePass_kernel, three per tile after a ticket counter, freed by
+closeScan. they grow to the largest scan made with the ScanPara; a scan continues the ticket
+count and takes a new epoch for its status words, so they are only zeroed when they grow.*/
+cl_mem              d_status;
+int                 numTileAllocated;
+cl_uint             ticketBase;
+cl_uint             epoch;
 };
 #endif
+#define SCAN_TILE_THREAD (256)
+#define SCAN_ITEMS_PER_THREAD (4)
+#define SCAN_TILE_SIZE (SCAN_TILE_THREAD*SCAN_ITEMS_PER_THREAD)
+#define SCAN_MAX_EPOCH (1<<29)
 void testScanImpl(int rLen);
+//exclusive scan of rLen ints, d_Dst is not d_Src.
 void scanImpl(cl_mem d_Src, int rLen, cl_mem d_Dst,int *index,cl_event *eventList,cl_kernel *kernel,int *Flag_CPU_GPU,double * burden,ScanPara* SP,int _CPU_GPU);
 void scanImpl(cl_mem d_Src, int offset, int rLen, cl_mem d_Dst,int *index,cl_event *eventList,cl_kernel *kernel,int *Flag_CPU_GPU,double * burden,ScanPara* SP,int _CPU_GPU);
 void closeScan(ScanPara* SP);
+//the ScanPara of the calling thread for scanImpl, made on its first scan and closed when the
+//thread exits; the caller does not close it.
+ScanPara* scan_getPara(int rLen);
+//initScan allocates nothing, scanImpl allocates the status words on its first scan.
 void initScan(int rLen,ScanPara* SP);
+//the block sum buffers of the multi-pass kernels below.
+void initScanPasses(int rLen,ScanPara* SP);
 
 
 
@@ -49,7 +49,7 @@ void radixSort_int(cl_mem d_R, int rLen, int numThreadPB, int numBlock, int sort
 	}
 }
 
-void radixSortImpl(cl_mem d_R, int rLen, int meaningless, int numThreadPB, int numBlock,int *index,cl_event *eventList,cl_kernel *kernel,int *Flag_CPU_GPU,double * burden,int _CPU_GPU)
+void bitonicSortImpl(cl_mem d_R, int rLen, int meaningless, int numThreadPB, int numBlock,int *index,cl_event *eventList,cl_kernel *kernel,int *Flag_CPU_GPU,double * burden,int _CPU_GPU)
 {
 	cl_int  sortAscending = 1; //1: ascending order, 0: descending order
 	cl_uint temp;
@@ -61,6 +61,76 @@ void radixSortImpl(cl_mem d_R, int rLen, int meaningless, int numThreadPB, int n
 	radixSort_int(d_R,rLen,numThreadPB,numBlock,sortAscending,numStages,index,eventList,kernel,Flag_CPU_GPU,burden,_CPU_GPU);
 }
 
+void mergeSort_blockSort_int(cl_mem d_R, int rLen, int numTile,int *index,cl_event *eventList,cl_kernel *kernel,int *Flag_CPU_GPU,double * burden,int _CPU_GPU)
+{
+	size_t numThreadsPerBlock_x=MERGESORT_THREAD;
+	size_t globalWorkingSetSize=MERGESORT_THREAD*numTile;
+	cl_getKernel("mergeSort_blockSort_kernel",kernel);
+	cl_int ciErr1 = clSetKernelArg((*kernel), 0, sizeof(cl_mem), (void*)&d_R);
+	ciErr1 |= clSetKernelArg((*kernel), 1, sizeof(cl_int), (void*)&rLen);
+	ciErr1 |= clSetKernelArg((*kernel), 2, sizeof(Record)*MERGESORT_TILE, NULL);
+	ciErr1 |= clSetKernelArg((*kernel), 3, sizeof(Record)*MERGESORT_TILE, NULL);
+	if (ciErr1 != CL_SUCCESS)
+	{
+		printf("Error in clSetKernelArg, Line %u in file %s !!!\n\n", __LINE__, __FILE__);
+		cl_clean(EXIT_FAILURE);
+	}
+	kernel_enqueue(rLen,32,
+		1, &globalWorkingSetSize, &numThreadsPerBlock_x,eventList,index,kernel,Flag_CPU_GPU,burden,_CPU_GPU);
+}
+//kernel is a mergeSort_merge_kernel already, a level only sets its arguments.
+void mergeSort_merge_int(cl_mem d_src, cl_mem d_dst, int rLen, int width, int numChunk,int *index,cl_event *eventList,cl_kernel *kernel,int *Flag_CPU_GPU,double * burden,int _CPU_GPU)
+{
+	size_t numThreadsPerBlock_x=MERGESORT_THREAD;
+	size_t globalWorkingSetSize=MERGESORT_THREAD*numChunk;
+	cl_int ciErr1 = clSetKernelArg((*kernel), 0, sizeof(cl_mem), (void*)&d_src);
+	ciErr1 |= clSetKernelArg((*kernel), 1, sizeof(cl_mem), (void*)&d_dst);
+	ciErr1 |= clSetKernelArg((*kernel), 2, sizeof(cl_int), (void*)&rLen);
+	ciErr1 |= clSetKernelArg((*kernel), 3, sizeof(cl_int), (void*)&width);
+	ciErr1 |= clSetKernelArg((*kernel), 4, sizeof(Record)*MERGESORT_TILE*2, NULL);
+	ciErr1 |= clSetKernelArg((*kernel), 5, sizeof(cl_int)*2, NULL);
+	if (ciErr1 != CL_SUCCESS)
+	{
+		printf("Error in clSetKernelArg, Line %u in file %s !!!\n\n", __LINE__, __FILE__);
+		cl_clean(EXIT_FAILURE);
+	}
+	kernel_enqueue(rLen,33,
+		1, &globalWorkingSetSize, &numThreadsPerBlock_x,eventList,index,kernel,Flag_CPU_GPU,burden,_CPU_GPU);
+}
+/*
+block sorts of MERGESORT_TILE records, then log2(rLen/MERGESORT_TILE) merge levels between d_R
+and a temporary; the launches are chained on eventList and nothing is waited on. The work of
+a level is rLen whatever rLen is, there is no padding to a power of two. The numThreadPB and
+numBlock of the caller are not used, the tile fixes both.
+*/
+void mergeSortImpl(cl_mem d_R, int rLen, int numThreadPB, int numBlock,int *index,cl_event *eventList,cl_kernel *kernel,int *Flag_CPU_GPU,double * burden,int _CPU_GPU)
+{
+	if(rLen<=1)
+		return;
+	int numTile=(rLen+MERGESORT_TILE-1)/MERGESORT_TILE;
+	mergeSort_blockSort_int(d_R,rLen,numTile,index,eventList,kernel,Flag_CPU_GPU,burden,_CPU_GPU);
+	if(numTile==1)
+		return;
+	cl_mem d_temp;
+	CL_MALLOC(&d_temp,sizeof(Record)*rLen);
+	cl_mem d_src=d_R;
+	cl_mem d_dst=d_temp;
+	//one merge kernel for all the levels; the block sort one is released once enqueued.
+	clReleaseKernel(*kernel);
+	cl_getKernel("mergeSort_merge_kernel",kernel);
+	for(int width=MERGESORT_TILE;width<rLen;width<<=1)
+	{
+		mergeSort_merge_int(d_src,d_dst,rLen,width,numTile,index,eventList,kernel,Flag_CPU_GPU,burden,_CPU_GPU);
+		cl_mem t=d_src;
+		d_src=d_dst;
+		d_dst=t;
+	}
+	if(d_src!=d_R)
+		cl_copyBuffer(d_R,d_src,sizeof(Record)*rLen,index,eventList,Flag_CPU_GPU,burden,_CPU_GPU);
+	//released once the queued merges are done.
+	CL_FREE(d_temp);
+}
+
 
 void testSortImpl(int rLen, int numThreadPB, int numBlock)
 {
@@ -81,3 +151,89 @@ void testSortImpl(int rLen, int numThreadPB, int numBlock)
 }
 
 
+void topK_histogram_int(cl_mem d_R, int rLen, int largest, cl_ulong prefix, cl_ulong prefixMask, int shift, cl_mem d_hist, int numThreadPB, int numBlock,int *index,cl_event *eventList,cl_kernel *kernel,int *Flag_CPU_GPU,double * burden,int _CPU_GPU)
+{
+	size_t numThreadsPerBlock_x=numThreadPB;
+	size_t globalWorkingSetSize=numThreadPB*numBlock;
+	cl_getKernel("topK_histogram_kernel",kernel);
+	cl_int ciErr1 = clSetKernelArg((*kernel), 0, sizeof(cl_mem), (void*)&d_R);
+	ciErr1 |= clSetKernelArg((*kernel), 1, sizeof(cl_int), (void*)&rLen);
+	ciErr1 |= clSetKernelArg((*kernel), 2, sizeof(cl_int), (void*)&largest);
+	ciErr1 |= clSetKernelArg((*kernel), 3, sizeof(cl_ulong), (void*)&prefix);
+	ciErr1 |= clSetKernelArg((*kernel), 4, sizeof(cl_ulong), (void*)&prefixMask);
+	ciErr1 |= clSetKernelArg((*kernel), 5, sizeof(cl_int), (void*)&shift);
+	ciErr1 |= clSetKernelArg((*kernel), 6, sizeof(cl_mem), (void*)&d_hist);
+	ciErr1 |= clSetKernelArg((*kernel), 7, sizeof(cl_int)*256, NULL);
+	if (ciErr1 != CL_SUCCESS)
+	{
+		printf("Error in clSetKernelArg, Line %u in file %s !!!\n\n", __LINE__, __FILE__);
+		cl_clean(EXIT_FAILURE);
+	}
+	kernel_enqueue(rLen,61,
+		1, &globalWorkingSetSize, &numThreadsPerBlock_x,eventList,index,kernel,Flag_CPU_GPU,burden,_CPU_GPU);
+}
+void topK_write_int(cl_mem d_R, int rLen, int largest, cl_ulong threshold, int k, cl_mem d_counter, cl_mem d_Rout, int numThreadPB, int numBlock,int *index,cl_event *eventList,cl_kernel *kernel,int *Flag_CPU_GPU,double * burden,int _CPU_GPU)
+{
+	size_t numThreadsPerBlock_x=numThreadPB;
+	size_t globalWorkingSetSize=numThreadPB*numBlock;
+	cl_getKernel("topK_write_kernel",kernel);
+	cl_int ciErr1 = clSetKernelArg((*kernel), 0, sizeof(cl_mem), (void*)&d_R);
+	ciErr1 |= clSetKernelArg((*kernel), 1, sizeof(cl_int), (void*)&rLen);
+	ciErr1 |= clSetKernelArg((*kernel), 2, sizeof(cl_int), (void*)&largest);
+	ciErr1 |= clSetKernelArg((*kernel), 3, sizeof(cl_ulong), (void*)&threshold);
+	ciErr1 |= clSetKernelArg((*kernel), 4, sizeof(cl_int), (void*)&k);
+	ciErr1 |= clSetKernelArg((*kernel), 5, sizeof(cl_mem), (void*)&d_counter);
+	ciErr1 |= clSetKernelArg((*kernel), 6, sizeof(cl_mem), (void*)&d_Rout);
+	if (ciErr1 != CL_SUCCESS)
+	{
+		printf("Error in clSetKernelArg, Line %u in file %s !!!\n\n", __LINE__, __FILE__);
+		cl_clean(EXIT_FAILURE);
+	}
+	kernel_enqueue(rLen,62,
+		1, &globalWorkingSetSize, &numThreadsPerBlock_x,eventList,index,kernel,Flag_CPU_GPU,burden,_CPU_GPU);
+}
+/*
+top k by radix select: histogram passes over the records narrow the key of the k-th record
+down 8 bits at a time, a last pass writes the records up to it to d_Rout. the key is the value
+and then the rid, so ties go by rid as on the CPU. the passes stop once every record of a digit
+is taken, so the rid is only looked at when the value of the k-th record has more ties than
+fit. the cost is linear in rLen whatever k is; the k records come out unordered.
+*/
+void topKImpl(cl_mem d_R, int rLen, int k, int largest, cl_mem d_Rout, int numThreadPB, int numBlock,int *index,cl_event *eventList,cl_kernel *kernel,int *Flag_CPU_GPU,double * burden,int _CPU_GPU)
+{
+	cl_mem d_hist=NULL;
+	cl_mem d_counter=NULL;
+	int h_hist[256];
+	cl_ulong prefix=0;
+	cl_ulong prefixMask=0;
+	int remaining=k;//the records to take among those matching prefix.
+	CL_MALLOC(&d_hist, sizeof(int)*256);
+	for(int shift=56;shift>=0;shift-=8)
+	{
+		memset_int(d_hist,256,0,256,1,index,eventList,kernel,Flag_CPU_GPU,burden,_CPU_GPU);
+		topK_histogram_int(d_R,rLen,largest,prefix,prefixMask,shift,d_hist,numThreadPB,numBlock,index,eventList,kernel,Flag_CPU_GPU,burden,_CPU_GPU);
+		clWaitForEvents(1,&eventList[(*index-1)%2]);
+		cl_readbuffer(h_hist,d_hist,sizeof(int)*256,0);
+		int digit=0;
+		while(h_hist[digit]<remaining)
+		{
+			remaining-=h_hist[digit];
+			digit++;
+		}
+		prefix|=((cl_ulong)digit)<<shift;
+		prefixMask|=((cl_ulong)255)<<shift;
+		if(h_hist[digit]==remaining)
+		{
+			//every record of the digit is taken, whatever its lower bits.
+			prefix|=~prefixMask;
+			break;
+		}
+	}
+	//prefix is now the key of the k-th record, the records up to it are taken.
+	CL_MALLOC(&d_counter, sizeof(int));
+	memset_int(d_counter,1,0,1,1,index,eventList,kernel,Flag_CPU_GPU,burden,_CPU_GPU);
+	topK_write_int(d_R,rLen,largest,prefix,k,d_counter,d_Rout,numThreadPB,numBlock,index,eventList,kernel,Flag_CPU_GPU,burden,_CPU_GPU);
+	clWaitForEvents(1,&eventList[(*index-1)%2]);
+	CL_FREE(d_hist);
+	CL_FREE(d_counter);
+}
@@ -1,3 +1,10 @@
 #include "common.h"
-void radixSortImpl(cl_mem d_R, int rLen, int keybits, int numThreadPB, int numBlock,int *index,cl_event *eventList,cl_kernel *Kernel,int *Flag_CPU_GPU,double * burden,int _CPU_GPU);
-void testSortImpl(int rLen, int numThreadPB, int numBlock);
\ No newline at end of file
+#define MERGESORT_TILE (512)//records of the block sort and of a merge chunk, as in primitive.cl.
+#define MERGESORT_THREAD (256)
+//bitonic sort, rLen a power of two; not stable.
+void bitonicSortImpl(cl_mem d_R, int rLen, int keybits, int numThreadPB, int numBlock,int *index,cl_event *eventList,cl_kernel *Kernel,int *Flag_CPU_GPU,double * burden,int _CPU_GPU);
+//stable sort of d_R by key, any rLen.
+void mergeSortImpl(cl_mem d_R, int rLen, int numThreadPB, int numBlock,int *index,cl_event *eventList,cl_kernel *kernel,int *Flag_CPU_GPU,double * burden,int _CPU_GPU);
+void testSortImpl(int rLen, int numThreadPB, int numBlock);
+//the k smallest records of d_R, or the k largest, to d_Rout in no order. 0<k<=rLen.
+void topKImpl(cl_mem d_R, int rLen, int k, int largest, cl_mem d_Rout, int numThreadPB, int numBlock,int *index,cl_event *eventList,cl_kernel *kernel,int *Flag_CPU_GPU,double * burden,int _CPU_GPU);
\ No newline at end of file
@@ -194,12 +194,9 @@ void splitImpl(cl_mem d_R, int rLen, int numPart, cl_mem d_S, cl_mem d_bound,
 	//prefix sum
 	cl_mem d_psSum;
 	CL_MALLOC(&d_psSum, sizeof(int)*numInPS);
-	ScanPara *SP;
-	SP=(ScanPara*)malloc(sizeof(ScanPara));
-	initScan(numInPS,SP);
+	ScanPara *SP=scan_getPara(numInPS);
 	scanImpl(d_Hist, numInPS, d_psSum,index,eventList,kernel,Flag_CPU_GPU,burden,SP,_CPU_GPU);
 	clWaitForEvents(1,&eventList[(*index-1)%2]); 
-	closeScan(SP);
 	CL_FREE(d_Hist);
 	
 	cl_mem d_loc;
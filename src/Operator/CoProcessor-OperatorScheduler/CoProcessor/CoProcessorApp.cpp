@@ -35,17 +35,23 @@ void usage(int argc, char **argv) {
                   "matrix n (positive integer)\n");
   fprintf(stderr, "\t<total number of threads>			- number of "
                   "thread per block(1 - 32)\n");
+  fprintf(stderr, "\t[residency aware]			- 1 to charge and "
+                  "prefetch buffer migration, 0 to ignore it (default 1)\n");
   //	exit(1);
   fprintf(stdout, "Use default value: %s <30> <4>\n", argv[0]);
 }
 int main(int argc, char **argv) {
-  if (argc != 3) {
+  int residencyAware = 1;
+  if (argc != 3 && argc != 4) {
     usage(argc, argv);
   } else {
     numQueries = atoi(argv[1]);
     numThread = atoi(argv[2]);
+    if (argc == 4)
+      residencyAware = atoi(argv[3]);
   }
   EngineStart(0, 0);
+  CL_SetResidencyAware(residencyAware);
   printf("Now start handshaking, please wait!\n");
   HandShake();
   printf("handshaking finished!\n\n\n");
@@ -127,14 +127,18 @@ void testQueryProcessor(QUERY_TYPE fromType, QUERY_TYPE toType, int numQuery,
     pool->assignTask(i, tp_naiveQP);
   }
   int timer = genTimer(0);
+  // the count is shared by all query threads, so only the batch total is exact.
+  CL_resetMigratedBytes();
   getTimer(timer);
   pool->run();
   double t = getTimer(timer);
+  double migratedBytes = (double)CL_getMigratedBytes();
   char outputFilename[50];
   sprintf(outputFilename, "./Output/O_level_Time.tony");
   OP_ofp = fopen(outputFilename, "a");
   if (OP_ofp != NULL) {
     fprintf(OP_ofp, "<%d> <%d>\n", numQuery, numThread);
+    fprintf(OP_ofp, "migrated bytes per query: %lf\n", migratedBytes / numQuery);
     fprintf(OP_ofp, "%lf\n\n", t);
     fclose(OP_ofp);
   } else {
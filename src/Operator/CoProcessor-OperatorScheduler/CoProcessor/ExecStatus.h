@@ -81,6 +81,7 @@ struct ExecStatus
 			//int i=0;
 			//for(i=0;i<resultLen;i++)
 			//	(*Rout)[i].rid=RID_baseTable[id][i];
+			CL_Prefetch(RID_baseTable[id],eM);
 			CL_setRIDList(RID_baseTable[id],resultLen,*Rout,256,64,eM);
 			//OP_bufferchecking(*Rout,1);
 			cl_mem baseTable=NULL;
@@ -117,6 +118,7 @@ struct ExecStatus
 			RID_baseTable[id][i]=Rout[i].rid;*/			
 			RIDLen[id]=resultLen;
 		}	
+		CL_Prefetch(RID_baseTable[id],eM);
 		*RIDList=RID_baseTable[id];
 		return RIDLen[id];
 	}
@@ -140,6 +142,8 @@ struct ExecStatus
 		{
 			CL_getRIDList(dt,OP_rLen,&(RID_baseTable[ID1]),256,64,eM);
 			CL_getValueList(dt,OP_rLen,&(RID_baseTable[ID2]),256,64,eM);
+			CL_TagResidence(RID_baseTable[ID1],sizeof(int)*OP_rLen,eM);
+			CL_TagResidence(RID_baseTable[ID2],sizeof(int)*OP_rLen,eM);
 		}
 /*		if(RID_baseTable[ID1]!=NULL)
 			delete RID_baseTable[ID1];
@@ -185,6 +189,7 @@ struct ExecStatus
 				DATA_TO_GPU(rLen*sizeof(Record));
 			}*/
 			CL_getRIDList(tempDT,OP_rLen,&(RID_baseTable[id]),256,64,eM);
+			CL_TagResidence(RID_baseTable[id],sizeof(int)*OP_rLen,eM);
 		}
 /*		if(RID_baseTable[id]!=NULL)
 		{
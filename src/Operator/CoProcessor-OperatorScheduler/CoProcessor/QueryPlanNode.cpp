@@ -164,7 +164,23 @@ EXEC_MODE QueryPlanNode::createOp()
 	{
 		tOp=new GroupByThreadOp(optType);		
 	}
-	return OPScheduler(optType);
+	//the intermediate results this operator will read.
+	cl_mem inputs[2]={NULL,NULL};
+	int numInput=0;
+	if(optType>=AGG_SUM_AFTER_GROUP_BY && optType<=AGG_MIN_AFTER_GROUP_BY)
+		inputs[numInput++]=planStatus->groupByRelation;
+	else if(optType!=TYPE_UNKNOWN)
+	{
+		inputs[numInput++]=planStatus->RID_baseTable[planStatus->getTableID(table1,columns[0])];
+		if(optType>=JOIN_NINLJ && optType<=JOIN_HJ)
+			inputs[numInput++]=planStatus->RID_baseTable[planStatus->getTableID(table2,columns[1])];
+	}
+	EXEC_MODE eM=OPScheduler(optType,inputs,numInput);
+	//start moving the inputs now, the migration overlaps the setup of the operator.
+	for(int i=0;i<numInput;i++)
+		if(inputs[i]!=NULL)
+			CL_Prefetch(inputs[i],eM);
+	return eM;
 }
 void QueryPlanNode::initOp(EXEC_MODE eM)
 {
@@ -289,6 +305,7 @@ void QueryPlanNode::PostExecution(EXEC_MODE eM)
 		planStatus->groupByNumGroup=((GroupByThreadOp*)tOp)->numGroup;
 		planStatus->groupByRelation=((GroupByThreadOp*)tOp)->Rout;
 		planStatus->groupByRlen=((GroupByThreadOp*)tOp)->OP_rLen;
+		CL_TagResidence(planStatus->groupByRelation,sizeof(Record)*planStatus->groupByRlen,eM);
 	}
 }
 ThreadOp* QueryPlanNode::getNextOp()
@@ -13,6 +13,7 @@
 #include "GroupByThreadOp.h"
 #include <iostream>
 #include "CoProcessorTest.h"
+#include "Scheduler.h"
 /////////////////////////////////////////////////////////////
 extern double OP_LothresholdForGPUApp;
 extern double OP_LothresholdForCPUApp;
@@ -43,11 +44,24 @@ void inline CPUBurdenINC(const double burden){
 }
 
 EXEC_MODE OPScheduler(OP_MODE _optType)
+{
+	return OPScheduler(_optType,NULL,0);
+}
+//inputs are the intermediate results the operator reads, they are charged the 
+//migration cost if they were last written by the other device.
+EXEC_MODE OPScheduler(OP_MODE _optType, cl_mem* inputs, int numInput)
 {
 /*OPERATOR SCHEDULER*/
 	EXEC_MODE eM;
 #ifdef Greedy
-	if((OP_CPUBurden+AddCPUBurden_OP[_optType])<(OP_GPUBurden+AddGPUBurden_OP[_optType]))
+	double toCPU=0,toGPU=0;
+	for(int i=0;i<numInput;i++)
+	{
+		if(inputs[i]==NULL) continue;
+		toCPU+=CL_MigrationBurden(inputs[i],EXEC_CPU);
+		toGPU+=CL_MigrationBurden(inputs[i],EXEC_GPU);
+	}
+	if((OP_CPUBurden+AddCPUBurden_OP[_optType]+toCPU)<(OP_GPUBurden+AddGPUBurden_OP[_optType]+toGPU))
 	{
 		eM=EXEC_CPU;
 		CPUBurdenINC(AddCPUBurden_OP[_optType]);
@@ -27,4 +27,5 @@ extern double OP_CPUBurden;
 extern double OP_GPUBurden;
 extern pthread_mutex_t OP_CPUBurdenCS;
 extern pthread_mutex_t OP_GPUBurdenCS;
-EXEC_MODE OPScheduler(OP_MODE _optType);
\ No newline at end of file
+EXEC_MODE OPScheduler(OP_MODE _optType);
+EXEC_MODE OPScheduler(OP_MODE _optType, cl_mem* inputs, int numInput);
\ No newline at end of file
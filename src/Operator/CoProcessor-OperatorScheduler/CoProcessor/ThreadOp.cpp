@@ -13,7 +13,7 @@ ThreadOp::ThreadOp()
 
 ThreadOp::~ThreadOp()
 {
-	clReleaseMemObject(this->R);
+	CL_DESTORY(&(this->R));
 }
 
 
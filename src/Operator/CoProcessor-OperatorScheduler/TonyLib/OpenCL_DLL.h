@@ -122,6 +122,14 @@ extern "C" int DLL_EXPORT  CL_hj( Record* h_R, int rLen, Record* h_S, int sLen,
 extern "C" int DLL_EXPORT CL_inlj( Record* h_Rin, int rLen, CUDA_CSSTree** h_tree, Record* h_Sin, int sLen, Record** h_Rout, int _CPU_GPU );
 
 extern "C"  int DLL_EXPORT  CL_mj( void * h_Rin, int rLen, Record* h_Sin, int sLen, Record** h_Joinout, int _CPU_GPU );
+//data residency
+extern "C" DLL_EXPORT void CL_TagResidence(cl_mem mem, int size, int _CPU_GPU);
+extern "C" DLL_EXPORT int CL_GetResidence(cl_mem mem);
+extern "C" DLL_EXPORT void CL_Prefetch(cl_mem mem, int _CPU_GPU);
+extern "C" DLL_EXPORT double CL_MigrationBurden(cl_mem mem, int _CPU_GPU);
+extern "C" DLL_EXPORT void CL_SetResidencyAware(int _ResidencyAware);
+extern "C" DLL_EXPORT double CL_getMigratedBytes();
+extern "C" DLL_EXPORT void CL_resetMigratedBytes();
 extern "C" DLL_EXPORT void EngineStart(bool handShake,int _KernelSchedule);
 extern "C" DLL_EXPORT  void EngineStop();
 extern "C" DLL_EXPORT void restore();
@@ -128,6 +128,14 @@ extern "C" int DLL_EXPORT CL_hj( Record* h_R, int rLen, Record* h_S, int sLen, R
 extern "C" int DLL_EXPORT CL_inlj( Record* h_Rin, int rLen, CUDA_CSSTree** h_tree, Record* h_Sin, int sLen, Record** h_Rout, int _CPU_GPU );
 
 extern "C" int DLL_EXPORT CL_mj( void * h_Rin, int rLen, Record* h_Sin, int sLen, Record** h_Joinout, int _CPU_GPU );
+//data residency
+extern "C" void DLL_EXPORT CL_TagResidence(cl_mem mem, int size, int _CPU_GPU);
+extern "C" int DLL_EXPORT CL_GetResidence(cl_mem mem);
+extern "C" void DLL_EXPORT CL_Prefetch(cl_mem mem, int _CPU_GPU);
+extern "C" double DLL_EXPORT CL_MigrationBurden(cl_mem mem, int _CPU_GPU);
+extern "C" void DLL_EXPORT CL_SetResidencyAware(int _ResidencyAware);
+extern "C" double DLL_EXPORT CL_getMigratedBytes();
+extern "C" void DLL_EXPORT CL_resetMigratedBytes();
 extern "C" void DLL_EXPORT EngineStart(bool handShake,int _KernelSchedule);
 extern "C" void DLL_EXPORT EngineStop();
 extern "C" void DLL_EXPORT restore();
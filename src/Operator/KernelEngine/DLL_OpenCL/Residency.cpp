@@ -0,0 +1,210 @@
+#include "Residency.h"
+#include "OpenCL_DLL.h"
+#include "scheduler.h"
+
+extern cl_command_queue CommandQueue[2]; // OpenCL command que
+extern int global_ResidencyAware;
+
+#ifdef _WIN32
+#define THREAD_LOCAL __declspec(thread)
+#else
+#define THREAD_LOCAL __thread
+#endif
+
+struct residence_entry {
+	cl_mem mem;
+	size_t size;
+	int CPU_GPU;
+};
+
+/*open addressing; mem NULL with size 0 is empty, with size!=0 a tombstone*/
+static residence_entry *residenceTable = NULL;
+static int residenceCapacity = 0;
+static int residenceLive = 0;
+static int residenceUsed = 0; // live entries and tombstones
+static bool residenceOverflow = false;
+static pthread_mutex_t residenceCS = PTHREAD_MUTEX_INITIALIZER;
+/*bytes migrated by every query thread, branch threads included*/
+static volatile size_t migratedBytes = 0;
+
+static inline int residence_hash(cl_mem mem, int capacity)
+{
+	size_t key = (size_t)mem;
+	key ^= key >> 17;
+	key *= 0x9E3779B1;
+	return (int)((key >> 7) & (capacity - 1));
+}
+/*rehash into a table twice as large if a quarter is live, dropping the
+ * tombstones; caller holds residenceCS*/
+static bool residence_rehash()
+{
+	int capacity = (residenceCapacity == 0) ? RESIDENCE_TABLE_SIZE : (residenceLive * 4 > residenceCapacity) ? residenceCapacity * 2 : residenceCapacity;
+	residence_entry *table = (residence_entry *)calloc(capacity, sizeof(residence_entry));
+	if (table == NULL)
+	{
+		if (!residenceOverflow)
+			printf("residence table of %d entries is full, new buffers are not " "tagged\n", residenceCapacity);
+		residenceOverflow = true;
+		return false;
+	}
+	int i;
+	for (i = 0; i < residenceCapacity; i++)
+	{
+		residence_entry *e = &residenceTable[i];
+		if (e->mem == NULL)
+			continue;
+		int h = residence_hash(e->mem, capacity);
+		while (table[h].mem != NULL)
+			h = (h + 1) & (capacity - 1);
+		table[h] = *e;
+	}
+	free(residenceTable);
+	residenceTable = table;
+	residenceCapacity = capacity;
+	residenceUsed = residenceLive;
+	return true;
+}
+/*linear probing; caller holds residenceCS*/
+static residence_entry *residence_find(cl_mem mem, bool create)
+{
+	if (create && (residenceUsed + 1) * 2 > residenceCapacity && !residence_rehash() && residenceUsed >= residenceCapacity)
+		return NULL;
+	if (residenceCapacity == 0)
+		return NULL;
+	int h = residence_hash(mem, residenceCapacity);
+	int i;
+	residence_entry *tombstone = NULL;
+	residence_entry *empty = NULL;
+	for (i = 0; i < residenceCapacity; i++)
+	{
+		residence_entry *e = &residenceTable[(h + i) & (residenceCapacity - 1)];
+		if (e->mem == mem)
+			return e;
+		if (e->mem == NULL)
+		{
+			if (e->size == 0) // never used, the key cannot be further.
+			{
+				empty = e;
+				break;
+			}
+			if (tombstone == NULL)
+				tombstone = e;
+		}
+	}
+	if (!create)
+		return NULL;
+	residence_entry *e = (tombstone != NULL) ? tombstone : empty;
+	if (e == NULL)
+		return NULL;
+	if (e == empty)
+		residenceUsed++;
+	residenceLive++;
+	e->mem = mem;
+	e->size = 0;
+	e->CPU_GPU = RESIDENCE_UNKNOWN;
+	return e;
+}
+
+void residence_tag(cl_mem mem, size_t size, int CPU_GPU)
+{
+	if (mem == NULL)
+		return;
+	pthread_mutex_lock(&residenceCS);
+	residence_entry *e = residence_find(mem, true);
+	if (e != NULL)
+	{
+		if (size > e->size)
+			e->size = size;
+		e->CPU_GPU = CPU_GPU;
+	}
+	pthread_mutex_unlock(&residenceCS);
+}
+int residence_get(cl_mem mem)
+{
+	int CPU_GPU = RESIDENCE_UNKNOWN;
+	pthread_mutex_lock(&residenceCS);
+	residence_entry *e = residence_find(mem, false);
+	if (e != NULL)
+		CPU_GPU = e->CPU_GPU;
+	pthread_mutex_unlock(&residenceCS);
+	return CPU_GPU;
+}
+size_t residence_size(cl_mem mem)
+{
+	size_t size = 0;
+	pthread_mutex_lock(&residenceCS);
+	residence_entry *e = residence_find(mem, false);
+	if (e != NULL)
+		size = e->size;
+	pthread_mutex_unlock(&residenceCS);
+	if (size == 0 && mem != NULL)
+		clGetMemObjectInfo(mem, CL_MEM_SIZE, sizeof(size_t), &size, NULL);
+	return size;
+}
+void residence_forget(cl_mem mem)
+{
+	if (mem == NULL)
+		return;
+	pthread_mutex_lock(&residenceCS);
+	residence_entry *e = residence_find(mem, false);
+	if (e != NULL)
+	{
+		e->mem = NULL; // keep size!=0 as tombstone for probing
+		e->size = 1;
+		e->CPU_GPU = RESIDENCE_UNKNOWN;
+		residenceLive--;
+	}
+	pthread_mutex_unlock(&residenceCS);
+}
+size_t residence_prefetch(cl_mem mem, int CPU_GPU)
+{
+	int from = residence_get(mem);
+	if (from == RESIDENCE_UNKNOWN || from == CPU_GPU)
+		return 0;
+	size_t size = residence_size(mem);
+	if (global_ResidencyAware)
+	{
+		cl_int ciErr1 = clEnqueueMigrateMemObjects(CommandQueue[CPU_GPU], 1, &mem, 0, 0, NULL, NULL);
+		if (ciErr1 != CL_SUCCESS)
+		{
+			printf("Error %d in clEnqueueMigrateMemObjects, Line %u in file %s !!!\n\n", ciErr1, __LINE__, __FILE__);
+			cl_clean(EXIT_FAILURE);
+		}
+		clFlush(CommandQueue[CPU_GPU]);
+	}
+	residence_tag(mem, size, CPU_GPU);
+	residence_count(size);
+	return size;
+}
+
+void residence_count(size_t bytes)
+{
+	__sync_fetch_and_add(&migratedBytes, bytes);
+}
+size_t residence_migratedBytes() { return migratedBytes; }
+void residence_resetMigratedBytes() { migratedBytes = 0; }
+
+/////////////////////////////////////////////////////////////////////////////////
+// exported
+/////////////////////////////////////////////////////////////////////////////////
+void CL_TagResidence(cl_mem mem, int size, int _CPU_GPU)
+{
+	residence_tag(mem, size, _CPU_GPU);
+}
+int CL_GetResidence(cl_mem mem) { return residence_get(mem); }
+void CL_Prefetch(cl_mem mem, int _CPU_GPU) { residence_prefetch(mem, _CPU_GPU); }
+double CL_MigrationBurden(cl_mem mem, int _CPU_GPU)
+{
+	if (!global_ResidencyAware)
+		return 0;
+	int from = residence_get(mem);
+	if (from == RESIDENCE_UNKNOWN || from == _CPU_GPU)
+		return 0;
+	return getMigrationBurden(from, _CPU_GPU, (double)residence_size(mem));
+}
+void CL_SetResidencyAware(int _ResidencyAware)
+{
+	global_ResidencyAware = _ResidencyAware;
+}
+double CL_getMigratedBytes() { return (double)residence_migratedBytes(); }
+void CL_resetMigratedBytes() { residence_resetMigratedBytes(); }
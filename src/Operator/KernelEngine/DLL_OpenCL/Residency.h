@@ -0,0 +1,23 @@
+#ifndef _RESIDENCY_H_
+#define _RESIDENCY_H_
+#include "common.h"
+/*
+ * Data residency of buffers on the shared context.
+ * Every buffer is tagged with the device (0 for CPU, 1 for GPU) that wrote it last,
+ * so that placement can charge the migration cost and prefetch ahead of time.
+ * The table starts at RESIDENCE_TABLE_SIZE entries and doubles when half full.
+ */
+#define RESIDENCE_UNKNOWN (-1)
+#define RESIDENCE_TABLE_SIZE 4096
+
+void residence_tag(cl_mem mem, size_t size, int CPU_GPU);
+int residence_get(cl_mem mem);
+size_t residence_size(cl_mem mem);
+void residence_forget(cl_mem mem);
+/*move mem to CPU_GPU with clEnqueueMigrateMemObjects, return the bytes migrated*/
+size_t residence_prefetch(cl_mem mem, int CPU_GPU);
+/*bytes migrated by all threads*/
+void residence_count(size_t bytes);
+size_t residence_migratedBytes();
+void residence_resetMigratedBytes();
+#endif
@@ -1,6 +1,7 @@
 #include "common.h"
 #include "KernelScheduler.h"
 #include "OpenCL_DLL.h"
+#include "Residency.h"
 #include "scheduler.h"
 
 // OpenCL Vars---------0 for CPU, 1 for GPU
@@ -260,8 +261,10 @@ void cl_getKernelByKernelFunction(char *kernelName, cl_kernel *Kernel) {
 }
 void CL_CREATE(cl_mem *mem, cl_int size) { CL_MALLOC(mem, size); }
 void CL_DESTORY(cl_mem *mem) {
-  if (mem)
+  if (mem) {
+    residence_forget(*mem);
     clReleaseMemObject(*mem);
+  }
 }
 cl_int cl_malloc(cl_mem *mem, cl_mem_flags flag, cl_int size) {
   cl_int ciErr1;
@@ -327,6 +330,7 @@ void cl_writebuffer(cl_mem to, void *from, size_t size, int *index,
     ciErr1 = clEnqueueWriteBuffer(CommandQueue[CPU_GPU], to, CL_FALSE, 0, size,
                                   from, 0, NULL, &eventList[*index]);
   (*index)++;
+  residence_tag(to, size, CPU_GPU);
 
   if (ciErr1 != CL_SUCCESS) {
     printf("ciErr1 is %d, Error in clEnqueueWriteBuffer, Line %u in file %s "
@@ -355,6 +359,7 @@ void cl_copyBuffer(cl_mem dest, cl_mem src, size_t size, int *index,
                                  0, NULL, &eventList[*index]);
 
   (*index)++;
+  residence_tag(dest, size, CPU_GPU);
   if (ciErr1 != CL_SUCCESS) {
     printf(" Error %d, in //cl_copyBuffer, Line %u in file %s !!!\n\n", ciErr1,
            __LINE__, __FILE__);
@@ -382,6 +387,7 @@ void cl_copyBuffer(cl_mem dest, int destOffset, cl_mem src, size_t size,
                                  destOffset, size, 0, NULL, &eventList[*index]);
 
   (*index)++;
+  residence_tag(dest, destOffset + size, CPU_GPU);
   // clEnqueueWriteBuffer(CommandQueue[CPU_GPU], to, CL_FALSE, 0, size, from, 0,
   // NULL, NULL);
   if (ciErr1 != CL_SUCCESS) {
@@ -410,6 +416,7 @@ void cl_copyBuffer(cl_mem dest, int destOffset, cl_mem src, int srcOffset,
                                  destOffset, size, 0, NULL, &eventList[*index]);
 
   (*index)++;
+  residence_tag(dest, destOffset + size, CPU_GPU);
   // clEnqueueWriteBuffer(CommandQueue[CPU_GPU], to, CL_FALSE, 0, size, from, 0,
   // NULL, NULL);
   if (ciErr1 != CL_SUCCESS) {
@@ -79,7 +79,8 @@ void cl_launchKernel(cl_uint work_dim, const size_t *groups, size_t *threads,cl_
 #define CL_MALLOC_R(PTR,SIZE) cl_malloc(PTR,CL_MEM_READ_ONLY,SIZE)
 #define CL_MALLOC(PTR,SIZE) cl_malloc(PTR,CL_MEM_READ_WRITE,SIZE)
 #define CL_MALLOC_W(PTR,SIZE) cl_malloc(PTR,CL_MEM_WRITE_ONLY,SIZE)
-#define CL_FREE(PTR) if(PTR)clReleaseMemObject(PTR);
+void residence_forget(cl_mem mem);
+#define CL_FREE(PTR) if(PTR)residence_forget(PTR),clReleaseMemObject(PTR);
 
 #define __DEBUG__(STR) printf(STR);
 
@@ -99,6 +99,7 @@ pthread_t h_thread;
 pthread_t h_thread1;
 pthread_t h_thread2;
 int global_KernelSchedule = 0;
+int global_ResidencyAware = 1;
 volatile int thread_running = 0;
 using namespace std;
 void Cleanup(int iExitCode);
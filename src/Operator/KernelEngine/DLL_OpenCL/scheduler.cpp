@@ -81,6 +81,13 @@ void inline recordUpdate(double _gBurden, double _cBurden)
 
 
 
+/*moving size bytes off a device is charged as a read there, onto a device as a write there*/
+double getMigrationBurden(int from,int to,double size)
+{
+	if(from==to||from<0) return 0;
+	return getAddBurden_Read(&from,size)+getAddBurden_Write(&to,size);
+}
+
 int Kernelscheduler(int size,int kid,int *Flag_CPU_GPU,double * burden,int _CPU_GPU)
 {
 	int CPU_GPU=0;
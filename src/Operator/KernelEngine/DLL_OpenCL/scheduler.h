@@ -3,4 +3,5 @@ void deschedule(const int preFlag, const double preBurden);
 int  cl_readbufferscheduler(int size,int *Flag_CPU_GPU,double * burden,int _CPU_GPU);
 int  cl_writebufferscheduler(int size,int *Flag_CPU_GPU,double * burden,int _CPU_GPU);
 int  cl_copyBufferscheduler(int size,int *Flag_CPU_GPU,double * burden,int _CPU_GPU);
+double getMigrationBurden(int from,int to,double size);
 void inline recordUpdate(double _gBurden, double _cBurden);
\ No newline at end of file
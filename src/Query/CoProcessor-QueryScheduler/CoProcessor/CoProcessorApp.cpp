@@ -50,7 +50,7 @@ int main(int argc, char **argv)
 	int choice;
 	QUERY_TYPE qt;
 	initDB2("RS.conf",TEST_MAX);
-	QUERY_TYPE qT1=Q_RANGE_SELECTION;
+	QUERY_TYPE qT1=Q_POINT_SELECTION;//point lookups mixed with the heavy joins.
 	QUERY_TYPE qT2=Q_HJ;
 	testQueryProcessor(qT1,qT2,numQueries,numThread);
 	EngineStop();
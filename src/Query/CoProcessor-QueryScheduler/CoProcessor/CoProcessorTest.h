@@ -19,12 +19,19 @@ typedef enum{
 	Q_NINLJ,
 }QUERY_TYPE;
 
+//priority classes of the dispatcher, point lookups are latency sensitive.
+#define QUERY_CLASS_LOW 0
+#define QUERY_CLASS_HIGH 1
+
 struct Query_stat{
 	bool isAssigned;
 	EXEC_MODE eM;
 	QUERY_TYPE qT;
 	float speedupGPUoverCPU;
 	float timeInSec;
+	int priority;//QUERY_CLASS_LOW or QUERY_CLASS_HIGH
+	double deadline;//ms after the batch is submitted, 0 for no deadline.
+	double finishTime;//ms after the batch is submitted.
 	//bool needCop;
 };
 
@@ -54,6 +61,7 @@ struct tp_singleQuery{
 	EXEC_MODE eM;
 	int id;
 	int postThreadID;
+	QUERY_TYPE qT;
 	void init(EXEC_MODE peM, char* pquery, int pid, int ppostThreadID)
 	{
 		eM=peM;
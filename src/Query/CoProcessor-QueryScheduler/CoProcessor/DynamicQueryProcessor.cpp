@@ -4,6 +4,9 @@
 #include "Helper.h"
 #include "MyThreadPoolCop.h"
 #include "QueryPlanTree.h"
+#include <algorithm>
+#include <float.h>
+#include <sys/time.h>
 
 #define CPUCORE_FORGPU 4
 
@@ -11,6 +14,10 @@
 #define WORK_STEALING 1
 
 #define STEALING_CHANCE 3
+/*share of the measured device time reserved for QUERY_CLASS_HIGH*/
+#define QUERY_HIGH_SHARE 0.3
+/*deadline of a high class query, in multiples of its predicted cost*/
+#define QUERY_DEADLINE_FACTOR 4
 bool isGPUavailable = true;
 extern double evalautedQuery;
 extern double Query_UpCPUBurden;
@@ -24,6 +31,7 @@ extern double Query_LothresholdForCPUApp;
 extern double Query_SpeedupGPUOverCPU[12];
 extern double RunInCPU[12];
 extern double RunInGPU[12];
+extern void queryTest(QUERY_TYPE qt, EXEC_MODE CPU_GPU, int qid);
 
 extern pthread_mutex_t Query_CPUBurdenCS;
 extern pthread_mutex_t Query_GPUBurdenCS;
@@ -54,42 +62,102 @@ void inline CPUBurdenDEC(const double burden) {
 double inline getSpeedUP(int qid) { return Query_SpeedupGPUOverCPU[qid]; }
 double inline getAddCPUBurden(int qid) { return RunInCPU[qid]; }
 double inline getAddGPUBurden(int qid) { return RunInGPU[qid]; }
+double inline getPredictedCost(int qid) {
+  return std::min(RunInCPU[qid], RunInGPU[qid]);
+}
+
+/*submission time of the batch and the device time used by each class*/
+static struct timeval batchStart;
+static double servedTime[2];
+/*run time of the finished queries of each type, for the uncalibrated ones*/
+static double measuredTime[12];
+static int measuredRuns[12];
+/*predicted cost of a query type, or its mean run time so far when the
+ * handshake did not calibrate it; 0 while nothing is known*/
+double inline getQueryCost(int qid) {
+  double cost = getPredictedCost(qid);
+  if (cost > 0)
+    return cost;
+  if (measuredRuns[qid] == 0)
+    return 0;
+  return measuredTime[qid] / measuredRuns[qid];
+}
+double inline getElapsedMS() {
+  struct timeval now;
+  gettimeofday(&now, 0);
+  return (now.tv_sec - batchStart.tv_sec) * 1000.0 +
+         (now.tv_usec - batchStart.tv_usec) / 1000.0;
+}
+/*slack of a query: time left before its deadline once it has run*/
+double inline getSlack(Query_stat *stat, double now) {
+  if (stat->deadline <= 0)
+    return DBL_MAX;
+  return stat->deadline - now - getQueryCost(stat->qT);
+}
 
+/*
+ * Pick the query with the least slack in each class. The high class takes
+ * the device while it has used less than QUERY_HIGH_SHARE of the measured
+ * run time, or when its query cannot wait for another one to finish;
+ * otherwise the low class goes. The caller holds the dispatch mutex.
+ */
 int pickQuerySmart(int threadid, Query_stat *gQstat, int numQuery) {
   int i = 0;
   int result = -1;
-  /*pick them up senqutially*/
-  for (i = 0; i < numQuery; i++)
-    if (gQstat[i].isAssigned == false) {
-      result = i;
-      gQstat[i].isAssigned = true;
-      break;
+  int best[2] = {-1, -1};
+  double bestSlack[2] = {DBL_MAX, DBL_MAX};
+  double now = getElapsedMS();
+  for (i = 0; i < numQuery; i++) {
+    if (gQstat[i].isAssigned)
+      continue;
+    int c = gQstat[i].priority;
+    double slack = getSlack(&gQstat[i], now);
+    if (best[c] == -1 || slack < bestSlack[c]) {
+      best[c] = i;
+      bestSlack[c] = slack;
     }
+  }
+  if (best[QUERY_CLASS_HIGH] == -1)
+    result = best[QUERY_CLASS_LOW];
+  else if (best[QUERY_CLASS_LOW] == -1)
+    result = best[QUERY_CLASS_HIGH];
+  else {
+    double served = servedTime[QUERY_CLASS_HIGH] + servedTime[QUERY_CLASS_LOW];
+    bool urgent =
+        bestSlack[QUERY_CLASS_HIGH] <
+        getQueryCost(gQstat[best[QUERY_CLASS_LOW]].qT);
+    if (urgent || servedTime[QUERY_CLASS_HIGH] <= QUERY_HIGH_SHARE * served)
+      result = best[QUERY_CLASS_HIGH];
+    else
+      result = best[QUERY_CLASS_LOW];
+  }
 
   if (result == -1)
     return -1;
+  QUERY_TYPE qT = gQstat[result].qT;
+  gQstat[result].isAssigned = true;
 
 /*QUERY SCHEDULER*/
 #ifdef Greedy
-  if ((Query_CPUBurden + getAddCPUBurden(i)) <
-      (Query_GPUBurden + getAddGPUBurden(i))) {
+  if ((Query_CPUBurden + getAddCPUBurden(qT)) <
+      (Query_GPUBurden + getAddGPUBurden(qT))) {
     printf("Query_CPUBurden %lf,Query_GPUBurden %lf\n", Query_CPUBurden,
            Query_GPUBurden);
-    gQstat[i].eM = EXEC_CPU;
-    CPUBurdenINC(getAddCPUBurden(i));
+    gQstat[result].eM = EXEC_CPU;
+    CPUBurdenINC(getAddCPUBurden(qT));
   } else {
-    gQstat[i].eM = EXEC_GPU;
-    GPUBurdenINC(getAddGPUBurden(i));
+    gQstat[result].eM = EXEC_GPU;
+    GPUBurdenINC(getAddGPUBurden(qT));
   }
 #else
   pthread_mutex_lock(&(preEMCS));
   if (preEM == EXEC_CPU) {
-    gQstat[i].eM = EXEC_GPU;
-    GPUBurdenINC(getAddGPUBurden(i));
+    gQstat[result].eM = EXEC_GPU;
+    GPUBurdenINC(getAddGPUBurden(qT));
     preEM = EXEC_GPU;
   } else {
-    gQstat[i].eM = EXEC_CPU;
-    CPUBurdenINC(getAddCPUBurden(i));
+    gQstat[result].eM = EXEC_CPU;
+    CPUBurdenINC(getAddCPUBurden(qT));
     preEM = EXEC_CPU;
   }
   pthread_mutex_unlock(&(preEMCS));
@@ -112,9 +180,9 @@ void* tp_QueryThread(void *lpParam) {
   int len = tree.planStatus->numResultColumn * tree.planStatus->numResultRow;
 deschedule:
   if (eM == EXEC_CPU) {
-    CPUBurdenDEC(getAddCPUBurden(pData->id));
+    CPUBurdenDEC(getAddCPUBurden(pData->qT));
   } else {
-    GPUBurdenDEC(getAddGPUBurden(pData->id));
+    GPUBurdenDEC(getAddGPUBurden(pData->qT));
   }
   free(tree.planStatus->finalResult);
   return 0;
@@ -155,9 +223,18 @@ void *tp_naiveQP(void *lpParam) {
     if (pData == NULL)
       exit(2);
     pData->init(gQstat[curQuery].eM, query, curQuery, threadid);
+    pData->qT = gQstat[curQuery].qT;
     pool->assignParameter(0, pData);
     pool->assignTask(0, tp_QueryThread); // execute this query.
+    double startTime = getElapsedMS();
     pool->run();
+    gQstat[curQuery].finishTime = getElapsedMS();
+    double runTime = gQstat[curQuery].finishTime - startTime;
+    WaitForSingleObject(dispatchMutex, INFINITE);
+    servedTime[gQstat[curQuery].priority] += runTime;
+    measuredTime[gQstat[curQuery].qT] += runTime;
+    measuredRuns[gQstat[curQuery].qT]++;
+    ReleaseMutex(dispatchMutex);
     free(pData);
     pool->destory();
     // resetGPU();
@@ -165,6 +242,34 @@ void *tp_naiveQP(void *lpParam) {
   return 0;
 }
 
+/*per class p50/p99 latency and deadline miss rate, in ms*/
+void reportClassLatency(FILE *ofp, Query_stat *gQStat, int numQuery) {
+  const char *className[2] = {"low", "high"};
+  double *latency = (double *)malloc(sizeof(double) * numQuery);
+  int c, i;
+  for (c = QUERY_CLASS_HIGH; c >= QUERY_CLASS_LOW; c--) {
+    int n = 0, withDeadline = 0, missed = 0;
+    for (i = 0; i < numQuery; i++) {
+      if (gQStat[i].priority != c)
+        continue;
+      latency[n++] = gQStat[i].finishTime;
+      if (gQStat[i].deadline > 0) {
+        withDeadline++;
+        if (gQStat[i].finishTime > gQStat[i].deadline)
+          missed++;
+      }
+    }
+    if (n == 0)
+      continue;
+    std::sort(latency, latency + n);
+    fprintf(ofp, "%s class: %d queries, p50 %lf p99 %lf, deadline miss %lf\n",
+            className[c], n, latency[(n - 1) * 50 / 100],
+            latency[(n - 1) * 99 / 100],
+            withDeadline ? (double)missed / withDeadline : 0.0);
+  }
+  free(latency);
+}
+
 void testQueryProcessor(QUERY_TYPE fromType, QUERY_TYPE toType, int numQuery,
                         int numThread) {
   HANDLE dispatchMutex = CreateMutex(NULL, FALSE, NULL);
@@ -177,13 +282,32 @@ void testQueryProcessor(QUERY_TYPE fromType, QUERY_TYPE toType, int numQuery,
   char **sqlQuery = (char **)malloc(sizeof(char *) * numQuery);
   // QUERY_TYPE* queryType=(QUERY_TYPE*)malloc(sizeof(QUERY_TYPE)*numQuery);
   Query_stat *gQStat = new Query_stat[numQuery];
+  // the point lookup deadlines need its cost; measure it if the handshake
+  // skipped it.
+  if (fromType == Q_POINT_SELECTION &&
+      getPredictedCost(Q_POINT_SELECTION) <= 0) {
+    queryTest(Q_POINT_SELECTION, EXEC_CPU, 0);
+    queryTest(Q_POINT_SELECTION, EXEC_GPU, 0);
+  }
   for (i = 0; i < numQuery; i++) {
     sqlQuery[i] = new char[512];
     gQStat[i].qT = makeRandomQuery(fromType, toType, sqlQuery[i]);
     gQStat[i].speedupGPUoverCPU = getSpeedUP(gQStat[i].qT);
     // cout<<gQStat[i].speedupGPUoverCPU<<endl;
     gQStat[i].isAssigned = false;
+    gQStat[i].finishTime = 0;
+    if (gQStat[i].qT == Q_POINT_SELECTION) {
+      gQStat[i].priority = QUERY_CLASS_HIGH;
+      gQStat[i].deadline = QUERY_DEADLINE_FACTOR * getQueryCost(gQStat[i].qT);
+    } else {
+      gQStat[i].priority = QUERY_CLASS_LOW;
+      gQStat[i].deadline = 0;
+    }
   }
+  servedTime[QUERY_CLASS_LOW] = 0;
+  servedTime[QUERY_CLASS_HIGH] = 0;
+  memset(measuredTime, 0, sizeof(measuredTime));
+  memset(measuredRuns, 0, sizeof(measuredRuns));
   int curID = 0;
   int numActiveThread = numThread;
   for (i = 0; i < numThread; i++) {
@@ -198,6 +322,7 @@ void testQueryProcessor(QUERY_TYPE fromType, QUERY_TYPE toType, int numQuery,
   }
   int timer = genTimer(1);
   getTimer(timer);
+  gettimeofday(&batchStart, 0);
   pool->run();
   double t = getTimer(timer);
   char outputFilename[50];
@@ -205,7 +330,9 @@ void testQueryProcessor(QUERY_TYPE fromType, QUERY_TYPE toType, int numQuery,
   Query_ofp = fopen(outputFilename, "a");
   if (Query_ofp != NULL) {
     fprintf(Query_ofp, "<%d> <%d>\n", numQuery, numThread);
-    fprintf(Query_ofp, "%lf\n\n", t);
+    fprintf(Query_ofp, "%lf\n", t);
+    reportClassLatency(Query_ofp, gQStat, numQuery);
+    fprintf(Query_ofp, "\n");
     fclose(Query_ofp);
   } else {
     fprintf(stderr,
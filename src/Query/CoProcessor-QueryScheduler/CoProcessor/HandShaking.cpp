@@ -103,12 +103,16 @@ void Query_handShaking()
 	for(qid=0;qid<12;qid++){	
 			switch(qid){
 				case 0:{
-						//_ASSERTE( _CrtCheckMemory( ) );
-						//initDB2("RS.conf",TEST_SMALL);
-						//qt=Q_POINT_SELECTION;
-						//queryTest(qt,EXEC_CPU,qid);
-						//queryTest(qt,EXEC_GPU,qid);
-						//	_ASSERTE( _CrtCheckMemory( ) );
+#ifdef _WIN32
+						_ASSERTE( _CrtCheckMemory( ) );
+#endif
+						//the scheduler sets the point lookup deadlines from these costs.
+						qt=Q_POINT_SELECTION;
+						queryTest(qt,EXEC_CPU,qid);
+						queryTest(qt,EXEC_GPU,qid);
+#ifdef _WIN32
+							_ASSERTE( _CrtCheckMemory( ) );
+#endif
 						break;
 					   }
 				case 1:{